@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""End-to-end regression harness for mrsolver.
+
+Runs mrsolver on the instances in minrank-instances with pinned seeds, thread
+counts and multi-degrees, checks that each printed solution is correct, i.e.
+rank(M0 + sum_i lambda_i * M_{i+1}) <= r over GF(16), and collects the wall
+time of each phase through --timing. The timings can be stored as a baseline
+and later runs are compared against it with a relative tolerance.
+
+Optionally, a thread-scaling sweep reports the speedup and the parallel
+efficiency of one instance over 1, 2, 4, ... threads.
+
+Usage:
+    # record a baseline on the benchmark machine
+    bin/mrs-regress.py --solver=build/src/mrsolver --update=baseline.json
+    # check for regressions against it
+    bin/mrs-regress.py --solver=build/src/mrsolver --baseline=baseline.json
+    # thread-scaling sweep
+    bin/mrs-regress.py --solver=build/src/mrsolver --sweep
+
+The exit status is non-zero if any solution is wrong or any phase regressed.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# (instance, multi-degree, seed, large). Large instances are only run with
+# --all or when selected with --case. The remaining instances in minrank-instances (test-case2, test-case9
+# onwards and glue-test-case1 onwards) either have no solution found by the
+# multi-degrees below or take too long to be part of a regular run.
+CASES = [
+    ("test-case0", "2,1,1", 1, False),
+    ("test-case1", "2,1,1", 1, False),
+    ("glue-test-case0", "2,1,1", 1, False),
+    ("test-case3", "2,2,1", 1, False),
+    ("test-case5", "2,1,1", 1, False),
+    ("test-case7", "2,1,1", 1, False),
+    ("test-case6", "2,2,1", 1, True),
+    ("test-case8", "2,1,1", 1, True),
+]
+
+# instance for the thread-scaling sweep, dominated by Block Lanczos
+SWEEP_CASE = ("test-case7", "2,1,1", 1)
+
+# ============================================================================
+# GF(16) arithmetic, with x^4 + x + 1 as the irreducible polynomial
+# ============================================================================
+
+
+def gf16_mul(a, b):
+    r = 0
+    for i in range(4):
+        if (b >> i) & 1:
+            r ^= a << i
+    for i in (6, 5, 4):
+        if (r >> i) & 1:
+            r ^= 0x13 << (i - 4)
+    return r
+
+
+GF16_INV = [0] + [next(x for x in range(1, 16) if gf16_mul(a, x) == 1)
+                  for a in range(1, 16)]
+
+
+def gf16_rank(mat):
+    mat = [row[:] for row in mat]
+    rank = 0
+    for c in range(len(mat[0]) if mat else 0):
+        piv = next((i for i in range(rank, len(mat)) if mat[i][c]), None)
+        if piv is None:
+            continue
+        mat[rank], mat[piv] = mat[piv], mat[rank]
+        inv = GF16_INV[mat[rank][c]]
+        mat[rank] = [gf16_mul(inv, x) for x in mat[rank]]
+        for i in range(len(mat)):
+            if i != rank and mat[i][c]:
+                f = mat[i][c]
+                mat[i] = [x ^ gf16_mul(f, y) for x, y in zip(mat[i], mat[rank])]
+        rank += 1
+    return rank
+
+# ============================================================================
+# instances and solutions
+# ============================================================================
+
+
+def load_instance(path):
+    """Return (r, [M0, M1, ...]) of a MinRank instance."""
+    with open(path) as f:
+        txt = f.read()
+    r = int(re.search(r"^r\s*=\s*(\d+)", txt, re.M).group(1))
+    blocks = re.findall(r"^M\d+:\n((?:[0-9 ]+\n?)+)", txt, re.M)
+    mats = [[[int(x) for x in line.split()]
+             for line in blk.strip().split("\n")] for blk in blocks]
+    return r, mats
+
+
+def check_solution(inst, output):
+    """Return (ok, message) for the solution printed by mrsolver."""
+    r, mats = inst
+    lam = [int(x) for x in re.findall(r"lambda_\d+ = (\d+)", output)]
+    if not lam:
+        return False, "no solution printed"
+    if len(lam) != len(mats) - 1:
+        return False, "expected %d lambdas, got %d" % (len(mats) - 1, len(lam))
+    s = [row[:] for row in mats[0]]
+    for l, m in zip(lam, mats[1:]):
+        for i, row in enumerate(m):
+            s[i] = [x ^ gf16_mul(l, y) for x, y in zip(s[i], row)]
+    rank = gf16_rank(s)
+    if rank > r:
+        return False, "rank %d > %d" % (rank, r)
+    return True, "rank %d" % rank
+
+# ============================================================================
+# running the solver
+# ============================================================================
+
+
+def run_solver(args, name, mdeg, seed, tnum):
+    """Run mrsolver once and return (output, timing report)."""
+    path = os.path.join(args.instances, name + ".txt")
+    with tempfile.NamedTemporaryFile(suffix=".json") as tf:
+        cmd = [args.solver, "--minrank=" + path, "--mdeg=" + mdeg,
+               "--seed=%d" % seed, "--thread=%d" % tnum,
+               "--timing=" + tf.name] + args.extra
+        try:
+            p = subprocess.run(cmd, stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT,
+                               universal_newlines=True, timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            return None, None
+        if p.returncode:
+            return p.stdout, None
+        try:
+            with open(tf.name) as f:
+                timing = json.load(f)
+        except ValueError:
+            timing = None
+    return p.stdout, timing
+
+
+def best_of(args, name, mdeg, seed, tnum):
+    """Run a case args.repeat times and keep the fastest run of each phase."""
+    out, best = None, None
+    for _ in range(args.repeat):
+        out, timing = run_solver(args, name, mdeg, seed, tnum)
+        if timing is None:
+            return out, None
+        if best is None:
+            best = timing
+            continue
+        best["total_sec"] = min(best["total_sec"], timing["total_sec"])
+        for grp in ("phases", "lanczos"):
+            for k, v in timing[grp].items():
+                b = best[grp][k]
+                b["sec"] = min(b["sec"], v["sec"])
+    return out, best
+
+
+def flatten(timing):
+    """Map a timing report to {phase: sec}."""
+    sec = {"total": timing["total_sec"]}
+    for k, v in timing["phases"].items():
+        sec[k] = v["sec"]
+    for k, v in timing["lanczos"].items():
+        sec["lanczos." + k] = v["sec"]
+    return sec
+
+
+def compare(cur, base, tol, min_sec):
+    """Return the phases slower than the baseline by more than tol."""
+    slow = []
+    for k, b in sorted(base.items()):
+        # phases too short to be measured reliably are skipped
+        if k not in cur or b < min_sec:
+            continue
+        if cur[k] > b * (1.0 + tol):
+            slow.append((k, b, cur[k]))
+    return slow
+
+
+def run_cases(args):
+    base = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            base = json.load(f)["cases"]
+
+    results, failed = {}, 0
+    for name, mdeg, seed, large in CASES:
+        if large and not (args.all or args.case):
+            continue
+        if args.case and name not in args.case:
+            continue
+        key = "%s:%s:t%d" % (name, mdeg, args.thread)
+        inst = load_instance(os.path.join(args.instances, name + ".txt"))
+        out, timing = best_of(args, name, mdeg, seed, args.thread)
+        if timing is None:
+            print("%-28s FAIL  solver failed or timed out" % key)
+            failed += 1
+            continue
+
+        ok, msg = check_solution(inst, out)
+        sec = flatten(timing)
+        results[key] = sec
+        status = "ok" if ok else "FAIL"
+        failed += not ok
+        line = "%-28s %-5s %-10s %9.3fs" % (key, status, msg, sec["total"])
+        if key in base:
+            slow = compare(sec, base[key], args.tol, args.min_sec)
+            line += "  %+6.1f%% vs baseline" % (
+                100.0 * (sec["total"] / base[key]["total"] - 1.0))
+            if slow:
+                failed += 1
+                line += "  REGRESSION"
+            print(line)
+            for k, b, c in slow:
+                print("    %-24s %9.3fs -> %9.3fs (%+.1f%%)"
+                      % (k, b, c, 100.0 * (c / b - 1.0)))
+        else:
+            print(line)
+
+    if args.update:
+        with open(args.update, "w") as f:
+            json.dump({"cases": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % args.update)
+    return failed
+
+
+def run_sweep(args):
+    name, mdeg, seed = SWEEP_CASE
+    tmax = args.sweep_max or os.cpu_count() or 1
+    tnums, t = [], 1
+    while t < tmax:
+        tnums.append(t)
+        t *= 2
+    tnums.append(tmax)
+
+    print("thread scaling of %s --mdeg=%s" % (name, mdeg))
+    print("%8s %10s %10s %8s %10s" % ("threads", "total", "lanczos",
+                                      "speedup", "efficiency"))
+    t1, failed = None, 0
+    for tnum in tnums:
+        _, timing = best_of(args, name, mdeg, seed, tnum)
+        if timing is None:
+            print("%8d FAIL" % tnum)
+            failed += 1
+            continue
+        lczs = timing["phases"]["lanczos"]["sec"]
+        if t1 is None:
+            t1 = lczs
+        speedup = t1 / lczs if lczs else 0.0
+        print("%8d %9.3fs %9.3fs %8.2f %9.1f%%" % (
+            tnum, timing["total_sec"], lczs, speedup, 100.0 * speedup / tnum))
+    return failed
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    ap = argparse.ArgumentParser(
+        description="End-to-end regression harness for mrsolver")
+    ap.add_argument("--solver", default=os.path.join(root, "build", "src",
+                                                     "mrsolver"),
+                    help="path to mrsolver (default: build/src/mrsolver)")
+    ap.add_argument("--instances", default=os.path.join(root,
+                                                        "minrank-instances"),
+                    help="directory of the MinRank instances")
+    ap.add_argument("--thread", type=int, default=1,
+                    help="number of threads for the regression runs")
+    ap.add_argument("--case", action="append",
+                    help="only run the given instance; can be repeated")
+    ap.add_argument("--all", action="store_true",
+                    help="include the large instances")
+    ap.add_argument("--repeat", type=int, default=3,
+                    help="run each case N times and keep the fastest")
+    ap.add_argument("--timeout", type=int, default=600,
+                    help="timeout of a single run in seconds")
+    ap.add_argument("--baseline", help="compare against the baseline FILE")
+    ap.add_argument("--update", metavar="FILE",
+                    help="write the timings as a new baseline to FILE")
+    ap.add_argument("--tol", type=float, default=0.15,
+                    help="relative slowdown tolerated per phase (0.15)")
+    ap.add_argument("--min-sec", type=float, default=0.1,
+                    help="skip phases shorter than this in the baseline")
+    ap.add_argument("--sweep", action="store_true",
+                    help="run the thread-scaling sweep instead")
+    ap.add_argument("--sweep-max", type=int,
+                    help="max number of threads of the sweep (default: nproc)")
+    ap.add_argument("extra", nargs="*",
+                    help="extra arguments for mrsolver, after --")
+    args = ap.parse_args()
+
+    if not os.access(args.solver, os.X_OK):
+        sys.exit("mrsolver not found at %s" % args.solver)
+    failed = run_sweep(args) if args.sweep else run_cases(args)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
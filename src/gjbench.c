@@ -0,0 +1,218 @@
+/* gjbench.c: benchmark and validate the Gauss-Jordan elimination of
+ *      RC128MGF16 and RC512MGF16 against the reference implementations */
+
+#include <rc128m_gf16.h>
+#include <rc512m_gf16.h>
+#include <dm_gf16.h>
+#include <thpool.h>
+#include <util.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* usage: check if the result of a Gauss-Jordan elimination is valid. The
+ *      reference implementation never picks the rows it parks at singular
+ *      columns as pivots again, so the result to check must find at least the
+ *      same independent columns. Then the row operations must satisfy
+ *      inv * a = m, the columns of the pivots must be unit vectors, and the
+ *      rows of the singular columns must be zero.
+ * params:
+ *      1) p: ptr to struct RC128MGF16 for temporary storage
+ *      2) a: ptr to struct RC128MGF16; the input matrix
+ *      3) d0: independent columns found by the reference implementation
+ *      4) m, inv, di: result to check
+ * return: true if it's valid */
+static bool
+rc128m_gf16_gj_valid(RC128MGF16* p, RC128MGF16* a, const uint128_t* d0,
+                     const RC128MGF16* m, const RC128MGF16* inv,
+                     const uint128_t* di) {
+    uint128_t t; uint128_t_and(&t, d0, di);
+    if(!uint128_t_equal(&t, d0))
+        return false;
+    rc128m_gf16_mul_naive(p, inv, a);
+    for(uint32_t r = 0; r < 128; ++r) {
+        const bool indep = uint128_t_at(di, r);
+        for(uint32_t c = 0; c < 128; ++c) {
+            const gf16_t v = rc128m_gf16_at(m, r, c);
+            if(rc128m_gf16_at(p, r, c) != v)
+                return false;
+            if(!indep && v)
+                return false;
+            if(uint128_t_at(di, c) && v != (r == c))
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool
+rc512m_gf16_gj_valid(RC512MGF16* p, RC512MGF16* a, const uint512_t* d0,
+                     const RC512MGF16* m, const RC512MGF16* inv,
+                     const uint512_t* di) {
+    uint512_t t; uint512_t_and(&t, d0, di);
+    if(!uint512_t_equal(&t, d0))
+        return false;
+    rc512m_gf16_mul_naive(p, inv, a);
+    for(uint32_t r = 0; r < 512; ++r) {
+        const bool indep = uint512_t_at(di, r);
+        for(uint32_t c = 0; c < 512; ++c) {
+            const gf16_t v = rc512m_gf16_at(m, r, c);
+            if(rc512m_gf16_at(p, r, c) != v)
+                return false;
+            if(!indep && v)
+                return false;
+            if(uint512_t_at(di, c) && v != (r == c))
+                return false;
+        }
+    }
+    return true;
+}
+
+/* usage: copy a struct RC512MGF16 into a struct DMGF16 of the same size, or
+ *      the other way around
+ * params:
+ *      1) dm: ptr to struct DMGF16
+ *      2) rc: ptr to struct RC512MGF16
+ *      3) to_dm: true if rc is copied into dm
+ * return: void */
+static void
+dm_gf16_rc512m_copy(DMGF16* dm, RC512MGF16* rc, bool to_dm) {
+    for(uint32_t r = 0; r < 512; ++r) {
+        for(uint32_t c = 0; c < 512; ++c) {
+            if(to_dm)
+                dm_gf16_set_at(dm, r, c, rc512m_gf16_at(rc, r, c));
+            else
+                rc512m_gf16_set_at(rc, r, c, dm_gf16_at(dm, r, c));
+        }
+    }
+}
+
+#define BENCH(cycles, expr) do { \
+    uint64_t __start = rdtsc(); \
+    expr; \
+    (cycles) += rdtsc() - __start; \
+} while(0)
+
+int
+main(int argc, char* argv[]) {
+    uint32_t rounds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 20;
+    uint32_t tnum = (argc > 2) ? strtoul(argv[2], NULL, 0) : get_cpu_core_count();
+    uint32_t dsize = (argc > 3) ? strtoul(argv[3], NULL, 0) : 2048;
+    if(!rounds || !tnum || !dsize) {
+        printf_err("usage: %s [ROUNDS] [THREADS] [DENSE_SIZE]\n", argv[0]);
+        return 1;
+    }
+    srand(time(NULL));
+
+    Threadpool* tp = thpool_create(tnum);
+    RC128MGF16* a128 = rc128m_gf16_create();
+    RC128MGF16* p128 = rc128m_gf16_create();
+    RC128MGF16* m128 = rc128m_gf16_arr_create(2);
+    RC128MGF16* i128 = rc128m_gf16_arr_create(2);
+    RC512MGF16* a512 = rc512m_gf16_create();
+    RC512MGF16* p512 = rc512m_gf16_create();
+    RC512MGF16* m512[3], *i512[3];
+    for(uint32_t i = 0; i < 3; ++i) {
+        m512[i] = rc512m_gf16_create();
+        i512[i] = rc512m_gf16_create();
+    }
+    DMGF16* dm512 = dm_gf16_create(512, 512);
+    DMGF16* di512 = dm_gf16_create(512, 512);
+    DMGF16* dml = dm_gf16_create(dsize, dsize);
+    DMGF16* dsl = dm_gf16_create(dsize, 1);
+    uint64_t* ddi = malloc(sizeof(uint64_t) * ((dsize + 63) >> 6));
+    int rval = 0;
+    if(!tp || !a128 || !p128 || !m128 || !i128 || !a512 || !p512 ||
+       !m512[0] || !m512[1] || !m512[2] || !i512[0] || !i512[1] || !i512[2] ||
+       !dm512 || !di512 || !dml || !dsl || !ddi) {
+        printf_err("[!] Failed to allocate memory\n");
+        rval = 1;
+        goto gjbench_cleanup;
+    }
+
+    uint64_t c128[2] = {0}, c512[4] = {0}, cl = 0;
+    uint32_t mismatch = 0;
+    for(uint32_t k = 0; k < rounds; ++k) {
+        uint128_t d128[2];
+        rc128m_gf16_rand(a128);
+        for(uint32_t i = 0; i < 2; ++i) {
+            rc128m_gf16_copy(rc128m_gf16_arr_at(m128, i), a128);
+            rc128m_gf16_identity(rc128m_gf16_arr_at(i128, i));
+        }
+        BENCH(c128[0], rc128m_gf16_gj_naive(rc128m_gf16_arr_at(m128, 0),
+                                            rc128m_gf16_arr_at(i128, 0),
+                                            d128));
+        BENCH(c128[1], rc128m_gf16_gj(rc128m_gf16_arr_at(m128, 1),
+                                      rc128m_gf16_arr_at(i128, 1), d128 + 1));
+        mismatch += !rc128m_gf16_gj_valid(p128, a128, d128,
+                                          rc128m_gf16_arr_at(m128, 1),
+                                          rc128m_gf16_arr_at(i128, 1), d128 + 1);
+
+        uint512_t d512[3];
+        rc512m_gf16_rand(a512);
+        for(uint32_t i = 0; i < 3; ++i) {
+            rc512m_gf16_copy(m512[i], a512);
+            rc512m_gf16_identity(i512[i]);
+        }
+        BENCH(c512[0], rc512m_gf16_gj_naive(m512[0], i512[0], d512));
+        BENCH(c512[1], rc512m_gf16_gj(m512[1], i512[1], d512 + 1));
+        BENCH(c512[2], rc512m_gf16_gj_parallel(m512[2], i512[2], d512 + 2,
+                                               tnum, tp));
+        for(uint32_t i = 1; i < 3; ++i)
+            mismatch += !rc512m_gf16_gj_valid(p512, a512, d512, m512[i],
+                                              i512[i], d512 + i);
+
+        // the dense matrix, checked in the same way
+        dm_gf16_rc512m_copy(dm512, a512, true);
+        dm_gf16_zero(di512);
+        for(uint32_t i = 0; i < 512; ++i)
+            dm_gf16_set_at(di512, i, i, 1);
+        BENCH(c512[3], dm_gf16_gj(dm512, di512, ddi, tnum, tp));
+        uint512_t dd;
+        memcpy(dd.s, ddi, sizeof(uint64_t) * 8);
+        dm_gf16_rc512m_copy(dm512, m512[1], false);
+        dm_gf16_rc512m_copy(di512, i512[1], false);
+        mismatch += !rc512m_gf16_gj_valid(p512, a512, d512, m512[1], i512[1],
+                                          &dd);
+
+        dm_gf16_rand(dml);
+        dm_gf16_rand(dsl);
+        BENCH(cl, dm_gf16_gj(dml, dsl, ddi, tnum, tp));
+    }
+
+    printf("kernel,size,threads,cycles_per_call,speedup\n");
+    printf("gj_naive,128,1,%lu,1.00\n", c128[0] / rounds);
+    printf("gj,128,1,%lu,%.2f\n", c128[1] / rounds, (double) c128[0] / c128[1]);
+    printf("gj_naive,512,1,%lu,1.00\n", c512[0] / rounds);
+    printf("gj,512,1,%lu,%.2f\n", c512[1] / rounds, (double) c512[0] / c512[1]);
+    printf("gj_parallel,512,%u,%lu,%.2f\n", tnum, c512[2] / rounds,
+           (double) c512[0] / c512[2]);
+    printf("dm_gj,512,%u,%lu,%.2f\n", tnum, c512[3] / rounds,
+           (double) c512[0] / c512[3]);
+    printf("dm_gj,%u,%u,%lu,\n", dsize, tnum, cl / rounds);
+    if(mismatch) {
+        printf_err("[!] %u results are invalid\n", mismatch);
+        rval = 1;
+    }
+
+gjbench_cleanup:
+    rc128m_gf16_free(a128);
+    rc128m_gf16_free(p128);
+    rc128m_gf16_arr_free(m128);
+    rc128m_gf16_arr_free(i128);
+    rc512m_gf16_free(a512);
+    rc512m_gf16_free(p512);
+    for(uint32_t i = 0; i < 3; ++i) {
+        rc512m_gf16_free(m512[i]);
+        rc512m_gf16_free(i512[i]);
+    }
+    dm_gf16_free(dm512);
+    dm_gf16_free(di512);
+    dm_gf16_free(dml);
+    dm_gf16_free(dsl);
+    free(ddi);
+    thpool_destroy(tp, true);
+    return rval;
+}
@@ -1,275 +1,207 @@
 #include <options.h>
-#include <gf.h>
-#include <gfa.h>
-#include <matrix_gf16.h>
 #include <thpool.h>
 #include <util.h>
 #include <gfm.h>
 #include <minrank.h>
 #include <ks.h>
 #include <mdeg.h>
-#include <mdmac.h>
-#include <cmsm_generic.h>
-#include <block_lanczos_gf16.h>
-#include <blake2s.h>
-#include <hmap.h>
+#include <planner.h>
+#include <prof.h>
 #include <loader.h>
+#include <mrs.h>
+#include <cosched.h>
+#include <guess.h>
+#include <dist.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <stdlib.h>
 
-// for solving the final linear system
-#include <rc64m_gf16.h>
-#include <rc128m_gf16.h>
-#include <rc256m_gf16.h>
-#include <rc512m_gf16.h>
-
-// sc for solution container
-uint32_t g_sc_size;
-void* (*g_sc_create)(void);
-void (*g_sc_zero)(void*);
-void* (*g_sc_raddr)(void*, uint32_t);
-gf16_t (*g_sc_at)(void*, uint32_t, uint32_t);
-void (*g_sc_gj_internal)(void*, void*, void*);
-void (*g_sc_free)(void*);
-uint64_t (*g_sc_uint_at)(void*, uint32_t);
-void (*g_sc_row_set_at)(void*, uint32_t, gf16_t);
-
-typedef union {
-    uint512_t b512;
-    uint256_t b256;
-    uint128_t b128;
-    uint64_t b64;
-} sc_di_t;
-
-static inline void
-g_sc_gj(void* restrict sc, void* restrict inv, sc_di_t* restrict di) {
-    void* ptr = NULL;
-    if(g_sc_size == 512) {
-        ptr = &(di->b512);
-    } else if (g_sc_size == 256) {
-        ptr = &(di->b256);
-    } else if (g_sc_size == 128) {
-        ptr = &(di->b128);
-    } else {
-        ptr = &(di->b64);
-    }
-    g_sc_gj_internal(sc, inv, ptr);
-}
-
-static inline uint64_t
-g_sc_popcnt(sc_di_t* di) {
-    if(g_sc_size == 512)
-        return uint512_t_popcount(&di->b512);
-    else if (g_sc_size == 256)
-        return uint256_t_popcount(&di->b256);
-    else if (g_sc_size == 128)
-        return uint128_t_popcount(&di->b128);
-    else
-        return uint64_popcount(di->b64);
-}
-
-static inline void
-init_sc_funcs(uint32_t remaining_ncols) {
-    assert(remaining_ncols <= 512);
-    if(remaining_ncols > 256) {
-        g_sc_size = 512;
-        g_sc_create = (void*(*)(void)) rc512m_gf16_create;
-        g_sc_zero = (void(*)(void*)) rc512m_gf16_zero;
-        g_sc_at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc512m_gf16_at;
-        g_sc_raddr = (void*(*)(void*, uint32_t)) rc512m_gf16_raddr;
-        g_sc_gj_internal = (void(*)(void*, void*, void*)) rc512m_gf16_gj;
-        g_sc_free = (void(*)(void*)) rc512m_gf16_free;
-        g_sc_uint_at = (uint64_t(*)(void*, uint32_t)) uint512_t_at;
-        g_sc_row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp512_gf16_set_at;
-    } else if(remaining_ncols > 128) {
-        g_sc_size = 256;
-        g_sc_create = (void*(*)(void)) rc256m_gf16_create;
-        g_sc_zero = (void(*)(void*)) rc256m_gf16_zero;
-        g_sc_at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc256m_gf16_at;
-        g_sc_raddr = (void*(*)(void*, uint32_t)) rc256m_gf16_raddr;
-        g_sc_gj_internal = (void(*)(void*, void*, void*)) rc256m_gf16_gj;
-        g_sc_free = (void(*)(void*)) rc256m_gf16_free;
-        g_sc_uint_at = (uint64_t(*)(void*, uint32_t)) uint256_t_at;
-        g_sc_row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp256_gf16_set_at;
-    } else if(remaining_ncols > 64) {
-        g_sc_size = 128;
-        g_sc_create = (void*(*)(void)) rc128m_gf16_create;
-        g_sc_zero = (void(*)(void*)) rc128m_gf16_zero;
-        g_sc_at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc128m_gf16_at;
-        g_sc_raddr = (void*(*)(void*, uint32_t)) rc128m_gf16_raddr;
-        g_sc_gj_internal = (void(*)(void*, void*, void*)) rc128m_gf16_gj;
-        g_sc_free = (void(*)(void*)) rc128m_gf16_free;
-        g_sc_uint_at = (uint64_t(*)(void*, uint32_t)) uint128_t_at;
-        g_sc_row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp128_gf16_set_at;
-    } else {
-        g_sc_size = 64;
-        g_sc_create = (void*(*)(void)) rc64m_gf16_create;
-        g_sc_zero = (void(*)(void*)) rc64m_gf16_zero;
-        g_sc_at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc64m_gf16_at;
-        g_sc_raddr = (void*(*)(void*, uint32_t)) rc64m_gf16_raddr;
-        g_sc_gj_internal = (void(*)(void*, void*, void*)) rc64m_gf16_gj;
-        g_sc_free = (void(*)(void*)) rc64m_gf16_free;
-        g_sc_uint_at = (uint64_t(*)(void*, uint32_t)) uint64_t_at;
-        g_sc_row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp64_gf16_set_at;
-    }
-}
-
-// TODO: fix this estimation
-#define LANCZOS_MAX_ITER    (0x1ULL << 3)
-
 /* ========================================================================
  * main
  * ======================================================================== */
 
-/* subroutine of main: find the non-zero vectors in v^T that lead to a linear
- *      combination of rows of cmsm that is zero. The indices of those vectors
- *      are encoded in a DiagMGF16* */
 static inline void
-verify_nullvec(DiagMGF16* restrict out, RMGF16* restrict p,
-               const CMSMGeneric* restrict cmsm, const RMGF16* restrict v) {
-    DiagMGF16 zv, zp;
-    rm_gf16_zc_pos(v, &zv); // find zero vectors
-    cmsm_gf16_tr_mul_rm(p, cmsm, v); // compute v^t * cm (i.e. cm^t * v)
-    rm_gf16_zc_pos(p, &zp);
-    diagm_gf16_andn(out, &zp, &zv);
-}
+print_sol(const MRSSolution* sol) {
+    if(!sol->consistent)
+        printf_ts("[+] The system has no solution\n");
 
-static inline void
-store_vec(void* p, void* sol, uint32_t dst_idx, uint32_t remaining_ncol,
-          gf16_t* vec_buf) {
-    void* dst = g_sc_raddr(p, dst_idx);
-    void* sol_dst = g_sc_raddr(sol, dst_idx);
-    g_sc_row_set_at(sol_dst, 0, vec_buf[0]); // constant term
-    for(uint32_t k = 1; k < remaining_ncol; ++k) { // variables
-        g_sc_row_set_at(dst, k-1, vec_buf[k]);
+    printf_ts("[+] Solution:\n");
+    printf("\t\tlinear variables:\n");
+    for(uint32_t i = 0; i < sol->k; ++i) { // for each linear var
+        if(sol->det[i]) {
+            printf("\t\tlambda_%u = %u\n", i, sol->val[i]);
+        } else {
+            printf("\t\tlambda_%u = free variable\n", i);
+        }
+    }
+    printf("\t\tkernel variables:\n");
+    for(uint32_t i = sol->k; i < sol->vnum; ++i) { // for each kernel var
+        uint32_t tmp[2];
+        ks_kernel_var_idx_to_2d(tmp, i, sol->k, sol->r);
+        if(sol->det[i]) {
+            printf("\t\tx(%u, %u) = %u\n", tmp[0], tmp[1], sol->val[i]);
+        } else {
+            printf("\t\tx(%u, %u) = free variable\n", tmp[0], tmp[1]);
+        }
     }
 }
 
-/* subroutine of main: given the positions of non-trivial nullvectors, compute linear
- *      combinations based on them and store the non-duplicate results */
-static inline uint32_t
-proc_nullvec(Hmap* restrict hmap, void* restrict p, void* restrict sol,
-             RMGF16* restrict prod, const RMGF16* restrict v,
-             const CMSMGeneric* restrict cmsm_kept, uint32_t tnum,
-             RMGF16PArg* restrict args, Threadpool* restrict tp,
-             const uint64_t* restrict vmap, MDMacColIterator* restrict it,
-#ifdef BLK_LANCZOS_COLLECT_STATS
-             uint32_t remaining_ncol, uint64_t* restrict full_count,
-             uint64_t* restrict dup_count) {
-#else
-            uint32_t remaining_ncol) {
-#endif
-    cmsm_gf16_tr_mul_rm_parallel(prod, cmsm_kept, v, tnum, args, tp);
-    // positions of nullvectors that are in the left kernel
-   DiagMGF16 valid_nv_pos;
-   // NOTE: we simply assume all nullvectors are in the left kernel of
-   // the submatrix to eliminate, since heuristically they are.
-    rm_gf16_nzc_pos(prod, &valid_nv_pos);
-
-    if(unlikely(diagm_gf16_is_zero(&valid_nv_pos)))
-        return 0;
-
-    uint8_t digest[BLAKE2S_HASH_SIZE];
-    gf_t vec_buf[remaining_ncol];
-    assert(remaining_ncol <= g_sc_size);
-    const uint32_t ori_nvcount = hmap_cur_size(hmap);
+/* subroutine of main: release the list of instances returned by
+ *      read_batch_list */
+static inline void
+free_batch_list(char** list, uint32_t n) {
+    if(!list)
+        return;
+    for(uint32_t i = 0; i < n; ++i)
+        free(list[i]);
+    free(list);
+}
 
-    for(uint32_t i = 0; i < g_sc_size; ++i) {
-        if( !diagm_gf16_at(&valid_nv_pos, i) )
+/* subroutine of main: read the paths to the instances to solve in batch, one
+ *      per line. Empty lines and lines starting with # are skipped. Return the
+ *      list, or NULL if the file can't be read or lists no instance */
+static char**
+read_batch_list(const char* fname, uint32_t* n) {
+    FILE* f = fopen(fname, "r");
+    if(!f)
+        return NULL;
+
+    char** list = NULL;
+    uint32_t sz = 0, cap = 0;
+    char* line = NULL;
+    size_t line_cap = 0;
+    ssize_t len;
+    while( (len = getline(&line, &line_cap, f)) >= 0 ) {
+        while(len && (line[len-1] == '\n' || line[len-1] == '\r' ||
+                      line[len-1] == ' ' || line[len-1] == '\t'))
+            line[--len] = '\0';
+        if(!len || line[0] == '#')
             continue;
 
-        uint32_t dst_idx = hmap_cur_size(hmap);
-        if(dst_idx >= g_sc_size) // enough nullvecs
-            break;
-
-        // extract the result of linear combi
-        for(uint32_t j = 0; j < remaining_ncol; ++j) {
-            // To this this, we need to map variable_index into column index in
-            // cmsm_kept. We do this with vmap, which maps from variable index
-            // to column index in MDMac. remain_cidxs maps from column index
-            // in cmsm_kept into column index in MDMac, so we can find column
-            // index in cmsm_kept when there's a match. remaining_ncol are
-            // typically small.
-            // TODO: this is ugly and inefficient
-            mdmac_col_iter_begin(it);
-            uint64_t col_idx = 0;
-            for(; col_idx < remaining_ncol; ++col_idx) {
-                if(mdmac_col_iter_idx(it) == vmap[j])
-                    break;
-                mdmac_col_iter_next(it);
-            }
-            assert(col_idx != remaining_ncol);
-            vec_buf[j] = rm_gf16_at(prod, col_idx, i);
+        if(sz == cap) {
+            cap = cap ? 2 * cap : 64;
+            char** tmp = realloc(list, sizeof(char*) * cap);
+            if(!tmp)
+                goto read_batch_list_fail;
+            list = tmp;
         }
+        if( !(list[sz] = strdup(line)) )
+            goto read_batch_list_fail;
+        ++sz;
+    }
 
-        blake2s(digest, vec_buf, NULL, BLAKE2S_HASH_SIZE, sizeof(gf_t) * remaining_ncol, 0);
-        // check if this linear combi has been extracted
-        switch(hmap_insert(hmap, digest, NULL)) {
-            case HMAP_INSERT_FULL:
-                // the bin is full, but other bins might be fine
-#ifdef BLK_LANCZOS_COLLECT_STATS
-                ++(*full_count);
-#endif
-                break;
-            case HMAP_INSERT_DUP:
-#ifdef BLK_LANCZOS_COLLECT_STATS
-                ++(*dup_count);
-#endif
-                break;
-            case HMAP_INSERT_SUC:
-                // store the linera combi
-                store_vec(p, sol, dst_idx, remaining_ncol, vec_buf);
-                break;
-            default:
-                // do nothing
-                break;
-        }
+    free(line);
+    fclose(f);
+    if(!sz) {
+        free(list);
+        return NULL;
     }
+    *n = sz;
+    return list;
 
-    return hmap_cur_size(hmap) - ori_nvcount;
+read_batch_list_fail:
+    free(line);
+    fclose(f);
+    free_batch_list(list, sz);
+    return NULL;
 }
 
-static inline void
-print_sol(void* restrict sol, void* restrict di,
-          uint32_t k, uint32_t r, uint32_t c) {
-    uint32_t total_vnum = ks_total_var_num(k, r, c);
-    for(uint32_t i = total_vnum; i < g_sc_size; ++i) {
-        if(g_sc_at(sol, i, 0)) {
-            printf_ts("[+] The system has no solution\n");
-            break;
+// progress of the instances solved by solve_throughput
+typedef struct {
+    char** names;
+    uint32_t num;
+    uint32_t solved_num;
+} ThroughputCtx;
+
+/* subroutine of solve_throughput: print the result of an instance */
+static void
+throughput_done(void* arg, uint32_t idx, CoJob* job) {
+    ThroughputCtx* ctx = arg;
+    printf_ts("[+] Instance %u/%u %s in %.2fs with %u threads: %s\n", idx + 1,
+              ctx->num, job->rv ? "failed" : "solved", job->sec, job->tnum,
+              ctx->names[idx]);
+    if(job->sol) {
+        print_sol(job->sol);
+        mrs_solution_free(job->sol);
+        job->sol = NULL;
+    }
+    ctx->solved_num += (job->rv == 0);
+}
+
+/* subroutine of main: solve the instances of the batch concurrently. The first
+ *      one is already loaded as mr, which is released along with the others.
+ *      Return 0 if all the instances are attempted, 1 otherwise */
+static int32_t
+solve_throughput(const MRSParams* restrict prm, const Options* restrict opt,
+                 char** batch, uint32_t batch_num, MinRank* mr) {
+    CoJob* jobs = calloc(batch_num, sizeof(CoJob));
+    char** names = malloc(sizeof(char*) * batch_num);
+    uint32_t n = 0;
+    int32_t rval = 0;
+    if(!jobs || !names) {
+        printf_err_ts("[!] Fail to create containers for the instances\n");
+        minrank_free(mr);
+        rval = 1;
+        goto solve_throughput_cleanup;
+    }
+
+    // the instances are small, so they're all loaded upfront
+    for(uint32_t bi = 0; bi < batch_num; ++bi) {
+        if(bi) {
+            LoaderGFMfromFileRet rt;
+            uint64_t ts = prof_start(PROF_LOAD);
+            enum LoaderGFMfromFileCode lrc = loader_gfm_from_file(&rt, batch[bi]);
+            prof_stop(PROF_LOAD, ts);
+            if(SUCCESS != lrc) {
+                printf_err_ts("[!] Failed to load input file %s\n", batch[bi]);
+                rval = 1;
+                continue;
+            }
+            if( !(mr = minrank_create(rt.nrow, rt.ncol, rt.k, rt.r, rt.m0,
+                                      rt.ms)) ) {
+                printf_err_ts("[!] Fail to create MinRank instance\n");
+                gfm_free(rt.m0);
+                gfm_arr_free(rt.ms, rt.k);
+                rval = 1;
+                continue;
+            }
+            minrank_set_field(mr, rt.q);
         }
-    }
 
-    printf_ts("[+] Solution:\n");
-    printf("\t\tlinear variables:\n");
-    for(uint32_t i = 0; i < k; ++i) { // for each linear var
-        if(g_sc_uint_at(di, i)) {
-            printf("\t\tlambda_%u = %u\n", i, g_sc_at(sol, i, 0));
-        } else {
-            printf("\t\tlambda_%u = free variable\n", i);
+        jobs[n].mr = mr;
+        if(!cosched_predict(jobs + n, prm)) {
+            printf_err_ts("[!] Fail to predict the cost of %s\n", batch[bi]);
+            minrank_free(mr);
+            rval = 1;
+            continue;
         }
+        names[n++] = batch[bi];
     }
-    printf("\t\tkernel variables:\n");
-    for(uint32_t i = k; i < total_vnum; ++i) { // for each kernel var
-        uint32_t tmp[2];
-        ks_kernel_var_idx_to_2d(tmp, i, k, r);
-        if(g_sc_uint_at(di, i)) {
-            printf("\t\tx(%u, %u) = %u\n", tmp[0], tmp[1], g_sc_at(sol, i, 0));
-        } else {
-            printf("\t\tx(%u, %u) = free variable\n", tmp[0], tmp[1]);
-        }
+
+    printf_ts("[+] Solving %u instances concurrently on %u threads within "
+              "%.2fMB\n", n, opt_tpsize(opt), opt_max_mem(opt) / MBFLOAT);
+    ThroughputCtx ctx = { .names = names, .num = n, .solved_num = 0 };
+    const double ts = get_timestamp();
+    if(!cosched_run(jobs, n, prm, opt_tpsize(opt), opt_max_mem(opt),
+                    throughput_done, &ctx)) {
+        printf_err_ts("[!] Fail to schedule the instances\n");
+        rval = 1;
     }
-}
+    const double sec = get_timestamp() - ts;
+    printf_ts("[+] Batch finished: %u of %u instances solved in %.2fs "
+              "(%.1f instances per hour)\n", ctx.solved_num, batch_num, sec,
+              sec > 0 ? 3600.0 * ctx.solved_num / sec : 0.0);
 
-static inline uint64_t
-count_nznum_in_cols(const uint32_t* restrict nznum, MDMacColIterator* restrict it) {
-    uint64_t sum = 0;
-    for(mdmac_col_iter_begin(it); !mdmac_col_iter_end(it); mdmac_col_iter_next(it)) {
-        uint64_t idx = mdmac_col_iter_idx(it);
-        sum += nznum[idx];
+solve_throughput_cleanup:
+    for(uint32_t i = 0; i < n; ++i) {
+        mrs_solution_free(jobs[i].sol);
+        minrank_free((MinRank*) jobs[i].mr);
     }
-    return sum;
+    free(jobs);
+    free(names);
+    return rval;
 }
 
 int32_t
@@ -291,22 +223,72 @@ main(int32_t argc, char* argv[]) {
         opt_free(opt);
         return 0;
     }
+    const bool dist = opt_dist(opt);
+    if(dist) {
+        if(!dist_supported()) {
+            printf_err_ts("[!] Option --dist requires a build with MPI "
+                          "(cmake -DUSE_MPI=ON)\n");
+            opt_free(opt);
+            return 1;
+        }
+        if(!dist_init(&argc, &argv)) {
+            printf_err_ts("[!] Failed to initialize MPI\n");
+            opt_free(opt);
+            return 1;
+        }
+        // all the ranks solve the same instance, only rank 0 reports it
+        if(dist_rank() && !freopen("/dev/null", "w", stdout))
+            printf_err_ts("[!] Failed to silence rank %u\n", dist_rank());
+        printf_ts("[+] Distributed over %u ranks\n", dist_size());
+    }
+    if(opt_timing_file(opt) || opt_perf_counters(opt))
+        prof_enable();
+    if(opt_perf_counters(opt) && !prof_perf_enable(opt_perf_peak_gbps(opt)))
+        printf_err_ts("[!] Hardware performance counters are unavailable, "
+                      "only the wall time is measured\n");
     const uint32_t tnum = opt_tpsize(opt); // number of threads to use
     printf_ts("number of threads to use: %u\n", tnum);
 
+    // the solver draws its random numbers from streams derived from the seed,
+    // see prng.h; rand() is only used by the calibration of the planner
+    uint32_t seed;
     if(opt_new_randseed(opt)) {
-        printf_ts("random seed: %u\n", opt_seed(opt));
-        srand(opt_seed(opt));
+        seed = opt_seed(opt);
     } else {
-        printf_ts("random seed: NULL\n");
-        srand(time(NULL));
+        seed = time(NULL);
+        // the ranks must draw the same random numbers
+        if(dist)
+            dist_bcast(&seed, sizeof(seed));
+    }
+    printf_ts("random seed: %u\n", seed);
+    srand(seed);
+
+    // in batch mode, the first instance defines the parameters
+    const char* mr_file = opt_mr_file(opt);
+    char** batch = NULL;
+    uint32_t batch_num = 1;
+    if(opt_batch_file(opt)) {
+        if( !(batch = read_batch_list(opt_batch_file(opt), &batch_num)) ) {
+            printf_err_ts("[!] Failed to read list of instances %s\n",
+                          opt_batch_file(opt));
+            opt_free(opt);
+            return 1;
+        }
+        mr_file = batch[0];
+        printf_ts("[+] Solving %u instances listed in %s\n", batch_num,
+                  opt_batch_file(opt));
     }
-    printf_ts("max output from system random generator: %d\n", RAND_MAX);
 
     LoaderGFMfromFileRet rt;
-    if(SUCCESS != loader_gfm_from_file(&rt, opt_mr_file(opt))) {
-        printf_err_ts("[!] Failed to load input file %s\n", opt_mr_file(opt));
+    uint64_t ts = prof_start(PROF_LOAD);
+    enum LoaderGFMfromFileCode lrc = loader_gfm_from_file(&rt, mr_file);
+    prof_stop(PROF_LOAD, ts);
+    if(SUCCESS != lrc) {
+        printf_err_ts("[!] Failed to load input file %s\n", mr_file);
+        free_batch_list(batch, batch_num);
         opt_free(opt);
+        if(dist)
+            dist_abort(1);
         return 1;
     }
 
@@ -317,12 +299,12 @@ main(int32_t argc, char* argv[]) {
     int32_t rval = 0; // return value
     // data storage
     Threadpool* tpool = NULL; GFM* ks = NULL; MinRank* mr = NULL;
-    const MDeg* mdeg  = NULL; MDMac* mdmac = NULL; MDMacColIterator* it = NULL;
-    CMSMGeneric* cmsm = NULL, *cmsm_kept = NULL;
-    uint64_t* vmap = NULL; uint32_t* nznum = NULL;
-    BLKGF16Arg* blkarg = NULL; RMGF16* nullvec_candidates = NULL;
-    RMGF16* p = NULL, *gf_buf = NULL; Hmap* dedup_hmap = NULL;
-    void* reduced_mdmac = NULL, *sol = NULL;
+    MRSolver* slv = NULL; MRSSolution* sol = NULL;
+    MDeg* auto_mdeg = NULL; PlanCalib calib;
+    MinRank* plan_mr = NULL; gf_t* guess_zero = NULL;
+    uint32_t nrow = rt.nrow, ncol = rt.ncol;
+    const uint32_t q = rt.q;
+    const uint32_t guess = opt_guess(opt);
 
     if( !(mr = minrank_create(rt.nrow, rt.ncol, k, r, rt.m0, rt.ms)) ) {
         printf_err_ts("[!] Fail to create MinRank instance\n");
@@ -331,279 +313,261 @@ main(int32_t argc, char* argv[]) {
         rval = 1;
         goto main_cleanup;
     }
+    minrank_set_field(mr, rt.q);
     printf_ts("[+] Input MinRank instance: %s\n"
+              "\t\tfield: GF(%u)\n"
               "\t\tdimension of matrices: %u x %u\n"
               "\t\tnumber of matrices: %u\n"
-              "\t\ttarget rank: %u\n", opt_mr_file(opt), minrank_nrow(mr),
-              minrank_ncol(mr), minrank_nmat(mr), minrank_rank(mr));
+              "\t\ttarget rank: %u\n", mr_file, minrank_field(mr),
+              minrank_nrow(mr), minrank_ncol(mr), minrank_nmat(mr),
+              minrank_rank(mr));
 
-    if(opt_ks_rand(opt)) {
-        printf_ts("[+] Generating random KS matrix:\n");
-        ks = ks_rand(minrank_nmat(mr), minrank_rank(mr), c, minrank_ncol(mr));
-    } else {
-        printf_ts("[+] Computing KS matrix:\n");
-        ks = minrank_ks(mr, c);
-    }
-
-    if(!ks) {
-        printf_err_ts("[!] Fail to create KS matrix\n");
+    if(guess && minrank_field(mr) == GF31_SIZE) {
+        printf_err_ts("[!] Guessing is not supported over GF(%u)\n",
+                      minrank_field(mr));
         rval = 1;
         goto main_cleanup;
     }
-    printf("\t\tnumber of rows in left multiplier (parameter c): %u\n"
-           "\t\tdimension (logical): %u x %u\n"
-           "\t\tdimension (actual): %lu x %lu\n",
-           opt_c(opt), opt_c(opt), minrank_ncol(mr), gfm_nrow(ks), gfm_ncol(ks));
-
-    printf_ts("[+] Selected multi-degree(s):\n");
-    uint32_t degs_num = opt_mdeg_num(opt);
-    for(uint32_t j = 0; j < degs_num; ++j) {
-        printf("\t\t( ");
-        mdeg = opt_mdeg(opt, j);
-        for(uint32_t i = 0; i < c; ++i) {
-            printf("%u, ", mdeg_deg(mdeg, i));
+    if(guess) {
+        const uint64_t guess_num = mrs_guess_num(mr, guess);
+        if(!guess_num) {
+            printf_err_ts("[!] Cannot guess %u of the %u linear variables\n",
+                          guess, minrank_nmat(mr));
+            rval = 1;
+            goto main_cleanup;
         }
-        printf("%u ), total: %u\n", mdeg_deg(mdeg, c), mdeg_total_deg(mdeg));
-    }
-
-    uint64_t max_tnum = gfm_find_max_tnum_per_eq(ks);
-    size_t mdmac_memsize = mdmac_calc_memsize(k, r, mdeg, minrank_ncol(mr),
-                                              max_tnum);
-
-    printf_ts("[+] Computing multi-degree Macaulay matrix\n"
-              "\t\tmax number of supported rows: 2^64-1\n"
-              "\t\tmax number of supported columns: 2^%u-1\n"
-              "\t\tmax number of non-zero entries in a row of the base system: %lu\n"
-              "\t\tstorage requirement: %.2fMB\n",
-              gfa_size_of_idx(), max_tnum, mdmac_memsize / MBFLOAT);
-
-    if(opt_dry(opt))
-        goto main_cleanup;
-
-    if( !(tpool = thpool_create(tnum)) ) {
-        printf_err_ts("[!] Fail to create thread pool\n");
-        rval = 1;
-        goto main_cleanup;
-    }
-
-    if(degs_num == 1)
-        mdmac = mdmac_create_from_ks(ks, mr, mdeg);
-    else
-        mdmac = mdmac_combi_create_from_ks(ks, mr, opt_degs(opt), degs_num);
-
-    if(!mdmac) {
-        printf_err_ts("[!] Fail to create multi-degree Macaulay\n");
-        rval = 1;
-        goto main_cleanup;
+        printf_ts("[+] Guessing %u linear variables: %lu specializations on "
+                  "%u worker groups\n", guess, guess_num,
+                  opt_guess_groups(opt));
     }
-    it = mdmac_col_iter_create_from_mdmac(mdmac, mdeg_is_nonlinear);
 
-    printf("\t\tdimension: %lu x %lu\n", mdmac_nrow(mdmac), mdmac_ncol(mdmac));
-    uint32_t target_nv_num = ks_total_var_num(k, r, c) + 1;
+    const MDeg** degs = opt_degs(opt);
+    uint32_t degs_num = opt_mdeg_num(opt);
+    // the matrix to eliminate only takes its buffers in memory with --ooc
+    const uint64_t ooc_blk_mem = opt_ooc_dir(opt) ? opt_ooc_blk_mem(opt) : 0;
+    if(opt_dry(opt) || opt_mdeg_auto(opt)) {
+        // when guessing, the Macaulay matrix is that of the specializations
+        const MinRank* pmr = mr;
+        if(guess) {
+            if( !(guess_zero = calloc(guess, sizeof(gf_t))) ||
+                !(plan_mr = minrank_specialize(mr, guess_zero, guess)) ) {
+                printf_err_ts("[!] Fail to specialize MinRank instance\n");
+                rval = 1;
+                goto main_cleanup;
+            }
+            pmr = plan_mr;
+        }
 
-    uint64_t cidxs_sz = mdmac_num_nlcol(mdmac);
-    uint64_t remaining_ncol = mdmac_ncol(mdmac) - cidxs_sz;
-    if(remaining_ncol > 512) {
-        printf_err_ts("[!] Resultant matrix with more than %lu columns is not "
-                      "supported\n", remaining_ncol);
-        goto main_cleanup;
-    }
-    init_sc_funcs(remaining_ncol);
+        if(opt_ks_rand(opt))
+            ks = ks_rand(minrank_nmat(pmr), minrank_rank(pmr), c,
+                         minrank_ncol(pmr), seed);
+        else
+            ks = minrank_ks(pmr, c);
+        if(!ks) {
+            printf_err_ts("[!] Fail to create KS matrix\n");
+            rval = 1;
+            goto main_cleanup;
+        }
 
-    uint32_t vnum = ks_total_var_num(k, r, c);
-    assert((vnum + 1) == remaining_ncol);
-    vmap = malloc(sizeof(uint64_t) * remaining_ncol);
-    if(!vmap) {
-        printf_err_ts("[!] Fail to create containers for variable map\n");
-        rval = 1;
-        goto main_cleanup;
-    }
-    vmap[0] = 0; // constant column
-    for(uint32_t i = 0; i < vnum; ++i) // variables (both linear and kernel)
-        vmap[1 + i] = mdmac_vidx_to_midx(mdmac, i);
+        if( !(tpool = thpool_create(tnum)) ) {
+            printf_err_ts("[!] Fail to create thread pool\n");
+            rval = 1;
+            goto main_cleanup;
+        }
 
-    if( !( nznum = malloc(sizeof(uint32_t) * mdmac_ncol(mdmac)))  ) {
-        printf_err_ts("[!] Fail to create containers for column indices\n");
-        rval = 1;
-        goto main_cleanup;
+        printf_ts("[+] Calibrating cost model\n");
+        if(!planner_calibrate(&calib, ks, pmr, c, tnum, tpool)) {
+            printf_err_ts("[!] Fail to calibrate cost model\n");
+            rval = 1;
+            goto main_cleanup;
+        }
+        printf("\t\tBlock Lanczos: %.3fns per non-zero entry, "
+               "%.3fns per row\n"
+               "\t\tconstruction: %.3fns per non-zero entry\n",
+               calib.nz_ns, calib.row_ns, calib.build_ns);
+
+        if(opt_mdeg_auto(opt)) {
+            printf_ts("[+] Searching multi-degrees within %.2fMB:\n",
+                      opt_max_mem(opt) / MBFLOAT);
+            MDPlan plan;
+            auto_mdeg = planner_auto_mdeg(&plan, &calib, ks, pmr, c,
+                                          opt_max_mem(opt), tnum, ooc_blk_mem,
+                                          true);
+            if(!auto_mdeg) {
+                printf_err_ts("[!] No multi-degree is predicted to solve the "
+                              "instance within the memory budget\n");
+                rval = 1;
+                goto main_cleanup;
+            }
+            degs = (const MDeg**) &auto_mdeg;
+            degs_num = 1;
+        }
     }
 
-    const int32_t mac_seed = rand();
-    uint64_t cmsm_rnum = opt_mac_nrow(opt);
-    if(cmsm_rnum == 0 || cmsm_rnum > mdmac_nrow(mdmac))
-        cmsm_rnum = mdmac_nrow(mdmac); // use all rows
-    const uint64_t mac_nznum = mdmac_nznum(nznum, mdmac, cmsm_rnum, mac_seed);
-    const uint64_t nznum_to_remove = count_nznum_in_cols(nznum, it);
-    mdmac_col_iter_set_filter(it, mdeg_is_linear);
-    const uint64_t nznum_to_keep = count_nznum_in_cols(nznum, it);
-    assert(mac_nznum == (nznum_to_remove + nznum_to_keep));
-    double cmsm_total_mem = cmsm_generic_calc_mem_size(cmsm_rnum, cidxs_sz,
-                                                       nznum_to_remove);
-    cmsm_total_mem += cmsm_generic_calc_mem_size(cmsm_rnum, remaining_ncol,
-                                                 nznum_to_keep);
-    cmsm_total_mem /= MBFLOAT;
-    printf("\t\trows to keep: %lu\n"
-           "\t\tcolumns to keep: %lu\n"
-           "\t\tcolumns to eliminate: %lu\n"
-           "\t\tnumber of non-zero entries: %lu (%.2f%%)\n"
-           "\t\tsize of column-majored condensed multi-degree Macaulay: %.2fMB\n",
-           cmsm_rnum, remaining_ncol, cidxs_sz, mac_nznum,
-           100.0 * mac_nznum / cmsm_rnum / cidxs_sz, cmsm_total_mem);
-
-    if( !(p = rm_gf16_create(cidxs_sz)) ) {
-        printf_err_ts("[!] Fail to create RMGF16 matrix for Block Lanczos\n");
-        rval = 1;
-        goto main_cleanup;
+    printf_ts("[+] Selected multi-degree(s):\n");
+    for(uint32_t j = 0; j < degs_num; ++j) {
+        printf("\t\t( ");
+        const MDeg* mdeg = degs[j];
+        for(uint32_t i = 0; i < c; ++i) {
+            printf("%u, ", mdeg_deg(mdeg, i));
+        }
+        printf("%u ), total: %u\n", mdeg_deg(mdeg, c), mdeg_total_deg(mdeg));
     }
 
-    printf_ts("[+] Condensing multi-degree Macaulay along columns\n");
-    mdmac_col_iter_set_filter(it, mdeg_is_nonlinear);
-    if( !(cmsm = cmsm_generic_from_mdmac(mdmac, cmsm_rnum, mac_seed, it, nznum,
-                                         nznum_to_remove)) ) {
-        printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
-        rval = 1;
-        goto main_cleanup;
-    }
-    // the filter for the iterator is still mdeg_is_linear
-    mdmac_col_iter_set_filter(it, mdeg_is_linear);
-    if( !(cmsm_kept = cmsm_generic_from_mdmac(mdmac, cmsm_rnum, mac_seed, it,
-                                              nznum, nznum_to_keep)) ) {
-        printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
-        rval = 1;
+    if(opt_dry(opt)) {
+        const MinRank* pmr = plan_mr ? plan_mr : mr;
+        if(guess)
+            printf_ts("[+] The predictions below are for a single guess\n");
+        MDPlan plan;
+        for(uint32_t j = 0; j < degs_num; ++j) {
+            planner_eval(&plan, &calib, ks, pmr, degs + j, 1, tnum,
+                         ooc_blk_mem);
+            printf_ts("[+] Predictions for multi-degree #%u:\n", j);
+            planner_print(&plan);
+        }
+        if(degs_num > 1) {
+            planner_eval(&plan, &calib, ks, pmr, degs, degs_num, tnum,
+                         ooc_blk_mem);
+            printf_ts("[+] Predictions for the combined multi-degrees:\n");
+            planner_print(&plan);
+        }
         goto main_cleanup;
     }
-    printf_ts("[+] Done\n");
-    printf("\t\tmax number of entries to eliminate in a column: %lu\n"
-           "\t\tavg number of entries to eliminate in a column: %lu\n",
-           cmsm_generic_max_tnum(cmsm), cmsm_generic_avg_tnum(cmsm));
-
-    if( !(blkarg = blkgf16_arg_create(cmsm_rnum, cidxs_sz, tnum)) ) {
-        printf_err_ts("[!] Fail to create containers for Block Lanczos\n");
-        rval = 1;
+    if(ks) { // only needed by the planner
+        gfm_free(ks);
+        ks = NULL;
+    }
+
+    // in batch mode, the symbolic phase is shared by all the instances,
+    // unless the matrix to eliminate is on disk, which can't be refilled
+    MRSParams prm = {
+        .c = c,
+        .degs = degs,
+        .degs_num = degs_num,
+        .mac_nrow = opt_mac_nrow(opt),
+        .mac_row_auto = opt_mac_row_auto(opt),
+        .mac_seed = (int32_t) seed,
+        .seed = seed,
+        .filter = opt_filter(opt),
+        .deflate = opt_deflate(opt),
+        .ks_rand = opt_ks_rand(opt),
+        .reuse = batch != NULL && !opt_ooc_dir(opt),
+        .tnum = tnum,
+        .plan_dir = opt_plan_dir(opt),
+        .ooc_dir = opt_ooc_dir(opt),
+        .ooc_blk_mem = opt_ooc_blk_mem(opt),
+        .dist = dist,
+    };
+    if(batch && opt_throughput(opt)) {
+        rval = solve_throughput(&prm, opt, batch, batch_num, mr);
+        mr = NULL; // released with the other instances
         goto main_cleanup;
     }
 
-    // launch block Lanczos until enough nullvectors are found
-    // NOTE: raise the capacity of dedup_hamp to avoid hash collision
-    if( !(dedup_hmap = hmap_create(target_nv_num * 10)) ) {
-        printf_err_ts("[!] Fail to create Hmap for Block Lanczos\n");
+    if( !tpool && !(tpool = thpool_create(tnum)) ) {
+        printf_err_ts("[!] Fail to create thread pool\n");
         rval = 1;
         goto main_cleanup;
     }
-    if( !(reduced_mdmac = g_sc_create()) || !(sol = g_sc_create()) ) {
-        printf_err_ts("[!] Fail to create containers for the resultant matrix\n");
+    prm.tpool = tpool;
+    if( !guess && !(slv = mrs_solver_create(&prm)) ) {
+        printf_err_ts("[!] Fail to create solver\n");
         rval = 1;
         goto main_cleanup;
     }
-    g_sc_zero(reduced_mdmac);
-    g_sc_zero(sol);
 
-    if( !(gf_buf = rm_gf16_create(remaining_ncol)) ) {
-        printf_err_ts("[!] Fail to create buffer to GF vector\n");
-        rval = 1;
-        goto main_cleanup;
-    }
+    uint32_t solved_num = 0;
+    for(uint32_t bi = 0; bi < batch_num; ++bi) {
+        double inst_ts = get_timestamp();
+        if(bi) { // the first instance is already loaded
+            ts = prof_start(PROF_LOAD);
+            lrc = loader_gfm_from_file(&rt, batch[bi]);
+            prof_stop(PROF_LOAD, ts);
+            if(SUCCESS != lrc) {
+                printf_err_ts("[!] Failed to load input file %s\n", batch[bi]);
+                rval = 1;
+                continue;
+            }
+            if(rt.nrow != nrow || rt.ncol != ncol || rt.k != k || rt.r != r ||
+               rt.q != q) {
+                printf_err_ts("[!] Parameters of %s differ from those of %s\n",
+                              batch[bi], batch[0]);
+                gfm_free(rt.m0);
+                gfm_arr_free(rt.ms, rt.k);
+                rval = 1;
+                continue;
+            }
 
-    printf_ts("[+] Try to extract %u nullvectors\n", target_nv_num);
-    // TODO: what is the expected rank?
-    uint64_t expected_rank = (cidxs_sz > cmsm_rnum) ? cmsm_rnum : cidxs_sz;
-    printf("\t\texpected rank of submatrix to eliminate: %lu\n"
-           "\t\tblock size: %d\n"
-           "\t\texpected number of iterations: %zu\n"
-           "\t\tsize of %lu x %d matrix: %.2fMB\n"
-           "\t\tsize of %lu x %d matrix: %.2fMB\n"
-           "\t\tsize of %d x %d matrix: %.2fKB\n",
-           expected_rank,
-           BLK_LANCZOS_BLOCK_SIZE,
-           blkgf16_iter_num(BLK_LANCZOS_BLOCK_SIZE, expected_rank),
-           cmsm_rnum, BLK_LANCZOS_BLOCK_SIZE,
-           rm_gf16_memsize(cmsm_rnum) / MBFLOAT,
-           mdmac_ncol(mdmac), BLK_LANCZOS_BLOCK_SIZE,
-           rm_gf16_memsize(mdmac_ncol(mdmac)) / MBFLOAT,
-           BLK_LANCZOS_BLOCK_SIZE, BLK_LANCZOS_BLOCK_SIZE,
-           rcm_gf16_memsize() / KBFLOAT);
-
-    mdmac_free(mdmac); // release resources as soon as possible
-    mdmac = NULL;
-    free(nznum);
-    nznum = NULL;
-
-    // the filter for the iterator is still mdeg_is_linear
-#ifdef BLK_LANCZOS_COLLECT_STATS
-    uint64_t hmap_full_count = 0, hmap_dup_count = 0,
-             zero_nv_count = 0, invalid_nv_count = 0;
-#endif
-    uint64_t iter = 0;
-    while(iter++ < LANCZOS_MAX_ITER && hmap_cur_size(dedup_hmap) < target_nv_num) {
-        // TODO: record iter_count
-        uint32_t iter_count = blk_lczs_gf16(blkarg, cmsm, tpool);
-        nullvec_candidates = blkgf16_arg_v(blkarg);
-#ifdef BLK_LANCZOS_COLLECT_STATS
-        DiagMGF16 nv_pos, zv;
-        verify_nullvec(&nv_pos, p, cmsm, nullvec_candidates);
-        rm_gf16_zc_pos(nullvec_candidates, &zv); // find zero vectors
-        zero_nv_count += diagm_gf16_nzc(&zv);
-        invalid_nv_count += diagm_gf16_zc(&nv_pos);
-        uint32_t nvc = proc_nullvec(dedup_hmap, reduced_mdmac, sol, gf_buf,
-                                    nullvec_candidates, cmsm_kept,
-                                    tnum, blkgf16_arg_pargs(blkarg), tpool,
-                                    vmap, it, remaining_ncol,
-                                    &hmap_full_count, &hmap_dup_count);
-#else
-        uint32_t nvc = proc_nullvec(dedup_hmap, reduced_mdmac, sol, gf_buf,
-                                    nullvec_candidates, cmsm_kept,
-                                    tnum, blkgf16_arg_pargs(blkarg), tpool,
-                                    vmap, it, remaining_ncol);
-#endif
-        printf_ts("[+] %zu-th batch: %u iterations, %u nullvectors\n", iter, iter_count, nvc);
-    }
+            if( !(mr = minrank_create(rt.nrow, rt.ncol, k, r, rt.m0, rt.ms)) ) {
+                printf_err_ts("[!] Fail to create MinRank instance\n");
+                gfm_free(rt.m0);
+                gfm_arr_free(rt.ms, k);
+                rval = 1;
+                goto main_cleanup;
+            }
+            minrank_set_field(mr, rt.q);
+        }
 
-    printf_ts("[+] Block Lanczos finished in %zu batches\n"
-              "\t\tnullvectors extracted: %zu\n", iter-1, hmap_cur_size(dedup_hmap));
-#ifdef BLK_LANCZOS_COLLECT_STATS
-    printf("\t\tnullvectors dropped due to capacity: %zu\n"
-           "\t\tnullvectors dropped due to duplication: %zu\n"
-           "\t\tnullvectors that are full zero: %zu\n"
-           "\t\tnullvectors not in the left kernel: %zu\n",
-           hmap_full_count, hmap_dup_count, zero_nv_count,
-           invalid_nv_count);
-#endif
-
-    if(hmap_cur_size(dedup_hmap) >= target_nv_num) {
-        printf_ts("[+] Solving the extracted linear system\n");
-        if(opt_ks_rand(opt)) {
-            printf_ts("[!] This solution is for the randomly sampled KS matrix!\n");
-            printf("\t\tNot the original MinRank instance!\n");
+        if(batch)
+            printf_ts("[+] Instance %u/%u: %s\n", bi + 1, batch_num, batch[bi]);
+        int32_t rv;
+        if(guess) {
+            uint64_t tried;
+            const double guess_ts = get_timestamp();
+            rv = mrs_guess_solve(&prm, mr, guess, opt_guess_groups(opt), &sol,
+                                 &tried);
+            if(rv >= 0)
+                printf_ts("[+] %s after %lu guesses in %.2fs\n",
+                          rv ? "No guess gives a solution" : "Solution found",
+                          tried, get_timestamp() - guess_ts);
+        } else {
+            rv = mrs_solver_solve(slv, mr, &sol);
         }
-        // reduced mdmac from nullvectors is dense and small. Just run Gaussian
-        // elimination to extract the linear variables
-        sc_di_t di; g_sc_gj(reduced_mdmac, sol, &di);
-        if(g_sc_popcnt(&di) < (target_nv_num-1))
-            printf_ts("[!] Failed, only %lu nullvectors are independent\n",
-                      g_sc_popcnt(&di));
-        else
-            print_sol(sol, &di, k, r, c);
+        minrank_free(mr);
+        mr = NULL;
+        if(rv < 0) {
+            rval = 1;
+            goto main_cleanup;
+        }
+        if(sol) {
+            print_sol(sol);
+            mrs_solution_free(sol);
+            sol = NULL;
+        }
+        solved_num += (rv == 0);
+        if(batch)
+            printf_ts("[+] Instance %u/%u %s in %.2fs\n", bi + 1, batch_num,
+                      rv ? "failed" : "solved", get_timestamp() - inst_ts);
     }
+    if(batch)
+        printf_ts("[+] Batch finished: %u of %u instances solved\n",
+                  solved_num, batch_num);
 
 main_cleanup:
+    if(opt_perf_counters(opt))
+        prof_perf_print_summary(stdout);
+    if(opt_timing_file(opt) && !(dist && dist_rank()) &&
+       !prof_write_json(opt_timing_file(opt)))
+        printf_err_ts("[!] Failed to write timing report to %s\n",
+                      opt_timing_file(opt));
     printf_ts("[+] Releasing resources\n");
-    minrank_free(mr); // owns rt.m0 and rt.ms
-    gfm_free(ks);
-    mdmac_col_iter_free(it);
-    mdmac_free(mdmac);
-    free(nznum);
-    free(vmap);
-    cmsm_generic_free(cmsm);
-    cmsm_generic_free(cmsm_kept);
-    blkgf16_arg_free(blkarg);
-    rm_gf16_free(p);
-    hmap_free(dedup_hmap);
-    if(g_sc_free) {
-        g_sc_free(reduced_mdmac);
-        g_sc_free(sol);
-    }
-    rm_gf16_free(gf_buf);
+    if(mr)
+        minrank_free(mr); // owns rt.m0 and rt.ms
+    if(ks)
+        gfm_free(ks);
+    mrs_solver_free(slv);
+    mdeg_free(auto_mdeg);
+    if(plan_mr)
+        minrank_free(plan_mr);
+    free(guess_zero);
     thpool_destroy(tpool, true);
+    free_batch_list(batch, batch_num);
     opt_free(opt);
+    if(dist) {
+        // a rank that fails may leave the others blocked in a collective
+        if(rval)
+            dist_abort(rval);
+        dist_finalize();
+    }
     return rval;
 }
@@ -274,13 +274,15 @@ bitmap_popcnt_upto(const Bitmap* const a, uint64_t i) {
     uint64_t slot_idx = i >> 6;
     uint64_t offset = i & 0x3FUL;
     uint64_t c = 0;
-    for(uint64_t j = 0; (j + 1) < slot_idx; ++j) {
+    for(uint64_t j = 0; j < slot_idx; ++j) {
         c += popcnt_64b(a->s[j]);
     }
 
-    uint64_t last_slot = a->s[slot_idx];
-    uint64_t mask = (0x1UL << offset) - 1;
-    c += popcnt_64b(last_slot & mask);
+    if(offset) { // i may be the size of the bitmap
+        uint64_t last_slot = a->s[slot_idx];
+        uint64_t mask = (0x1UL << offset) - 1;
+        c += popcnt_64b(last_slot & mask);
+    }
     return c;
 }
 
@@ -391,3 +393,37 @@ bitmap_fill(Bitmap* const b, uint64_t v, uint64_t num, uint64_t offset) {
         v >>= 1;
     }
 }
+
+/* usage: Given 1 Bitmap, create its rank directory, which stores the number
+ *      of 1's before each slot so that the number of 1's before any bit takes
+ *      a single popcnt. The Bitmap must not be modified or released while
+ *      the directory is in use
+ * params:
+ *      1) b: ptr to struct Bitmap
+ * return: ptr to BitmapRank, on error return NULL */
+BitmapRank*
+bitmap_rank_create(const Bitmap* b) {
+    BitmapRank* r = malloc(sizeof(BitmapRank) +
+                           sizeof(uint64_t) * (bitmap_snum(b) + 1));
+    if(!r) {
+        return NULL;
+    }
+
+    r->b = b;
+    r->cnt[0] = 0;
+    for(uint64_t i = 0; i < bitmap_snum(b) - 1; ++i) {
+        r->cnt[i+1] = r->cnt[i] + popcnt_64b(bitmap_slot_at(b, i));
+    }
+    r->cnt[bitmap_snum(b)] = r->cnt[bitmap_snum(b)-1] +
+                             popcnt_64b(bitmap_last_slot(b));
+    return r;
+}
+
+/* usage: Release a struct BitmapRank
+ * params:
+ *      1) r: ptr to a struct BitmapRank
+ * return: void */
+void
+bitmap_rank_free(BitmapRank* r) {
+    free(r);
+}
@@ -20,6 +20,15 @@ typedef struct {
     uint64_t* restrict s;
 } Bitmap;
 
+/* ========================================================================
+ * struct BitmapRank definition
+ * ======================================================================== */
+
+typedef struct { // rank directory of a Bitmap
+    const Bitmap* b;
+    uint64_t cnt[]; // number of 1's before each slot, plus the total
+} BitmapRank;
+
 /* ========================================================================
  * functions prototypes
  * ======================================================================== */
@@ -418,4 +427,50 @@ bitmap_bitwise_and(const Bitmap* const restrict b,
 void
 bitmap_fill(Bitmap* const b, uint64_t v, uint64_t num, uint64_t offset);
 
+/* usage: Given 1 Bitmap, create its rank directory, which stores the number
+ *      of 1's before each slot so that the number of 1's before any bit takes
+ *      a single popcnt. The Bitmap must not be modified or released while
+ *      the directory is in use
+ * params:
+ *      1) b: ptr to struct Bitmap
+ * return: ptr to BitmapRank, on error return NULL */
+BitmapRank*
+bitmap_rank_create(const Bitmap* b);
+
+/* usage: Release a struct BitmapRank
+ * params:
+ *      1) r: ptr to a struct BitmapRank
+ * return: void */
+void
+bitmap_rank_free(BitmapRank* r);
+
+/* usage: Given the rank directory of a Bitmap, return the number of bits that
+ *      are set to 1 up to (but not including) the i-th bit. Same as
+ *      bitmap_popcnt_upto but in constant time
+ * params:
+ *      1) r: ptr to struct BitmapRank
+ *      2) i: index of the bit to stop counting, up to the size of the Bitmap
+ * return: the number of 1's up to (but not including) the i-th bit */
+static inline uint64_t
+bitmap_rank1(const BitmapRank* r, uint64_t i) {
+    assert(i <= bitmap_size(r->b));
+    const uint64_t offset = i & 0x3FULL;
+    uint64_t c = r->cnt[i >> 6];
+    if(offset) // i may be the size of the bitmap
+        c += uint64_popcount(bitmap_slot_at(r->b, i >> 6) &
+                             ((0x1ULL << offset) - 1));
+    return c;
+}
+
+/* usage: Given the rank directory of a Bitmap, return the number of bits that
+ *      are set to 0 up to (but not including) the i-th bit
+ * params:
+ *      1) r: ptr to struct BitmapRank
+ *      2) i: index of the bit to stop counting, up to the size of the Bitmap
+ * return: the number of 0's up to (but not including) the i-th bit */
+static inline uint64_t
+bitmap_rank0(const BitmapRank* r, uint64_t i) {
+    return i - bitmap_rank1(r, i);
+}
+
 #endif /* __BLK_LANCZOS_BITMAP_H__ */
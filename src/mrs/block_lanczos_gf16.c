@@ -2,7 +2,11 @@
 #include "block_lanczos.h"
 #include "matrix_gf16.h"
 #include "util.h"
+#include "prof.h"
 #include "thpool.h"
+#include "prng.h"
+#include "dist.h"
+#include "cmsm_ooc.h"
 #include <pthread.h>
 
 /* ========================================================================
@@ -24,6 +28,8 @@ struct BLKGF16Arg {
     RCMGF16* restrict gramian_partials;
     pthread_mutex_t lock;
     uint32_t tnum; // number of threads to use
+    uint64_t seed; // seed of the starting points, see prng.h
+    uint32_t starts; // starting points drawn since the seed was set
 };
 
 /* ========================================================================
@@ -61,6 +67,21 @@ blkgf16_arg_pargs(BLKGF16Arg* arg) {
     return arg->pargs;
 }
 
+/* usage: compute the amount of memory needed for a struct BLKGF16Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf16_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum) {
+    // v, p, Av and a partial Av for each thread, mtv, and the small matrices
+    size_t sz = sizeof(BLKGF16Arg) + (3 + tnum) * rm_gf16_memsize(rnum);
+    sz += rm_gf16_memsize(cnum) + (4 + tnum) * rcm_gf16_memsize();
+    sz += (sizeof(RMGF16PArg) + sizeof(RMGF16*)) * tnum;
+    return sz;
+}
+
 /* usage: create a struct BLKGF16Arg, which is a collection of data
  *      structures used by the Block Lanczos algorithm
  * params:
@@ -157,37 +178,105 @@ blkgf16_arg_free(BLKGF16Arg* arg) {
     free(arg);
 }
 
+/* usage: Given a struct BLKGF16Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf16_arg_set_cnum(BLKGF16Arg* arg, uint64_t cnum) {
+    if(rm_gf16_rnum(arg->mtv) == cnum)
+        return true;
+    RMGF16* mtv = rm_gf16_create(cnum);
+    if(!mtv)
+        return false;
+    rm_gf16_free(arg->mtv);
+    arg->mtv = mtv;
+    return true;
+}
+
+/* usage: Given a struct BLKGF16Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf16_arg_set_seed(BLKGF16Arg* arg, uint64_t seed) {
+    arg->seed = seed;
+    arg->starts = 0;
+}
+
 static force_inline uint32_t
 blk_lczs_gf16_generic(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
-                      Threadpool* restrict tp) {
+                      CMSMOOC* restrict ooc, Threadpool* restrict tp,
+                      bool dist) {
     // NOTE: containers for the final results and the intermediate results are
     // allocated and provided by the caller
 
-    // init: randomize v, and set p = 0
-    rm_gf16_rand(arg->v);
+    // init: randomize v, and set p = 0. The Lanczos vectors are replicated
+    // over the ranks, which draw the same v from the same stream
+    prng_fill_parallel((uint64_t*) rm_gf16_raddr(arg->v, 0),
+                       rm_gf16_rnum(arg->v) * sizeof(RowGF16) /
+                       sizeof(uint64_t), arg->seed, PRNG_LCZS, arg->starts++,
+                       arg->tnum, tp);
     rm_gf16_zero(arg->p);
 
     uint64_t iter = 0;
     DiagMGF16 di;
     do {
-        cmsm_gf16_tr_mul_rm_parallel(arg->mtv, cm, arg->v, arg->tnum,
-                                     arg->pargs, tp);
-        cmsm_gf16_mul_rm_parallel(arg->av, cm, arg->mtv, arg->tnum,
-                                  arg->av_partials, arg->pargs, tp, &arg->lock);
+        if(ooc) {
+            // both products are computed in the same pass over the matrix
+            bool ok;
+            PROF(PROF_LCZS_OOC_MUL,
+                 ok = cmsm_ooc_gf16_sym_mul_rm_parallel(arg->av, arg->mtv, ooc,
+                                                        arg->v,
+                                                        arg->av_partials, tp));
+            if(!ok)
+                return 0;
+        } else {
+            PROF(PROF_LCZS_TR_MUL,
+                 cmsm_gf16_tr_mul_rm_parallel(arg->mtv, cm, arg->v, arg->tnum,
+                                              arg->pargs, tp));
+            PROF(PROF_LCZS_MUL,
+                 cmsm_gf16_mul_rm_parallel(arg->av, cm, arg->mtv, arg->tnum,
+                                           arg->av_partials, arg->pargs, tp,
+                                           &arg->lock));
+        }
+        // each rank holds a block of the columns, so its Av is the product
+        // with its block only. So is vtAv below
+        if(dist)
+            PROF(PROF_LCZS_ALLREDUCE,
+                 dist_xor_u64((uint64_t*) rm_gf16_raddr(arg->av, 0),
+                              rm_gf16_rnum(arg->av) * sizeof(RowGF16) /
+                              sizeof(uint64_t)));
 
         // compute vtA2v and vtAv
-        rm_gf16_gramian_parallel(arg->mtv, arg->vtAv, arg->tnum,
-                                 arg->gramian_partials, arg->pargs, tp);
-        rm_gf16_gramian_parallel(arg->av, arg->vtA2v, arg->tnum,
-                                 arg->gramian_partials, arg->pargs, tp);
+        PROF(PROF_LCZS_GRAMIAN_VTAV,
+             rm_gf16_gramian_parallel(arg->mtv, arg->vtAv, arg->tnum,
+                                      arg->gramian_partials, arg->pargs, tp));
+        if(dist)
+            PROF(PROF_LCZS_ALLREDUCE,
+                 dist_xor_u64((uint64_t*) rcm_gf16_raddr(arg->vtAv, 0),
+                              BLK_LANCZOS_BLOCK_SIZE * sizeof(RowGF16) /
+                              sizeof(uint64_t)));
+        PROF(PROF_LCZS_GRAMIAN_VTA2V,
+             rm_gf16_gramian_parallel(arg->av, arg->vtA2v, arg->tnum,
+                                      arg->gramian_partials, arg->pargs, tp));
 
         // perform Gauss-Jordan on vtAv amd compute w_{inv}
+        uint64_t ts = prof_start(PROF_LCZS_GJ);
         rcm_gf16_copy(arg->c, arg->vtAv); // copy vtAv into tmp (reuse c)
         rcm_gf16_identity(arg->w); // to compute the inverse
         rcm_gf16_gj(arg->c, arg->w, &di);
+        prof_stop(PROF_LCZS_GJ, ts);
 
         // compute w_{inv} from w and indcols
         // NOTE: in most iterations, w has a small rank defect
+        ts = prof_start(PROF_LCZS_SMALL);
         if(likely(diagm_gf16_is_not_full_rank(&di)))
             rcm_gf16_zero_subset_rc(arg->w, &di);
         assert(true == rcm_gf16_is_symmetric(arg->w));
@@ -195,15 +284,22 @@ blk_lczs_gf16_generic(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
         // compute C_{i+1, i}; note that vtA2v will be modified
         rcm_gf16_mixi(arg->vtA2v, arg->vtAv, &di);
         rcm_gf16_mul_naive(arg->c, arg->w, arg->vtA2v);
+        prof_stop(PROF_LCZS_SMALL, ts);
         // compute vn (stored in Av); note that vtAv will be modified
-        rm_gf16_mixi_parallel(arg->av, arg->v, &di, arg->tnum, arg->pargs, tp);
-        rm_gf16_fms_diag_parallel(arg->av, arg->p, arg->vtAv, &di, arg->tnum,
-                                  arg->pargs, tp);
-        rm_gf16_fms_parallel(arg->av, arg->v, arg->c, arg->tnum, arg->pargs, tp);
+        PROF(PROF_LCZS_MIXI,
+             rm_gf16_mixi_parallel(arg->av, arg->v, &di, arg->tnum, arg->pargs,
+                                   tp));
+        PROF(PROF_LCZS_FMS_DIAG,
+             rm_gf16_fms_diag_parallel(arg->av, arg->p, arg->vtAv, &di,
+                                       arg->tnum, arg->pargs, tp));
+        PROF(PROF_LCZS_FMS,
+             rm_gf16_fms_parallel(arg->av, arg->v, arg->c, arg->tnum,
+                                  arg->pargs, tp));
         // compute pn (stored in p)
         DiagMGF16 ndi; diagm_gf16_negate(&ndi, &di);
-        rm_gf16_diag_fma_parallel(arg->p, arg->v, arg->w, &ndi, arg->tnum,
-                                  arg->pargs, tp);
+        PROF(PROF_LCZS_DIAG_FMA,
+             rm_gf16_diag_fma_parallel(arg->p, arg->v, arg->w, &ndi, arg->tnum,
+                                       arg->pargs, tp));
 
         // swap v and Av
         RMGF16* tmp = arg->av;
@@ -213,6 +309,13 @@ blk_lczs_gf16_generic(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
         ++iter;
     } while(likely(diagm_gf16_nonzero(&di)));
 
+    // each sparse product touches every non-zero entry once per iteration
+    if(ooc)
+        prof_add_units(PROF_LCZS_OOC_MUL, 2 * iter * cmsm_ooc_nznum(ooc));
+    else {
+        prof_add_units(PROF_LCZS_TR_MUL, iter * cmsm_generic_nznum(cm));
+        prof_add_units(PROF_LCZS_MUL, iter * cmsm_generic_nznum(cm));
+    }
     return iter;
 }
 
@@ -231,5 +334,40 @@ blk_lczs_gf16_generic(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
 uint32_t
 blk_lczs_gf16(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
               Threadpool* restrict tpool) {
-    return blk_lczs_gf16_generic(arg, cm, tpool);
+    return blk_lczs_gf16_generic(arg, cm, NULL, tpool, false);
+}
+
+/* usage: the distributed counterpart of blk_lczs_gf16. Each rank holds a
+ *      block of the columns of m, and all the ranks call it together. The
+ *      Lanczos vectors are replicated, so v is the same on all the ranks
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of the block of m must equal the parameters used to
+ *              create arg
+ *      2) cm: ptr to struct CMSMGeneric, the block of columns of m of the
+ *          calling rank
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf16_dist(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
+                   Threadpool* restrict tpool) {
+    return blk_lczs_gf16_generic(arg, cm, NULL, tpool, true);
+}
+
+/* usage: the out-of-core counterpart of blk_lczs_gf16, where m is read from
+ *      disk block by block once per iteration
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg,
+ *              and so must the number of threads given to cmsm_ooc_create
+ *      2) cm: ptr to struct CMSMOOC
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v, or 0 if reading the
+ *      matrix failed */
+uint32_t
+blk_lczs_gf16_ooc(BLKGF16Arg* restrict arg, CMSMOOC* restrict cm,
+                  Threadpool* restrict tpool) {
+    return blk_lczs_gf16_generic(arg, NULL, cm, tpool, false);
 }
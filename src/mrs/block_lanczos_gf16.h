@@ -2,8 +2,10 @@
 #define __BLOCK_LANCZOS_GF16_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "cmsm_generic.h"
+#include "cmsm_ooc.h"
 #include "r64m_gf16_parallel.h"
 #include "rmsm_generic.h"
 #include "thpool.h"
@@ -42,6 +44,15 @@ blkgf16_arg_v(BLKGF16Arg* arg);
 RMGF16PArg*
 blkgf16_arg_pargs(BLKGF16Arg* arg);
 
+/* usage: compute the amount of memory needed for a struct BLKGF16Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf16_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum);
+
 /* usage: create a struct BLKGF16Arg, which is a collection of data
  *      structures used by the Block Lanczos algorithm
  * params:
@@ -59,6 +70,26 @@ blkgf16_arg_create(uint64_t rnum, uint64_t cnum, uint32_t tnum);
 void
 blkgf16_arg_free(BLKGF16Arg* arg);
 
+/* usage: Given a struct BLKGF16Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf16_arg_set_cnum(BLKGF16Arg* arg, uint64_t cnum);
+
+/* usage: Given a struct BLKGF16Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf16_arg_set_seed(BLKGF16Arg* arg, uint64_t seed);
+
 /* usage: Given a sparse matrix m stored in column-majored format (CMSMGeneric)
  *      of size N x L and a BLKGF16Arg, find an RMatrix v such that v^T * m = 0
  *      with Block Lanczos algorithm.  The vector v is stored into the given
@@ -75,4 +106,35 @@ uint32_t
 blk_lczs_gf16(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
               Threadpool* restrict tpool);
 
+/* usage: the distributed counterpart of blk_lczs_gf16. Each rank holds a
+ *      block of the columns of m, and all the ranks call it together. The
+ *      Lanczos vectors are replicated, so v is the same on all the ranks
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of the block of m must equal the parameters used to
+ *              create arg
+ *      2) cm: ptr to struct CMSMGeneric, the block of columns of m of the
+ *          calling rank
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf16_dist(BLKGF16Arg* restrict arg, const CMSMGeneric* restrict cm,
+                   Threadpool* restrict tpool);
+
+/* usage: the out-of-core counterpart of blk_lczs_gf16, where m is read from
+ *      disk block by block once per iteration
+ * params:
+ *      1) arg: ptr to struct BLKGF16Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg,
+ *              and so must the number of threads given to cmsm_ooc_create
+ *      2) cm: ptr to struct CMSMOOC
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v, or 0 if reading the
+ *      matrix failed */
+uint32_t
+blk_lczs_gf16_ooc(BLKGF16Arg* restrict arg, CMSMOOC* restrict cm,
+                  Threadpool* restrict tpool);
+
 #endif // __BLOCK_LANCZOS_GF16_H__
@@ -0,0 +1,320 @@
+#include "block_lanczos_gf2.h"
+#include "block_lanczos.h"
+#include "uint64a.h"
+#include "util.h"
+#include "prof.h"
+#include "thpool.h"
+#include "prng.h"
+#include <pthread.h>
+
+/* ========================================================================
+ * struct BLKGF2Arg definition
+ * ======================================================================== */
+
+struct BLKGF2Arg {
+    R64MGF2* restrict v;
+    R64MGF2* restrict p;
+    R64MGF2* restrict av;
+    R64MGF2* restrict mtv;
+    RC64MGF2 vtAv;
+    RC64MGF2 vtA2v;
+    RC64MGF2 c;
+    RC64MGF2 w;
+    // containers for parallelization
+    R64MGF2PArg* restrict pargs;
+    R64MGF2** restrict av_partials;
+    pthread_mutex_t lock;
+    uint32_t tnum; // number of threads to use
+    uint64_t seed; // seed of the starting points, see prng.h
+    uint32_t starts; // starting points drawn since the seed was set
+    // nullvectors lifted to GF(16)
+    RMGF16* restrict nv;
+    RMGF16PArg* restrict nv_pargs;
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Given the rank of the square matrix (or submatrix) to eliminate,
+ *      compute the expected number of iterations for Block Lanczos algorithm.
+ * params:
+ *      1) block_sz: block size
+ *      2) r: rank of the matrix to eliminate
+ * return: estimated number of iterations */
+uint64_t pure_func
+blkgf2_iter_num(uint64_t block_sz, uint64_t r) {
+    return blkgeneric_iter_num(block_sz, 2, r);
+}
+
+/* usage: given a struct BLKGF2Arg, retrieve the container that stores the
+ *      nullvectors lifted to GF(16)
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: ptr to struct RMGF16 which stores the nullvectors */
+RMGF16*
+blkgf2_arg_v(BLKGF2Arg* arg) {
+    return arg->nv;
+}
+
+/* usage: given a struct BLKGF2Arg, retrieve the data structure used for
+ *      parallelization of the operations on the lifted nullvectors
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: ptr to struct RMGF16PArg */
+RMGF16PArg*
+blkgf2_arg_pargs(BLKGF2Arg* arg) {
+    return arg->nv_pargs;
+}
+
+/* usage: compute the amount of memory needed for a struct BLKGF2Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf2_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum) {
+    // v, p, Av and a partial Av for each thread, mtv, and the lifted v
+    size_t sz = sizeof(BLKGF2Arg) + (3 + tnum) * r64m_gf2_memsize(rnum);
+    sz += r64m_gf2_memsize(cnum) + rm_gf16_memsize(rnum);
+    sz += (sizeof(R64MGF2PArg) + sizeof(R64MGF2*) + sizeof(RMGF16PArg)) * tnum;
+    return sz;
+}
+
+/* usage: create a struct BLKGF2Arg, which is a collection of data
+ *      structures used by the Block Lanczos algorithm
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: ptr to struct BLKGF2Arg on success, NULL on error */
+BLKGF2Arg*
+blkgf2_arg_create(uint64_t rnum, uint64_t cnum, uint32_t tnum) {
+    BLKGF2Arg* arg = malloc(sizeof(BLKGF2Arg));
+    if(!arg)
+        return NULL;
+
+    memset(arg, 0x0, sizeof(BLKGF2Arg)); // set all ptrs to NULL
+    if(pthread_mutex_init(&arg->lock, NULL)) {
+        free(arg);
+        return NULL;
+    }
+
+    if(NULL == (arg->v = r64m_gf2_create(rnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->p = r64m_gf2_create(rnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->av = r64m_gf2_create(rnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->mtv = r64m_gf2_create(cnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->nv = rm_gf16_create(rnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->pargs = malloc(sizeof(R64MGF2PArg) * tnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->nv_pargs = malloc(sizeof(RMGF16PArg) * tnum)))
+        goto blkgf2_arg_create_fail;
+    if(NULL == (arg->av_partials = calloc(tnum, sizeof(R64MGF2*))))
+        goto blkgf2_arg_create_fail;
+
+    arg->tnum = tnum;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        if(NULL == (arg->av_partials[i] = r64m_gf2_create(rnum)))
+            goto blkgf2_arg_create_fail;
+    }
+    return arg;
+
+blkgf2_arg_create_fail:
+    blkgf2_arg_free(arg);
+    return NULL;
+}
+
+/* usage: Given a struct BLKGF2Arg, free it
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: void */
+void
+blkgf2_arg_free(BLKGF2Arg* arg) {
+    if(!arg)
+        return;
+    pthread_mutex_destroy(&arg->lock);
+    r64m_gf2_free(arg->v);
+    r64m_gf2_free(arg->p);
+    r64m_gf2_free(arg->av);
+    r64m_gf2_free(arg->mtv);
+    rm_gf16_free(arg->nv);
+    if(arg->av_partials) {
+        for(uint32_t i = 0; i < arg->tnum; ++i)
+            r64m_gf2_free(arg->av_partials[i]);
+    }
+    free(arg->av_partials);
+    free(arg->nv_pargs);
+    free(arg->pargs);
+    free(arg);
+}
+
+/* usage: Given a struct BLKGF2Arg, return the number of rows of the matrix to
+ *      eliminate it's created for
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: number of rows */
+uint64_t
+blkgf2_arg_rnum(const BLKGF2Arg* arg) {
+    return r64m_gf2_rnum(arg->v);
+}
+
+/* usage: Given a struct BLKGF2Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf2_arg_set_cnum(BLKGF2Arg* arg, uint64_t cnum) {
+    if(r64m_gf2_rnum(arg->mtv) == cnum)
+        return true;
+    R64MGF2* mtv = r64m_gf2_create(cnum);
+    if(!mtv)
+        return false;
+    r64m_gf2_free(arg->mtv);
+    arg->mtv = mtv;
+    return true;
+}
+
+/* usage: Given a struct BLKGF2Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf2_arg_set_seed(BLKGF2Arg* arg, uint64_t seed) {
+    arg->seed = seed;
+    arg->starts = 0;
+}
+
+/* subroutine of blk_lczs_gf2: one run of Block Lanczos with block size 64.
+ *      The result is stored in arg->v */
+static uint32_t
+blk_lczs_gf2_run(BLKGF2Arg* restrict arg, const CMSMGeneric* restrict cm,
+                 Threadpool* restrict tp) {
+    // init: randomize v, and set p = 0
+    prng_fill_parallel(r64m_gf2_raddr(arg->v, 0), r64m_gf2_rnum(arg->v),
+                       arg->seed, PRNG_LCZS, arg->starts++, arg->tnum, tp);
+    r64m_gf2_zero(arg->p);
+
+    uint64_t iter = 0;
+    uint64_t di = 0; // columns selected in the previous iteration
+    do {
+        PROF(PROF_LCZS_TR_MUL,
+             cmsm_gf2_tr_mul_parallel(arg->mtv, cm, arg->v, arg->tnum,
+                                      arg->pargs, tp));
+        PROF(PROF_LCZS_MUL,
+             cmsm_gf2_mul_parallel(arg->av, cm, arg->mtv, arg->tnum,
+                                   arg->av_partials, arg->pargs, tp,
+                                   &arg->lock));
+
+        // compute vtA2v and vtAv
+        PROF(PROF_LCZS_GRAMIAN_VTAV, r64m_gf2_gramian(arg->mtv, &arg->vtAv));
+        PROF(PROF_LCZS_GRAMIAN_VTA2V, r64m_gf2_gramian(arg->av, &arg->vtA2v));
+
+        // select the columns and compute w_{inv}, already restricted to them
+        uint64_t ts = prof_start(PROF_LCZS_GJ);
+        rc64m_gf2_gj(&arg->vtAv, &arg->w, &di, di);
+        prof_stop(PROF_LCZS_GJ, ts);
+
+        // compute C_{i+1, i}; note that vtA2v will be modified
+        ts = prof_start(PROF_LCZS_SMALL);
+        assert(true == rc64m_gf2_is_symmetric(&arg->w));
+        rc64m_gf2_mixi(&arg->vtA2v, &arg->vtAv, di);
+        rc64m_gf2_mul(&arg->c, &arg->w, &arg->vtA2v);
+        prof_stop(PROF_LCZS_SMALL, ts);
+        // compute vn (stored in Av)
+        PROF(PROF_LCZS_MIXI, r64m_gf2_mixi(arg->av, arg->v, di));
+        PROF(PROF_LCZS_FMS_DIAG,
+             r64m_gf2_fms_diag(arg->av, arg->p, &arg->vtAv, di));
+        PROF(PROF_LCZS_FMS, r64m_gf2_fms(arg->av, arg->v, &arg->c));
+        // compute pn (stored in p)
+        PROF(PROF_LCZS_DIAG_FMA,
+             r64m_gf2_diag_fma(arg->p, arg->v, &arg->w, ~di));
+
+        // swap v and Av
+        R64MGF2* tmp = arg->av;
+        arg->av = arg->v;
+        arg->v = tmp;
+
+        ++iter;
+    } while(likely(di));
+
+    prof_add_units(PROF_LCZS_TR_MUL, iter * cmsm_generic_nznum(cm));
+    prof_add_units(PROF_LCZS_MUL, iter * cmsm_generic_nznum(cm));
+    return iter;
+}
+
+/* subroutine of blk_lczs_gf2: Block Lanczos only ensures v^T * m * m^T * v = 0
+ *      at the end, which over GF(2) leaves many columns of m^T * v non-zero.
+ *      Replace v with the linear combinations of its columns that are in the
+ *      left kernel of m, and clear the remaining columns */
+static void
+blk_lczs_gf2_kernel(BLKGF2Arg* restrict arg, const CMSMGeneric* restrict cm,
+                    Threadpool* restrict tp) {
+    cmsm_gf2_tr_mul_parallel(arg->mtv, cm, arg->v, arg->tnum, arg->pargs, tp);
+
+    // the columns of t are the linear combinations. Each non-zero row of
+    // m^T * v * t is eliminated with one of the alive columns, which dies
+    RC64MGF2* t = &arg->c; // reuse c
+    rc64m_gf2_identity(t);
+    uint64_t alive = UINT64_MAX;
+    const uint64_t* mtv = r64m_gf2_raddr(arg->mtv, 0);
+    for(uint64_t i = 0; alive && i < r64m_gf2_rnum(arg->mtv); ++i) {
+        uint64_t r = rc64m_gf2_vec_mul(mtv[i], t) & alive;
+        if(!r)
+            continue;
+        uint64_t pvt = uint64_t_lsb(r);
+        uint64_t others = r ^ pvt;
+        for(uint32_t j = 0; j < 64; ++j) {
+            if(t->rows[j] & pvt)
+                t->rows[j] ^= others;
+        }
+        alive ^= pvt;
+    }
+    for(uint32_t j = 0; j < 64; ++j)
+        t->rows[j] &= alive;
+    r64m_gf2_muli(arg->v, t);
+}
+
+/* usage: Given a sparse matrix m over GF(2) stored in column-majored format
+ *      (CMSMGeneric) of size N x L and a BLKGF2Arg, find an RMGF16 v such that
+ *      v^T * m = 0 with Block Lanczos algorithm over GF(2). Block Lanczos is
+ *      run BLK_LANCZOS_BLOCK_SIZE / 64 times to fill v, and only the linear
+ *      combinations of its results that are in the left kernel of m are kept.
+ *      The vector v can be retrieved by calling `blkgf2_arg_v`.
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg
+ *      2) cm: ptr to struct CMSMGeneric, whose entries are all 0 or 1
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf2(BLKGF2Arg* restrict arg, const CMSMGeneric* restrict cm,
+             Threadpool* restrict tpool) {
+    uint32_t iter = 0;
+    rm_gf16_zero(arg->nv);
+    for(uint32_t off = 0; off < BLK_LANCZOS_BLOCK_SIZE; off += 64) {
+        iter += blk_lczs_gf2_run(arg, cm, tpool);
+        blk_lczs_gf2_kernel(arg, cm, tpool);
+
+        // lift to GF(16)
+        const uint64_t* v = r64m_gf2_raddr(arg->v, 0);
+        for(uint64_t i = 0; i < r64m_gf2_rnum(arg->v); ++i) {
+            RowGF16* dst = rm_gf16_raddr(arg->nv, i);
+            for(uint64_t x = v[i]; x; x = uint64_t_clear_lsb(x))
+                row_gf16_set_at(dst, off + uint64_t_ctz(x), 1);
+        }
+    }
+    return iter;
+}
@@ -0,0 +1,123 @@
+#ifndef __BLOCK_LANCZOS_GF2_H__
+#define __BLOCK_LANCZOS_GF2_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsm_generic.h"
+#include "r64m_gf2.h"
+#include "rc64m_gf2.h"
+#include "thpool.h"
+#include "matrix_gf16.h"
+#include "util.h"
+
+// Block Lanczos for matrices whose entries are all in GF(2), e.g. the
+// Macaulay matrices of MinRank instances over GF(2). The Lanczos vectors take
+// 1 bit per entry and the sparse products are XORs only. Since GF(2) is a
+// subfield of GF(16), the nullvectors found are also nullvectors over GF(16):
+// they are lifted into a RMGF16 of the usual block size, so the rest of the
+// solver handles them as the ones from blk_lczs_gf16.
+
+typedef struct BLKGF2Arg BLKGF2Arg;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Given the rank of the square matrix (or submatrix) to eliminate,
+ *      compute the expected number of iterations for Block Lanczos algorithm.
+ * params:
+ *      1) block_sz: block size
+ *      2) r: rank of the matrix to eliminate
+ * return: estimated number of iterations */
+uint64_t pure_func
+blkgf2_iter_num(uint64_t block_sz, uint64_t r);
+
+/* usage: given a struct BLKGF2Arg, retrieve the container that stores the
+ *      nullvectors lifted to GF(16)
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: ptr to struct RMGF16 which stores the nullvectors */
+RMGF16*
+blkgf2_arg_v(BLKGF2Arg* arg);
+
+/* usage: given a struct BLKGF2Arg, retrieve the data structure used for
+ *      parallelization of the operations on the lifted nullvectors
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: ptr to struct RMGF16PArg */
+RMGF16PArg*
+blkgf2_arg_pargs(BLKGF2Arg* arg);
+
+/* usage: compute the amount of memory needed for a struct BLKGF2Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf2_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum);
+
+/* usage: create a struct BLKGF2Arg, which is a collection of data
+ *      structures used by the Block Lanczos algorithm
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: ptr to struct BLKGF2Arg on success, NULL on error */
+BLKGF2Arg*
+blkgf2_arg_create(uint64_t rnum, uint64_t cnum, uint32_t tnum);
+
+/* usage: Given a struct BLKGF2Arg, free it
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: void */
+void
+blkgf2_arg_free(BLKGF2Arg* arg);
+
+/* usage: Given a struct BLKGF2Arg, return the number of rows of the matrix to
+ *      eliminate it's created for
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ * return: number of rows */
+uint64_t
+blkgf2_arg_rnum(const BLKGF2Arg* arg);
+
+/* usage: Given a struct BLKGF2Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf2_arg_set_cnum(BLKGF2Arg* arg, uint64_t cnum);
+
+/* usage: Given a struct BLKGF2Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf2_arg_set_seed(BLKGF2Arg* arg, uint64_t seed);
+
+/* usage: Given a sparse matrix m over GF(2) stored in column-majored format
+ *      (CMSMGeneric) of size N x L and a BLKGF2Arg, find an RMGF16 v such that
+ *      v^T * m = 0 with Block Lanczos algorithm over GF(2). Block Lanczos is
+ *      run BLK_LANCZOS_BLOCK_SIZE / 64 times to fill v, and only the linear
+ *      combinations of its results that are in the left kernel of m are kept.
+ *      The vector v can be retrieved by calling `blkgf2_arg_v`.
+ * params:
+ *      1) arg: ptr to struct BLKGF2Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg
+ *      2) cm: ptr to struct CMSMGeneric, whose entries are all 0 or 1
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf2(BLKGF2Arg* restrict arg, const CMSMGeneric* restrict cm,
+             Threadpool* restrict tpool);
+
+#endif // __BLOCK_LANCZOS_GF2_H__
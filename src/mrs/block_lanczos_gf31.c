@@ -0,0 +1,312 @@
+#include "block_lanczos_gf31.h"
+#include "block_lanczos.h"
+#include "uint64a.h"
+#include "util.h"
+#include "prof.h"
+#include "thpool.h"
+#include "prng.h"
+#include <pthread.h>
+
+/* ========================================================================
+ * struct BLKGF31Arg definition
+ * ======================================================================== */
+
+struct BLKGF31Arg {
+    R64MGF31* restrict v;
+    R64MGF31* restrict p;
+    R64MGF31* restrict av;
+    R64MGF31* restrict mtv;
+    RC64MGF31 vtAv;
+    RC64MGF31 vtA2v;
+    RC64MGF31 c;
+    RC64MGF31 w;
+    // containers for parallelization
+    R64MGF31PArg* restrict pargs;
+    R64MGF31** restrict av_partials;
+    pthread_mutex_t lock;
+    uint32_t tnum; // number of threads to use
+    uint64_t seed; // seed of the starting points, see prng.h
+    uint32_t starts; // starting points drawn since the seed was set
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Given the rank of the square matrix (or submatrix) to eliminate,
+ *      compute the expected number of iterations for Block Lanczos algorithm.
+ * params:
+ *      1) block_sz: block size
+ *      2) r: rank of the matrix to eliminate
+ * return: estimated number of iterations */
+uint64_t pure_func
+blkgf31_iter_num(uint64_t block_sz, uint64_t r) {
+    return blkgeneric_iter_num(block_sz, GF31_SIZE, r);
+}
+
+/* usage: given a struct BLKGF31Arg, retrieve the container that stores the
+ *      nullvectors
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: ptr to struct R64MGF31 which stores the nullvectors */
+R64MGF31*
+blkgf31_arg_v(BLKGF31Arg* arg) {
+    return arg->v;
+}
+
+/* usage: given a struct BLKGF31Arg, retrieve the data structure used for
+ *      parallelization
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: ptr to struct R64MGF31PArg */
+R64MGF31PArg*
+blkgf31_arg_pargs(BLKGF31Arg* arg) {
+    return arg->pargs;
+}
+
+/* usage: compute the amount of memory needed for a struct BLKGF31Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf31_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum) {
+    // v, p, Av and a partial Av for each thread, and mtv
+    size_t sz = sizeof(BLKGF31Arg) + (3 + tnum) * r64m_gf31_memsize(rnum);
+    sz += r64m_gf31_memsize(cnum);
+    sz += (sizeof(R64MGF31PArg) + sizeof(R64MGF31*)) * tnum;
+    return sz;
+}
+
+/* usage: create a struct BLKGF31Arg, which is a collection of data
+ *      structures used by the Block Lanczos algorithm
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: ptr to struct BLKGF31Arg on success, NULL on error */
+BLKGF31Arg*
+blkgf31_arg_create(uint64_t rnum, uint64_t cnum, uint32_t tnum) {
+    BLKGF31Arg* arg = aligned_alloc(64, sizeof(BLKGF31Arg));
+    if(!arg)
+        return NULL;
+
+    memset(arg, 0x0, sizeof(BLKGF31Arg)); // set all ptrs to NULL
+    if(pthread_mutex_init(&arg->lock, NULL)) {
+        free(arg);
+        return NULL;
+    }
+
+    if(NULL == (arg->v = r64m_gf31_create(rnum)))
+        goto blkgf31_arg_create_fail;
+    if(NULL == (arg->p = r64m_gf31_create(rnum)))
+        goto blkgf31_arg_create_fail;
+    if(NULL == (arg->av = r64m_gf31_create(rnum)))
+        goto blkgf31_arg_create_fail;
+    if(NULL == (arg->mtv = r64m_gf31_create(cnum)))
+        goto blkgf31_arg_create_fail;
+    if(NULL == (arg->pargs = malloc(sizeof(R64MGF31PArg) * tnum)))
+        goto blkgf31_arg_create_fail;
+    if(NULL == (arg->av_partials = calloc(tnum, sizeof(R64MGF31*))))
+        goto blkgf31_arg_create_fail;
+
+    arg->tnum = tnum;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        if(NULL == (arg->av_partials[i] = r64m_gf31_create(rnum)))
+            goto blkgf31_arg_create_fail;
+    }
+    return arg;
+
+blkgf31_arg_create_fail:
+    blkgf31_arg_free(arg);
+    return NULL;
+}
+
+/* usage: Given a struct BLKGF31Arg, free it
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: void */
+void
+blkgf31_arg_free(BLKGF31Arg* arg) {
+    if(!arg)
+        return;
+    pthread_mutex_destroy(&arg->lock);
+    r64m_gf31_free(arg->v);
+    r64m_gf31_free(arg->p);
+    r64m_gf31_free(arg->av);
+    r64m_gf31_free(arg->mtv);
+    if(arg->av_partials) {
+        for(uint32_t i = 0; i < arg->tnum; ++i)
+            r64m_gf31_free(arg->av_partials[i]);
+    }
+    free(arg->av_partials);
+    free(arg->pargs);
+    free(arg);
+}
+
+/* usage: Given a struct BLKGF31Arg, return the number of rows of the matrix to
+ *      eliminate it's created for
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: number of rows */
+uint64_t
+blkgf31_arg_rnum(const BLKGF31Arg* arg) {
+    return r64m_gf31_rnum(arg->v);
+}
+
+/* usage: Given a struct BLKGF31Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf31_arg_set_cnum(BLKGF31Arg* arg, uint64_t cnum) {
+    if(r64m_gf31_rnum(arg->mtv) == cnum)
+        return true;
+    R64MGF31* mtv = r64m_gf31_create(cnum);
+    if(!mtv)
+        return false;
+    r64m_gf31_free(arg->mtv);
+    arg->mtv = mtv;
+    return true;
+}
+
+/* usage: Given a struct BLKGF31Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf31_arg_set_seed(BLKGF31Arg* arg, uint64_t seed) {
+    arg->seed = seed;
+    arg->starts = 0;
+}
+
+/* subroutine of blk_lczs_gf31: Block Lanczos only ensures
+ *      v^T * m * m^T * v = 0 at the end, so a few columns of m^T * v may be
+ *      non-zero. Replace v with the linear combinations of its columns that
+ *      are in the left kernel of m, and clear the remaining columns */
+static void
+blk_lczs_gf31_kernel(BLKGF31Arg* restrict arg, const CMSMGeneric* restrict cm,
+                     Threadpool* restrict tp) {
+    cmsm_gf31_tr_mul_parallel(arg->mtv, cm, arg->v, arg->tnum, arg->pargs, tp);
+
+    // the columns of t are the linear combinations. Each non-zero row of
+    // m^T * v * t is eliminated with one of the alive columns, which dies
+    RC64MGF31* t = &arg->c; // reuse c
+    alignas(64) uint16_t w[64 * 64];
+    alignas(64) uint16_t acc[64];
+    alignas(64) gf31_t r[64];
+    alignas(64) gf31_t f[64];
+    rc64m_gf31_identity(t);
+    rc64m_gf31_widen(w, t, UINT64_MAX);
+    uint64_t alive = UINT64_MAX;
+    for(uint64_t i = 0; alive && i < r64m_gf31_rnum(arg->mtv); ++i) {
+        const gf31_t* row = r64m_gf31_raddr(arg->mtv, i);
+        if(!gf31_t_arr_nzc(row, 64))
+            continue;
+        gf31_t_arr_acc_vec_mul64(acc, row, w);
+        gf31_t_arr_from_acc64(r, acc);
+
+        uint64_t nz = 0;
+        for(uint32_t j = 0; j < 64; ++j)
+            nz |= (uint64_t) (r[j] != 0) << j;
+        nz &= alive;
+        if(!nz)
+            continue;
+        uint64_t pvt = uint64_t_ctz(nz);
+        gf31_t inv = gf31_t_inv(r[pvt]);
+        for(uint32_t j = 0; j < 64; ++j)
+            f[j] = ((nz >> j) & 0x1ULL) ? gf31_t_mul(r[j], inv) : 0;
+        f[pvt] = 0;
+        // column j of t -= f[j] * column pvt of t
+        for(uint32_t k = 0; k < 64; ++k)
+            gf31_t_arr_fmsubi_scalar64(t->rows[k], f, t->rows[k][pvt]);
+        alive ^= 0x1ULL << pvt;
+        rc64m_gf31_widen(w, t, alive);
+    }
+    for(uint64_t cols = ~alive; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        for(uint32_t k = 0; k < 64; ++k)
+            t->rows[k][c] = 0;
+    }
+    r64m_gf31_muli(arg->v, t);
+}
+
+/* usage: Given a sparse matrix m over GF(31) stored in column-majored format
+ *      (CMSMGeneric) of size N x L and a BLKGF31Arg, find an R64MGF31 v such
+ *      that v^T * m = 0 with Block Lanczos algorithm. Only the linear
+ *      combinations of the columns of the result that are in the left kernel
+ *      of m are kept, the other columns of v are zero. The vector v can be
+ *      retrieved by calling `blkgf31_arg_v`.
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg
+ *      2) cm: ptr to struct CMSMGeneric, whose entries are in GF(31)
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf31(BLKGF31Arg* restrict arg, const CMSMGeneric* restrict cm,
+              Threadpool* restrict tp) {
+    // init: randomize v, and set p = 0
+    prng_fill_parallel((uint64_t*) r64m_gf31_raddr(arg->v, 0),
+                       r64m_gf31_rnum(arg->v) * 8, arg->seed, PRNG_LCZS,
+                       arg->starts++, arg->tnum, tp);
+    r64m_gf31_fold(arg->v);
+    r64m_gf31_zero(arg->p);
+
+    uint64_t iter = 0;
+    uint64_t di = 0; // columns selected in the previous iteration
+    do {
+        PROF(PROF_LCZS_TR_MUL,
+             cmsm_gf31_tr_mul_parallel(arg->mtv, cm, arg->v, arg->tnum,
+                                       arg->pargs, tp));
+        PROF(PROF_LCZS_MUL,
+             cmsm_gf31_mul_parallel(arg->av, cm, arg->mtv, arg->tnum,
+                                    arg->av_partials, arg->pargs, tp,
+                                    &arg->lock));
+
+        // compute vtA2v and vtAv
+        PROF(PROF_LCZS_GRAMIAN_VTAV, r64m_gf31_gramian(arg->mtv, &arg->vtAv));
+        PROF(PROF_LCZS_GRAMIAN_VTA2V, r64m_gf31_gramian(arg->av, &arg->vtA2v));
+
+        // select the columns and compute w_{inv}, already restricted to them
+        uint64_t ts = prof_start(PROF_LCZS_GJ);
+        rc64m_gf31_gj(&arg->vtAv, &arg->w, &di, di);
+        prof_stop(PROF_LCZS_GJ, ts);
+
+        // compute C_{i+1, i}; note that vtA2v will be modified
+        ts = prof_start(PROF_LCZS_SMALL);
+        assert(true == rc64m_gf31_is_symmetric(&arg->w));
+        rc64m_gf31_mixi(&arg->vtA2v, &arg->vtAv, di);
+        rc64m_gf31_mul(&arg->c, &arg->w, &arg->vtA2v);
+        prof_stop(PROF_LCZS_SMALL, ts);
+        // compute vn (stored in Av)
+        PROF(PROF_LCZS_MIXI, r64m_gf31_mixi(arg->av, arg->v, di));
+        PROF(PROF_LCZS_FMS_DIAG,
+             r64m_gf31_fms_diag(arg->av, arg->p, &arg->vtAv, di));
+        PROF(PROF_LCZS_FMS, r64m_gf31_fms(arg->av, arg->v, &arg->c));
+        // compute pn (stored in p)
+        PROF(PROF_LCZS_DIAG_FMA,
+             r64m_gf31_diag_fma(arg->p, arg->v, &arg->w, ~di));
+
+        // swap v and Av
+        R64MGF31* tmp = arg->av;
+        arg->av = arg->v;
+        arg->v = tmp;
+
+        ++iter;
+    } while(likely(di));
+
+    prof_add_units(PROF_LCZS_TR_MUL, iter * cmsm_generic_nznum(cm));
+    prof_add_units(PROF_LCZS_MUL, iter * cmsm_generic_nznum(cm));
+
+    blk_lczs_gf31_kernel(arg, cm, tp);
+    return iter;
+}
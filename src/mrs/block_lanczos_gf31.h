@@ -0,0 +1,120 @@
+#ifndef __BLOCK_LANCZOS_GF31_H__
+#define __BLOCK_LANCZOS_GF31_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsm_generic.h"
+#include "r64m_gf31.h"
+#include "rc64m_gf31.h"
+#include "thpool.h"
+#include "util.h"
+
+// Block Lanczos with block size 64 for matrices over GF(31), e.g. the
+// Macaulay matrices of MinRank instances over GF(31). The Lanczos vectors
+// take 1 byte per entry, and the products are accumulated in 16-bit lanes and
+// reduced lazily, see gf31.h.
+
+typedef struct BLKGF31Arg BLKGF31Arg;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Given the rank of the square matrix (or submatrix) to eliminate,
+ *      compute the expected number of iterations for Block Lanczos algorithm.
+ * params:
+ *      1) block_sz: block size
+ *      2) r: rank of the matrix to eliminate
+ * return: estimated number of iterations */
+uint64_t pure_func
+blkgf31_iter_num(uint64_t block_sz, uint64_t r);
+
+/* usage: given a struct BLKGF31Arg, retrieve the container that stores the
+ *      nullvectors
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: ptr to struct R64MGF31 which stores the nullvectors */
+R64MGF31*
+blkgf31_arg_v(BLKGF31Arg* arg);
+
+/* usage: given a struct BLKGF31Arg, retrieve the data structure used for
+ *      parallelization
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: ptr to struct R64MGF31PArg */
+R64MGF31PArg*
+blkgf31_arg_pargs(BLKGF31Arg* arg);
+
+/* usage: compute the amount of memory needed for a struct BLKGF31Arg
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: amount of memory needed in bytes */
+size_t
+blkgf31_arg_memsize(uint64_t rnum, uint64_t cnum, uint32_t tnum);
+
+/* usage: create a struct BLKGF31Arg, which is a collection of data
+ *      structures used by the Block Lanczos algorithm
+ * params:
+ *      1) rnum: number of rows of the matrix to eliminate
+ *      2) cnum: number of columns of the matrix to eliminate
+ *      3) tnum: number of threads to use
+ * return: ptr to struct BLKGF31Arg on success, NULL on error */
+BLKGF31Arg*
+blkgf31_arg_create(uint64_t rnum, uint64_t cnum, uint32_t tnum);
+
+/* usage: Given a struct BLKGF31Arg, free it
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: void */
+void
+blkgf31_arg_free(BLKGF31Arg* arg);
+
+/* usage: Given a struct BLKGF31Arg, return the number of rows of the matrix to
+ *      eliminate it's created for
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ * return: number of rows */
+uint64_t
+blkgf31_arg_rnum(const BLKGF31Arg* arg);
+
+/* usage: Given a struct BLKGF31Arg, adapt it to a matrix with a different
+ *      number of columns but the same number of rows
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ *      2) cnum: the new number of columns of the matrix to eliminate
+ * return: true on success, false if memory allocation failed. On failure, arg
+ *      is left unchanged */
+bool
+blkgf31_arg_set_cnum(BLKGF31Arg* arg, uint64_t cnum);
+
+/* usage: Given a struct BLKGF31Arg, set the seed of the random starting
+ *      points of Block Lanczos. The i-th run afterwards starts from the i-th
+ *      PRNG_LCZS stream, see prng.h
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg
+ *      2) seed: the seed
+ * return: void */
+void
+blkgf31_arg_set_seed(BLKGF31Arg* arg, uint64_t seed);
+
+/* usage: Given a sparse matrix m over GF(31) stored in column-majored format
+ *      (CMSMGeneric) of size N x L and a BLKGF31Arg, find an R64MGF31 v such
+ *      that v^T * m = 0 with Block Lanczos algorithm. Only the linear
+ *      combinations of the columns of the result that are in the left kernel
+ *      of m are kept, the other columns of v are zero. The vector v can be
+ *      retrieved by calling `blkgf31_arg_v`.
+ * params:
+ *      1) arg: ptr to struct BLKGF31Arg, which contains data structures used
+ *              as buffers for intermediate computation results. Note that the
+ *              dimensions of m must equal the parameters used to create arg
+ *      2) cm: ptr to struct CMSMGeneric, whose entries are in GF(31)
+ *      3) tpool: ptr to struct Threadpool
+ * return: the number of iterations used to extract v */
+uint32_t
+blk_lczs_gf31(BLKGF31Arg* restrict arg, const CMSMGeneric* restrict cm,
+              Threadpool* restrict tpool);
+
+#endif // __BLOCK_LANCZOS_GF31_H__
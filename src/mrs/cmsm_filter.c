@@ -0,0 +1,583 @@
+#include "cmsm_filter.h"
+#include "gf.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/* ========================================================================
+ * struct CMSMFilter definition
+ * ======================================================================== */
+
+struct CMSMFilter {
+    uint64_t ori_rnum; // number of rows of the original matrix
+    uint64_t rnum; // number of rows of the reduced matrix
+    // the i-th row of the reduced matrix is the linear combination of the rows
+    // of the original matrix stored from cptr[i] to cptr[i+1] - 1
+    uint64_t* cptr;
+    gfa_idx_t* cidxs;
+    gf_t* cvals;
+    CMSMGeneric* m; // the reduced matrix
+};
+
+/* sparse vector whose entries are sorted by the index */
+typedef struct {
+    gfa_idx_t* idx;
+    gf_t* v;
+    uint32_t sz;
+    uint32_t cap;
+} SpVec;
+
+/* weight of a row, for sorting */
+typedef struct {
+    uint32_t w;
+    gfa_idx_t ri;
+} RowWt;
+
+/* data structures only needed during filtering */
+typedef struct {
+    uint64_t rnum;
+    uint64_t cnum;
+    uint64_t ralive_num;
+    uint64_t calive_num;
+    uint64_t nznum;
+    SpVec* rows;
+    SpVec* combs; // linear combination of the original rows for each row
+    SpVec tmp;
+    uint32_t* colw; // number of non-zero entries in each column
+    // rows that might have a non-zero entry in each column. A row can be
+    // stale due to cancellation, which is filtered out when the list is used
+    gfa_idx_t** clists;
+    uint32_t* clsz;
+    uint32_t* clcap;
+    uint64_t* stamp; // for removing duplicated rows from the lists
+    uint64_t epoch;
+    bool* ralive;
+    bool* calive;
+} FilterState;
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+static bool
+spvec_reserve(SpVec* a, uint32_t cap) {
+    if(cap <= a->cap)
+        return true;
+    cap = (cap < 8) ? 8 : cap;
+    gfa_idx_t* idx = realloc(a->idx, sizeof(gfa_idx_t) * cap);
+    if(!idx)
+        return false;
+    a->idx = idx;
+    gf_t* v = realloc(a->v, sizeof(gf_t) * cap);
+    if(!v)
+        return false;
+    a->v = v;
+    a->cap = cap;
+    return true;
+}
+
+static void
+spvec_free(SpVec* a) {
+    free(a->idx);
+    free(a->v);
+    memset(a, 0x0, sizeof(SpVec));
+}
+
+static gf_t
+spvec_find(const SpVec* a, gfa_idx_t idx) {
+    uint32_t lo = 0, hi = a->sz;
+    while(lo < hi) {
+        uint32_t mid = lo + ((hi - lo) >> 1);
+        if(a->idx[mid] < idx)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo < a->sz && a->idx[lo] == idx) ? a->v[lo] : 0;
+}
+
+static bool
+clist_push(FilterState* s, gfa_idx_t ci, gfa_idx_t ri) {
+    if(s->clsz[ci] == s->clcap[ci]) {
+        uint32_t cap = s->clcap[ci] ? (s->clcap[ci] << 1) : 4;
+        gfa_idx_t* l = realloc(s->clists[ci], sizeof(gfa_idx_t) * cap);
+        if(!l)
+            return false;
+        s->clists[ci] = l;
+        s->clcap[ci] = cap;
+    }
+    s->clists[ci][s->clsz[ci]++] = ri;
+    return true;
+}
+
+/* usage: compute a += b * c for sparse vectors. If ri is not GFA_IDX_MAX, a
+ *      is the ri-th row, and the column weights are updated accordingly
+ * return: true on success, false if memory allocation failed */
+static bool
+spvec_fmaddi(FilterState* restrict s, SpVec* restrict a, const SpVec* restrict b,
+             gf_t c, gfa_idx_t ri) {
+    SpVec* t = &s->tmp;
+    if(!spvec_reserve(t, a->sz + b->sz))
+        return false;
+    uint32_t i = 0, j = 0, k = 0;
+    while(i < a->sz || j < b->sz) {
+        if(j == b->sz || (i < a->sz && a->idx[i] < b->idx[j])) {
+            t->idx[k] = a->idx[i];
+            t->v[k++] = a->v[i++];
+        } else if(i == a->sz || b->idx[j] < a->idx[i]) {
+            t->idx[k] = b->idx[j];
+            t->v[k++] = gf_t_mul(b->v[j], c);
+            if(ri != GFA_IDX_MAX) { // a new entry
+                ++(s->colw[b->idx[j]]);
+                ++(s->nznum);
+                if(!clist_push(s, b->idx[j], ri))
+                    return false;
+            }
+            ++j;
+        } else {
+            gf_t v = gf_t_add(a->v[i], gf_t_mul(b->v[j], c));
+            if(v) {
+                t->idx[k] = a->idx[i];
+                t->v[k++] = v;
+            } else if(ri != GFA_IDX_MAX) { // cancelled
+                --(s->colw[a->idx[i]]);
+                --(s->nznum);
+            }
+            ++i; ++j;
+        }
+    }
+    t->sz = k;
+    SpVec swp = *a; *a = *t; *t = swp;
+    return true;
+}
+
+static void
+filter_kill_row(FilterState* s, gfa_idx_t ri) {
+    const SpVec* r = s->rows + ri;
+    for(uint32_t i = 0; i < r->sz; ++i)
+        --(s->colw[r->idx[i]]);
+    s->nznum -= r->sz;
+    s->ralive[ri] = false;
+    --(s->ralive_num);
+    spvec_free(s->rows + ri);
+    spvec_free(s->combs + ri);
+}
+
+static void
+filter_kill_col(FilterState* s, gfa_idx_t ci) {
+    assert(s->colw[ci] == 0);
+    s->calive[ci] = false;
+    --(s->calive_num);
+    free(s->clists[ci]);
+    s->clists[ci] = NULL;
+    s->clsz[ci] = s->clcap[ci] = 0;
+}
+
+/* usage: collect the rows with a non-zero entry in the given column, and
+ *      drop the stale ones from its list
+ * return: number of rows collected */
+static uint32_t
+filter_col_rows(FilterState* restrict s, gfa_idx_t ci,
+                gfa_idx_t* restrict ris, gf_t* restrict vs) {
+    gfa_idx_t* l = s->clists[ci];
+    uint32_t n = 0;
+    ++(s->epoch);
+    for(uint32_t i = 0; i < s->clsz[ci]; ++i) {
+        gfa_idx_t ri = l[i];
+        if(!s->ralive[ri] || s->stamp[ri] == s->epoch)
+            continue;
+        gf_t v = spvec_find(s->rows + ri, ci);
+        if(!v)
+            continue;
+        s->stamp[ri] = s->epoch;
+        l[n] = ri;
+        ris[n] = ri;
+        vs[n++] = v;
+    }
+    s->clsz[ci] = n;
+    assert(n == s->colw[ci]);
+    return n;
+}
+
+static int
+filter_cmp_row_wt(const void* a, const void* b) {
+    uint32_t wa = ((const RowWt*) a)->w;
+    uint32_t wb = ((const RowWt*) b)->w;
+    return (wa < wb) - (wa > wb); // descending
+}
+
+/* usage: remove the heaviest rows in excess
+ * return: true if any row is removed, false otherwise */
+static bool
+filter_prune(FilterState* s, uint64_t excess, RowWt* buf) {
+    if(s->ralive_num <= s->calive_num + excess)
+        return false;
+    uint64_t n = 0;
+    for(uint64_t ri = 0; ri < s->rnum; ++ri) {
+        if(s->ralive[ri]) {
+            buf[n].w = s->rows[ri].sz;
+            buf[n++].ri = ri;
+        }
+    }
+    qsort(buf, n, sizeof(RowWt), filter_cmp_row_wt);
+    uint64_t num = s->ralive_num - s->calive_num - excess;
+    for(uint64_t i = 0; i < num; ++i)
+        filter_kill_row(s, buf[i].ri);
+    return true;
+}
+
+static void
+filter_state_free(FilterState* s) {
+    if(s->rows) {
+        for(uint64_t i = 0; i < s->rnum; ++i)
+            spvec_free(s->rows + i);
+    }
+    if(s->combs) {
+        for(uint64_t i = 0; i < s->rnum; ++i)
+            spvec_free(s->combs + i);
+    }
+    if(s->clists) {
+        for(uint64_t i = 0; i < s->cnum; ++i)
+            free(s->clists[i]);
+    }
+    spvec_free(&s->tmp);
+    free(s->rows);
+    free(s->combs);
+    free(s->colw);
+    free(s->clists);
+    free(s->clsz);
+    free(s->clcap);
+    free(s->stamp);
+    free(s->ralive);
+    free(s->calive);
+}
+
+/* usage: initialize the data structures for filtering from a CMSMGeneric
+ * return: true on success, false otherwise */
+static bool
+filter_state_init(FilterState* s, const CMSMGeneric* m) {
+    memset(s, 0x0, sizeof(FilterState));
+    s->rnum = s->ralive_num = cmsm_generic_rnum(m);
+    s->cnum = s->calive_num = cmsm_generic_cnum(m);
+    s->nznum = cmsm_generic_nznum(m);
+
+    uint64_t* rptr = malloc(sizeof(uint64_t) * (s->rnum + 1));
+    gfa_idx_t* cidxs = malloc(sizeof(gfa_idx_t) * (s->nznum ? s->nznum : 1));
+    gf_t* vals = malloc(sizeof(gf_t) * (s->nznum ? s->nznum : 1));
+    s->rows = calloc(s->rnum, sizeof(SpVec));
+    s->combs = calloc(s->rnum, sizeof(SpVec));
+    s->colw = calloc(s->cnum, sizeof(uint32_t));
+    s->clists = calloc(s->cnum, sizeof(gfa_idx_t*));
+    s->clsz = calloc(s->cnum, sizeof(uint32_t));
+    s->clcap = calloc(s->cnum, sizeof(uint32_t));
+    s->stamp = calloc(s->rnum, sizeof(uint64_t));
+    s->ralive = malloc(sizeof(bool) * s->rnum);
+    s->calive = malloc(sizeof(bool) * s->cnum);
+    bool ok = rptr && cidxs && vals && s->rows && s->combs && s->colw &&
+              s->clists && s->clsz && s->clcap && s->stamp && s->ralive &&
+              s->calive;
+    if(!ok)
+        goto filter_state_init_end;
+
+    memset(s->ralive, true, sizeof(bool) * s->rnum);
+    memset(s->calive, true, sizeof(bool) * s->cnum);
+    cmsm_generic_to_csr(m, rptr, cidxs, vals);
+    for(uint64_t ri = 0; ri < s->rnum && ok; ++ri) {
+        uint32_t sz = rptr[ri+1] - rptr[ri];
+        SpVec* r = s->rows + ri;
+        SpVec* c = s->combs + ri;
+        if( !(ok = spvec_reserve(r, sz) && spvec_reserve(c, 1)) )
+            break;
+        memcpy(r->idx, cidxs + rptr[ri], sizeof(gfa_idx_t) * sz);
+        memcpy(r->v, vals + rptr[ri], sizeof(gf_t) * sz);
+        r->sz = sz;
+        c->idx[0] = ri;
+        c->v[0] = 1;
+        c->sz = 1;
+        for(uint32_t i = 0; i < sz && ok; ++i) {
+            ++(s->colw[r->idx[i]]);
+            ok = clist_push(s, r->idx[i], ri);
+        }
+    }
+
+filter_state_init_end:
+    free(rptr);
+    free(cidxs);
+    free(vals);
+    return ok;
+}
+
+/* usage: eliminate the column with the given rows by merging them
+ * return: true on success, false if memory allocation failed */
+static bool
+filter_merge(FilterState* restrict s, gfa_idx_t ci, const gfa_idx_t* restrict ris,
+             const gf_t* restrict vs, uint32_t w) {
+    uint32_t pi = 0; // the lightest row as the pivot
+    for(uint32_t i = 1; i < w; ++i) {
+        if(s->rows[ris[i]].sz < s->rows[ris[pi]].sz)
+            pi = i;
+    }
+
+    gfa_idx_t p = ris[pi];
+    gf_t pinv = gf_t_inv(vs[pi]);
+    for(uint32_t i = 0; i < w; ++i) {
+        if(i == pi)
+            continue;
+        gf_t c = gf_t_mul(vs[i], pinv); // subtraction is addition in GF(2^n)
+        if(!spvec_fmaddi(s, s->rows + ris[i], s->rows + p, c, ris[i]) ||
+           !spvec_fmaddi(s, s->combs + ris[i], s->combs + p, c, GFA_IDX_MAX))
+            return false;
+    }
+    filter_kill_row(s, p);
+    filter_kill_col(s, ci);
+    return true;
+}
+
+/* usage: build the struct CMSMFilter from the remaining rows and columns
+ * return: true on success, false otherwise */
+static bool
+filter_finalize(CMSMFilter* restrict f, const FilterState* restrict s) {
+    gfa_idx_t* cmap = malloc(sizeof(gfa_idx_t) * (s->cnum ? s->cnum : 1));
+    uint64_t* rptr = malloc(sizeof(uint64_t) * (s->ralive_num + 1));
+    gfa_idx_t* cidxs = malloc(sizeof(gfa_idx_t) * (s->nznum ? s->nznum : 1));
+    gf_t* vals = malloc(sizeof(gf_t) * (s->nznum ? s->nznum : 1));
+    uint64_t cnznum = 0;
+    for(uint64_t ri = 0; ri < s->rnum; ++ri) {
+        if(s->ralive[ri])
+            cnznum += s->combs[ri].sz;
+    }
+    f->cptr = malloc(sizeof(uint64_t) * (s->ralive_num + 1));
+    f->cidxs = malloc(sizeof(gfa_idx_t) * (cnznum ? cnznum : 1));
+    f->cvals = malloc(sizeof(gf_t) * (cnznum ? cnznum : 1));
+    bool ok = cmap && rptr && cidxs && vals && f->cptr && f->cidxs && f->cvals;
+    if(!ok)
+        goto filter_finalize_end;
+
+    uint64_t cnum = 0;
+    for(uint64_t ci = 0; ci < s->cnum; ++ci)
+        cmap[ci] = s->calive[ci] ? cnum++ : GFA_IDX_MAX;
+
+    uint64_t rnum = 0;
+    rptr[0] = f->cptr[0] = 0;
+    for(uint64_t ri = 0; ri < s->rnum; ++ri) {
+        if(!s->ralive[ri])
+            continue;
+        const SpVec* r = s->rows + ri;
+        uint64_t dst = rptr[rnum];
+        for(uint32_t i = 0; i < r->sz; ++i) {
+            assert(cmap[r->idx[i]] != GFA_IDX_MAX);
+            cidxs[dst] = cmap[r->idx[i]];
+            vals[dst++] = r->v[i];
+        }
+        rptr[rnum+1] = dst;
+
+        const SpVec* c = s->combs + ri;
+        memcpy(f->cidxs + f->cptr[rnum], c->idx, sizeof(gfa_idx_t) * c->sz);
+        memcpy(f->cvals + f->cptr[rnum], c->v, sizeof(gf_t) * c->sz);
+        f->cptr[rnum+1] = f->cptr[rnum] + c->sz;
+        ++rnum;
+    }
+    assert(rnum == s->ralive_num && rptr[rnum] == s->nznum);
+
+    f->rnum = rnum;
+    ok = (NULL != (f->m = cmsm_generic_from_csr(rnum, cnum, rptr, cidxs, vals)));
+
+filter_finalize_end:
+    free(cmap);
+    free(rptr);
+    free(cidxs);
+    free(vals);
+    return ok;
+}
+
+/* usage: Filter a CMSMGeneric
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) excess: the number of rows to keep beyond the number of columns
+ *      3) max_merge_wt: max number of non-zero entries in a column for it to
+ *              be eliminated by merging rows
+ *      4) max_nznum: max number of non-zero entries of the reduced matrix.
+ *              Columns are no longer merged once it's reached
+ * return: ptr to struct CMSMFilter on success, NULL otherwise */
+CMSMFilter*
+cmsm_filter_create(const CMSMGeneric* m, uint64_t excess, uint32_t max_merge_wt,
+                   uint64_t max_nznum) {
+    CMSMFilter* f = calloc(1, sizeof(CMSMFilter));
+    if(!f)
+        return NULL;
+    f->ori_rnum = cmsm_generic_rnum(m);
+
+    FilterState s;
+    gfa_idx_t* ris = malloc(sizeof(gfa_idx_t) * (f->ori_rnum ? f->ori_rnum : 1));
+    gf_t* vs = malloc(sizeof(gf_t) * (f->ori_rnum ? f->ori_rnum : 1));
+    RowWt* wts = malloc(sizeof(RowWt) * (f->ori_rnum ? f->ori_rnum : 1));
+    bool ok = filter_state_init(&s, m) && ris && vs && wts;
+
+    bool changed = true;
+    while(ok && changed) {
+        changed = false;
+        for(uint64_t ci = 0; ci < s.cnum && ok; ++ci) {
+            if(!s.calive[ci] || s.colw[ci] > max_merge_wt)
+                continue;
+
+            uint32_t w = s.colw[ci];
+            if(w == 0) {
+                filter_kill_col(&s, ci);
+                changed = true;
+                continue;
+            }
+
+            filter_col_rows(&s, ci, ris, vs);
+            if(w == 1) {
+                filter_kill_row(&s, ris[0]);
+                filter_kill_col(&s, ci);
+                changed = true;
+                continue;
+            }
+
+            // upper bound of the change in the number of non-zero entries
+            int64_t pw = UINT32_MAX;
+            for(uint32_t i = 0; i < w; ++i) {
+                if(s.rows[ris[i]].sz < pw)
+                    pw = s.rows[ris[i]].sz;
+            }
+            int64_t delta = (int64_t) (w - 1) * (pw - 2) - pw;
+            if((int64_t) s.nznum + delta > (int64_t) max_nznum)
+                continue;
+
+            ok = filter_merge(&s, ci, ris, vs, w);
+            changed = true;
+        }
+
+        if(ok && !changed)
+            changed = filter_prune(&s, excess, wts);
+    }
+
+    ok = ok && filter_finalize(f, &s);
+    filter_state_free(&s);
+    free(ris);
+    free(vs);
+    free(wts);
+    if(!ok) {
+        cmsm_filter_free(f);
+        return NULL;
+    }
+    return f;
+}
+
+/* usage: Release a struct CMSMFilter
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ * return: void */
+void
+cmsm_filter_free(CMSMFilter* f) {
+    if(!f)
+        return;
+    cmsm_generic_free(f->m);
+    free(f->cptr);
+    free(f->cidxs);
+    free(f->cvals);
+    free(f);
+}
+
+/* usage: Return the reduced matrix, which is owned by the struct CMSMFilter
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ * return: ptr to struct CMSMGeneric */
+const CMSMGeneric*
+cmsm_filter_matrix(const CMSMFilter* f) {
+    return f->m;
+}
+
+/* usage: Apply the row operations of the filter to another matrix with the
+ *      same number of rows as the original matrix, e.g. the columns that are
+ *      not eliminated. For any v of the reduced matrix, v^T * the result is
+ *      the same as the lifted v^T * m.
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ *      2) m: ptr to struct CMSMGeneric
+ * return: ptr to a new struct CMSMGeneric with as many rows as the reduced
+ *      matrix on success, NULL otherwise */
+CMSMGeneric*
+cmsm_filter_apply(const CMSMFilter* restrict f, const CMSMGeneric* restrict m) {
+    assert(cmsm_generic_rnum(m) == f->ori_rnum);
+    const uint64_t cnum = cmsm_generic_cnum(m);
+    const uint64_t nznum = cmsm_generic_nznum(m);
+    uint64_t* rptr = malloc(sizeof(uint64_t) * (f->ori_rnum + 1));
+    gfa_idx_t* cidxs = malloc(sizeof(gfa_idx_t) * (nznum ? nznum : 1));
+    gf_t* vals = malloc(sizeof(gf_t) * (nznum ? nznum : 1));
+    gf_t* acc = calloc(cnum ? cnum : 1, sizeof(gf_t));
+    uint64_t* rrptr = malloc(sizeof(uint64_t) * (f->rnum + 1));
+    uint64_t cap = nznum ? nznum : 1;
+    gfa_idx_t* rcidxs = malloc(sizeof(gfa_idx_t) * cap);
+    gf_t* rvals = malloc(sizeof(gf_t) * cap);
+    CMSMGeneric* res = NULL;
+    if(!rptr || !cidxs || !vals || !acc || !rrptr || !rcidxs || !rvals)
+        goto cmsm_filter_apply_end;
+
+    cmsm_generic_to_csr(m, rptr, cidxs, vals);
+    rrptr[0] = 0;
+    for(uint64_t ri = 0; ri < f->rnum; ++ri) {
+        for(uint64_t k = f->cptr[ri]; k < f->cptr[ri+1]; ++k) {
+            gfa_idx_t oi = f->cidxs[k];
+            gf_t c = f->cvals[k];
+            for(uint64_t i = rptr[oi]; i < rptr[oi+1]; ++i)
+                acc[cidxs[i]] = gf_t_add(acc[cidxs[i]], gf_t_mul(vals[i], c));
+        }
+
+        // NOTE: the matrix is expected to have few columns
+        uint64_t dst = rrptr[ri];
+        for(uint64_t ci = 0; ci < cnum; ++ci) {
+            if(!acc[ci])
+                continue;
+            if(dst == cap) {
+                cap <<= 1;
+                gfa_idx_t* tc = realloc(rcidxs, sizeof(gfa_idx_t) * cap);
+                if(!tc)
+                    goto cmsm_filter_apply_end;
+                rcidxs = tc;
+                gf_t* tv = realloc(rvals, sizeof(gf_t) * cap);
+                if(!tv)
+                    goto cmsm_filter_apply_end;
+                rvals = tv;
+            }
+            rcidxs[dst] = ci;
+            rvals[dst++] = acc[ci];
+            acc[ci] = 0;
+        }
+        rrptr[ri+1] = dst;
+    }
+    res = cmsm_generic_from_csr(f->rnum, cnum, rrptr, rcidxs, rvals);
+
+cmsm_filter_apply_end:
+    free(rptr);
+    free(cidxs);
+    free(vals);
+    free(acc);
+    free(rrptr);
+    free(rcidxs);
+    free(rvals);
+    return res;
+}
+
+/* usage: Lift a block of vectors for the reduced matrix back to the original
+ *      matrix
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ *      2) v: ptr to struct RMGF16 with as many rows as the original matrix
+ *      3) vr: ptr to struct RMGF16 with as many rows as the reduced matrix
+ * return: void */
+void
+cmsm_filter_lift(const CMSMFilter* restrict f, RMGF16* restrict v,
+                 RMGF16* restrict vr) {
+    assert(rm_gf16_rnum(v) == f->ori_rnum);
+    assert(rm_gf16_rnum(vr) == f->rnum);
+    rm_gf16_zero(v);
+    for(uint64_t ri = 0; ri < f->rnum; ++ri) {
+        const RowGF16* src = rm_gf16_raddr(vr, ri);
+        for(uint64_t k = f->cptr[ri]; k < f->cptr[ri+1]; ++k)
+            row_gf16_fmaddi_scalar(rm_gf16_raddr(v, f->cidxs[k]), src, f->cvals[k]);
+    }
+}
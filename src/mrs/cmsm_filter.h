@@ -0,0 +1,82 @@
+#ifndef __CMSM_FILTER_H__
+#define __CMSM_FILTER_H__
+
+#include <stdint.h>
+#include "cmsm_generic.h"
+#include "matrix_gf16.h"
+#include "gfa.h"
+
+// structured Gaussian elimination (a.k.a. filtering) of a CMSMGeneric before
+// Block Lanczos. Since Block Lanczos finds vectors v such that v^T * m = 0,
+// only row operations are allowed:
+//
+//  1) A column with a single non-zero entry forces that entry of v to be zero,
+//     so both the column and the row are removed.
+//  2) A column with a few non-zero entries is eliminated by adding multiples
+//     of its lightest row to the others, after which the lightest row is a
+//     singleton and is removed. This continues as long as the number of
+//     non-zero entries stays within the given budget.
+//  3) Rows in excess of the number of columns plus the requested excess are
+//     removed, starting from the heaviest ones.
+//
+// Each row of the reduced matrix is a linear combination of the rows of the
+// original matrix, which is recorded so that the vectors found for the reduced
+// matrix can be lifted back.
+
+typedef struct CMSMFilter CMSMFilter;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Filter a CMSMGeneric
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) excess: the number of rows to keep beyond the number of columns
+ *      3) max_merge_wt: max number of non-zero entries in a column for it to
+ *              be eliminated by merging rows
+ *      4) max_nznum: max number of non-zero entries of the reduced matrix.
+ *              Columns are no longer merged once it's reached
+ * return: ptr to struct CMSMFilter on success, NULL otherwise */
+CMSMFilter*
+cmsm_filter_create(const CMSMGeneric* m, uint64_t excess, uint32_t max_merge_wt,
+                   uint64_t max_nznum);
+
+/* usage: Release a struct CMSMFilter
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ * return: void */
+void
+cmsm_filter_free(CMSMFilter* f);
+
+/* usage: Return the reduced matrix, which is owned by the struct CMSMFilter
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ * return: ptr to struct CMSMGeneric */
+const CMSMGeneric*
+cmsm_filter_matrix(const CMSMFilter* f);
+
+/* usage: Apply the row operations of the filter to another matrix with the
+ *      same number of rows as the original matrix, e.g. the columns that are
+ *      not eliminated. For any v of the reduced matrix, v^T * the result is
+ *      the same as the lifted v^T * m.
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ *      2) m: ptr to struct CMSMGeneric
+ * return: ptr to a new struct CMSMGeneric with as many rows as the reduced
+ *      matrix on success, NULL otherwise */
+CMSMGeneric*
+cmsm_filter_apply(const CMSMFilter* restrict f, const CMSMGeneric* restrict m);
+
+/* usage: Lift a block of vectors for the reduced matrix back to the original
+ *      matrix
+ * params:
+ *      1) f: ptr to struct CMSMFilter
+ *      2) v: ptr to struct RMGF16 with as many rows as the original matrix
+ *      3) vr: ptr to struct RMGF16 with as many rows as the reduced matrix
+ * return: void */
+void
+cmsm_filter_lift(const CMSMFilter* restrict f, RMGF16* restrict v,
+                 RMGF16* restrict vr);
+
+#endif // __CMSM_FILTER_H__
@@ -1,4 +1,5 @@
 #include "cmsm_generic.h"
+#include "cmsm_ooc.h"
 #include "gf.h"
 #include "gfa.h"
 #include "matrix_gf16.h"
@@ -6,6 +7,10 @@
 #include "thpool.h"
 #include <pthread.h>
 
+// the counters of a thread in cmsm_generic_split_mdmac span all the columns,
+// so only as many threads as fit in this many bytes take part in it
+#define CMSM_SPLIT_CNT_MEM      (128ULL << 20)
+
 /* ========================================================================
  * struct CMSMGeneric definition
  * ======================================================================== */
@@ -106,6 +111,16 @@ cmsm_generic_col(const CMSMGeneric* m, uint64_t i) {
     return gfa_arr_at(m->cols, i);
 }
 
+/* usage: given a struct CMSMGeneric, return the selected column
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) i: index of the column
+ * return: ptr to struct GFA that points to the selected column */
+const GFA*
+cmsm_generic_col_at(const CMSMGeneric* m, uint64_t i) {
+    return cmsm_generic_col(m, i);
+}
+
 /* usage: given a struct CMSMGeneric, return the selected entry
  * params:
  *      1) m: ptr to struct CMSMGeneric
@@ -157,19 +172,39 @@ struct CMSMGenericCtorArg {
     CMSMGeneric* restrict m;
     const uint64_t* restrict rmap;
     const MDMac* restrict mac;
+    // only for recording where the entries come from in the base KS system
+    const GFM* restrict ks;
+    const uint64_t* restrict coff; // offset of each column in memblk
+    uint32_t* restrict koff;
 };
 
 static inline void
 cmsm_generic_ctor_cb(uint64_t i, uint64_t ridx, void* __arg) {
     struct CMSMGenericCtorArg* arg = __arg;
     const GFA* row = mdmac_row(arg->mac, ridx);
+    // the non-zero entries of the row are those of a row in the base KS system
+    const gf_t* ks_row = NULL;
+    uint64_t ks_off = 0, kj = 0;
+    if(arg->koff) {
+        const uint64_t src = mdmac_row_src(arg->mac, ridx);
+        ks_row = gfm_row_addr(arg->ks, src);
+        ks_off = src * gfm_ncol(arg->ks);
+    }
     for(uint64_t j = 0; j < gfa_size(row); ++j) {
         gfa_idx_t idx; gf_t v = gfa_at(row, j, &idx);
+        if(arg->koff) {
+            while(!ks_row[kj])
+                ++kj;
+            ++kj;
+        }
         if(arg->rmap[idx] == UINT64_MAX) // the column is not included. skip it
             continue;
 
         assert(arg->rmap[idx] < arg->m->cnum);
         GFA * target_col = (GFA*) cmsm_generic_col(arg->m, arg->rmap[idx]);
+        if(arg->koff)
+            arg->koff[arg->coff[arg->rmap[idx]] + gfa_size(target_col)] =
+                ks_off + kj - 1;
         // NOTE: the ridx is the row index in the full MDMac, while i is
         // the new row index in the set of selected rows
         gfa_set_at(target_col, gfa_size(target_col), i, v);
@@ -177,24 +212,17 @@ cmsm_generic_ctor_cb(uint64_t i, uint64_t ridx, void* __arg) {
     }
 }
 
-/* usage: create and initialize a CMSMGeneric from the selected columns of a
- *      multi-degree Macaulay matrix
- * params:
- *      1) mac: ptr to struct MDMac
- *      2) nrow: number of rows to randomly select
- *      3) row_seed: seed for the random number generator for selecting rows
- *      4) it: ptr to struct MDMacColIterator. An iterator that
- *          returns indices of columns that should be included
- *      5) nznum_per_col: a uint32_t array that stores the non-zero entries of
- *          each column of mac
- *      6) nznum: number of non-zero entries in the selected columns
- * return: ptr to struct CMSMGeneric on success, NULL otherwise */
-CMSMGeneric*
-cmsm_generic_from_mdmac(const MDMac* restrict mac,
-                        uint64_t nrow, int32_t row_seed,
-                        MDMacColIterator* restrict it,
-                        const uint32_t* restrict nznum_per_col,
-                        uint64_t nznum) {
+/* subroutine of cmsm_generic_from_mdmac, cmsm_generic_from_mdmac_rows and
+ * cmsm_generic_from_mdmac_src: the rows are given by ridxs if it's not NULL,
+ * or randomly selected with row_seed otherwise. If koff is not NULL, the
+ * positions of the entries in ks are recorded into it */
+static CMSMGeneric*
+cmsm_generic_from_mdmac_internal(const MDMac* restrict mac, uint64_t nrow,
+                                 const uint64_t* restrict ridxs, int32_t row_seed,
+                                 MDMacColIterator* restrict it,
+                                 const uint32_t* restrict nznum_per_col,
+                                 uint64_t nznum, const GFM* restrict ks,
+                                 uint32_t* restrict koff) {
     size_t buf_size = cmsm_generic_calc_buf_size(nznum);
     CMSMGeneric* m = malloc(sizeof(CMSMGeneric) + buf_size);
     if(!m)
@@ -229,16 +257,32 @@ cmsm_generic_from_mdmac(const MDMac* restrict mac,
     m->rnum = nrow;
     m->cnum = cnum;
 
+    uint64_t* coff = NULL;
+    if(koff && !(coff = malloc(sizeof(uint64_t) * cnum))) {
+        free(rmap);
+        cmsm_generic_free(m);
+        return NULL;
+    }
+    uint64_t off = 0;
     for(uint64_t i = 0; i < cnum; ++i) {
         GFA * col = (GFA*) cmsm_generic_col(m, i);
+        if(coff) {
+            coff[i] = off;
+            off += gfa_size(col);
+        }
         gfa_set_size(col, 0);
     }
 
     struct CMSMGenericCtorArg ctor_arg = {
-        .m = m, .mac = mac, .rmap = rmap
+        .m = m, .mac = mac, .rmap = rmap, .ks = ks, .coff = coff, .koff = koff,
     };
-    int64_t rv = mdmac_iter_random_rows(mdmac_nrow(mac), nrow, row_seed,
-                                        cmsm_generic_ctor_cb, &ctor_arg);
+    int64_t rv = 0;
+    if(ridxs)
+        mdmac_iter_rows(ridxs, nrow, cmsm_generic_ctor_cb, &ctor_arg);
+    else
+        rv = mdmac_iter_random_rows(mdmac_nrow(mac), nrow, row_seed,
+                                    cmsm_generic_ctor_cb, &ctor_arg);
+    free(coff);
     free(rmap);
     if(rv) {
         cmsm_generic_free(m);
@@ -256,6 +300,588 @@ cmsm_generic_from_mdmac(const MDMac* restrict mac,
     return m;
 }
 
+/* usage: create and initialize a CMSMGeneric from the selected columns of a
+ *      multi-degree Macaulay matrix
+ * params:
+ *      1) mac: ptr to struct MDMac
+ *      2) nrow: number of rows to randomly select
+ *      3) row_seed: seed for the random number generator for selecting rows
+ *      4) it: ptr to struct MDMacColIterator. An iterator that
+ *          returns indices of columns that should be included
+ *      5) nznum_per_col: a uint32_t array that stores the non-zero entries of
+ *          each column of mac
+ *      6) nznum: number of non-zero entries in the selected columns
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_mdmac(const MDMac* restrict mac,
+                        uint64_t nrow, int32_t row_seed,
+                        MDMacColIterator* restrict it,
+                        const uint32_t* restrict nznum_per_col,
+                        uint64_t nznum) {
+    return cmsm_generic_from_mdmac_internal(mac, nrow, NULL, row_seed, it,
+                                            nznum_per_col, nznum, NULL, NULL);
+}
+
+/* usage: create and initialize a CMSMGeneric from the selected rows and
+ *      columns of a multi-degree Macaulay matrix
+ * params:
+ *      1) mac: ptr to struct MDMac
+ *      2) ridxs: indices of the rows to include, e.g. selected with
+ *          mdmac_select_rows
+ *      3) nrow: size of ridxs
+ *      4) it: ptr to struct MDMacColIterator. An iterator that
+ *          returns indices of columns that should be included
+ *      5) nznum_per_col: a uint32_t array that stores the non-zero entries of
+ *          each column of mac in the given rows
+ *      6) nznum: number of non-zero entries in the selected rows and columns
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_mdmac_rows(const MDMac* restrict mac,
+                             const uint64_t* restrict ridxs, uint64_t nrow,
+                             MDMacColIterator* restrict it,
+                             const uint32_t* restrict nznum_per_col,
+                             uint64_t nznum) {
+    return cmsm_generic_from_mdmac_internal(mac, nrow, ridxs, 0, it,
+                                            nznum_per_col, nznum, NULL, NULL);
+}
+
+/* usage: create and initialize a CMSMGeneric from a multi-degree Macaulay
+ *      matrix as cmsm_generic_from_mdmac_rows, or cmsm_generic_from_mdmac if
+ *      ridxs is NULL, and record where each of its entries comes from in the
+ *      base KS system. The matrix can then serve as the sparsity pattern for
+ *      other instances of the same parameters, see cmsm_generic_refill
+ * params:
+ *      1) mac: ptr to struct MDMac
+ *      2) ks: ptr to struct GFM, the base KS system mac is computed from
+ *      3) ridxs: indices of the rows to include, or NULL
+ *      4) nrow: number of rows to include
+ *      5) row_seed: seed to randomly select the rows if ridxs is NULL
+ *      6) it: ptr to struct MDMacColIterator. An iterator that
+ *          returns indices of columns that should be included
+ *      7) nznum_per_col: a uint32_t array that stores the non-zero entries of
+ *          each column of mac in the selected rows
+ *      8) nznum: number of non-zero entries in the selected rows and columns
+ *      9) koff: a uint32_t array of size nznum. Container for the positions of
+ *          the entries in the memory block of ks, in the order they are stored
+ *          column by column
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_mdmac_src(const MDMac* restrict mac, const GFM* restrict ks,
+                            const uint64_t* restrict ridxs, uint64_t nrow,
+                            int32_t row_seed, MDMacColIterator* restrict it,
+                            const uint32_t* restrict nznum_per_col,
+                            uint64_t nznum, uint32_t* restrict koff) {
+    return cmsm_generic_from_mdmac_internal(mac, nrow, ridxs, row_seed, it,
+                                            nznum_per_col, nznum, ks, koff);
+}
+
+/* usage: refill a CMSMGeneric with the coefficients of a base KS system. The
+ *      sparsity pattern is taken from a matrix created with
+ *      cmsm_generic_from_mdmac_src from a KS system of the same parameters,
+ *      and entries that are zero in the new KS system are dropped
+ * params:
+ *      1) m: ptr to struct CMSMGeneric, the container to refill. Must have
+ *          been copied from pat, e.g. with cmsm_generic_append_cols(pat, pat,
+ *          NULL, 0), or refilled from it before
+ *      2) pat: ptr to struct CMSMGeneric, the sparsity pattern
+ *      3) koff: positions of the entries of pat in the base KS system, as
+ *          returned by cmsm_generic_from_mdmac_src
+ *      4) ks: ptr to struct GFM, the new base KS system
+ * return: void */
+void
+cmsm_generic_refill(CMSMGeneric* restrict m, const CMSMGeneric* restrict pat,
+                    const uint32_t* restrict koff, const GFM* restrict ks) {
+    assert(m->cnum == pat->cnum && m->rnum == pat->rnum);
+    const gf_t* src = gfm_row_addr(ks, 0);
+    uint64_t nznum = 0, max_tnum = 0;
+    for(uint64_t i = 0; i < pat->cnum; ++i) {
+        const GFA* pcol = cmsm_generic_col(pat, i);
+        GFA* col = (GFA*) cmsm_generic_col(m, i);
+        gfa_idx_t sz = 0;
+        for(gfa_idx_t j = 0; j < gfa_size(pcol); ++j) {
+            const gf_t v = src[*koff++];
+            if(!v)
+                continue;
+            gfa_idx_t ridx;
+            gfa_at(pcol, j, &ridx);
+            gfa_set_at(col, sz++, ridx, v);
+        }
+        gfa_set_size(col, sz);
+        nznum += sz;
+        if(sz > max_tnum)
+            max_tnum = sz;
+    }
+    m->nznum = nznum;
+    m->max_tnum = max_tnum;
+    m->avg_tnum = nznum / m->cnum;
+}
+
+/* wrapper for passing arguments to the workers of cmsm_generic_split_mdmac */
+struct __CMSMSplitArg {
+    const MDMac* restrict mac;
+    const uint64_t* restrict ridxs;
+    const BitmapRank* restrict kcols; // the columns to keep
+    uint32_t* restrict cnts; // counters of all the threads, then column sizes
+    uint32_t tnum;
+    uint32_t tid;
+    uint64_t sidx; // range of rows, or of columns for the prefix sums
+    uint64_t eidx;
+    uint64_t elim_cnum;
+    uint64_t nznum; // number of entries to eliminate in the range of columns
+    uint64_t nznum_kept; // number of entries to keep in the range of columns
+    GFA* ecols; // the columns to eliminate ebeg ~ eend - 1 to write
+    uint64_t ebeg;
+    uint64_t eend;
+    CMSMGeneric* kept; // or NULL if the columns to keep are not written
+    // only for recording where the entries come from in the base KS system
+    const GFM* restrict ks;
+    const uint64_t* restrict coff; // offset of each column in its memblk
+    uint32_t* restrict koff;
+    uint32_t* restrict koff_kept;
+};
+
+/* subroutine of cmsm_generic_split_mdmac: count the entries of each column in
+ *      the rows of the thread */
+static void
+cmsm_generic_split_count_worker(void* __arg) {
+    struct __CMSMSplitArg* arg = __arg;
+    const uint64_t ncol = mdmac_ncol(arg->mac);
+    uint32_t* restrict cnt = arg->cnts + arg->tid * ncol;
+    memset(cnt, 0x0, sizeof(uint32_t) * ncol);
+    for(uint64_t i = arg->sidx; i < arg->eidx; ++i) {
+        const GFA* row = mdmac_row(arg->mac, arg->ridxs[i]);
+        for(uint64_t j = 0; j < gfa_size(row); ++j) {
+            gfa_idx_t idx; gfa_at(row, j, &idx);
+            ++cnt[idx];
+        }
+    }
+}
+
+/* subroutine of cmsm_generic_split_mdmac: turn the counters of the columns in
+ *      the range of the thread into the positions where each thread starts
+ *      writing in the columns, and store the sizes of the columns after
+ *      the counters, indexed by the columns to eliminate and then the columns
+ *      to keep */
+static void
+cmsm_generic_split_prefix_worker(void* __arg) {
+    struct __CMSMSplitArg* arg = __arg;
+    const uint64_t ncol = mdmac_ncol(arg->mac);
+    uint32_t* restrict sizes = arg->cnts + arg->tnum * ncol;
+    uint64_t nznum = 0, nznum_kept = 0;
+    for(uint64_t ci = arg->sidx; ci < arg->eidx; ++ci) {
+        uint32_t sum = 0;
+        for(uint32_t t = 0; t < arg->tnum; ++t) {
+            uint32_t* cnt = arg->cnts + t * ncol + ci;
+            const uint32_t n = *cnt;
+            *cnt = sum;
+            sum += n;
+        }
+        const uint64_t ki = bitmap_rank1(arg->kcols, ci);
+        if(bitmap_at(arg->kcols->b, ci)) {
+            sizes[arg->elim_cnum + ki] = sum;
+            nznum_kept += sum;
+        } else {
+            sizes[ci - ki] = sum;
+            nznum += sum;
+        }
+    }
+    arg->nznum = nznum;
+    arg->nznum_kept = nznum_kept;
+}
+
+/* subroutine of cmsm_generic_split_mdmac: write the entries in the rows of the
+ *      thread into the columns. The threads hold increasing ranges of rows and
+ *      start writing after the entries of the previous threads, so the
+ *      entries of each column are sorted by row. Only the entries of the range
+ *      of columns to eliminate, and those of the columns to keep if kept is
+ *      set, are written */
+static void
+cmsm_generic_split_scatter_worker(void* __arg) {
+    struct __CMSMSplitArg* arg = __arg;
+    const uint64_t ncol = mdmac_ncol(arg->mac);
+    uint32_t* restrict pos = arg->cnts + arg->tid * ncol;
+    for(uint64_t i = arg->sidx; i < arg->eidx; ++i) {
+        const uint64_t ridx = arg->ridxs[i];
+        const GFA* row = mdmac_row(arg->mac, ridx);
+        // the non-zero entries of the row are those of a row in the base KS
+        // system
+        const gf_t* ks_row = NULL;
+        uint64_t ks_off = 0, kj = 0;
+        if(arg->ks) {
+            const uint64_t src = mdmac_row_src(arg->mac, ridx);
+            ks_row = gfm_row_addr(arg->ks, src);
+            ks_off = src * gfm_ncol(arg->ks);
+        }
+        for(uint64_t j = 0; j < gfa_size(row); ++j) {
+            gfa_idx_t idx; gf_t v = gfa_at(row, j, &idx);
+            if(arg->ks) {
+                while(!ks_row[kj])
+                    ++kj;
+                ++kj;
+            }
+            const uint64_t ki = bitmap_rank1(arg->kcols, idx);
+            uint32_t p;
+            GFA* col;
+            if(bitmap_at(arg->kcols->b, idx)) {
+                if(!arg->kept)
+                    continue;
+                p = pos[idx]++;
+                col = (GFA*) cmsm_generic_col(arg->kept, ki);
+                if(arg->ks)
+                    arg->koff_kept[arg->coff[arg->elim_cnum + ki] + p] =
+                        ks_off + kj - 1;
+            } else {
+                const uint64_t ci = idx - ki;
+                if(ci < arg->ebeg || ci >= arg->eend)
+                    continue;
+                p = pos[idx]++;
+                col = (GFA*) gfa_arr_at(arg->ecols, ci - arg->ebeg);
+                if(arg->ks)
+                    arg->koff[arg->coff[ci] + p] = ks_off + kj - 1;
+            }
+            assert(p < gfa_size(col));
+            // NOTE: the ridx is the row index in the full MDMac, while i is
+            // the new row index in the set of selected rows
+            gfa_set_at(col, p, i, v);
+        }
+    }
+}
+
+/* subroutine of cmsm_generic_split_mdmac and cmsm_generic_split_mdmac_ooc:
+ *      count the entries of each column in the rows of each of the first hnum
+ *      threads, then turn the counters into the positions where the threads
+ *      start writing in the columns with all the threads, and compute the
+ *      sizes of the columns */
+static void
+cmsm_generic_split_count(struct __CMSMSplitArg* restrict args, uint64_t nrow,
+                         uint64_t ncol, uint32_t hnum, uint32_t tnum,
+                         Threadpool* restrict tp) {
+    const uint64_t rstrip = nrow / hnum, cstrip = ncol / tnum;
+    for(uint32_t i = 0; i < hnum; ++i) {
+        args[i].sidx = i * rstrip;
+        args[i].eidx = (i == hnum - 1) ? nrow : (i + 1) * rstrip;
+        thpool_add_job(tp, cmsm_generic_split_count_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].sidx = i * cstrip;
+        args[i].eidx = (i == tnum - 1) ? ncol : (i + 1) * cstrip;
+        thpool_add_job(tp, cmsm_generic_split_prefix_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
+/* subroutine of cmsm_generic_split_mdmac and cmsm_generic_split_mdmac_ooc:
+ *      write the entries of the columns to eliminate ebeg ~ eend - 1 into
+ *      ecols, and those of the columns to keep into kept unless it's NULL,
+ *      with the first hnum threads */
+static void
+cmsm_generic_split_scatter(struct __CMSMSplitArg* restrict args, uint64_t nrow,
+                           uint32_t hnum, GFA* restrict ecols, uint64_t ebeg,
+                           uint64_t eend, CMSMGeneric* restrict kept,
+                           Threadpool* restrict tp) {
+    const uint64_t rstrip = nrow / hnum;
+    for(uint32_t i = 0; i < hnum; ++i) {
+        args[i].sidx = i * rstrip;
+        args[i].eidx = (i == hnum - 1) ? nrow : (i + 1) * rstrip;
+        args[i].ecols = ecols;
+        args[i].ebeg = ebeg;
+        args[i].eend = eend;
+        args[i].kept = kept;
+        thpool_add_job(tp, cmsm_generic_split_scatter_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
+/* wrapper for passing arguments to function cmsm_generic_cmp_col_sz_split */
+struct __GFASizeArgSplit {
+    const uint32_t* restrict sizes;
+    uint64_t* restrict coff;
+    uint64_t max;
+    uint64_t sum;
+};
+
+/* subroutine of cmsm_generic_split_mdmac: return the number of non-zero
+ *      entries in the given column, and record its offset in the memory block
+ *      if needed */
+static gfa_idx_t
+cmsm_generic_cmp_col_sz_split(uint64_t col_idx, GFA* e, void* __arg) {
+    (void) e;
+    struct __GFASizeArgSplit* arg = (struct __GFASizeArgSplit*) __arg;
+    uint32_t sz = arg->sizes[col_idx];
+    // NOTE: this function does not init the column
+    if(arg->coff)
+        arg->coff[col_idx] = arg->sum;
+
+    // compute some stats
+    if(sz > arg->max)
+        arg->max = sz;
+    arg->sum += sz;
+    return sz;
+}
+
+/* subroutine of cmsm_generic_split_mdmac: create a CMSMGeneric whose columns
+ *      have the given sizes, without initializing them */
+static CMSMGeneric*
+cmsm_generic_create_split(uint64_t rnum, uint64_t cnum, uint64_t nznum,
+                          const uint32_t* restrict sizes,
+                          uint64_t* restrict coff) {
+    CMSMGeneric* m = malloc(sizeof(CMSMGeneric) +
+                            cmsm_generic_calc_buf_size(nznum));
+    if(!m)
+        return NULL;
+
+    struct __GFASizeArgSplit arg = {
+        .sizes = sizes, .coff = coff, .max = 0, .sum = 0,
+    };
+    m->cols = gfa_arr_create_f(cnum, m->memblk, &arg,
+                               cmsm_generic_cmp_col_sz_split);
+    if(!m->cols) {
+        free(m);
+        return NULL;
+    }
+    assert(arg.sum == nznum);
+    m->nznum = nznum;
+    m->max_tnum = arg.max;
+    m->avg_tnum = cnum ? arg.sum / cnum : 0;
+    m->rnum = rnum;
+    m->cnum = cnum;
+    return m;
+}
+
+/* subroutine of cmsm_generic_split_mdmac and
+ *      cmsm_generic_split_calc_mem_size: return the number of threads whose
+ *      counters fit in CMSM_SPLIT_CNT_MEM, at least 1 and at most tnum */
+static uint32_t
+cmsm_generic_split_tnum(uint64_t ncol, uint32_t tnum) {
+    const uint64_t n = CMSM_SPLIT_CNT_MEM / (sizeof(uint32_t) * (ncol + 1));
+    if(!n)
+        return 1;
+    return (n < tnum) ? n : tnum;
+}
+
+/* usage: given the number of columns of a multi-degree Macaulay matrix,
+ *      compute the size of the counters cmsm_generic_split_mdmac needs on top
+ *      of the matrices it creates
+ * params:
+ *      1) ncol: number of columns of the multi-degree Macaulay matrix
+ *      2) tnum: number of threads to use
+ * return: size in bytes */
+size_t
+cmsm_generic_split_calc_mem_size(uint64_t ncol, uint32_t tnum) {
+    return sizeof(uint32_t) * ncol * (cmsm_generic_split_tnum(ncol, tnum) + 1);
+}
+
+/* usage: create and initialize both the matrix to eliminate and the matrix of
+ *      the columns to keep from the given rows of a multi-degree Macaulay
+ *      matrix, in a single parallel pass over the rows. The columns of both
+ *      matrices are in the same order as in the multi-degree Macaulay
+ *      matrix, so the index of a column in either of them is its rank in
+ *      kcols. Each thread counts
+ *      the entries of each column in its range of rows, and then writes them
+ *      after those of the previous threads, so the result is the same as
+ *      cmsm_generic_from_mdmac_rows for any number of threads. Since the
+ *      counters of a thread span all the columns, only as many threads as
+ *      cmsm_generic_split_calc_mem_size allows for take part. If ks is not
+ *      NULL, also record where each of the entries comes from in the base KS
+ *      system as cmsm_generic_from_mdmac_src
+ * params:
+ *      1) elim: container for the ptr to the matrix to eliminate
+ *      2) kept: container for the ptr to the matrix of the columns to keep
+ *      3) mac: ptr to struct MDMac
+ *      4) ridxs: indices of the rows to include
+ *      5) nrow: size of ridxs
+ *      6) kcols: ptr to the struct BitmapRank of a Bitmap where the columns
+ *          to keep are set
+ *      7) ks: ptr to struct GFM, the base KS system mac is computed from, or
+ *          NULL
+ *      8) koff: container for the positions of the entries of the matrix to
+ *          eliminate in the memory block of ks. Only used if ks is not NULL.
+ *          The array is allocated and must be freed by the caller
+ *      9) koff_kept: same as koff for the matrix of the columns to keep
+ *      10) tnum: number of threads to use
+ *      11) tp: ptr to a struct Threadpool
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_split_mdmac(CMSMGeneric** restrict elim,
+                         CMSMGeneric** restrict kept,
+                         const MDMac* restrict mac,
+                         const uint64_t* restrict ridxs, uint64_t nrow,
+                         const BitmapRank* restrict kcols,
+                         const GFM* restrict ks, uint32_t** restrict koff,
+                         uint32_t** restrict koff_kept, uint32_t tnum,
+                         Threadpool* restrict tp) {
+    const uint64_t ncol = mdmac_ncol(mac);
+    assert(bitmap_size(kcols->b) == ncol);
+    const uint64_t kept_cnum = bitmap_rank1(kcols, ncol);
+    const uint64_t elim_cnum = ncol - kept_cnum;
+    // the threads that count and write the entries of the rows, all of them
+    // compute the prefix sums
+    const uint32_t hnum = cmsm_generic_split_tnum(ncol, tnum);
+    struct __CMSMSplitArg* args = malloc(sizeof(struct __CMSMSplitArg) * tnum);
+    uint32_t* cnts = malloc(sizeof(uint32_t) * ncol * (hnum + 1));
+    uint64_t* coff = NULL;
+    bool ok = false;
+    *elim = *kept = NULL;
+    if(ks) {
+        *koff = *koff_kept = NULL;
+        coff = malloc(sizeof(uint64_t) * ncol);
+    }
+    if(!args || !cnts || (ks && !coff))
+        goto cmsm_generic_split_mdmac_cleanup;
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i] = (struct __CMSMSplitArg) {
+            .mac = mac, .ridxs = ridxs, .kcols = kcols, .cnts = cnts,
+            .tnum = hnum, .tid = i, .elim_cnum = elim_cnum, .ks = ks,
+            .coff = coff,
+        };
+    }
+    cmsm_generic_split_count(args, nrow, ncol, hnum, tnum, tp);
+
+    uint64_t nznum = 0, nznum_kept = 0;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        nznum += args[i].nznum;
+        nznum_kept += args[i].nznum_kept;
+    }
+    const uint32_t* sizes = cnts + hnum * ncol;
+    if( !(*elim = cmsm_generic_create_split(nrow, elim_cnum, nznum, sizes,
+                                            coff)) ||
+        !(*kept = cmsm_generic_create_split(nrow, kept_cnum,
+                                            nznum_kept,
+                                            sizes + elim_cnum,
+                                            coff ? coff + elim_cnum : NULL)) )
+        goto cmsm_generic_split_mdmac_cleanup;
+    if(ks && ( !(*koff = malloc(sizeof(uint32_t) * (nznum ? nznum : 1))) ||
+               !(*koff_kept = malloc(sizeof(uint32_t) *
+                                     (nznum_kept ? nznum_kept : 1))) ))
+        goto cmsm_generic_split_mdmac_cleanup;
+
+    if(ks) {
+        for(uint32_t i = 0; i < hnum; ++i) {
+            args[i].koff = *koff;
+            args[i].koff_kept = *koff_kept;
+        }
+    }
+    cmsm_generic_split_scatter(args, nrow, hnum, (*elim)->cols, 0, elim_cnum,
+                               *kept, tp);
+    ok = true;
+
+cmsm_generic_split_mdmac_cleanup:
+    if(!ok) {
+        cmsm_generic_free(*elim);
+        cmsm_generic_free(*kept);
+        *elim = *kept = NULL;
+        if(ks) {
+            free(*koff);
+            free(*koff_kept);
+            *koff = *koff_kept = NULL;
+        }
+    }
+    free(coff);
+    free(cnts);
+    free(args);
+    return ok;
+}
+
+// wrapper for passing arguments to function cmsm_generic_split_fill_ooc
+struct __CMSMSplitFillArg {
+    struct __CMSMSplitArg* args;
+    uint64_t nrow;
+    uint32_t hnum;
+    CMSMGeneric* kept; // until the columns to keep are written
+    Threadpool* tp;
+};
+
+/* subroutine of cmsm_generic_split_mdmac_ooc: write the entries of a block of
+ *      the columns to eliminate. The columns to keep are written along with
+ *      the first block */
+static bool
+cmsm_generic_split_fill_ooc(GFA* restrict cols, uint64_t cbeg, uint64_t cend,
+                            void* restrict __arg) {
+    struct __CMSMSplitFillArg* arg = __arg;
+    cmsm_generic_split_scatter(arg->args, arg->nrow, arg->hnum, cols, cbeg,
+                               cend, arg->kept, arg->tp);
+    arg->kept = NULL;
+    return true;
+}
+
+/* usage: the counterpart of cmsm_generic_split_mdmac with the matrix to
+ *      eliminate on disk. It's never held in memory as a whole: once the
+ *      sizes of the columns are known, its blocks are written one at a time,
+ *      each with a pass over the rows that only writes the entries of the
+ *      block. The matrix of the columns to keep is created in memory
+ * params:
+ *      1) elim: container for the ptr to the matrix to eliminate
+ *      2) kept: container for the ptr to the matrix of the columns to keep
+ *      3) mac: ptr to struct MDMac
+ *      4) ridxs: indices of the rows to include
+ *      5) nrow: size of ridxs
+ *      6) kcols: ptr to the struct BitmapRank of a Bitmap where the columns
+ *          to keep are set
+ *      7) dir: directory to create the file of the matrix to eliminate in
+ *      8) blk_mem: max size of a block of the matrix to eliminate in bytes
+ *      9) tnum: number of threads to use
+ *      10) tp: ptr to a struct Threadpool
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_split_mdmac_ooc(CMSMOOC** restrict elim,
+                             CMSMGeneric** restrict kept,
+                             const MDMac* restrict mac,
+                             const uint64_t* restrict ridxs, uint64_t nrow,
+                             const BitmapRank* restrict kcols,
+                             const char* restrict dir, uint64_t blk_mem,
+                             uint32_t tnum, Threadpool* restrict tp) {
+    const uint64_t ncol = mdmac_ncol(mac);
+    assert(bitmap_size(kcols->b) == ncol);
+    const uint64_t kept_cnum = bitmap_rank1(kcols, ncol);
+    const uint64_t elim_cnum = ncol - kept_cnum;
+    const uint32_t hnum = cmsm_generic_split_tnum(ncol, tnum);
+    struct __CMSMSplitArg* args = malloc(sizeof(struct __CMSMSplitArg) * tnum);
+    uint32_t* cnts = malloc(sizeof(uint32_t) * ncol * (hnum + 1));
+    bool ok = false;
+    *elim = NULL;
+    *kept = NULL;
+    if(!args || !cnts)
+        goto cmsm_generic_split_mdmac_ooc_cleanup;
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i] = (struct __CMSMSplitArg) {
+            .mac = mac, .ridxs = ridxs, .kcols = kcols, .cnts = cnts,
+            .tnum = hnum, .tid = i, .elim_cnum = elim_cnum,
+        };
+    }
+    cmsm_generic_split_count(args, nrow, ncol, hnum, tnum, tp);
+
+    uint64_t nznum_kept = 0;
+    for(uint32_t i = 0; i < tnum; ++i)
+        nznum_kept += args[i].nznum_kept;
+    const uint32_t* sizes = cnts + hnum * ncol;
+    if( !(*kept = cmsm_generic_create_split(nrow, kept_cnum, nznum_kept,
+                                            sizes + elim_cnum, NULL)) )
+        goto cmsm_generic_split_mdmac_ooc_cleanup;
+
+    struct __CMSMSplitFillArg farg = {
+        .args = args, .nrow = nrow, .hnum = hnum, .kept = *kept, .tp = tp,
+    };
+    if( !(*elim = cmsm_ooc_create(nrow, elim_cnum, sizes, dir, blk_mem, tnum,
+                                  cmsm_generic_split_fill_ooc, &farg)) )
+        goto cmsm_generic_split_mdmac_ooc_cleanup;
+    if(farg.kept) // there's no column to eliminate
+        cmsm_generic_split_fill_ooc(NULL, 0, 0, &farg);
+    ok = true;
+
+cmsm_generic_split_mdmac_ooc_cleanup:
+    if(!ok) {
+        cmsm_generic_free(*kept);
+        *kept = NULL;
+    }
+    free(cnts);
+    free(args);
+    return ok;
+}
+
 /* wrapper for passing arguments to function cmsm_generic_cmp_col_sz_gf_arr */
 struct __GFASizeArgGFArr {
     const gf_t* restrict mat;
@@ -319,6 +945,378 @@ cmsm_generic_from_gf_arr(const gf_t* a, uint64_t rnum, uint64_t cnum) {
     return m;
 }
 
+/* wrapper for passing arguments to function cmsm_generic_cp_col */
+struct __GFACopyArg {
+    const CMSMGeneric* restrict a;
+    const CMSMGeneric* restrict b;
+    const uint64_t* restrict cidxs;
+    uint64_t max_sz;
+};
+
+/* subroutine of cmsm_generic_append_cols: copy a column of a or one of the
+ * selected columns of b into the new column, and return its size. */
+static gfa_idx_t
+cmsm_generic_cp_col(uint64_t col_idx, GFA* e, void* __arg) {
+    struct __GFACopyArg* arg = (struct __GFACopyArg*) __arg;
+    const GFA* src = (col_idx < arg->a->cnum) ?
+                     cmsm_generic_col(arg->a, col_idx) :
+                     cmsm_generic_col(arg->b, arg->cidxs[col_idx - arg->a->cnum]);
+    gfa_idx_t sz = gfa_size(src);
+    for(gfa_idx_t i = 0; i < sz; ++i) {
+        gfa_idx_t idx; gf_t v = gfa_at(src, i, &idx);
+        gfa_set_at(e, i, idx, v);
+    }
+    if(arg->max_sz < sz)
+        arg->max_sz = sz;
+    return sz;
+}
+
+/* usage: create a CMSMGeneric which consists of all the columns of a
+ *      followed by the selected columns of b
+ * params:
+ *      1) a: ptr to struct CMSMGeneric
+ *      2) b: ptr to struct CMSMGeneric with the same number of rows as a
+ *      3) cidxs: indices of the columns of b to append
+ *      4) n: number of columns to append
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_append_cols(const CMSMGeneric* restrict a,
+                         const CMSMGeneric* restrict b,
+                         const uint64_t* restrict cidxs, uint64_t n) {
+    assert(a->rnum == b->rnum);
+    uint64_t nznum = a->nznum;
+    for(uint64_t i = 0; i < n; ++i)
+        nznum += gfa_size(cmsm_generic_col(b, cidxs[i]));
+
+    CMSMGeneric* m = malloc(sizeof(CMSMGeneric) + cmsm_generic_calc_buf_size(nznum));
+    if(!m)
+        return NULL;
+
+    struct __GFACopyArg arg = {
+        .a = a, .b = b, .cidxs = cidxs, .max_sz = 0,
+    };
+    m->cols = gfa_arr_create_f(a->cnum + n, m->memblk, &arg, cmsm_generic_cp_col);
+    if(!m->cols) {
+        free(m);
+        return NULL;
+    }
+
+    m->nznum = nznum;
+    m->max_tnum = arg.max_sz;
+    m->rnum = a->rnum;
+    m->cnum = a->cnum + n;
+    m->avg_tnum = nznum / m->cnum;
+    return m;
+}
+
+/* wrapper for passing arguments to function cmsm_generic_cp_col_csr */
+struct __GFACSRArg {
+    const uint64_t* restrict sizes;
+    uint64_t max_sz;
+};
+
+/* subroutine of cmsm_generic_from_csr: collect the entries of the given
+ * column from the rows, and return its size. */
+static gfa_idx_t
+cmsm_generic_cp_col_csr(uint64_t col_idx, GFA* e, void* __arg) {
+    (void) e; // the entries are filled in later row by row
+    struct __GFACSRArg* arg = (struct __GFACSRArg*) __arg;
+    gfa_idx_t sz = arg->sizes[col_idx];
+    if(arg->max_sz < sz)
+        arg->max_sz = sz;
+    return sz;
+}
+
+/* usage: create and initialize a CMSMGeneric from a matrix stored in the
+ *      compressed sparse row (CSR) format
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) rptr: an array of rnum + 1 uint64_t. The entries of the i-th row are
+ *              stored from rptr[i] to rptr[i+1] - 1
+ *      4) cidxs: column indices of the entries. Must be sorted within a row
+ *      5) vals: values of the entries
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_csr(uint64_t rnum, uint64_t cnum,
+                      const uint64_t* restrict rptr,
+                      const gfa_idx_t* restrict cidxs,
+                      const gf_t* restrict vals) {
+    uint64_t nznum = rptr[rnum];
+    CMSMGeneric* m = malloc(sizeof(CMSMGeneric) + cmsm_generic_calc_buf_size(nznum));
+    uint64_t* sizes = calloc(cnum ? cnum : 1, sizeof(uint64_t));
+    if(!m || !sizes) {
+        free(sizes);
+        free(m);
+        return NULL;
+    }
+
+    for(uint64_t i = 0; i < nznum; ++i)
+        ++sizes[cidxs[i]];
+
+    struct __GFACSRArg arg = { .sizes = sizes, .max_sz = 0 };
+    m->cols = gfa_arr_create_f(cnum, m->memblk, &arg, cmsm_generic_cp_col_csr);
+    free(sizes);
+    if(!m->cols) {
+        free(m);
+        return NULL;
+    }
+
+    m->nznum = nznum;
+    m->max_tnum = arg.max_sz;
+    m->rnum = rnum;
+    m->cnum = cnum;
+    m->avg_tnum = cnum ? nznum / cnum : 0;
+
+    // rows are visited in order, so each column is sorted by the row index
+    for(uint64_t ci = 0; ci < cnum; ++ci)
+        gfa_set_size((GFA*) cmsm_generic_col(m, ci), 0);
+    for(uint64_t ri = 0; ri < rnum; ++ri) {
+        for(uint64_t i = rptr[ri]; i < rptr[ri+1]; ++i) {
+            GFA* col = (GFA*) cmsm_generic_col(m, cidxs[i]);
+            gfa_set_at(col, gfa_size(col), ri, vals[i]);
+            gfa_inc_size(col);
+        }
+    }
+    return m;
+}
+
+/* usage: create a random sparse matrix with a fixed expected number of
+ *      non-zero entries in each column. Entries are drawn with rand()
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) col_wt: expected number of non-zero entries in a column
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_rand(uint64_t rnum, uint64_t cnum, uint32_t col_wt) {
+    const uint64_t nznum = cnum * col_wt;
+    uint64_t* rptr = malloc(sizeof(uint64_t) * (rnum + 1));
+    gfa_idx_t* cidxs = malloc(sizeof(gfa_idx_t) * (nznum + rnum));
+    gf_t* vals = malloc(sizeof(gf_t) * (nznum + rnum));
+    CMSMGeneric* m = NULL;
+    if(!rptr || !cidxs || !vals)
+        goto cmsm_generic_rand_end;
+
+    rptr[0] = 0;
+    for(uint64_t ri = 0; ri < rnum; ++ri) {
+        // spread the entries evenly over the rows
+        uint64_t sz = (nznum * (ri + 1)) / rnum - (nznum * ri) / rnum;
+        gfa_idx_t* row = cidxs + rptr[ri];
+        for(uint64_t i = 0; i < sz; ++i)
+            row[i] = rand() % cnum;
+        qsort(row, sz, sizeof(gfa_idx_t), cmp_uint);
+        uint64_t n = 0;
+        for(uint64_t i = 0; i < sz; ++i) {
+            if(n && row[n-1] == row[i])
+                continue;
+            row[n] = row[i];
+            vals[rptr[ri] + n++] = 1 + rand() % 15;
+        }
+        rptr[ri+1] = rptr[ri] + n;
+    }
+    m = cmsm_generic_from_csr(rnum, cnum, rptr, cidxs, vals);
+
+cmsm_generic_rand_end:
+    free(rptr);
+    free(cidxs);
+    free(vals);
+    return m;
+}
+
+/* usage: convert a struct CMSMGeneric into the compressed sparse row (CSR)
+ *      format. See cmsm_generic_from_csr for the format.
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) rptr: an array of rnum + 1 uint64_t
+ *      3) cidxs: an array of nznum gfa_idx_t for the column indices
+ *      4) vals: an array of nznum gf_t for the values
+ * return: void */
+void
+cmsm_generic_to_csr(const CMSMGeneric* restrict m, uint64_t* restrict rptr,
+                    gfa_idx_t* restrict cidxs, gf_t* restrict vals) {
+    memset(rptr, 0x0, sizeof(uint64_t) * (m->rnum + 1));
+    for(uint64_t ci = 0; ci < m->cnum; ++ci) {
+        const GFA* col = cmsm_generic_col(m, ci);
+        for(gfa_idx_t i = 0; i < gfa_size(col); ++i) {
+            gfa_idx_t ri; gfa_at(col, i, &ri);
+            ++rptr[ri + 1];
+        }
+    }
+    for(uint64_t ri = 0; ri < m->rnum; ++ri)
+        rptr[ri + 1] += rptr[ri];
+
+    // columns are visited in order, so each row is sorted by the column index
+    uint64_t* pos = (uint64_t*) rptr; // shifted back below
+    for(uint64_t ci = 0; ci < m->cnum; ++ci) {
+        const GFA* col = cmsm_generic_col(m, ci);
+        for(gfa_idx_t i = 0; i < gfa_size(col); ++i) {
+            gfa_idx_t ri; gf_t v = gfa_at(col, i, &ri);
+            uint64_t dst = pos[ri]++;
+            cidxs[dst] = ci;
+            vals[dst] = v;
+        }
+    }
+    for(uint64_t ri = m->rnum; ri > 0; --ri)
+        rptr[ri] = rptr[ri - 1];
+    rptr[0] = 0;
+}
+
+/* subroutine of cmsm_generic_write and cmsm_generic_from_buf: size of an
+ * array in the binary format, padded to a multiple of 8 bytes */
+static inline uint64_t
+cmsm_generic_padded_size(uint64_t n, size_t esize) {
+    return (n * esize + 7) & ~0x7ULL;
+}
+
+/* subroutine of cmsm_generic_write: pad the array just written */
+static inline bool
+cmsm_generic_write_pad(FILE* f, uint64_t n, size_t esize) {
+    static const uint8_t zeros[8] = {0};
+    const uint64_t pad = cmsm_generic_padded_size(n, esize) - n * esize;
+    return !pad || 1 == fwrite(zeros, pad, 1, f);
+}
+
+/* usage: write a struct CMSMGeneric to a file in the binary format below,
+ *      where each field is in the byte order of the host and each array is
+ *      padded to a multiple of 8 bytes:
+ *
+ *          3 x 8           rnum, cnum, nznum
+ *          8 x cnum        number of entries in each column
+ *          nznum x sizeof(gfa_idx_t)
+ *                          row indices of the entries, column after column
+ *          nznum x sizeof(gf_t)
+ *                          values of the entries, in the same order
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) f: the file to write to
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_write(const CMSMGeneric* restrict m, FILE* restrict f) {
+    const uint64_t hdr[3] = { m->rnum, m->cnum, m->nznum };
+    if(1 != fwrite(hdr, sizeof(hdr), 1, f))
+        return false;
+
+    for(uint64_t ci = 0; ci < m->cnum; ++ci) {
+        const uint64_t sz = gfa_size(cmsm_generic_col(m, ci));
+        if(1 != fwrite(&sz, sizeof(sz), 1, f))
+            return false;
+    }
+
+    for(uint64_t ci = 0; ci < m->cnum; ++ci) {
+        const GFA* col = cmsm_generic_col(m, ci);
+        for(gfa_idx_t i = 0; i < gfa_size(col); ++i) {
+            gfa_idx_t ri; gfa_at(col, i, &ri);
+            if(1 != fwrite(&ri, sizeof(ri), 1, f))
+                return false;
+        }
+    }
+    if(!cmsm_generic_write_pad(f, m->nznum, sizeof(gfa_idx_t)))
+        return false;
+
+    for(uint64_t ci = 0; ci < m->cnum; ++ci) {
+        const GFA* col = cmsm_generic_col(m, ci);
+        for(gfa_idx_t i = 0; i < gfa_size(col); ++i) {
+            gfa_idx_t ri; const gf_t v = gfa_at(col, i, &ri);
+            if(1 != fwrite(&v, sizeof(v), 1, f))
+                return false;
+        }
+    }
+    return cmsm_generic_write_pad(f, m->nznum, sizeof(gf_t));
+}
+
+/* wrapper for passing arguments to function cmsm_generic_cp_col_buf */
+struct __GFABufArg {
+    const uint64_t* restrict sizes;
+    const gfa_idx_t* restrict ridxs;
+    const gf_t* restrict vals;
+    uint64_t offset;
+    uint64_t max_sz;
+};
+
+/* subroutine of cmsm_generic_from_buf: copy the given column from the
+ * buffer, and return its size. */
+static gfa_idx_t
+cmsm_generic_cp_col_buf(uint64_t col_idx, GFA* e, void* __arg) {
+    struct __GFABufArg* arg = (struct __GFABufArg*) __arg;
+    const gfa_idx_t sz = arg->sizes[col_idx];
+    for(gfa_idx_t i = 0; i < sz; ++i, ++(arg->offset))
+        gfa_set_at(e, i, arg->ridxs[arg->offset], arg->vals[arg->offset]);
+    if(arg->max_sz < sz)
+        arg->max_sz = sz;
+    return sz;
+}
+
+/* usage: create and initialize a CMSMGeneric from a buffer holding a matrix
+ *      written by cmsm_generic_write
+ * params:
+ *      1) buf: the buffer, aligned to 8 bytes
+ *      2) size: size of the buffer in bytes
+ *      3) used: ptr to a size_t. Container for the number of bytes the matrix
+ *          takes in the buffer
+ * return: ptr to struct CMSMGeneric on success, NULL if memory allocation
+ *      failed or the buffer doesn't hold a valid matrix */
+CMSMGeneric*
+cmsm_generic_from_buf(const void* restrict buf, size_t size,
+                      size_t* restrict used) {
+    const uint64_t* hdr = buf;
+    if(size < sizeof(uint64_t) * 3)
+        return NULL;
+    const uint64_t rnum = hdr[0], cnum = hdr[1], nznum = hdr[2];
+    if(cnum > size || nznum > size || rnum > GFA_IDX_MAX)
+        return NULL;
+
+    const uint64_t total = sizeof(uint64_t) * (3 + cnum) +
+                           cmsm_generic_padded_size(nznum, sizeof(gfa_idx_t)) +
+                           cmsm_generic_padded_size(nznum, sizeof(gf_t));
+    if(size < total)
+        return NULL;
+
+    const uint64_t* sizes = hdr + 3;
+    const gfa_idx_t* ridxs = (const gfa_idx_t*) (sizes + cnum);
+    const gf_t* vals = (const gf_t*) ((const uint8_t*) ridxs +
+                       cmsm_generic_padded_size(nznum, sizeof(gfa_idx_t)));
+    uint64_t sum = 0;
+    for(uint64_t ci = 0; ci < cnum; ++ci)
+        sum += sizes[ci];
+    if(sum != nznum)
+        return NULL;
+    for(uint64_t i = 0; i < nznum; ++i) {
+        if(ridxs[i] >= rnum)
+            return NULL;
+    }
+
+    CMSMGeneric* m = malloc(sizeof(CMSMGeneric) + cmsm_generic_calc_buf_size(nznum));
+    if(!m)
+        return NULL;
+
+    struct __GFABufArg arg = {
+        .sizes = sizes, .ridxs = ridxs, .vals = vals, .offset = 0, .max_sz = 0,
+    };
+    m->cols = gfa_arr_create_f(cnum, m->memblk, &arg, cmsm_generic_cp_col_buf);
+    if(!m->cols) {
+        free(m);
+        return NULL;
+    }
+
+    m->nznum = nznum;
+    m->max_tnum = arg.max_sz;
+    m->rnum = rnum;
+    m->cnum = cnum;
+    m->avg_tnum = cnum ? nznum / cnum : 0;
+    *used = total;
+    return m;
+}
+
+/* usage: given a struct CMSMGeneric, return its number of non-zero entries
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ * return: number of non-zero entries */
+uint64_t
+cmsm_generic_nznum(const CMSMGeneric* m) {
+    return m->nznum;
+}
+
 /* usage: given a struct CMSMGeneric, release it
  * params:
  *      1) m: ptr to struct CMSMGeneric
@@ -644,6 +1642,268 @@ cmsm_gf16_tr_mul_rm_parallel(RMGF16* restrict res,
     thpool_wait_jobs(tp);
 }
 
+/* usage: given a struct CMSMGeneric m, check if all its entries are in GF(2),
+ *      i.e. if all the non-zero entries are 1
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ * return: true if so, false otherwise */
+bool
+cmsm_generic_is_gf2(const CMSMGeneric* m) {
+    for(uint64_t i = 0; i < cmsm_generic_cnum(m); ++i) {
+        const GFA* col = cmsm_generic_col(m, i);
+        for(uint64_t j = 0; j < gfa_size(col); ++j) {
+            gfa_idx_t ridx;
+            if(gfa_at(col, j, &ridx) != 1)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void
+cmsm_gf2_mul_worker(void* __arg) {
+    R64MGF2PArg* arg = (R64MGF2PArg*) __arg;
+    const CMSMGeneric* m = arg->c;
+    const R64MGF2* v = arg->b;
+    pthread_mutex_t* lock = arg->ptr;
+    R64MGF2* partial = arg->d;
+    assert(arg->eidx >= arg->sidx);
+
+    r64m_gf2_zero(partial);
+    uint64_t* dst = r64m_gf2_raddr(partial, 0);
+    for(uint64_t ci = arg->sidx; ci < arg->eidx; ++ci) { // left multiplication
+        const GFA* col = cmsm_generic_col(m, ci);
+        const uint64_t v_row = *r64m_gf2_raddr((R64MGF2*) v, ci);
+        for(uint64_t j = 0; j < gfa_size(col); ++j) {
+            gfa_idx_t ridx; gfa_at(col, j, &ridx);
+            dst[ridx] ^= v_row;
+        }
+    }
+
+    pthread_mutex_lock(lock);
+    r64m_gf2_addi(arg->a, partial);
+    pthread_mutex_unlock(lock);
+}
+
+/* usage: given a struct CMSMGeneric m whose entries are in GF(2) and a struct
+ *      R64MGF2 v, compute m * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF2 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF2
+ *      4) tnum : number of threads to use
+ *      5) partials: an array of length tnum of ptr to struct R64MGF2.
+ *          Each R64MGF2 must have the same dimension as res. This array is used
+ *          to hold partial results during computation and will be modified.
+ *      6) args: ptr to an array of struct R64MGF2PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      7) tp: ptr to a struct Threadpool
+ *      8) lock: ptr to pthread_mutex_t. Used for sync and must be initialized.
+ * return: void */
+void
+cmsm_gf2_mul_parallel(R64MGF2* restrict res, const CMSMGeneric* restrict m,
+                      const R64MGF2* restrict v, uint32_t tnum,
+                      R64MGF2** restrict partials, R64MGF2PArg* restrict args,
+                      Threadpool* restrict tp, pthread_mutex_t* restrict lock) {
+    assert(cmsm_generic_rnum(m) == r64m_gf2_rnum(res));
+    assert(cmsm_generic_cnum(m) == r64m_gf2_rnum(v));
+    r64m_gf2_zero(res);
+    uint64_t strip_sz = cmsm_generic_cnum(m) / tnum;
+    uint64_t sidx = 0;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].a = res;
+        args[i].b = v;
+        args[i].c = m;
+        args[i].d = partials[i];
+        args[i].ptr = lock;
+        args[i].sidx = sidx;
+        sidx += strip_sz;
+        args[i].eidx = (i == tnum - 1) ? cmsm_generic_cnum(m) : sidx;
+    }
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        thpool_add_job(tp, cmsm_gf2_mul_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
+static void
+cmsm_gf2_tr_mul_worker(void* __arg) {
+    R64MGF2PArg* arg = (R64MGF2PArg*) __arg;
+    const CMSMGeneric* m = arg->c;
+    const uint64_t* v = r64m_gf2_raddr((R64MGF2*) arg->b, 0);
+    uint64_t* dst = r64m_gf2_raddr(arg->a, 0);
+    for(uint64_t i = arg->sidx; i < arg->eidx; ++i) {
+        // each row of m^t (column of m) is the sum of some rows of v
+        const GFA* col = cmsm_generic_col(m, i);
+        uint64_t sum = 0;
+        for(uint64_t j = 0; j < gfa_size(col); ++j) {
+            gfa_idx_t ridx; gfa_at(col, j, &ridx);
+            sum ^= v[ridx];
+        }
+        dst[i] = sum;
+    }
+}
+
+/* usage: given a struct CMSMGeneric m whose entries are in GF(2) and a struct
+ *      R64MGF2 v, compute m^t * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF2 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF2
+ *      4) tnum : number of threads to use
+ *      5) args: ptr to an array of struct R64MGF2PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      6) tp: ptr to a struct Threadpool
+ * return: void */
+void
+cmsm_gf2_tr_mul_parallel(R64MGF2* restrict res, const CMSMGeneric* restrict m,
+                         const R64MGF2* restrict v, uint32_t tnum,
+                         R64MGF2PArg* restrict args, Threadpool* restrict tp) {
+    assert(r64m_gf2_rnum(res) == cmsm_generic_cnum(m));
+    assert(r64m_gf2_rnum(v) == cmsm_generic_rnum(m));
+    uint64_t strip_sz = r64m_gf2_rnum(res) / tnum;
+    uint64_t sidx = 0;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].a = res;
+        args[i].b = v;
+        args[i].c = m;
+        args[i].sidx = sidx;
+        sidx += strip_sz;
+        args[i].eidx = (i == tnum - 1) ? r64m_gf2_rnum(res) : sidx;
+    }
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        thpool_add_job(tp, cmsm_gf2_tr_mul_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
+static void
+cmsm_gf31_mul_worker(void* __arg) {
+    R64MGF31PArg* arg = (R64MGF31PArg*) __arg;
+    const CMSMGeneric* m = arg->c;
+    R64MGF31* v = (R64MGF31*) arg->b;
+    pthread_mutex_t* lock = arg->ptr;
+    R64MGF31* partial = arg->d;
+    assert(arg->eidx >= arg->sidx);
+
+    r64m_gf31_zero(partial);
+    for(uint64_t ci = arg->sidx; ci < arg->eidx; ++ci) { // left multiplication
+        const GFA* col = cmsm_generic_col(m, ci);
+        const gf31_t* v_row = r64m_gf31_raddr(v, ci);
+        for(uint64_t j = 0; j < gfa_size(col); ++j) {
+            gfa_idx_t ridx;
+            gf_t c = gfa_at(col, j, &ridx);
+            gf31_t_arr_fmaddi_scalar64(r64m_gf31_raddr(partial, ridx), v_row, c);
+        }
+    }
+
+    pthread_mutex_lock(lock);
+    r64m_gf31_addi(arg->a, partial);
+    pthread_mutex_unlock(lock);
+}
+
+/* usage: given a struct CMSMGeneric m over GF(31) and a struct R64MGF31 v,
+ *      compute m * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF31 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF31
+ *      4) tnum : number of threads to use
+ *      5) partials: an array of length tnum of ptr to struct R64MGF31.
+ *          Each R64MGF31 must have the same dimension as res. This array is
+ *          used to hold partial results during computation and will be
+ *          modified.
+ *      6) args: ptr to an array of struct R64MGF31PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      7) tp: ptr to a struct Threadpool
+ *      8) lock: ptr to pthread_mutex_t. Used for sync and must be initialized.
+ * return: void */
+void
+cmsm_gf31_mul_parallel(R64MGF31* restrict res, const CMSMGeneric* restrict m,
+                       const R64MGF31* restrict v, uint32_t tnum,
+                       R64MGF31** restrict partials, R64MGF31PArg* restrict args,
+                       Threadpool* restrict tp, pthread_mutex_t* restrict lock) {
+    assert(cmsm_generic_rnum(m) == r64m_gf31_rnum(res));
+    assert(cmsm_generic_cnum(m) == r64m_gf31_rnum(v));
+    r64m_gf31_zero(res);
+    uint64_t strip_sz = cmsm_generic_cnum(m) / tnum;
+    uint64_t sidx = 0;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].a = res;
+        args[i].b = v;
+        args[i].c = m;
+        args[i].d = partials[i];
+        args[i].ptr = lock;
+        args[i].sidx = sidx;
+        sidx += strip_sz;
+        args[i].eidx = (i == tnum - 1) ? cmsm_generic_cnum(m) : sidx;
+    }
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        thpool_add_job(tp, cmsm_gf31_mul_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
+static void
+cmsm_gf31_tr_mul_worker(void* __arg) {
+    R64MGF31PArg* arg = (R64MGF31PArg*) __arg;
+    const CMSMGeneric* m = arg->c;
+    R64MGF31* v = (R64MGF31*) arg->b;
+    alignas(64) uint16_t acc[64];
+    for(uint64_t i = arg->sidx; i < arg->eidx; ++i) {
+        // each row of m^t (column of m) is a linear combination of some rows
+        // of v, accumulated in 16-bit lanes and reduced every GF31_ACC_TERMS
+        // terms
+        const GFA* col = cmsm_generic_col(m, i);
+        memset(acc, 0x0, sizeof(acc));
+        for(uint64_t j = 0; j < gfa_size(col); ++j) {
+            gfa_idx_t ridx;
+            gf_t c = gfa_at(col, j, &ridx);
+            gf31_t_arr_acc_fmaddi_scalar64(acc, r64m_gf31_raddr(v, ridx), c);
+            if((j + 1) % GF31_ACC_TERMS == 0)
+                gf31_t_arr_acc_reduc64(acc);
+        }
+        gf31_t_arr_from_acc64(r64m_gf31_raddr(arg->a, i), acc);
+    }
+}
+
+/* usage: given a struct CMSMGeneric m over GF(31) and a struct R64MGF31 v,
+ *      compute m^t * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF31 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF31
+ *      4) tnum : number of threads to use
+ *      5) args: ptr to an array of struct R64MGF31PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      6) tp: ptr to a struct Threadpool
+ * return: void */
+void
+cmsm_gf31_tr_mul_parallel(R64MGF31* restrict res, const CMSMGeneric* restrict m,
+                          const R64MGF31* restrict v, uint32_t tnum,
+                          R64MGF31PArg* restrict args, Threadpool* restrict tp) {
+    assert(r64m_gf31_rnum(res) == cmsm_generic_cnum(m));
+    assert(r64m_gf31_rnum(v) == cmsm_generic_rnum(m));
+    uint64_t strip_sz = r64m_gf31_rnum(res) / tnum;
+    uint64_t sidx = 0;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].a = res;
+        args[i].b = v;
+        args[i].c = m;
+        args[i].sidx = sidx;
+        sidx += strip_sz;
+        args[i].eidx = (i == tnum - 1) ? r64m_gf31_rnum(res) : sidx;
+    }
+
+    for(uint32_t i = 0; i < tnum; ++i) {
+        thpool_add_job(tp, cmsm_gf31_tr_mul_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+}
+
 /* usage: given a CMSMGeneric m, print its enties
  * params:
  *      1) m: ptr to struct CMSMGeneric
@@ -2,10 +2,16 @@
 #define __CMSMATRIX_GENERIC_H__
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
 
+#include "bitmap.h"
+#include "cmsm_ooc.h"
 #include "mdmac.h"
 #include "matrix_gf16.h"
 #include "r64m_generic.h"
+#include "r64m_gf2.h"
+#include "r64m_gf31.h"
 #include "thpool.h"
 
 typedef struct CMSMGeneric CMSMGeneric;
@@ -60,6 +66,14 @@ cmsm_generic_max_tnum(const CMSMGeneric* m);
 uint64_t
 cmsm_generic_avg_tnum(const CMSMGeneric* m);
 
+/* usage: given a struct CMSMGeneric, return the selected column
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) i: index of the column
+ * return: ptr to struct GFA that points to the selected column */
+const GFA*
+cmsm_generic_col_at(const CMSMGeneric* m, uint64_t i);
+
 /* usage: given a struct CMSMGeneric, return the selected entry
  * params:
  *      1) m: ptr to struct CMSMGeneric
@@ -88,6 +102,147 @@ cmsm_generic_from_mdmac(const MDMac* restrict mac,
                         const uint32_t* restrict nznum_per_col,
                         uint64_t nznum);
 
+/* usage: create and initialize a CMSMGeneric from the selected rows and
+ *      columns of a multi-degree Macaulay matrix
+ * params:
+ *      1) mac: ptr to struct MDMac
+ *      2) ridxs: indices of the rows to include, e.g. selected with
+ *          mdmac_select_rows
+ *      3) nrow: size of ridxs
+ *      4) it: ptr to struct MDMacColIterator. An iterator that
+ *          returns indices of columns that should be included
+ *      5) nznum_per_col: a uint32_t array that stores the non-zero entries of
+ *          each column of mac in the given rows
+ *      6) nznum: number of non-zero entries in the selected rows and columns
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_mdmac_rows(const MDMac* restrict mac,
+                             const uint64_t* restrict ridxs, uint64_t nrow,
+                             MDMacColIterator* restrict it,
+                             const uint32_t* restrict nznum_per_col,
+                             uint64_t nznum);
+
+/* usage: create and initialize a CMSMGeneric from a multi-degree Macaulay
+ *      matrix as cmsm_generic_from_mdmac_rows, or cmsm_generic_from_mdmac if
+ *      ridxs is NULL, and record where each of its entries comes from in the
+ *      base KS system. The matrix can then serve as the sparsity pattern for
+ *      other instances of the same parameters, see cmsm_generic_refill
+ * params:
+ *      1) mac: ptr to struct MDMac
+ *      2) ks: ptr to struct GFM, the base KS system mac is computed from
+ *      3) ridxs: indices of the rows to include, or NULL
+ *      4) nrow: number of rows to include
+ *      5) row_seed: seed to randomly select the rows if ridxs is NULL
+ *      6) it: ptr to struct MDMacColIterator. An iterator that
+ *          returns indices of columns that should be included
+ *      7) nznum_per_col: a uint32_t array that stores the non-zero entries of
+ *          each column of mac in the selected rows
+ *      8) nznum: number of non-zero entries in the selected rows and columns
+ *      9) koff: a uint32_t array of size nznum. Container for the positions of
+ *          the entries in the memory block of ks, in the order they are stored
+ *          column by column
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_mdmac_src(const MDMac* restrict mac, const GFM* restrict ks,
+                            const uint64_t* restrict ridxs, uint64_t nrow,
+                            int32_t row_seed, MDMacColIterator* restrict it,
+                            const uint32_t* restrict nznum_per_col,
+                            uint64_t nznum, uint32_t* restrict koff);
+
+/* usage: refill a CMSMGeneric with the coefficients of a base KS system. The
+ *      sparsity pattern is taken from a matrix created with
+ *      cmsm_generic_from_mdmac_src from a KS system of the same parameters,
+ *      and entries that are zero in the new KS system are dropped
+ * params:
+ *      1) m: ptr to struct CMSMGeneric, the container to refill. Must have
+ *          been copied from pat, e.g. with cmsm_generic_append_cols(pat, pat,
+ *          NULL, 0), or refilled from it before
+ *      2) pat: ptr to struct CMSMGeneric, the sparsity pattern
+ *      3) koff: positions of the entries of pat in the base KS system, as
+ *          returned by cmsm_generic_from_mdmac_src
+ *      4) ks: ptr to struct GFM, the new base KS system
+ * return: void */
+void
+cmsm_generic_refill(CMSMGeneric* restrict m, const CMSMGeneric* restrict pat,
+                    const uint32_t* restrict koff, const GFM* restrict ks);
+
+/* usage: given the number of columns of a multi-degree Macaulay matrix,
+ *      compute the size of the counters cmsm_generic_split_mdmac needs on top
+ *      of the matrices it creates
+ * params:
+ *      1) ncol: number of columns of the multi-degree Macaulay matrix
+ *      2) tnum: number of threads to use
+ * return: size in bytes */
+size_t
+cmsm_generic_split_calc_mem_size(uint64_t ncol, uint32_t tnum);
+
+/* usage: create and initialize both the matrix to eliminate and the matrix of
+ *      the columns to keep from the given rows of a multi-degree Macaulay
+ *      matrix, in a single parallel pass over the rows. The columns of both
+ *      matrices are in the same order as in the multi-degree Macaulay
+ *      matrix, so the index of a column in either of them is its rank in
+ *      kcols. Each thread counts
+ *      the entries of each column in its range of rows, and then writes them
+ *      after those of the previous threads, so the result is the same as
+ *      cmsm_generic_from_mdmac_rows for any number of threads. Since the
+ *      counters of a thread span all the columns, only as many threads as
+ *      cmsm_generic_split_calc_mem_size allows for take part. If ks is not
+ *      NULL, also record where each of the entries comes from in the base KS
+ *      system as cmsm_generic_from_mdmac_src
+ * params:
+ *      1) elim: container for the ptr to the matrix to eliminate
+ *      2) kept: container for the ptr to the matrix of the columns to keep
+ *      3) mac: ptr to struct MDMac
+ *      4) ridxs: indices of the rows to include
+ *      5) nrow: size of ridxs
+ *      6) kcols: ptr to the struct BitmapRank of a Bitmap where the columns
+ *          to keep are set
+ *      7) ks: ptr to struct GFM, the base KS system mac is computed from, or
+ *          NULL
+ *      8) koff: container for the positions of the entries of the matrix to
+ *          eliminate in the memory block of ks. Only used if ks is not NULL.
+ *          The array is allocated and must be freed by the caller
+ *      9) koff_kept: same as koff for the matrix of the columns to keep
+ *      10) tnum: number of threads to use
+ *      11) tp: ptr to a struct Threadpool
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_split_mdmac(CMSMGeneric** restrict elim,
+                         CMSMGeneric** restrict kept,
+                         const MDMac* restrict mac,
+                         const uint64_t* restrict ridxs, uint64_t nrow,
+                         const BitmapRank* restrict kcols,
+                         const GFM* restrict ks, uint32_t** restrict koff,
+                         uint32_t** restrict koff_kept, uint32_t tnum,
+                         Threadpool* restrict tp);
+
+/* usage: the counterpart of cmsm_generic_split_mdmac with the matrix to
+ *      eliminate on disk. It's never held in memory as a whole: once the
+ *      sizes of the columns are known, its blocks are written one at a time,
+ *      each with a pass over the rows that only writes the entries of the
+ *      block. The matrix of the columns to keep is created in memory
+ * params:
+ *      1) elim: container for the ptr to the matrix to eliminate
+ *      2) kept: container for the ptr to the matrix of the columns to keep
+ *      3) mac: ptr to struct MDMac
+ *      4) ridxs: indices of the rows to include
+ *      5) nrow: size of ridxs
+ *      6) kcols: ptr to the struct BitmapRank of a Bitmap where the columns
+ *          to keep are set
+ *      7) dir: directory to create the file of the matrix to eliminate in
+ *      8) blk_mem: max size of a block of the matrix to eliminate in bytes
+ *      9) tnum: number of threads to use
+ *      10) tp: ptr to a struct Threadpool
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_split_mdmac_ooc(CMSMOOC** restrict elim,
+                             CMSMGeneric** restrict kept,
+                             const MDMac* restrict mac,
+                             const uint64_t* restrict ridxs, uint64_t nrow,
+                             const BitmapRank* restrict kcols,
+                             const char* restrict dir, uint64_t blk_mem,
+                             uint32_t tnum, Threadpool* restrict tp);
+
 /* usage: create and initialize a CMSMGeneric from a full matrix
  * params:
  *      1) a: a gf_t array that stores the matrix
@@ -97,6 +252,94 @@ cmsm_generic_from_mdmac(const MDMac* restrict mac,
 CMSMGeneric*
 cmsm_generic_from_gf_arr(const gf_t* a, uint64_t rnum, uint64_t cnum);
 
+/* usage: create a CMSMGeneric which consists of all the columns of a
+ *      followed by the selected columns of b
+ * params:
+ *      1) a: ptr to struct CMSMGeneric
+ *      2) b: ptr to struct CMSMGeneric with the same number of rows as a
+ *      3) cidxs: indices of the columns of b to append
+ *      4) n: number of columns to append
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_append_cols(const CMSMGeneric* restrict a,
+                         const CMSMGeneric* restrict b,
+                         const uint64_t* restrict cidxs, uint64_t n);
+
+/* usage: create and initialize a CMSMGeneric from a matrix stored in the
+ *      compressed sparse row (CSR) format
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) rptr: an array of rnum + 1 uint64_t. The entries of the i-th row are
+ *              stored from rptr[i] to rptr[i+1] - 1
+ *      4) cidxs: column indices of the entries. Must be sorted within a row
+ *      5) vals: values of the entries
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_from_csr(uint64_t rnum, uint64_t cnum,
+                      const uint64_t* restrict rptr,
+                      const gfa_idx_t* restrict cidxs,
+                      const gf_t* restrict vals);
+
+/* usage: create a random sparse matrix with a fixed expected number of
+ *      non-zero entries in each column. Entries are drawn with rand()
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) col_wt: expected number of non-zero entries in a column
+ * return: ptr to struct CMSMGeneric on success, NULL otherwise */
+CMSMGeneric*
+cmsm_generic_rand(uint64_t rnum, uint64_t cnum, uint32_t col_wt);
+
+/* usage: convert a struct CMSMGeneric into the compressed sparse row (CSR)
+ *      format. See cmsm_generic_from_csr for the format.
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) rptr: an array of rnum + 1 uint64_t
+ *      3) cidxs: an array of nznum gfa_idx_t for the column indices
+ *      4) vals: an array of nznum gf_t for the values
+ * return: void */
+void
+cmsm_generic_to_csr(const CMSMGeneric* restrict m, uint64_t* restrict rptr,
+                    gfa_idx_t* restrict cidxs, gf_t* restrict vals);
+
+/* usage: write a struct CMSMGeneric to a file in the binary format below,
+ *      where each field is in the byte order of the host and each array is
+ *      padded to a multiple of 8 bytes:
+ *
+ *          3 x 8           rnum, cnum, nznum
+ *          8 x cnum        number of entries in each column
+ *          nznum x sizeof(gfa_idx_t)
+ *                          row indices of the entries, column after column
+ *          nznum x sizeof(gf_t)
+ *                          values of the entries, in the same order
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ *      2) f: the file to write to
+ * return: true on success, false otherwise */
+bool
+cmsm_generic_write(const CMSMGeneric* restrict m, FILE* restrict f);
+
+/* usage: create and initialize a CMSMGeneric from a buffer holding a matrix
+ *      written by cmsm_generic_write
+ * params:
+ *      1) buf: the buffer, aligned to 8 bytes
+ *      2) size: size of the buffer in bytes
+ *      3) used: ptr to a size_t. Container for the number of bytes the matrix
+ *          takes in the buffer
+ * return: ptr to struct CMSMGeneric on success, NULL if memory allocation
+ *      failed or the buffer doesn't hold a valid matrix */
+CMSMGeneric*
+cmsm_generic_from_buf(const void* restrict buf, size_t size,
+                      size_t* restrict used);
+
+/* usage: given a struct CMSMGeneric, return its number of non-zero entries
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ * return: number of non-zero entries */
+uint64_t
+cmsm_generic_nznum(const CMSMGeneric* m);
+
 /* usage: given a struct CMSMGeneric, release it
  * params:
  *      1) m: ptr to struct CMSMGeneric
@@ -184,6 +427,89 @@ cmsm_gf16_tr_mul_rm_parallel(RMGF16* restrict res,
                              RMGF16PArg* restrict args,
                              Threadpool* restrict tp);
 
+/* usage: given a struct CMSMGeneric m, check if all its entries are in GF(2),
+ *      i.e. if all the non-zero entries are 1
+ * params:
+ *      1) m: ptr to struct CMSMGeneric
+ * return: true if so, false otherwise */
+bool
+cmsm_generic_is_gf2(const CMSMGeneric* m);
+
+/* usage: given a struct CMSMGeneric m whose entries are in GF(2) and a struct
+ *      R64MGF2 v, compute m * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF2 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF2
+ *      4) tnum : number of threads to use
+ *      5) partials: an array of length tnum of ptr to struct R64MGF2.
+ *          Each R64MGF2 must have the same dimension as res. This array is used
+ *          to hold partial results during computation and will be modified.
+ *      6) args: ptr to an array of struct R64MGF2PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      7) tp: ptr to a struct Threadpool
+ *      8) lock: ptr to pthread_mutex_t. Used for sync and must be initialized.
+ * return: void */
+void
+cmsm_gf2_mul_parallel(R64MGF2* restrict res, const CMSMGeneric* restrict m,
+                      const R64MGF2* restrict v, uint32_t tnum,
+                      R64MGF2** restrict partials, R64MGF2PArg* restrict args,
+                      Threadpool* restrict tp, pthread_mutex_t* restrict lock);
+
+/* usage: given a struct CMSMGeneric m whose entries are in GF(2) and a struct
+ *      R64MGF2 v, compute m^t * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF2 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF2
+ *      4) tnum : number of threads to use
+ *      5) args: ptr to an array of struct R64MGF2PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      6) tp: ptr to a struct Threadpool
+ * return: void */
+void
+cmsm_gf2_tr_mul_parallel(R64MGF2* restrict res, const CMSMGeneric* restrict m,
+                         const R64MGF2* restrict v, uint32_t tnum,
+                         R64MGF2PArg* restrict args, Threadpool* restrict tp);
+
+/* usage: given a struct CMSMGeneric m over GF(31) and a struct R64MGF31 v,
+ *      compute m * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF31 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF31
+ *      4) tnum : number of threads to use
+ *      5) partials: an array of length tnum of ptr to struct R64MGF31.
+ *          Each R64MGF31 must have the same dimension as res. This array is
+ *          used to hold partial results during computation and will be
+ *          modified.
+ *      6) args: ptr to an array of struct R64MGF31PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      7) tp: ptr to a struct Threadpool
+ *      8) lock: ptr to pthread_mutex_t. Used for sync and must be initialized.
+ * return: void */
+void
+cmsm_gf31_mul_parallel(R64MGF31* restrict res, const CMSMGeneric* restrict m,
+                       const R64MGF31* restrict v, uint32_t tnum,
+                       R64MGF31** restrict partials, R64MGF31PArg* restrict args,
+                       Threadpool* restrict tp, pthread_mutex_t* restrict lock);
+
+/* usage: given a struct CMSMGeneric m over GF(31) and a struct R64MGF31 v,
+ *      compute m^t * v in parallel
+ * params:
+ *      1) res: ptr to struct R64MGF31 for storing the result
+ *      2) m: ptr to struct CMSMGeneric
+ *      3) v: ptr to struct R64MGF31
+ *      4) tnum : number of threads to use
+ *      5) args: ptr to an array of struct R64MGF31PArg. Must
+ *          have size at least as large as the number of threads to use
+ *      6) tp: ptr to a struct Threadpool
+ * return: void */
+void
+cmsm_gf31_tr_mul_parallel(R64MGF31* restrict res, const CMSMGeneric* restrict m,
+                          const R64MGF31* restrict v, uint32_t tnum,
+                          R64MGF31PArg* restrict args, Threadpool* restrict tp);
+
 /* usage: given a CMSMGeneric m, print its enties
  * params:
  *      1) m: ptr to struct CMSMGeneric
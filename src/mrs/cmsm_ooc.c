@@ -0,0 +1,525 @@
+#include "cmsm_ooc.h"
+#include "gfa.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ========================================================================
+ * struct CMSMOOC definition
+ * ======================================================================== */
+
+// a buffer that holds no block
+#define CMSM_OOC_FREE       (UINT32_MAX)
+
+// arguments of a thread for a block
+typedef struct {
+    RMGF16* restrict av;
+    RMGF16* restrict mtv;
+    RMGF16* restrict partial;
+    const RMGF16* restrict v;
+    const GFA* restrict cols; // the columns of the block
+    uint64_t cbeg; // index of the first column of the block
+    uint64_t sidx; // columns of the block to process, relative to cbeg
+    uint64_t eidx;
+    pthread_mutex_t* lock; // for adding partial to av
+    bool first; // whether it's the first block of the product
+    bool last; // or the last one
+} CMSMOOCJob;
+
+struct CMSMOOC { // out-of-core column-major sparse matrix
+    uint64_t rnum; // number of rows
+    uint64_t cnum; // number of columns
+    uint64_t nznum; // number of non-zero entries
+    uint64_t max_tnum; // max number of non-zero entries in a column
+    uint32_t blk_num; // number of blocks
+    uint32_t tnum; // number of threads that compute the products
+    uint64_t* cbeg; // the i-th block holds columns cbeg[i] ~ cbeg[i+1] - 1
+    uint64_t* ebeg; // and entries ebeg[i] ~ ebeg[i+1] - 1 of the file
+    GFA** cols; // the columns of each block, in the buffer that holds it
+    gfa_idx_t* buf[2]; // the i-th block is always loaded into buf[i & 1]
+    uint64_t buf_sz; // size of each buffer in gfa_idx_t
+    CMSMOOCJob* jobs;
+    pthread_mutex_t av_lock; // for adding the partial results
+    // the reader thread, only if there are more blocks than buffers
+    int fd;
+    bool streamed;
+    bool quit; // whether the reader thread should exit
+    bool err; // whether the reader thread failed
+    uint32_t loaded[2]; // the block held by each buffer, or CMSM_OOC_FREE
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t reader;
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: given a struct CMSMOOC, return its number of rows
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of rows */
+uint64_t
+cmsm_ooc_rnum(const CMSMOOC* m) {
+    return m->rnum;
+}
+
+/* usage: given a struct CMSMOOC, return its number of columns
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of columns */
+uint64_t
+cmsm_ooc_cnum(const CMSMOOC* m) {
+    return m->cnum;
+}
+
+/* usage: given a struct CMSMOOC, return its number of non-zero entries
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of non-zero entries */
+uint64_t
+cmsm_ooc_nznum(const CMSMOOC* m) {
+    return m->nznum;
+}
+
+/* usage: given a struct CMSMOOC, return the max number of non-zero entries
+ *      in a column
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: max number of non-zero entries in a column */
+uint64_t
+cmsm_ooc_max_tnum(const CMSMOOC* m) {
+    return m->max_tnum;
+}
+
+/* usage: given a struct CMSMOOC, return the avg number of non-zero entries
+ *      in a column
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: avg number of non-zero entries in a column */
+uint64_t
+cmsm_ooc_avg_tnum(const CMSMOOC* m) {
+    return m->cnum ? m->nznum / m->cnum : 0;
+}
+
+/* usage: given a struct CMSMOOC, return its number of blocks
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of blocks */
+uint32_t
+cmsm_ooc_blk_num(const CMSMOOC* m) {
+    return m->blk_num;
+}
+
+/* usage: given a struct CMSMOOC, return the size of the buffers it holds in
+ *      memory, i.e. twice the size of its largest block
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: size in bytes */
+size_t
+cmsm_ooc_mem_size(const CMSMOOC* m) {
+    return (m->blk_num < 2 ? m->blk_num : 2) * m->buf_sz * sizeof(gfa_idx_t);
+}
+
+/* usage: given the number of columns and of non-zero entries of a matrix,
+ *      compute the memory a struct CMSMOOC holding it needs: the two buffers
+ *      and the columns of all the blocks. A column larger than a block is not
+ *      accounted for
+ * params:
+ *      1) cnum: number of columns
+ *      2) nznum: number of non-zero entries
+ *      3) blk_mem: max size of a block in bytes
+ * return: size in bytes */
+size_t
+cmsm_ooc_calc_mem_size(uint64_t cnum, uint64_t nznum, uint64_t blk_mem) {
+    uint64_t buf_sz = sizeof(gfa_idx_t) * nznum;
+    if(buf_sz > blk_mem) // or the matrix is in a single block
+        buf_sz = blk_mem;
+    return sizeof(CMSMOOC) + 2 * buf_sz + gfa_memsize() * cnum;
+}
+
+/* subroutine of cmsm_ooc_create: split the columns of the given sizes into
+ *      blocks of at most cap entries, or of a single column. The first column
+ *      of each block is stored into cbeg if it's not NULL. Return the number
+ *      of blocks */
+static uint32_t
+cmsm_ooc_split(uint64_t* restrict cbeg, const uint32_t* restrict sizes,
+               uint64_t cnum, uint64_t cap) {
+    uint32_t n = 0;
+    uint64_t sz = 0;
+    for(uint64_t ci = 0; ci < cnum; ++ci) {
+        const uint64_t csz = sizes[ci];
+        if(!ci || sz + csz > cap) {
+            if(cbeg)
+                cbeg[n] = ci;
+            ++n;
+            sz = 0;
+        }
+        sz += csz;
+    }
+    return n;
+}
+
+/* subroutine of cmsm_ooc_create: return the size of the given column of a
+ *      block, without initializing it */
+static gfa_idx_t
+cmsm_ooc_col_sz(uint64_t col_idx, GFA* e, void* __arg) {
+    (void) e;
+    const uint32_t* sizes = (const uint32_t*) __arg;
+    return sizes[col_idx];
+}
+
+/* subroutine of cmsm_ooc_create and cmsm_ooc_reader: read or write n bytes
+ *      at the given offset of the file, resuming after short transfers.
+ *      Return true on success, false otherwise */
+static bool
+cmsm_ooc_rw(int fd, void* buf, size_t n, off_t off, bool wr) {
+    uint8_t* p = buf;
+    while(n) {
+        const ssize_t rv = wr ? pwrite(fd, p, n, off) : pread(fd, p, n, off);
+        if(rv < 0 && errno == EINTR)
+            continue;
+        if(rv <= 0)
+            return false;
+        p += rv;
+        off += rv;
+        n -= rv;
+    }
+    return true;
+}
+
+/* subroutine of cmsm_ooc_create: the reader thread. It loads the blocks one
+ *      after another into their buffers, cycling through the matrix, as soon
+ *      as the buffer of the next block is released */
+static void*
+cmsm_ooc_reader(void* __arg) {
+    CMSMOOC* m = (CMSMOOC*) __arg;
+    uint32_t bi = 0;
+    pthread_mutex_lock(&m->lock);
+    while(true) {
+        const uint32_t slot = bi & 0x1U;
+        while(!m->quit && m->loaded[slot] != CMSM_OOC_FREE)
+            pthread_cond_wait(&m->cond, &m->lock);
+        if(m->quit)
+            break;
+        pthread_mutex_unlock(&m->lock);
+
+        const uint64_t n = m->ebeg[bi+1] - m->ebeg[bi];
+        const bool ok = cmsm_ooc_rw(m->fd, m->buf[slot], n * sizeof(gfa_idx_t),
+                                    m->ebeg[bi] * sizeof(gfa_idx_t), false);
+
+        pthread_mutex_lock(&m->lock);
+        if(!ok) {
+            m->err = true;
+            pthread_cond_broadcast(&m->cond);
+            break;
+        }
+        m->loaded[slot] = bi;
+        pthread_cond_broadcast(&m->cond);
+        if(++bi == m->blk_num)
+            bi = 0;
+    }
+    pthread_mutex_unlock(&m->lock);
+    return NULL;
+}
+
+/* usage: create a CMSMOOC from the sizes of its columns. The columns are
+ *      filled one block at a time by a function, and each block is written
+ *      into a file in the given directory as soon as it's filled, so only two
+ *      blocks are held in memory at once. The file is removed as soon as it's
+ *      opened, so nothing is left behind on exit. If the matrix fits in the
+ *      two buffers, it's kept in memory and no file is created
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) sizes: number of non-zero entries of each column
+ *      4) dir: directory to create the file in
+ *      5) blk_mem: max size of a block in bytes. A column larger than that
+ *          forms a block of its own
+ *      6) tnum: number of threads that compute the products
+ *      7) fill: the function that fills the columns of a block
+ *      8) arg: a generic pointer passed to fill
+ * return: ptr to struct CMSMOOC on success, NULL otherwise */
+CMSMOOC*
+cmsm_ooc_create(uint64_t rnum, uint64_t cnum, const uint32_t* restrict sizes,
+                const char* restrict dir, uint64_t blk_mem, uint32_t tnum,
+                CMSMOOCFillFn fill, void* restrict arg) {
+    uint64_t cap = blk_mem / sizeof(gfa_idx_t);
+    if(!cap)
+        cap = 1;
+    CMSMOOC* o = calloc(1, sizeof(CMSMOOC));
+    if(!o)
+        return NULL;
+    o->fd = -1;
+    o->rnum = rnum;
+    o->cnum = cnum;
+    o->tnum = tnum;
+    o->loaded[0] = o->loaded[1] = CMSM_OOC_FREE;
+    if(pthread_mutex_init(&o->av_lock, NULL)) {
+        free(o);
+        return NULL;
+    }
+
+    // with an odd number of blocks, the last block and the first one would
+    // take turns on the same buffer, so an empty block is added at the end
+    uint32_t n = cmsm_ooc_split(NULL, sizes, cnum, cap);
+    o->streamed = n > 2;
+    o->blk_num = n + (o->streamed && (n & 0x1U));
+    if( !(o->cbeg = malloc(sizeof(uint64_t) * (o->blk_num + 1))) ||
+        !(o->ebeg = malloc(sizeof(uint64_t) * (o->blk_num + 1))) ||
+        !(o->cols = calloc(o->blk_num, sizeof(GFA*))) ||
+        !(o->jobs = malloc(sizeof(CMSMOOCJob) * tnum)) )
+        goto cmsm_ooc_create_fail;
+    cmsm_ooc_split(o->cbeg, sizes, cnum, cap);
+    for(uint32_t i = n; i <= o->blk_num; ++i)
+        o->cbeg[i] = o->cnum;
+    o->ebeg[0] = 0;
+    for(uint32_t i = 0; i < o->blk_num; ++i) {
+        uint64_t sz = 0;
+        for(uint64_t ci = o->cbeg[i]; ci < o->cbeg[i+1]; ++ci) {
+            sz += sizes[ci];
+            if(sizes[ci] > o->max_tnum)
+                o->max_tnum = sizes[ci];
+        }
+        o->ebeg[i+1] = o->ebeg[i] + sz;
+        if(sz > o->buf_sz)
+            o->buf_sz = sz;
+    }
+    o->nznum = o->ebeg[o->blk_num];
+    for(uint32_t i = 0; i < 2 && i < o->blk_num; ++i) {
+        if( !(o->buf[i] = malloc(sizeof(gfa_idx_t) * (o->buf_sz ? o->buf_sz : 1))) )
+            goto cmsm_ooc_create_fail;
+    }
+
+    if(o->streamed) {
+        const char* name = "/mrs-ooc-XXXXXX";
+        char* path = malloc(strlen(dir) + strlen(name) + 1);
+        if(!path)
+            goto cmsm_ooc_create_fail;
+        strcpy(path, dir);
+        strcat(path, name);
+        o->fd = mkstemp(path);
+        if(o->fd >= 0)
+            unlink(path);
+        free(path);
+        if(o->fd < 0)
+            goto cmsm_ooc_create_fail;
+    }
+
+    // the columns of each block point into the buffer that holds it. Filling
+    // them writes the block into the buffer, which is then written out
+    for(uint32_t i = 0; i < o->blk_num; ++i) {
+        o->cols[i] = gfa_arr_create_f(o->cbeg[i+1] - o->cbeg[i], o->buf[i & 0x1U],
+                                      (void*) (sizes + o->cbeg[i]),
+                                      cmsm_ooc_col_sz);
+        if(!o->cols[i])
+            goto cmsm_ooc_create_fail;
+        if(o->cbeg[i] < o->cbeg[i+1] &&
+           !fill(o->cols[i], o->cbeg[i], o->cbeg[i+1], arg))
+            goto cmsm_ooc_create_fail;
+        if(o->streamed &&
+           !cmsm_ooc_rw(o->fd, o->buf[i & 0x1U],
+                        (o->ebeg[i+1] - o->ebeg[i]) * sizeof(gfa_idx_t),
+                        o->ebeg[i] * sizeof(gfa_idx_t), true))
+            goto cmsm_ooc_create_fail;
+    }
+
+    if(o->streamed) {
+        if(pthread_mutex_init(&o->lock, NULL))
+            goto cmsm_ooc_create_fail;
+        if(pthread_cond_init(&o->cond, NULL)) {
+            pthread_mutex_destroy(&o->lock);
+            goto cmsm_ooc_create_fail;
+        }
+        if(pthread_create(&o->reader, NULL, cmsm_ooc_reader, o)) {
+            pthread_cond_destroy(&o->cond);
+            pthread_mutex_destroy(&o->lock);
+            goto cmsm_ooc_create_fail;
+        }
+    }
+    return o;
+
+cmsm_ooc_create_fail:
+    // the reader thread is not started yet
+    o->streamed = false;
+    cmsm_ooc_free(o);
+    return NULL;
+}
+
+/* usage: Release a struct CMSMOOC and remove its file
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: void */
+void
+cmsm_ooc_free(CMSMOOC* m) {
+    if(!m)
+        return;
+    if(m->streamed) {
+        pthread_mutex_lock(&m->lock);
+        m->quit = true;
+        pthread_cond_broadcast(&m->cond);
+        pthread_mutex_unlock(&m->lock);
+        pthread_join(m->reader, NULL);
+        pthread_cond_destroy(&m->cond);
+        pthread_mutex_destroy(&m->lock);
+    }
+    if(m->fd >= 0)
+        close(m->fd);
+    if(m->cols) {
+        for(uint32_t i = 0; i < m->blk_num; ++i)
+            gfa_arr_free(m->cols[i]);
+    }
+    pthread_mutex_destroy(&m->av_lock);
+    free(m->buf[0]);
+    free(m->buf[1]);
+    free(m->jobs);
+    free(m->cols);
+    free(m->ebeg);
+    free(m->cbeg);
+    free(m);
+}
+
+/* subroutine of cmsm_ooc_gf16_sym_mul_rm_parallel: wait until the given
+ *      block is loaded. Return false if reading it failed */
+static inline bool
+cmsm_ooc_acquire(CMSMOOC* m, uint32_t bi) {
+    if(!m->streamed)
+        return true;
+    pthread_mutex_lock(&m->lock);
+    while(!m->err && m->loaded[bi & 0x1U] != bi)
+        pthread_cond_wait(&m->cond, &m->lock);
+    const bool ok = !m->err;
+    pthread_mutex_unlock(&m->lock);
+    return ok;
+}
+
+/* subroutine of cmsm_ooc_gf16_sym_mul_rm_parallel: release the buffer of the
+ *      given block, so that the reader thread can load the next block into it
+ */
+static inline void
+cmsm_ooc_release(CMSMOOC* m, uint32_t bi) {
+    if(!m->streamed)
+        return;
+    pthread_mutex_lock(&m->lock);
+    m->loaded[bi & 0x1U] = CMSM_OOC_FREE;
+    pthread_cond_broadcast(&m->cond);
+    pthread_mutex_unlock(&m->lock);
+}
+
+static void
+cmsm_ooc_gf16_sym_mul_worker(void* __arg) {
+    CMSMOOCJob* job = (CMSMOOCJob*) __arg;
+    RMGF16* v = (RMGF16*) job->v;
+    RMGF16* partial = job->partial;
+    assert(job->eidx >= job->sidx);
+
+    if(job->first)
+        rm_gf16_zero(partial);
+    uint64_t i = job->sidx;
+    RowGF16* dst = rm_gf16_raddr(job->mtv, job->cbeg + i);
+    for(; i < job->eidx; ++i, ++dst) {
+        const GFA* col = gfa_arr_at(job->cols, i);
+        const uint64_t head = gfa_size(col) & ~0x1ULL;
+        // the row of m^t * v is a linear combination of rows of v
+        uint64_t j = 0;
+        for(; j < head; j += 2) {
+            gfa_idx_t r0; gf_t c0 = gfa_at(col, j, &r0);
+            gfa_idx_t r1; gf_t c1 = gfa_at(col, j + 1, &r1);
+#if BLK_LANCZOS_BLOCK_SIZE == 64
+            Grp64GF16* src0 = rm_gf16_raddr(v, r0);
+            Grp64GF16* src1 = rm_gf16_raddr(v, r1);
+            grp64_gf16_fmaddi_scalar_1x2(dst, src0, src1, c0, c1);
+#else
+            row_gf16_fmaddi_scalar(dst, rm_gf16_raddr(v, r0), c0);
+            row_gf16_fmaddi_scalar(dst, rm_gf16_raddr(v, r1), c1);
+#endif
+        }
+        if(j < gfa_size(col)) {
+            gfa_idx_t ridx; gf_t c = gfa_at(col, j, &ridx);
+            row_gf16_fmaddi_scalar(dst, rm_gf16_raddr(v, ridx), c);
+        }
+
+        // and it's complete, so its product with the column is added to the
+        // rows of m * (m^t * v) while the column is still in cache
+        for(j = 0; j < head; j += 2) {
+            gfa_idx_t r0; gf_t c0 = gfa_at(col, j, &r0);
+            gfa_idx_t r1; gf_t c1 = gfa_at(col, j + 1, &r1);
+#if BLK_LANCZOS_BLOCK_SIZE == 64
+            Grp64GF16* dst0 = rm_gf16_raddr(partial, r0);
+            Grp64GF16* dst1 = rm_gf16_raddr(partial, r1);
+            grp64_gf16_fmaddi_scalar_2x1(dst0, dst1, dst, c0, c1);
+#else
+            row_gf16_fmaddi_scalar(rm_gf16_raddr(partial, r0), dst, c0);
+            row_gf16_fmaddi_scalar(rm_gf16_raddr(partial, r1), dst, c1);
+#endif
+        }
+        if(j < gfa_size(col)) {
+            gfa_idx_t ridx; gf_t c = gfa_at(col, j, &ridx);
+            row_gf16_fmaddi_scalar(rm_gf16_raddr(partial, ridx), dst, c);
+        }
+    }
+
+    if(job->last) {
+        pthread_mutex_lock(job->lock);
+        rm_gf16_addi(job->av, partial);
+        pthread_mutex_unlock(job->lock);
+    }
+}
+
+/* usage: given a struct CMSMOOC m and a struct RMGF16 v, compute m^t * v and
+ *      then m * (m^t * v) in parallel, with a single pass over m
+ * params:
+ *      1) av: ptr to struct RMGF16 for storing m * (m^t * v)
+ *      2) mtv: ptr to struct RMGF16 for storing m^t * v
+ *      3) m: ptr to struct CMSMOOC
+ *      4) v: ptr to struct RMGF16
+ *      5) partials: an array of ptr to struct RMGF16, one for each of the
+ *          threads given to cmsm_ooc_create. Each RMGF16 must have the same
+ *          dimension as av. This array is used to hold partial results during
+ *          computation and will be modified.
+ *      6) tp: ptr to a struct Threadpool
+ * return: true on success, false if reading the matrix failed */
+bool
+cmsm_ooc_gf16_sym_mul_rm_parallel(RMGF16* restrict av, RMGF16* restrict mtv,
+                                  CMSMOOC* restrict m, const RMGF16* restrict v,
+                                  RMGF16** restrict partials,
+                                  Threadpool* restrict tp) {
+    assert(rm_gf16_rnum(av) == m->rnum);
+    assert(rm_gf16_rnum(mtv) == m->cnum);
+    assert(rm_gf16_rnum(v) == m->rnum);
+    const uint32_t tnum = m->tnum;
+    rm_gf16_zero(mtv);
+    rm_gf16_zero(av);
+    for(uint32_t bi = 0; bi < m->blk_num; ++bi) {
+        if(!cmsm_ooc_acquire(m, bi))
+            return false;
+        const uint64_t ncol = m->cbeg[bi+1] - m->cbeg[bi];
+        const uint64_t strip_sz = ncol / tnum;
+        uint64_t sidx = 0;
+        for(uint32_t i = 0; i < tnum; ++i) {
+            CMSMOOCJob* job = m->jobs + i;
+            job->av = av;
+            job->mtv = mtv;
+            job->partial = partials[i];
+            job->v = v;
+            job->cols = m->cols[bi];
+            job->cbeg = m->cbeg[bi];
+            job->lock = &m->av_lock;
+            job->first = !bi;
+            job->last = bi == m->blk_num - 1;
+            job->sidx = sidx;
+            sidx += strip_sz;
+            job->eidx = (i == tnum - 1) ? ncol : sidx;
+            thpool_add_job(tp, cmsm_ooc_gf16_sym_mul_worker, job);
+        }
+        thpool_wait_jobs(tp);
+        cmsm_ooc_release(m, bi);
+    }
+
+    return true;
+}
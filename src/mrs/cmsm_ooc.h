@@ -0,0 +1,143 @@
+#ifndef __CMSM_OOC_H__
+#define __CMSM_OOC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "gfa.h"
+#include "matrix_gf16.h"
+#include "thpool.h"
+
+// Out-of-core counterpart of CMSMGeneric for the matrix to eliminate. The
+// entries are stored in a file in blocks of consecutive columns, and only two
+// blocks are held in memory at once. A reader thread loads the next block
+// while the current one is processed, in the same order in every product, so
+// the reads always run one block ahead of the computation. The products of
+// Block Lanczos m^t * v and m * (m^t * v) are computed in the same pass over
+// a block, so the matrix is read once per iteration.
+
+typedef struct CMSMOOC CMSMOOC;
+
+// fills the columns cbeg ~ cend - 1 of a CMSMOOC being created, whose
+// containers are given in cols with their sizes set. Returns false on error
+typedef bool (*CMSMOOCFillFn)(GFA* restrict cols, uint64_t cbeg, uint64_t cend,
+                              void* restrict arg);
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: create a CMSMOOC from the sizes of its columns. The columns are
+ *      filled one block at a time by a function, and each block is written
+ *      into a file in the given directory as soon as it's filled, so only two
+ *      blocks are held in memory at once. The file is removed as soon as it's
+ *      opened, so nothing is left behind on exit. If the matrix fits in the
+ *      two buffers, it's kept in memory and no file is created
+ * params:
+ *      1) rnum: number of rows
+ *      2) cnum: number of columns
+ *      3) sizes: number of non-zero entries of each column
+ *      4) dir: directory to create the file in
+ *      5) blk_mem: max size of a block in bytes. A column larger than that
+ *          forms a block of its own
+ *      6) tnum: number of threads that compute the products
+ *      7) fill: the function that fills the columns of a block
+ *      8) arg: a generic pointer passed to fill
+ * return: ptr to struct CMSMOOC on success, NULL otherwise */
+CMSMOOC*
+cmsm_ooc_create(uint64_t rnum, uint64_t cnum, const uint32_t* restrict sizes,
+                const char* restrict dir, uint64_t blk_mem, uint32_t tnum,
+                CMSMOOCFillFn fill, void* restrict arg);
+
+/* usage: Release a struct CMSMOOC and remove its file
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: void */
+void
+cmsm_ooc_free(CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return its number of rows
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of rows */
+uint64_t
+cmsm_ooc_rnum(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return its number of columns
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of columns */
+uint64_t
+cmsm_ooc_cnum(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return its number of non-zero entries
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of non-zero entries */
+uint64_t
+cmsm_ooc_nznum(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return the max number of non-zero entries
+ *      in a column
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: max number of non-zero entries in a column */
+uint64_t
+cmsm_ooc_max_tnum(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return the avg number of non-zero entries
+ *      in a column
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: avg number of non-zero entries in a column */
+uint64_t
+cmsm_ooc_avg_tnum(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return its number of blocks
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: number of blocks */
+uint32_t
+cmsm_ooc_blk_num(const CMSMOOC* m);
+
+/* usage: given a struct CMSMOOC, return the size of the buffers it holds in
+ *      memory, i.e. twice the size of its largest block
+ * params:
+ *      1) m: ptr to struct CMSMOOC
+ * return: size in bytes */
+size_t
+cmsm_ooc_mem_size(const CMSMOOC* m);
+
+/* usage: given the number of columns and of non-zero entries of a matrix,
+ *      compute the memory a struct CMSMOOC holding it needs: the two buffers
+ *      and the columns of all the blocks. A column larger than a block is not
+ *      accounted for
+ * params:
+ *      1) cnum: number of columns
+ *      2) nznum: number of non-zero entries
+ *      3) blk_mem: max size of a block in bytes
+ * return: size in bytes */
+size_t
+cmsm_ooc_calc_mem_size(uint64_t cnum, uint64_t nznum, uint64_t blk_mem);
+
+/* usage: given a struct CMSMOOC m and a struct RMGF16 v, compute m^t * v and
+ *      then m * (m^t * v) in parallel, with a single pass over m
+ * params:
+ *      1) av: ptr to struct RMGF16 for storing m * (m^t * v)
+ *      2) mtv: ptr to struct RMGF16 for storing m^t * v
+ *      3) m: ptr to struct CMSMOOC
+ *      4) v: ptr to struct RMGF16
+ *      5) partials: an array of ptr to struct RMGF16, one for each of the
+ *          threads given to cmsm_ooc_create. Each RMGF16 must have the same
+ *          dimension as av. This array is used to hold partial results during
+ *          computation and will be modified.
+ *      6) tp: ptr to a struct Threadpool
+ * return: true on success, false if reading the matrix failed */
+bool
+cmsm_ooc_gf16_sym_mul_rm_parallel(RMGF16* restrict av, RMGF16* restrict mtv,
+                                  CMSMOOC* restrict m, const RMGF16* restrict v,
+                                  RMGF16** restrict partials,
+                                  Threadpool* restrict tp);
+
+#endif // __CMSM_OOC_H__
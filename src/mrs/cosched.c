@@ -0,0 +1,264 @@
+#define _GNU_SOURCE             // for sched_getaffinity and CPU_SET
+#include "cosched.h"
+#include "planner.h"
+#include "gfm.h"
+#include "thpool.h"
+#include "math_util.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* ========================================================================
+ * struct CoSched definition
+ * ======================================================================== */
+
+typedef struct CoSched CoSched;
+
+// a solve and the cores it's given
+typedef struct {
+    CoSched* cs;
+    uint32_t idx; // index of the job
+    uint32_t* cpus; // indices of the cores, of size job->tnum
+    pthread_t th;
+} CoSlot;
+
+struct CoSched {
+    pthread_mutex_t lock;
+    pthread_cond_t job_done;
+    CoJob* jobs;
+    const MRSParams* prm;
+    uint32_t* done_q; // indices of the finished jobs not reaped yet
+    uint32_t done_len;
+};
+
+typedef struct {
+    uint64_t work;
+    uint32_t idx;
+} CoOrder;
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Predict the work and the peak memory of an instance with the cost
+ *      model of the planner
+ * params:
+ *      1) job: ptr to CoJob. Its instance is set
+ *      2) prm: ptr to MRSParams, the parameters of the solve
+ * return: true on success, false if memory allocation failed */
+bool
+cosched_predict(CoJob* restrict job, const MRSParams* restrict prm) {
+    // only the positions of the non-zero entries matter
+    GFM* ks = minrank_ks_pattern(job->mr, prm->c);
+    if(!ks)
+        return false;
+
+    const PlanCalib cal = {0}; // only the sizes are needed
+    MDPlan p;
+    planner_eval(&p, &cal, ks, job->mr, prm->degs, prm->degs_num, 1,
+                 prm->ooc_dir ? prm->ooc_blk_mem : 0);
+    gfm_free(ks);
+    job->work = p.nznum * p.iter_num;
+    job->mem = p.memsize;
+    return true;
+}
+
+/* subroutine of cosched_run: solve an instance on the cores it's given, then
+ *      queue it to be reaped */
+static void*
+cosched_worker(void* arg) {
+    CoSlot* slot = arg;
+    CoSched* cs = slot->cs;
+    CoJob* job = cs->jobs + slot->idx;
+    const double ts = get_timestamp();
+
+    // the calling thread takes part in the solve too
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(uint32_t i = 0; i < job->tnum; ++i)
+        CPU_SET(slot->cpus[i], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    MRSParams prm = *cs->prm;
+    prm.tnum = job->tnum;
+    prm.reuse = false;
+    prm.quiet = true; // the logs of concurrent solves would be interleaved
+    job->rv = -1;
+    job->sol = NULL;
+    if( (prm.tpool = thpool_create(job->tnum)) ) {
+        thpool_pin(prm.tpool, slot->cpus, job->tnum);
+        MRSolver* s = mrs_solver_create(&prm);
+        if(s) {
+            job->rv = mrs_solver_solve(s, job->mr, &job->sol);
+            mrs_solver_free(s);
+        }
+        thpool_destroy(prm.tpool, true);
+    }
+    job->sec = get_timestamp() - ts;
+
+    pthread_mutex_lock(&cs->lock);
+    cs->done_q[cs->done_len++] = slot->idx;
+    pthread_cond_signal(&cs->job_done);
+    pthread_mutex_unlock(&cs->lock);
+    return NULL;
+}
+
+/* subroutine of cosched_run: number of threads to give to a job */
+static inline uint32_t
+cosched_share(const CoJob* job, uint32_t free_cnum, uint32_t pending) {
+    uint64_t t = (job->work + COSCHED_WORK_PER_THREAD - 1) /
+                 COSCHED_WORK_PER_THREAD;
+    if(pending <= free_cnum && t < free_cnum / pending)
+        t = free_cnum / pending; // spread the cores over the tail
+    if(t > free_cnum)
+        t = free_cnum;
+    if(!t)
+        t = 1;
+    // the solver splits its work in powers of 2
+    uint64_t p = next_power_of_2(t);
+    return (p > t) ? p >> 1 : p;
+}
+
+/* subroutine of cosched_run: give the cores of a job back */
+static inline void
+cosched_release(CoSlot* restrict slot, bool* restrict busy,
+                const uint32_t* restrict cpus, uint32_t cnum, uint32_t tnum) {
+    for(uint32_t i = 0; i < tnum; ++i) {
+        for(uint32_t j = 0; j < cnum; ++j) {
+            if(cpus[j] == slot->cpus[i])
+                busy[j] = false;
+        }
+    }
+    free(slot->cpus);
+    slot->cpus = NULL;
+}
+
+static int
+cosched_order_cmp(const void* a, const void* b) {
+    const CoOrder* x = a, *y = b;
+    if(x->work != y->work)
+        return (x->work < y->work) ? 1 : -1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+/* usage: Solve the instances concurrently
+ * params:
+ *      1) jobs: an array of CoJob, whose instances and predictions are set
+ *      2) n: size of jobs
+ *      3) prm: ptr to MRSParams, the parameters of each solve. The number of
+ *          threads and the thread pool are set per solve
+ *      4) cnum: number of cores to use
+ *      5) max_mem: memory budget in bytes
+ *      6) done: callback when a solve finishes, or NULL
+ *      7) arg: first argument of the callback
+ * return: true if all the instances are attempted, false on error */
+bool
+cosched_run(CoJob* restrict jobs, uint32_t n, const MRSParams* restrict prm,
+            uint32_t cnum, uint64_t max_mem, CoSchedDoneFn done, void* arg) {
+    CoSched cs = { .jobs = jobs, .prm = prm, .done_len = 0 };
+    CoSlot* slots = calloc(n, sizeof(CoSlot));
+    CoOrder* order = malloc(sizeof(CoOrder) * n);
+    uint32_t* cpus = malloc(sizeof(uint32_t) * (cnum ? cnum : 1));
+    bool* busy = calloc(cnum ? cnum : 1, sizeof(bool));
+    cs.done_q = malloc(sizeof(uint32_t) * n);
+    bool ok = false;
+    if(!slots || !order || !cpus || !busy || !cs.done_q)
+        goto cosched_run_cleanup;
+
+    // the cores this process may run on
+    cpu_set_t avail;
+    if(sched_getaffinity(0, sizeof(avail), &avail)) {
+        CPU_ZERO(&avail);
+        for(uint32_t i = 0; i < cnum && i < CPU_SETSIZE; ++i)
+            CPU_SET(i, &avail);
+    }
+    uint32_t avail_num = 0;
+    for(uint32_t i = 0; i < CPU_SETSIZE && avail_num < cnum; ++i) {
+        if(CPU_ISSET(i, &avail))
+            cpus[avail_num++] = i;
+    }
+    if(!avail_num)
+        goto cosched_run_cleanup;
+    cnum = avail_num;
+
+    // the largest jobs first, so that the small ones fill the gaps at the end
+    for(uint32_t i = 0; i < n; ++i) {
+        order[i].work = jobs[i].work;
+        order[i].idx = i;
+    }
+    qsort(order, n, sizeof(CoOrder), cosched_order_cmp);
+
+    pthread_mutex_init(&cs.lock, NULL);
+    pthread_cond_init(&cs.job_done, NULL);
+    uint32_t next = 0, running = 0, free_cnum = cnum;
+    uint64_t mem_used = 0;
+    ok = true;
+    pthread_mutex_lock(&cs.lock);
+    while(next < n || running) {
+        // release the cores and the memory of the finished jobs
+        while(cs.done_len) {
+            const uint32_t idx = cs.done_q[--cs.done_len];
+            pthread_mutex_unlock(&cs.lock);
+            CoSlot* slot = slots + idx;
+            pthread_join(slot->th, NULL);
+            cosched_release(slot, busy, cpus, cnum, jobs[idx].tnum);
+            free_cnum += jobs[idx].tnum;
+            mem_used -= jobs[idx].mem;
+            --running;
+            if(done)
+                done(arg, idx, jobs + idx);
+            pthread_mutex_lock(&cs.lock);
+        }
+
+        // start as many jobs as the free cores and the memory allow
+        while(ok && next < n && free_cnum) {
+            const uint32_t idx = order[next].idx;
+            CoJob* job = jobs + idx;
+            if(running && mem_used + job->mem > max_mem)
+                break;
+
+            CoSlot* slot = slots + idx;
+            job->tnum = cosched_share(job, free_cnum, n - next);
+            if( !(slot->cpus = malloc(sizeof(uint32_t) * job->tnum)) ) {
+                ok = false;
+                break;
+            }
+            for(uint32_t i = 0, j = 0; i < job->tnum; ++j) {
+                if(!busy[j]) {
+                    busy[j] = true;
+                    slot->cpus[i++] = cpus[j];
+                }
+            }
+            slot->cs = &cs;
+            slot->idx = idx;
+            if(pthread_create(&slot->th, NULL, cosched_worker, slot)) {
+                cosched_release(slot, busy, cpus, cnum, job->tnum);
+                ok = false;
+                break;
+            }
+            free_cnum -= job->tnum;
+            mem_used += job->mem;
+            ++running;
+            ++next;
+        }
+
+        if(!running && (!ok || next == n))
+            break;
+        if(!cs.done_len)
+            pthread_cond_wait(&cs.job_done, &cs.lock);
+    }
+    pthread_mutex_unlock(&cs.lock);
+    pthread_cond_destroy(&cs.job_done);
+    pthread_mutex_destroy(&cs.lock);
+
+cosched_run_cleanup:
+    free(slots);
+    free(order);
+    free(cpus);
+    free(busy);
+    free(cs.done_q);
+    return ok;
+}
@@ -0,0 +1,75 @@
+#ifndef __COSCHED_H__
+#define __COSCHED_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "minrank.h"
+#include "mrs.h"
+
+// Co-scheduler for throughput: solve a queue of instances, several at once.
+// For small instances, a solve barely scales past a few threads because the
+// fork/join of each Block Lanczos iteration dominates, so the cores of the
+// node are split among concurrent solves instead. Each solve runs in its own
+// solver context, with its own thread pool pinned to a subset of the cores.
+//
+// The instances are started from the largest predicted work down. A solve is
+// given one thread per COSCHED_WORK_PER_THREAD of predicted work, within the
+// free cores. When fewer instances than free cores are left, the free cores
+// are spread over them, so the tail of the queue speeds up as solves finish.
+// The cores of a solve are fixed when it starts: the containers of the solver
+// are sized by its number of threads, so a running solve isn't given the cores
+// freed after it started, which stay idle once the queue is empty.
+// A solve is only started if its predicted peak memory fits in what's left
+// of the budget, unless nothing else is running.
+
+// predicted work per thread, in non-zero entries times Block Lanczos
+// iterations
+#define COSCHED_WORK_PER_THREAD     (0x1ULL << 26)
+
+// an instance to solve
+typedef struct {
+    const MinRank* mr;
+    uint64_t work; // predicted work, see cosched_predict
+    size_t mem; // predicted peak memory in bytes
+
+    // filled in when the solve is done
+    int32_t rv; // as returned by mrs_solver_solve
+    MRSSolution* sol; // owned by the caller
+    uint32_t tnum; // number of threads it's given
+    double sec; // wall time of the solve
+} CoJob;
+
+// called by cosched_run, from the calling thread, as each solve finishes
+typedef void (*CoSchedDoneFn)(void* arg, uint32_t idx, CoJob* job);
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Predict the work and the peak memory of an instance with the cost
+ *      model of the planner
+ * params:
+ *      1) job: ptr to CoJob. Its instance is set
+ *      2) prm: ptr to MRSParams, the parameters of the solve
+ * return: true on success, false if memory allocation failed */
+bool
+cosched_predict(CoJob* restrict job, const MRSParams* restrict prm);
+
+/* usage: Solve the instances concurrently
+ * params:
+ *      1) jobs: an array of CoJob, whose instances and predictions are set
+ *      2) n: size of jobs
+ *      3) prm: ptr to MRSParams, the parameters of each solve. The number of
+ *          threads and the thread pool are set per solve
+ *      4) cnum: number of cores to use
+ *      5) max_mem: memory budget in bytes
+ *      6) done: callback when a solve finishes, or NULL
+ *      7) arg: first argument of the callback
+ * return: true if all the instances are attempted, false on error */
+bool
+cosched_run(CoJob* restrict jobs, uint32_t n, const MRSParams* restrict prm,
+            uint32_t cnum, uint64_t max_mem, CoSchedDoneFn done, void* arg);
+
+#endif // __COSCHED_H__
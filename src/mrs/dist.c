@@ -0,0 +1,314 @@
+#include "dist.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(MRS_USE_MPI)
+#include <mpi.h>
+
+// max number of elements per call, since MPI counts are int
+#define DIST_CHUNK  (0x1ULL << 28)
+
+/* ========================================================================
+ * function implementations with MPI
+ * ======================================================================== */
+
+/* usage: Check whether the library is built with MPI
+ * params: void
+ * return: true if so, false otherwise */
+bool
+dist_supported(void) {
+    return true;
+}
+
+/* usage: Initialize the communication layer. Only the thread that calls it
+ *      communicates, the thread pools compute in between
+ * params:
+ *      1) argc: ptr to the number of arguments of main
+ *      2) argv: ptr to the arguments of main
+ * return: true on success, false otherwise */
+bool
+dist_init(int32_t* argc, char*** argv) {
+    int provided;
+    if(MPI_SUCCESS != MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED,
+                                      &provided))
+        return false;
+    if(provided < MPI_THREAD_FUNNELED) {
+        MPI_Finalize();
+        return false;
+    }
+    return true;
+}
+
+/* usage: Finalize the communication layer initialized by dist_init
+ * params: void
+ * return: void */
+void
+dist_finalize(void) {
+    MPI_Finalize();
+}
+
+/* usage: Terminate all the ranks, e.g. when one of them fails while the
+ *      others may be blocked in a collective
+ * params:
+ *      1) code: exit code
+ * return: void */
+void
+dist_abort(int32_t code) {
+    MPI_Abort(MPI_COMM_WORLD, code);
+}
+
+/* usage: Return the index of the calling rank
+ * params: void
+ * return: index of the rank, 0 without MPI */
+uint32_t
+dist_rank(void) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+/* usage: Return the number of ranks
+ * params: void
+ * return: number of ranks, 1 without MPI */
+uint32_t
+dist_size(void) {
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+/* usage: Wait until all the ranks reach this point
+ * params: void
+ * return: void */
+void
+dist_barrier(void) {
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+/* usage: XOR the buffers of all the ranks, i.e. sum them over GF(2^k), and
+ *      store the result into the buffer of every rank
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint64_t
+ * return: void */
+void
+dist_xor_u64(uint64_t* buf, uint64_t n) {
+    for(uint64_t i = 0; i < n; i += DIST_CHUNK) {
+        const uint64_t sz = (n - i < DIST_CHUNK) ? n - i : DIST_CHUNK;
+        MPI_Allreduce(MPI_IN_PLACE, buf + i, sz, MPI_UINT64_T, MPI_BXOR,
+                      MPI_COMM_WORLD);
+    }
+}
+
+/* usage: Sum the buffers of all the ranks elementwise, and store the result
+ *      into the buffer of every rank
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint32_t
+ * return: void */
+void
+dist_sum_u32(uint32_t* buf, uint64_t n) {
+    for(uint64_t i = 0; i < n; i += DIST_CHUNK) {
+        const uint64_t sz = (n - i < DIST_CHUNK) ? n - i : DIST_CHUNK;
+        MPI_Allreduce(MPI_IN_PLACE, buf + i, sz, MPI_UINT32_T, MPI_SUM,
+                      MPI_COMM_WORLD);
+    }
+}
+
+/* usage: the counterpart of dist_sum_u32 for uint64_t
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint64_t
+ * return: void */
+void
+dist_sum_u64(uint64_t* buf, uint64_t n) {
+    for(uint64_t i = 0; i < n; i += DIST_CHUNK) {
+        const uint64_t sz = (n - i < DIST_CHUNK) ? n - i : DIST_CHUNK;
+        MPI_Allreduce(MPI_IN_PLACE, buf + i, sz, MPI_UINT64_T, MPI_SUM,
+                      MPI_COMM_WORLD);
+    }
+}
+
+/* usage: Copy the buffer of rank 0 into the buffers of the other ranks
+ * params:
+ *      1) buf: the buffer
+ *      2) sz: size of buf in bytes
+ * return: void */
+void
+dist_bcast(void* buf, uint64_t sz) {
+    for(uint64_t i = 0; i < sz; i += DIST_CHUNK) {
+        const uint64_t n = (sz - i < DIST_CHUNK) ? sz - i : DIST_CHUNK;
+        MPI_Bcast((uint8_t*) buf + i, n, MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
+}
+
+/* subroutine of dist_alltoallv and dist_allgatherv: convert the numbers of
+ *      elements into the int counts and displacements of MPI. Return false if
+ *      they don't fit */
+static inline bool
+dist_counts(int* restrict cnt, int* restrict displ,
+            const uint64_t* restrict n, uint32_t size) {
+    uint64_t off = 0;
+    for(uint32_t i = 0; i < size; ++i) {
+        if(off > INT_MAX || n[i] > INT_MAX)
+            return false;
+        cnt[i] = n[i];
+        displ[i] = off;
+        off += n[i];
+    }
+    return true;
+}
+
+/* subroutine of dist_alltoallv and dist_allgatherv: create the MPI datatype
+ *      of an element of esz bytes */
+static inline bool
+dist_elem_type(MPI_Datatype* t, size_t esz) {
+    if(MPI_SUCCESS != MPI_Type_contiguous(esz, MPI_BYTE, t))
+        return false;
+    if(MPI_SUCCESS != MPI_Type_commit(t)) {
+        MPI_Type_free(t);
+        return false;
+    }
+    return true;
+}
+
+/* usage: Send a block of elements to each rank and receive a block from each
+ *      rank. The blocks are stored contiguously in the order of the ranks
+ * params:
+ *      1) sbuf: the blocks to send
+ *      2) scnt: an array of dist_size() uint64_t, the number of elements sent
+ *          to each rank
+ *      3) rbuf: container for the blocks received
+ *      4) rcnt: an array of dist_size() uint64_t, the number of elements
+ *          received from each rank
+ *      5) esz: size of an element in bytes
+ * return: true on success, false if a block is too large for MPI or memory
+ *      allocation failed */
+bool
+dist_alltoallv(const void* restrict sbuf, const uint64_t* restrict scnt,
+               void* restrict rbuf, const uint64_t* restrict rcnt, size_t esz) {
+    const uint32_t size = dist_size();
+    int* buf = malloc(sizeof(int) * size * 4);
+    if(!buf)
+        return false;
+    int* sc = buf, *sd = buf + size, *rc = buf + 2 * size, *rd = buf + 3 * size;
+    bool ok = dist_counts(sc, sd, scnt, size) && dist_counts(rc, rd, rcnt, size);
+    MPI_Datatype t;
+    if(ok && (ok = dist_elem_type(&t, esz))) {
+        ok = MPI_SUCCESS == MPI_Alltoallv(sbuf, sc, sd, t, rbuf, rc, rd, t,
+                                          MPI_COMM_WORLD);
+        MPI_Type_free(&t);
+    }
+    free(buf);
+    return ok;
+}
+
+/* usage: Gather the blocks of elements of all the ranks on every rank. The
+ *      blocks are stored contiguously in the order of the ranks
+ * params:
+ *      1) sbuf: the block of the calling rank
+ *      2) rbuf: container for all the blocks
+ *      3) rcnt: an array of dist_size() uint64_t, the number of elements of
+ *          the block of each rank
+ *      4) esz: size of an element in bytes
+ * return: true on success, false if a block is too large for MPI or memory
+ *      allocation failed */
+bool
+dist_allgatherv(const void* restrict sbuf, void* restrict rbuf,
+                const uint64_t* restrict rcnt, size_t esz) {
+    const uint32_t size = dist_size();
+    int* buf = malloc(sizeof(int) * size * 2);
+    if(!buf)
+        return false;
+    int* rc = buf, *rd = buf + size;
+    bool ok = dist_counts(rc, rd, rcnt, size);
+    MPI_Datatype t;
+    if(ok && (ok = dist_elem_type(&t, esz))) {
+        ok = MPI_SUCCESS == MPI_Allgatherv(sbuf, rc[dist_rank()], t, rbuf, rc,
+                                           rd, t, MPI_COMM_WORLD);
+        MPI_Type_free(&t);
+    }
+    free(buf);
+    return ok;
+}
+
+#else
+
+/* ========================================================================
+ * function implementations for a single rank
+ * ======================================================================== */
+
+bool
+dist_supported(void) {
+    return false;
+}
+
+bool
+dist_init(int32_t* argc, char*** argv) {
+    (void) argc; (void) argv;
+    return true;
+}
+
+void
+dist_finalize(void) {
+}
+
+void
+dist_abort(int32_t code) {
+    exit(code);
+}
+
+uint32_t
+dist_rank(void) {
+    return 0;
+}
+
+uint32_t
+dist_size(void) {
+    return 1;
+}
+
+void
+dist_barrier(void) {
+}
+
+void
+dist_xor_u64(uint64_t* buf, uint64_t n) {
+    (void) buf; (void) n;
+}
+
+void
+dist_sum_u32(uint32_t* buf, uint64_t n) {
+    (void) buf; (void) n;
+}
+
+void
+dist_sum_u64(uint64_t* buf, uint64_t n) {
+    (void) buf; (void) n;
+}
+
+void
+dist_bcast(void* buf, uint64_t sz) {
+    (void) buf; (void) sz;
+}
+
+bool
+dist_alltoallv(const void* restrict sbuf, const uint64_t* restrict scnt,
+               void* restrict rbuf, const uint64_t* restrict rcnt, size_t esz) {
+    assert(scnt[0] == rcnt[0]);
+    (void) rcnt;
+    memcpy(rbuf, sbuf, scnt[0] * esz);
+    return true;
+}
+
+bool
+dist_allgatherv(const void* restrict sbuf, void* restrict rbuf,
+                const uint64_t* restrict rcnt, size_t esz) {
+    memcpy(rbuf, sbuf, rcnt[0] * esz);
+    return true;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef __DIST_H__
+#define __DIST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Communication layer of the distributed mode, where the matrix to eliminate
+// is sharded by columns over the processes of an MPI job. Every process (rank)
+// builds its share of the rows of the Macaulay matrix, and the entries are
+// then exchanged so that each rank ends up with a contiguous block of the
+// columns to eliminate. Block Lanczos keeps the Lanczos vectors replicated:
+// only the products with the matrix and the Gramian of M^T * v are partial
+// sums, which are combined with allreduce. Over GF(16), the sum is XOR.
+//
+// Without MRS_USE_MPI (cmake -DUSE_MPI=ON), there is a single rank and every
+// collective is a no-op, so the distributed code paths still build.
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Check whether the library is built with MPI
+ * params: void
+ * return: true if so, false otherwise */
+bool
+dist_supported(void);
+
+/* usage: Initialize the communication layer. Only the thread that calls it
+ *      communicates, the thread pools compute in between
+ * params:
+ *      1) argc: ptr to the number of arguments of main
+ *      2) argv: ptr to the arguments of main
+ * return: true on success, false otherwise */
+bool
+dist_init(int32_t* argc, char*** argv);
+
+/* usage: Finalize the communication layer initialized by dist_init
+ * params: void
+ * return: void */
+void
+dist_finalize(void);
+
+/* usage: Terminate all the ranks, e.g. when one of them fails while the
+ *      others may be blocked in a collective
+ * params:
+ *      1) code: exit code
+ * return: void */
+void
+dist_abort(int32_t code);
+
+/* usage: Return the index of the calling rank
+ * params: void
+ * return: index of the rank, 0 without MPI */
+uint32_t
+dist_rank(void);
+
+/* usage: Return the number of ranks
+ * params: void
+ * return: number of ranks, 1 without MPI */
+uint32_t
+dist_size(void);
+
+/* usage: Wait until all the ranks reach this point
+ * params: void
+ * return: void */
+void
+dist_barrier(void);
+
+/* usage: XOR the buffers of all the ranks, i.e. sum them over GF(2^k), and
+ *      store the result into the buffer of every rank
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint64_t
+ * return: void */
+void
+dist_xor_u64(uint64_t* buf, uint64_t n);
+
+/* usage: Sum the buffers of all the ranks elementwise, and store the result
+ *      into the buffer of every rank
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint32_t
+ * return: void */
+void
+dist_sum_u32(uint32_t* buf, uint64_t n);
+
+/* usage: the counterpart of dist_sum_u32 for uint64_t
+ * params:
+ *      1) buf: the buffer
+ *      2) n: size of buf in uint64_t
+ * return: void */
+void
+dist_sum_u64(uint64_t* buf, uint64_t n);
+
+/* usage: Copy the buffer of rank 0 into the buffers of the other ranks
+ * params:
+ *      1) buf: the buffer
+ *      2) sz: size of buf in bytes
+ * return: void */
+void
+dist_bcast(void* buf, uint64_t sz);
+
+/* usage: Send a block of elements to each rank and receive a block from each
+ *      rank. The blocks are stored contiguously in the order of the ranks
+ * params:
+ *      1) sbuf: the blocks to send
+ *      2) scnt: an array of dist_size() uint64_t, the number of elements sent
+ *          to each rank
+ *      3) rbuf: container for the blocks received
+ *      4) rcnt: an array of dist_size() uint64_t, the number of elements
+ *          received from each rank
+ *      5) esz: size of an element in bytes
+ * return: true on success, false if a block is too large for MPI or memory
+ *      allocation failed */
+bool
+dist_alltoallv(const void* restrict sbuf, const uint64_t* restrict scnt,
+               void* restrict rbuf, const uint64_t* restrict rcnt, size_t esz);
+
+/* usage: Gather the blocks of elements of all the ranks on every rank. The
+ *      blocks are stored contiguously in the order of the ranks
+ * params:
+ *      1) sbuf: the block of the calling rank
+ *      2) rbuf: container for all the blocks
+ *      3) rcnt: an array of dist_size() uint64_t, the number of elements of
+ *          the block of each rank
+ *      4) esz: size of an element in bytes
+ * return: true on success, false if a block is too large for MPI or memory
+ *      allocation failed */
+bool
+dist_allgatherv(const void* restrict sbuf, void* restrict rbuf,
+                const uint64_t* restrict rcnt, size_t esz);
+
+#endif // __DIST_H__
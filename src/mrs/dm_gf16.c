@@ -0,0 +1,578 @@
+#include "dm_gf16.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdalign.h>
+#include <assert.h>
+
+// number of struct Grp64GF16 in a tile of columns. A table of all linear
+// combinations of the pivot rows is built for 1 tile at a time. With 256
+// entries, the table takes 64KB.
+#define DM_GF16_TILE_BNUM   8
+
+/* ========================================================================
+ * struct DMGF16 definition
+ * ======================================================================== */
+
+struct DMGF16 {
+    uint64_t nrow;
+    uint64_t ncol;
+    uint64_t bnum; // number of struct Grp64GF16 in a row
+    Grp64GF16* rows;
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: compute the number of struct Grp64GF16 in a row
+ * params:
+ *      1) ncol: number of columns
+ * return: number of struct Grp64GF16 */
+static inline uint64_t
+dm_gf16_calc_bnum(uint64_t ncol) {
+    uint64_t bnum = (ncol + 63) >> 6;
+    return (bnum + 1) & ~0x1ULL; // every row starts at 64-byte boundary
+}
+
+/* usage: compute the size of memory needed for struct DMGF16
+ * params:
+ *      1) nrow: number of rows
+ *      2) ncol: number of columns
+ * return: size in bytes */
+uint64_t
+dm_gf16_memsize(uint64_t nrow, uint64_t ncol) {
+    return sizeof(DMGF16) +
+           sizeof(Grp64GF16) * nrow * dm_gf16_calc_bnum(ncol);
+}
+
+/* usage: Create a DMGF16 container. Note the matrix is not initialized.
+ * params:
+ *      1) nrow: number of rows
+ *      2) ncol: number of columns
+ * return: a ptr to struct DMGF16. On failure, return NULL */
+DMGF16*
+dm_gf16_create(uint64_t nrow, uint64_t ncol) {
+    DMGF16* m = malloc(sizeof(DMGF16));
+    if(!m)
+        return NULL;
+    m->nrow = nrow;
+    m->ncol = ncol;
+    m->bnum = dm_gf16_calc_bnum(ncol);
+    uint64_t sz = sizeof(Grp64GF16) * nrow * m->bnum;
+    // NOTE: alignment requirement for Grp64GF16 is 32-byte boundary, but
+    // 64-byte boundary is better for AVX-512
+    m->rows = aligned_alloc(64, sz ? sz : 64);
+    if(!m->rows) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+/* usage: Release a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_free(DMGF16* m) {
+    if(!m)
+        return;
+    free(m->rows);
+    free(m);
+}
+
+/* usage: return the number of rows in a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: number of rows */
+uint64_t
+dm_gf16_nrow(const DMGF16* m) {
+    return m->nrow;
+}
+
+/* usage: return the number of columns in a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: number of columns */
+uint64_t
+dm_gf16_ncol(const DMGF16* m) {
+    return m->ncol;
+}
+
+/* usage: return the addr of the selected row in a struct DMGF16
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ * return: the row addr as a ptr to an array of struct Grp64GF16 */
+Grp64GF16*
+dm_gf16_raddr(DMGF16* m, uint64_t i) {
+    assert(i < m->nrow);
+    return m->rows + i * m->bnum;
+}
+
+/* usage: return the selected element in a row of a struct DMGF16
+ * params:
+ *      1) row: ptr to the row, as returned by dm_gf16_raddr()
+ *      2) j: index of the column
+ * return: the j-th element of the row */
+gf16_t
+dm_gf16_row_at(const Grp64GF16* row, uint64_t j) {
+    return grp64_gf16_at(row + (j >> 6), j & 0x3FULL);
+}
+
+/* usage: set the selected element in a row of a struct DMGF16 to the given
+ *      value. This allows a nullvector to be stored into the matrix without
+ *      knowing its size.
+ * params:
+ *      1) row: ptr to the row, as returned by dm_gf16_raddr()
+ *      2) j: index of the column
+ *      3) v: the new value
+ * return: void */
+void
+dm_gf16_row_set_at(Grp64GF16* row, uint64_t j, gf16_t v) {
+    grp64_gf16_set_at(row + (j >> 6), j & 0x3FULL, v);
+}
+
+/* usage: return the selected element in a struct DMGF16
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ *      3) j: index of the column
+ * return: the (i, j)-th element of the matrix */
+gf16_t
+dm_gf16_at(const DMGF16* m, uint64_t i, uint64_t j) {
+    assert(i < m->nrow && j < m->ncol);
+    return dm_gf16_row_at(dm_gf16_raddr((DMGF16*) m, i), j);
+}
+
+/* usage: set the selected element in a struct DMGF16 to the given value
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ *      3) j: index of the column
+ *      4) v: the new value
+ * return: void */
+void
+dm_gf16_set_at(DMGF16* m, uint64_t i, uint64_t j, gf16_t v) {
+    assert(i < m->nrow && j < m->ncol);
+    assert(v <= GF16_MAX);
+    dm_gf16_row_set_at(dm_gf16_raddr(m, i), j, v);
+}
+
+/* usage: Reset a struct DMGF16 to zero matrix
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_zero(DMGF16* m) {
+    memset(m->rows, 0, sizeof(Grp64GF16) * m->nrow * m->bnum);
+}
+
+/* usage: Given a struct DMGF16, populate it with random coefficients.
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_rand(DMGF16* m) {
+    const uint64_t used_bnum = (m->ncol + 63) >> 6;
+    const uint64_t last_mask = (m->ncol & 0x3FULL) ?
+                               (0x1ULL << (m->ncol & 0x3FULL)) - 1 : UINT64_MAX;
+    for(uint64_t i = 0; i < m->nrow; ++i) {
+        Grp64GF16* row = dm_gf16_raddr(m, i);
+        for(uint64_t b = 0; b < m->bnum; ++b) {
+            if(b < used_bnum)
+                grp64_gf16_rand(row + b);
+            else
+                grp64_gf16_zero(row + b);
+        }
+        if(used_bnum) // the padding must stay zero
+            grp64_gf16_zero_subset(row + used_bnum - 1, last_mask);
+    }
+}
+
+/* usage: subroutine of dm_gf16_gj: multiply a row with a scalar
+ * params:
+ *      1) row: ptr to an array of struct Grp64GF16
+ *      2) bnum: size of the array
+ *      3) c: the scalar multiplier
+ * return: void */
+static inline void
+dm_gf16_row_muli_scalar(Grp64GF16* row, uint64_t bnum, gf16_t c) {
+    for(uint64_t b = 0; b < bnum; ++b)
+        grp64_gf16_muli_scalar(row + b, c);
+}
+
+/* usage: subroutine of dm_gf16_gj: compute a - b * c for 2 rows a and b
+ * params:
+ *      1) a: ptr to an array of struct Grp64GF16
+ *      2) b: ptr to an array of struct Grp64GF16
+ *      3) bnum: size of the arrays
+ *      4) c: the scalar multiplier
+ * return: void */
+static inline void
+dm_gf16_row_fmsubi_scalar(Grp64GF16* restrict a, const Grp64GF16* restrict b,
+                          uint64_t bnum, gf16_t c) {
+    if(!c)
+        return;
+    for(uint64_t i = 0; i < bnum; ++i)
+        grp64_gf16_fmsubi_scalar(a + i, b + i, c);
+}
+
+/* usage: subroutine of dm_gf16_gj: check if a tile of a row is zero
+ * params:
+ *      1) row: ptr to an array of struct Grp64GF16
+ *      2) w: size of the array
+ * return: true if all elements are zero */
+static inline bool
+dm_gf16_tile_is_zero(const Grp64GF16* row, uint64_t w) {
+    uint64_t nz = 0;
+    for(uint64_t b = 0; b < w; ++b)
+        nz |= grp64_gf16_nzpos(row + b);
+    return !nz;
+}
+
+/* usage: subroutine of dm_gf16_gj: given a tile of 1 or 2 pivot rows, compute
+ *      all linear combinations of them
+ * params:
+ *      1) tbl: storage for the table. Upon return, the (a + 16 * b)-th entry,
+ *          which starts at tbl + (a + 16 * b) * DM_GF16_TILE_BNUM, is
+ *          a * p0 + b * p1.
+ *      2) p0: ptr to the tile of the 1st pivot row
+ *      3) p1: ptr to the tile of the 2nd pivot row. If NULL, only the 1st
+ *          16 entries are computed
+ *      4) w: number of struct Grp64GF16 in the tile
+ * return: void */
+static inline void
+dm_gf16_comb_tbl(Grp64GF16* restrict tbl, const Grp64GF16* restrict p0,
+                 const Grp64GF16* restrict p1, uint64_t w) {
+    for(uint64_t b = 0; b < w; ++b)
+        grp64_gf16_zero(tbl + b);
+    for(gf16_t a = 1; a < 16; ++a) {
+        Grp64GF16* dst = tbl + a * DM_GF16_TILE_BNUM;
+        for(uint64_t b = 0; b < w; ++b)
+            grp64_gf16_mul_scalar(dst + b, p0 + b, a);
+    }
+    if(!p1)
+        return;
+
+    for(gf16_t c = 1; c < 16; ++c) {
+        Grp64GF16* base = tbl + (c << 4) * DM_GF16_TILE_BNUM;
+        for(uint64_t b = 0; b < w; ++b)
+            grp64_gf16_mul_scalar(base + b, p1 + b, c);
+        for(gf16_t a = 1; a < 16; ++a) {
+            Grp64GF16* dst = base + a * DM_GF16_TILE_BNUM;
+            const Grp64GF16* src = tbl + a * DM_GF16_TILE_BNUM;
+            for(uint64_t b = 0; b < w; ++b) {
+                grp64_gf16_copy(dst + b, base + b);
+                grp64_gf16_addi(dst + b, src + b);
+            }
+        }
+    }
+}
+
+/* usage: subroutine of dm_gf16_gj: reduce the columns [sidx, eidx) of all
+ *      rows with the pivot rows
+ * params:
+ *      1) mat: ptr to struct DMGF16
+ *      2) pr0: index of the 1st pivot row
+ *      3) pr1: index of the 2nd pivot row. UINT64_MAX if there is only 1
+ *      4) coef: coef[r] = a + 16 * b, where a * pr0 + b * pr1 is to be
+ *          subtracted from the r-th row
+ *      5) tbl: storage for the table of linear combinations of pivot rows
+ *      6) sidx: index of the 1st struct Grp64GF16 in a row to reduce
+ *      7) eidx: index of the last struct Grp64GF16 in a row to reduce + 1
+ * return: void */
+static void
+dm_gf16_reduc(DMGF16* restrict mat, uint64_t pr0, uint64_t pr1,
+              const uint8_t* restrict coef, Grp64GF16* restrict tbl,
+              uint64_t sidx, uint64_t eidx) {
+    const Grp64GF16* p0 = dm_gf16_raddr(mat, pr0);
+    const Grp64GF16* p1 = (pr1 == UINT64_MAX) ? NULL : dm_gf16_raddr(mat, pr1);
+    for(uint64_t t = sidx; t < eidx; t += DM_GF16_TILE_BNUM) {
+        const uint64_t w = (eidx - t < DM_GF16_TILE_BNUM) ? eidx - t :
+                                                            DM_GF16_TILE_BNUM;
+        // tiles of pivot columns reduced in previous passes are often zero
+        if(dm_gf16_tile_is_zero(p0 + t, w) &&
+           (!p1 || dm_gf16_tile_is_zero(p1 + t, w)))
+            continue;
+
+        dm_gf16_comb_tbl(tbl, p0 + t, p1 ? p1 + t : NULL, w);
+        for(uint64_t r = 0; r < mat->nrow; ++r) {
+            if(!coef[r])
+                continue;
+            Grp64GF16* dst = dm_gf16_raddr(mat, r) + t;
+            const Grp64GF16* src = tbl + coef[r] * DM_GF16_TILE_BNUM;
+            // subtraction is the same as addition in GF(16)
+            for(uint64_t b = 0; b < w; ++b)
+                grp64_gf16_addi(dst + b, src + b);
+        }
+    }
+}
+
+typedef struct {
+    DMGF16* m;
+    DMGF16* aug;
+    uint64_t pr0; // index of the 1st pivot row
+    uint64_t pr1; // index of the 2nd pivot row, UINT64_MAX if none
+    const uint8_t* coef;
+    Grp64GF16* tbl;
+    // [sidx, eidx) of the struct Grp64GF16 in a row of m followed by a row
+    // of aug are reduced by this worker
+    uint64_t sidx;
+    uint64_t eidx;
+} DMGF16GJArg;
+
+/* usage: subroutine of dm_gf16_gj: reduce a range of columns of m and aug
+ * params:
+ *      1) __arg: ptr to DMGF16GJArg
+ * return: void */
+static void
+dm_gf16_gj_worker(void* __arg) {
+    const DMGF16GJArg* arg = (DMGF16GJArg*) __arg;
+    const uint64_t mbnum = arg->m->bnum;
+    if(arg->sidx < mbnum) {
+        uint64_t e = (arg->eidx < mbnum) ? arg->eidx : mbnum;
+        dm_gf16_reduc(arg->m, arg->pr0, arg->pr1, arg->coef, arg->tbl,
+                      arg->sidx, e);
+    }
+    if(arg->eidx > mbnum) {
+        uint64_t s = (arg->sidx > mbnum) ? arg->sidx - mbnum : 0;
+        dm_gf16_reduc(arg->aug, arg->pr0, arg->pr1, arg->coef, arg->tbl,
+                      s, arg->eidx - mbnum);
+    }
+}
+
+/* usage: subroutine of dm_gf16_gj: find the 1st row that is not a pivot yet
+ *      and has a non-zero element in the given column. The element can be
+ *      reduced by a pivot row first.
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) unused: bitmap of the rows that are not pivots yet
+ *      3) j: index of the column
+ *      4) e: the row is reduced by e times the pivot row in the previous
+ *          column, i.e. the element is m[r][j] - m[r][j-1] * e
+ * return: index of the row. UINT64_MAX if not found */
+static inline uint64_t
+dm_gf16_find_pivot(const DMGF16* m, const uint64_t* unused, uint64_t j,
+                   gf16_t e) {
+    const uint64_t wnum = (m->nrow + 63) >> 6;
+    for(uint64_t w = 0; w < wnum; ++w) {
+        uint64_t bits = unused[w];
+        while(bits) {
+            const uint64_t r = (w << 6) + uint64_t_ctz(bits);
+            bits &= bits - 1;
+            const Grp64GF16* row = dm_gf16_raddr((DMGF16*) m, r);
+            gf16_t v = dm_gf16_row_at(row, j);
+            if(e)
+                v ^= gf16_t_mul(dm_gf16_row_at(row, j - 1), e);
+            if(v)
+                return r;
+        }
+    }
+    return UINT64_MAX;
+}
+
+/* usage: subroutine of dm_gf16_gj: move the rows of m and aug so that the
+ *      i-th row becomes the src[i]-th row before the permutation.
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) aug: ptr to struct DMGF16
+ *      3) src: an array of nrow uint64_t. Will be overwritten
+ *      4) tmp0: storage for a row of m
+ *      5) tmp1: storage for a row of aug
+ * return: void */
+static void
+dm_gf16_permute_rows(DMGF16* restrict m, DMGF16* restrict aug,
+                     uint64_t* restrict src, Grp64GF16* restrict tmp0,
+                     Grp64GF16* restrict tmp1) {
+    const size_t msz = sizeof(Grp64GF16) * m->bnum;
+    const size_t asz = sizeof(Grp64GF16) * aug->bnum;
+    for(uint64_t i = 0; i < m->nrow; ++i) {
+        if(src[i] == i)
+            continue;
+        // follow the cycle that starts at i
+        memcpy(tmp0, dm_gf16_raddr(m, i), msz);
+        memcpy(tmp1, dm_gf16_raddr(aug, i), asz);
+        uint64_t j = i;
+        while(src[j] != i) {
+            memcpy(dm_gf16_raddr(m, j), dm_gf16_raddr(m, src[j]), msz);
+            memcpy(dm_gf16_raddr(aug, j), dm_gf16_raddr(aug, src[j]), asz);
+            uint64_t next = src[j];
+            src[j] = j;
+            j = next;
+        }
+        memcpy(dm_gf16_raddr(m, j), tmp0, msz);
+        memcpy(dm_gf16_raddr(aug, j), tmp1, asz);
+        src[j] = j;
+    }
+}
+
+/* usage: Given a struct DMGF16 m, perform Gauss-Jordan elimination on it to
+ *      identify independent columns. The same row operations are applied to
+ *      aug, so if the caller passes the constant column as aug, the solution
+ *      of solvable systems can be computed. Upon return, the pivot row of the
+ *      i-th independent column is the i-th row of m, while the remaining rows
+ *      fill the positions of the singular columns and the rows after the last
+ *      column.
+ *
+ *      The elimination takes 2 pivots per pass over the matrix: the rows are
+ *      reduced with a lookup into a table of all 256 linear combinations of
+ *      the 2 pivot rows, which is built for a tile of columns at a time. The
+ *      columns are split across threads, so no synchronization is needed
+ *      within a pass.
+ * params:
+ *      1) m: ptr to a struct DMGF16. Must have no less rows than columns
+ *      2) aug: ptr to a struct DMGF16 with the same number of rows as m
+ *      3) di: an array of (ncol + 63) / 64 uint64_t. When the function
+ *              returns, di encodes the independent columns. If the 1st column
+ *              is independent, then the 1st bit of di[0] is set, and so on.
+ *      4) tnum: number of threads to use
+ *      5) tp: ptr to a struct Threadpool. Can be NULL if tnum is 1
+ * return: true on success, false if memory allocation failed */
+bool
+dm_gf16_gj(DMGF16* restrict m, DMGF16* restrict aug, uint64_t* restrict di,
+           uint32_t tnum, Threadpool* restrict tp) {
+    assert(m->nrow >= m->ncol);
+    assert(m->nrow == aug->nrow);
+    const uint64_t nrow = m->nrow;
+    const uint64_t ncol = m->ncol;
+    const uint64_t total_bnum = m->bnum + aug->bnum;
+    if(!tp || !tnum)
+        tnum = 1;
+    // at least 1 tile per thread
+    if(tnum > (total_bnum + DM_GF16_TILE_BNUM - 1) / DM_GF16_TILE_BNUM)
+        tnum = (total_bnum + DM_GF16_TILE_BNUM - 1) / DM_GF16_TILE_BNUM;
+    if(!tnum)
+        tnum = 1;
+
+    const uint64_t rwnum = (nrow + 63) >> 6;
+    uint8_t* coef = malloc(sizeof(uint8_t) * nrow);
+    uint64_t* unused = malloc(sizeof(uint64_t) * (rwnum ? rwnum : 1));
+    uint64_t* src = malloc(sizeof(uint64_t) * (nrow ? nrow : 1));
+    DMGF16GJArg* args = malloc(sizeof(DMGF16GJArg) * tnum);
+    Grp64GF16* tbls = aligned_alloc(64, sizeof(Grp64GF16) * tnum * 256 *
+                                        DM_GF16_TILE_BNUM);
+    Grp64GF16* tmp = aligned_alloc(64, sizeof(Grp64GF16) * total_bnum + 64);
+    bool rv = (coef && unused && src && args && tbls && tmp);
+    if(!rv)
+        goto dm_gf16_gj_cleanup;
+
+    memset(di, 0, sizeof(uint64_t) * ((ncol + 63) >> 6));
+    for(uint64_t w = 0; w < rwnum; ++w)
+        unused[w] = UINT64_MAX;
+    if(nrow & 0x3FULL)
+        unused[rwnum - 1] = (0x1ULL << (nrow & 0x3FULL)) - 1;
+    for(uint64_t i = 0; i < nrow; ++i)
+        src[i] = UINT64_MAX;
+
+    // split the columns evenly, in units of 2 struct Grp64GF16 so that every
+    // range starts at 64-byte boundary
+    uint64_t chunk = (total_bnum + tnum - 1) / tnum;
+    chunk = (chunk + 1) & ~0x1ULL;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].m = m;
+        args[i].aug = aug;
+        args[i].coef = coef;
+        args[i].tbl = tbls + (uint64_t) i * 256 * DM_GF16_TILE_BNUM;
+        args[i].sidx = i * chunk;
+        args[i].eidx = (i + 1) * chunk;
+        if(args[i].sidx > total_bnum)
+            args[i].sidx = total_bnum;
+        if(args[i].eidx > total_bnum)
+            args[i].eidx = total_bnum;
+    }
+
+    uint64_t j = 0;
+    while(j < ncol) { // for each pass
+        const uint64_t pr0 = dm_gf16_find_pivot(m, unused, j, 0);
+        if(pr0 == UINT64_MAX) { // singular column
+            ++j;
+            continue;
+        }
+        Grp64GF16* mp0 = dm_gf16_raddr(m, pr0);
+        Grp64GF16* ap0 = dm_gf16_raddr(aug, pr0);
+        gf16_t inv_coeff = gf16_t_inv(dm_gf16_row_at(mp0, j));
+        dm_gf16_row_muli_scalar(mp0, m->bnum, inv_coeff);
+        dm_gf16_row_muli_scalar(ap0, aug->bnum, inv_coeff);
+        unused[pr0 >> 6] &= ~(0x1ULL << (pr0 & 0x3FULL));
+        di[j >> 6] |= 0x1ULL << (j & 0x3FULL);
+        src[j] = pr0;
+
+        // try to take the pivot of the next column in the same pass
+        uint64_t pr1 = UINT64_MAX;
+        uint64_t step = 1;
+        if(j + 1 < ncol) {
+            step = 2;
+            pr1 = dm_gf16_find_pivot(m, unused, j + 1,
+                                     dm_gf16_row_at(mp0, j + 1));
+            // if not found, the next column is singular: it will be zero in
+            // all the remaining rows after this pass
+        }
+        if(pr1 != UINT64_MAX) {
+            Grp64GF16* mp1 = dm_gf16_raddr(m, pr1);
+            Grp64GF16* ap1 = dm_gf16_raddr(aug, pr1);
+            // reduce the 2 pivot rows with each other
+            gf16_t c = dm_gf16_row_at(mp1, j);
+            dm_gf16_row_fmsubi_scalar(mp1, mp0, m->bnum, c);
+            dm_gf16_row_fmsubi_scalar(ap1, ap0, aug->bnum, c);
+            inv_coeff = gf16_t_inv(dm_gf16_row_at(mp1, j + 1));
+            dm_gf16_row_muli_scalar(mp1, m->bnum, inv_coeff);
+            dm_gf16_row_muli_scalar(ap1, aug->bnum, inv_coeff);
+            c = dm_gf16_row_at(mp0, j + 1);
+            dm_gf16_row_fmsubi_scalar(mp0, mp1, m->bnum, c);
+            dm_gf16_row_fmsubi_scalar(ap0, ap1, aug->bnum, c);
+            unused[pr1 >> 6] &= ~(0x1ULL << (pr1 & 0x3FULL));
+            di[(j + 1) >> 6] |= 0x1ULL << ((j + 1) & 0x3FULL);
+            src[j + 1] = pr1;
+        }
+
+        // the coefficients must be collected before any row is reduced
+        for(uint64_t r = 0; r < nrow; ++r) {
+            const Grp64GF16* row = dm_gf16_raddr(m, r);
+            coef[r] = dm_gf16_row_at(row, j);
+            if(pr1 != UINT64_MAX)
+                coef[r] |= dm_gf16_row_at(row, j + 1) << 4;
+        }
+        coef[pr0] = 0;
+        if(pr1 != UINT64_MAX)
+            coef[pr1] = 0;
+
+        for(uint32_t i = 0; i < tnum; ++i) {
+            args[i].pr0 = pr0;
+            args[i].pr1 = pr1;
+        }
+        if(tnum == 1) {
+            dm_gf16_gj_worker(args);
+        } else {
+            for(uint32_t i = 0; i < tnum; ++i) {
+                if(args[i].sidx < args[i].eidx)
+                    thpool_add_job(tp, dm_gf16_gj_worker, args + i);
+            }
+            thpool_wait_jobs(tp);
+        }
+        j += step;
+    }
+
+    // the remaining rows go to the positions of the singular columns and
+    // then after the last column
+    uint64_t w = 0;
+    for(uint64_t i = 0; i < nrow; ++i) {
+        if(src[i] != UINT64_MAX)
+            continue;
+        while(!unused[w])
+            ++w;
+        src[i] = (w << 6) + uint64_t_ctz(unused[w]);
+        unused[w] &= unused[w] - 1;
+    }
+    dm_gf16_permute_rows(m, aug, src, tmp, tmp + m->bnum);
+
+dm_gf16_gj_cleanup:
+    free(coef);
+    free(unused);
+    free(src);
+    free(args);
+    free(tbls);
+    free(tmp);
+    return rv;
+}
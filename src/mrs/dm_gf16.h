@@ -0,0 +1,142 @@
+#ifndef __DM_GF16_H__
+#define __DM_GF16_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gf16.h"
+#include "grp64_gf16.h"
+#include "thpool.h"
+
+// dense row-major matrix of any size over GF(16). Each row is an array of
+// struct Grp64GF16, i.e. the elements are bitsliced 64 at a time.
+
+typedef struct DMGF16 DMGF16;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: compute the size of memory needed for struct DMGF16
+ * params:
+ *      1) nrow: number of rows
+ *      2) ncol: number of columns
+ * return: size in bytes */
+uint64_t
+dm_gf16_memsize(uint64_t nrow, uint64_t ncol);
+
+/* usage: Create a DMGF16 container. Note the matrix is not initialized.
+ * params:
+ *      1) nrow: number of rows
+ *      2) ncol: number of columns
+ * return: a ptr to struct DMGF16. On failure, return NULL */
+DMGF16*
+dm_gf16_create(uint64_t nrow, uint64_t ncol);
+
+/* usage: Release a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_free(DMGF16* m);
+
+/* usage: return the number of rows in a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: number of rows */
+uint64_t
+dm_gf16_nrow(const DMGF16* m);
+
+/* usage: return the number of columns in a struct DMGF16
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: number of columns */
+uint64_t
+dm_gf16_ncol(const DMGF16* m);
+
+/* usage: return the addr of the selected row in a struct DMGF16
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ * return: the row addr as a ptr to an array of struct Grp64GF16 */
+Grp64GF16*
+dm_gf16_raddr(DMGF16* m, uint64_t i);
+
+/* usage: return the selected element in a row of a struct DMGF16
+ * params:
+ *      1) row: ptr to the row, as returned by dm_gf16_raddr()
+ *      2) j: index of the column
+ * return: the j-th element of the row */
+gf16_t
+dm_gf16_row_at(const Grp64GF16* row, uint64_t j);
+
+/* usage: set the selected element in a row of a struct DMGF16 to the given
+ *      value. This allows a nullvector to be stored into the matrix without
+ *      knowing its size.
+ * params:
+ *      1) row: ptr to the row, as returned by dm_gf16_raddr()
+ *      2) j: index of the column
+ *      3) v: the new value
+ * return: void */
+void
+dm_gf16_row_set_at(Grp64GF16* row, uint64_t j, gf16_t v);
+
+/* usage: return the selected element in a struct DMGF16
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ *      3) j: index of the column
+ * return: the (i, j)-th element of the matrix */
+gf16_t
+dm_gf16_at(const DMGF16* m, uint64_t i, uint64_t j);
+
+/* usage: set the selected element in a struct DMGF16 to the given value
+ * params:
+ *      1) m: ptr to struct DMGF16
+ *      2) i: index of the row
+ *      3) j: index of the column
+ *      4) v: the new value
+ * return: void */
+void
+dm_gf16_set_at(DMGF16* m, uint64_t i, uint64_t j, gf16_t v);
+
+/* usage: Reset a struct DMGF16 to zero matrix
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_zero(DMGF16* m);
+
+/* usage: Given a struct DMGF16, populate it with random coefficients.
+ * params:
+ *      1) m: ptr to a struct DMGF16
+ * return: void */
+void
+dm_gf16_rand(DMGF16* m);
+
+/* usage: Given a struct DMGF16 m, perform Gauss-Jordan elimination on it to
+ *      identify independent columns. The same row operations are applied to
+ *      aug, so if the caller passes the constant column as aug, the solution
+ *      of solvable systems can be computed. Upon return, the pivot row of the
+ *      i-th independent column is the i-th row of m, while the remaining rows
+ *      fill the positions of the singular columns and the rows after the last
+ *      column.
+ *
+ *      The elimination takes 2 pivots per pass over the matrix: the rows are
+ *      reduced with a lookup into a table of all 256 linear combinations of
+ *      the 2 pivot rows, which is built for a tile of columns at a time. The
+ *      columns are split across threads, so no synchronization is needed
+ *      within a pass.
+ * params:
+ *      1) m: ptr to a struct DMGF16. Must have no less rows than columns
+ *      2) aug: ptr to a struct DMGF16 with the same number of rows as m
+ *      3) di: an array of (ncol + 63) / 64 uint64_t. When the function
+ *              returns, di encodes the independent columns. If the 1st column
+ *              is independent, then the 1st bit of di[0] is set, and so on.
+ *      4) tnum: number of threads to use
+ *      5) tp: ptr to a struct Threadpool. Can be NULL if tnum is 1
+ * return: true on success, false if memory allocation failed */
+bool
+dm_gf16_gj(DMGF16* restrict m, DMGF16* restrict aug, uint64_t* restrict di,
+           uint32_t tnum, Threadpool* restrict tp);
+
+#endif // __DM_GF16_H__
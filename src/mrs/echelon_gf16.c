@@ -0,0 +1,160 @@
+#include "echelon_gf16.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/* ========================================================================
+ * struct EchelonGF16 definition
+ * ======================================================================== */
+
+struct EchelonGF16 {
+    uint32_t ncol;
+    uint32_t cstart; // first column that can be a pivot
+    uint32_t stride; // ncol rounded up to a multiple of 64
+    uint32_t rank;
+    uint32_t* piv; // pivot column of each row
+    gf16_t* rows; // max rank + 1 rows, the last of which is for reduction
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Create a EchelonGF16 container with no rows
+ * params:
+ *      1) ncol: number of columns
+ *      2) cstart: index of the first column that can be a pivot. Must be
+ *              smaller than ncol
+ * return: a ptr to struct EchelonGF16. On failure, return NULL */
+EchelonGF16*
+echelon_gf16_create(uint32_t ncol, uint32_t cstart) {
+    assert(cstart < ncol);
+    EchelonGF16* e = malloc(sizeof(EchelonGF16));
+    if(!e)
+        return NULL;
+    e->ncol = ncol;
+    e->cstart = cstart;
+    e->stride = (ncol + 63) & ~0x3FU;
+    e->rank = 0;
+    e->piv = malloc(sizeof(uint32_t) * (ncol - cstart));
+    e->rows = aligned_alloc(64, sizeof(gf16_t) * e->stride * (ncol - cstart + 1));
+    if(!e->piv || !e->rows) {
+        echelon_gf16_free(e);
+        return NULL;
+    }
+    return e;
+}
+
+/* usage: Release a struct EchelonGF16
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: void */
+void
+echelon_gf16_free(EchelonGF16* e) {
+    if(!e)
+        return;
+    free(e->piv);
+    free(e->rows);
+    free(e);
+}
+
+/* usage: Drop all the rows collected so far, e.g. to reuse the container for
+ *      another linear system of the same size
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: void */
+void
+echelon_gf16_reset(EchelonGF16* e) {
+    e->rank = 0;
+}
+
+/* usage: return the number of rows collected so far, which is also the rank
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: the rank */
+uint32_t
+echelon_gf16_rank(const EchelonGF16* e) {
+    return e->rank;
+}
+
+/* usage: return the max rank, i.e. number of columns that can be a pivot
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: the max rank */
+uint32_t
+echelon_gf16_max_rank(const EchelonGF16* e) {
+    return e->ncol - e->cstart;
+}
+
+/* usage: return the addr of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) i: index of the row
+ * return: ptr to the row as an array of gf16_t */
+static inline gf16_t*
+echelon_gf16_raddr(const EchelonGF16* e, uint32_t i) {
+    return e->rows + (uint64_t) e->stride * i;
+}
+
+/* usage: return the selected row. The i-th row has its pivot normalized to 1,
+ *      and is zero at the pivots of the previous rows. After a failed
+ *      echelon_gf16_insert(), the row at index rank holds the reduced
+ *      candidate, whose pivot columns are all zero.
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) i: index of the row, no larger than the rank
+ * return: ptr to the row as an array of gf16_t */
+const gf16_t*
+echelon_gf16_row(const EchelonGF16* e, uint32_t i) {
+    assert(i <= e->rank);
+    return echelon_gf16_raddr(e, i);
+}
+
+/* usage: return the pivot column of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) i: index of the row, smaller than the rank
+ * return: index of the pivot column */
+uint32_t
+echelon_gf16_pivot(const EchelonGF16* e, uint32_t i) {
+    assert(i < e->rank);
+    return e->piv[i];
+}
+
+/* usage: Reduce a vector by the rows collected so far. If the result is
+ *      non-zero at any column that can be a pivot, it's appended as a new row
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) v: the vector as an array of ncol gf16_t
+ * return: true if the vector increases the rank, false otherwise */
+bool
+echelon_gf16_insert(EchelonGF16* restrict e, const gf16_t* restrict v) {
+    gf16_t* dst = echelon_gf16_raddr(e, e->rank);
+    memcpy(dst, v, sizeof(gf16_t) * e->ncol);
+    memset(dst + e->ncol, 0x0, sizeof(gf16_t) * (e->stride - e->ncol));
+
+    // the i-th row is zero at the pivots of the previous rows, so eliminating
+    // with the rows in order never brings back a cleared pivot
+    for(uint32_t i = 0; i < e->rank; ++i) {
+        gf16_t c = dst[e->piv[i]];
+        if(!c)
+            continue;
+        const gf16_t* src = echelon_gf16_raddr(e, i);
+        for(uint32_t j = 0; j < e->stride; j += 64)
+            gf16_t_arr_fmsubi_scalar64(dst + j, src + j, c);
+    }
+
+    uint32_t p = e->cstart;
+    while(p < e->ncol && !dst[p])
+        ++p;
+    if(p == e->ncol)
+        return false;
+
+    // normalize the pivot to 1
+    gf16_t inv = gf16_t_inv(dst[p]);
+    for(uint32_t j = 0; j < e->stride; j += 64)
+        gf16_t_arr_muli_scalar64(dst + j, inv);
+    e->piv[e->rank++] = p;
+    return true;
+}
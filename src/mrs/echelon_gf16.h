@@ -0,0 +1,85 @@
+#ifndef __ECHELON_GF16_H__
+#define __ECHELON_GF16_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gf16.h"
+
+// incrementally maintained row echelon form over GF(16). Vectors are inserted
+// one at a time and reduced by the rows collected so far, so a vector that is
+// linearly dependent on them is identified immediately. The first few columns
+// can be excluded from pivoting, e.g. the constant column of a linear system.
+
+typedef struct EchelonGF16 EchelonGF16;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Create a EchelonGF16 container with no rows
+ * params:
+ *      1) ncol: number of columns
+ *      2) cstart: index of the first column that can be a pivot. Must be
+ *              smaller than ncol
+ * return: a ptr to struct EchelonGF16. On failure, return NULL */
+EchelonGF16*
+echelon_gf16_create(uint32_t ncol, uint32_t cstart);
+
+/* usage: Release a struct EchelonGF16
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: void */
+void
+echelon_gf16_free(EchelonGF16* e);
+
+/* usage: Drop all the rows collected so far, e.g. to reuse the container for
+ *      another linear system of the same size
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: void */
+void
+echelon_gf16_reset(EchelonGF16* e);
+
+/* usage: return the number of rows collected so far, which is also the rank
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: the rank */
+uint32_t
+echelon_gf16_rank(const EchelonGF16* e);
+
+/* usage: return the max rank, i.e. number of columns that can be a pivot
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ * return: the max rank */
+uint32_t
+echelon_gf16_max_rank(const EchelonGF16* e);
+
+/* usage: return the selected row. The i-th row has its pivot normalized to 1,
+ *      and is zero at the pivots of the previous rows. After a failed
+ *      echelon_gf16_insert(), the row at index rank holds the reduced
+ *      candidate, whose pivot columns are all zero.
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) i: index of the row, no larger than the rank
+ * return: ptr to the row as an array of gf16_t */
+const gf16_t*
+echelon_gf16_row(const EchelonGF16* e, uint32_t i);
+
+/* usage: return the pivot column of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) i: index of the row, smaller than the rank
+ * return: index of the pivot column */
+uint32_t
+echelon_gf16_pivot(const EchelonGF16* e, uint32_t i);
+
+/* usage: Reduce a vector by the rows collected so far. If the result is
+ *      non-zero at any column that can be a pivot, it's appended as a new row
+ * params:
+ *      1) e: ptr to a struct EchelonGF16
+ *      2) v: the vector as an array of ncol gf16_t
+ * return: true if the vector increases the rank, false otherwise */
+bool
+echelon_gf16_insert(EchelonGF16* restrict e, const gf16_t* restrict v);
+
+#endif // __ECHELON_GF16_H__
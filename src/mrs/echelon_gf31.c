@@ -0,0 +1,185 @@
+#include "echelon_gf31.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/* ========================================================================
+ * struct EchelonGF31 definition
+ * ======================================================================== */
+
+struct EchelonGF31 {
+    uint32_t ncol;
+    uint32_t cstart; // first column that can be a pivot
+    uint32_t stride; // ncol rounded up to a multiple of 64
+    uint32_t rank;
+    uint32_t* piv; // pivot column of each row
+    gf31_t* rows; // max rank + 1 rows, the last of which is for reduction
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Create a EchelonGF31 container with no rows
+ * params:
+ *      1) ncol: number of columns
+ *      2) cstart: index of the first column that can be a pivot. Must be
+ *              smaller than ncol
+ * return: a ptr to struct EchelonGF31. On failure, return NULL */
+EchelonGF31*
+echelon_gf31_create(uint32_t ncol, uint32_t cstart) {
+    assert(cstart < ncol);
+    EchelonGF31* e = malloc(sizeof(EchelonGF31));
+    if(!e)
+        return NULL;
+    e->ncol = ncol;
+    e->cstart = cstart;
+    e->stride = (ncol + 63) & ~0x3FU;
+    e->rank = 0;
+    e->piv = malloc(sizeof(uint32_t) * (ncol - cstart));
+    e->rows = aligned_alloc(64, sizeof(gf31_t) * e->stride * (ncol - cstart + 1));
+    if(!e->piv || !e->rows) {
+        echelon_gf31_free(e);
+        return NULL;
+    }
+    return e;
+}
+
+/* usage: Release a struct EchelonGF31
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: void */
+void
+echelon_gf31_free(EchelonGF31* e) {
+    if(!e)
+        return;
+    free(e->piv);
+    free(e->rows);
+    free(e);
+}
+
+/* usage: Drop all the rows collected so far, e.g. to reuse the container for
+ *      another linear system of the same size
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: void */
+void
+echelon_gf31_reset(EchelonGF31* e) {
+    e->rank = 0;
+}
+
+/* usage: return the number of rows collected so far, which is also the rank
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: the rank */
+uint32_t
+echelon_gf31_rank(const EchelonGF31* e) {
+    return e->rank;
+}
+
+/* usage: return the max rank, i.e. number of columns that can be a pivot
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: the max rank */
+uint32_t
+echelon_gf31_max_rank(const EchelonGF31* e) {
+    return e->ncol - e->cstart;
+}
+
+/* usage: return the addr of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) i: index of the row
+ * return: ptr to the row as an array of gf31_t */
+static inline gf31_t*
+echelon_gf31_raddr(const EchelonGF31* e, uint32_t i) {
+    return e->rows + (uint64_t) e->stride * i;
+}
+
+/* usage: return the selected row. The i-th row has its pivot normalized to 1,
+ *      and is zero at the pivots of the previous rows. After a failed
+ *      echelon_gf31_insert(), the row at index rank holds the reduced
+ *      candidate, whose pivot columns are all zero.
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) i: index of the row, no larger than the rank
+ * return: ptr to the row as an array of gf31_t */
+const gf31_t*
+echelon_gf31_row(const EchelonGF31* e, uint32_t i) {
+    assert(i <= e->rank);
+    return echelon_gf31_raddr(e, i);
+}
+
+/* usage: return the pivot column of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) i: index of the row, smaller than the rank
+ * return: index of the pivot column */
+uint32_t
+echelon_gf31_pivot(const EchelonGF31* e, uint32_t i) {
+    assert(i < e->rank);
+    return e->piv[i];
+}
+
+/* usage: Reduce a vector by the rows collected so far. If the result is
+ *      non-zero at any column that can be a pivot, it's appended as a new row
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) v: the vector as an array of ncol gf31_t
+ * return: true if the vector increases the rank, false otherwise */
+bool
+echelon_gf31_insert(EchelonGF31* restrict e, const gf31_t* restrict v) {
+    gf31_t* dst = echelon_gf31_raddr(e, e->rank);
+    memcpy(dst, v, sizeof(gf31_t) * e->ncol);
+    memset(dst + e->ncol, 0x0, sizeof(gf31_t) * (e->stride - e->ncol));
+
+    // the i-th row is zero at the pivots of the previous rows, so eliminating
+    // with the rows in order never brings back a cleared pivot
+    for(uint32_t i = 0; i < e->rank; ++i) {
+        gf31_t c = dst[e->piv[i]];
+        if(!c)
+            continue;
+        const gf31_t* src = echelon_gf31_raddr(e, i);
+        for(uint32_t j = 0; j < e->stride; j += 64)
+            gf31_t_arr_fmsubi_scalar64(dst + j, src + j, c);
+    }
+
+    uint32_t p = e->cstart;
+    while(p < e->ncol && !dst[p])
+        ++p;
+    if(p == e->ncol)
+        return false;
+
+    // normalize the pivot to 1
+    gf31_t inv = gf31_t_inv(dst[p]);
+    for(uint32_t j = 0; j < e->stride; j += 64)
+        gf31_t_arr_muli_scalar64(dst + j, inv);
+    e->piv[e->rank++] = p;
+    return true;
+}
+
+/* usage: Given a EchelonGF31 of full rank whose column 0 holds the constant
+ *      terms of a linear system, i.e. created with cstart = 1, solve the
+ *      system by back substitution
+ * params:
+ *      1) e: ptr to a struct EchelonGF31, whose rank equals the max rank
+ *      2) x: container for the solution, an array of ncol - 1 gf31_t. The
+ *          value of the variable of column j is stored at index j - 1
+ * return: void */
+void
+echelon_gf31_solve(const EchelonGF31* restrict e, gf31_t* restrict x) {
+    assert(e->cstart == 1 && e->rank == echelon_gf31_max_rank(e));
+    // every variable is a pivot, and the i-th row is zero at the pivots of
+    // the previous rows, so it only involves the pivots of the later rows
+    for(uint32_t i = e->rank; i-- > 0; ) {
+        const gf31_t* row = echelon_gf31_raddr(e, i);
+        const uint32_t p = e->piv[i];
+        gf31_t sum = row[0];
+        for(uint32_t j = 1; j < e->ncol; ++j) {
+            if(j != p && row[j])
+                sum = gf31_t_add(sum, gf31_t_mul(row[j], x[j-1]));
+        }
+        x[p-1] = gf31_t_neg(sum);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef __ECHELON_GF31_H__
+#define __ECHELON_GF31_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gf31.h"
+
+// incrementally maintained row echelon form over GF(31). Vectors are inserted
+// one at a time and reduced by the rows collected so far, so a vector that is
+// linearly dependent on them is identified immediately. The first few columns
+// can be excluded from pivoting, e.g. the constant column of a linear system.
+
+typedef struct EchelonGF31 EchelonGF31;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Create a EchelonGF31 container with no rows
+ * params:
+ *      1) ncol: number of columns
+ *      2) cstart: index of the first column that can be a pivot. Must be
+ *              smaller than ncol
+ * return: a ptr to struct EchelonGF31. On failure, return NULL */
+EchelonGF31*
+echelon_gf31_create(uint32_t ncol, uint32_t cstart);
+
+/* usage: Release a struct EchelonGF31
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: void */
+void
+echelon_gf31_free(EchelonGF31* e);
+
+/* usage: Drop all the rows collected so far, e.g. to reuse the container for
+ *      another linear system of the same size
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: void */
+void
+echelon_gf31_reset(EchelonGF31* e);
+
+/* usage: return the number of rows collected so far, which is also the rank
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: the rank */
+uint32_t
+echelon_gf31_rank(const EchelonGF31* e);
+
+/* usage: return the max rank, i.e. number of columns that can be a pivot
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ * return: the max rank */
+uint32_t
+echelon_gf31_max_rank(const EchelonGF31* e);
+
+/* usage: return the selected row. The i-th row has its pivot normalized to 1,
+ *      and is zero at the pivots of the previous rows. After a failed
+ *      echelon_gf31_insert(), the row at index rank holds the reduced
+ *      candidate, whose pivot columns are all zero.
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) i: index of the row, no larger than the rank
+ * return: ptr to the row as an array of gf31_t */
+const gf31_t*
+echelon_gf31_row(const EchelonGF31* e, uint32_t i);
+
+/* usage: return the pivot column of the selected row
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) i: index of the row, smaller than the rank
+ * return: index of the pivot column */
+uint32_t
+echelon_gf31_pivot(const EchelonGF31* e, uint32_t i);
+
+/* usage: Reduce a vector by the rows collected so far. If the result is
+ *      non-zero at any column that can be a pivot, it's appended as a new row
+ * params:
+ *      1) e: ptr to a struct EchelonGF31
+ *      2) v: the vector as an array of ncol gf31_t
+ * return: true if the vector increases the rank, false otherwise */
+bool
+echelon_gf31_insert(EchelonGF31* restrict e, const gf31_t* restrict v);
+
+/* usage: Given a EchelonGF31 of full rank whose column 0 holds the constant
+ *      terms of a linear system, i.e. created with cstart = 1, solve the
+ *      system by back substitution
+ * params:
+ *      1) e: ptr to a struct EchelonGF31, whose rank equals the max rank
+ *      2) x: container for the solution, an array of ncol - 1 gf31_t. The
+ *          value of the variable of column j is stored at index j - 1
+ * return: void */
+void
+echelon_gf31_solve(const EchelonGF31* restrict e, gf31_t* restrict x);
+
+#endif // __ECHELON_GF31_H__
@@ -14,6 +14,27 @@
 // NOTE: 0 has no inverse
 gf16_t gf16_t_inv_table[16] = {0x0, 0x1, 0x9, 0xE, 0xD, 0xB, 0x7, 0x6, 0xF, 0x2, 0xC, 0x5, 0xA, 0x4, 0x3, 0x8};
 
+// row i of the matrix of c, i.e. bit i of the product, is byte 7 - i
+const uint64_t gf16_gfni_mat[16] = {
+    0x0000000000000000ULL, 0x0102040800000000ULL, 0x0809020400000000ULL,
+    0x090B060C00000000ULL, 0x040C090200000000ULL, 0x050E0D0A00000000ULL,
+    0x0C050B0600000000ULL, 0x0D070F0E00000000ULL, 0x02060C0900000000ULL,
+    0x0304080100000000ULL, 0x0A0F0E0D00000000ULL, 0x0B0D0A0500000000ULL,
+    0x060A050B00000000ULL, 0x0708010300000000ULL, 0x0E03070F00000000ULL,
+    0x0F01030700000000ULL,
+};
+
+// row 2j + h, i.e. bit j of the elements in byte h, is byte 2j + h, and the
+// bit 7 - r of a row selects row r of the transposed lane
+const uint64_t gf16_gfni_bs_mat[16] = {
+    0x0000000000000000ULL, 0x0102040810204080ULL, 0x0408102041820102ULL,
+    0x050A142851A24182ULL, 0x10204182050A0408ULL, 0x1122458A152A4488ULL,
+    0x142851A24488050AULL, 0x152A55AA54A8458AULL, 0x4182050A14281020ULL,
+    0x40800102040850A0ULL, 0x458A152A55AA1122ULL, 0x44881122458A51A2ULL,
+    0x51A2448811221428ULL, 0x50A04080010254A8ULL, 0x55AA54A850A0152AULL,
+    0x54A850A0408055AAULL,
+};
+
 gf16_t
 gf16_t_reduc_7b(uint8_t v) {
     assert( !(v & 0x80U) );
@@ -356,6 +377,9 @@ static force_inline void
 gf16_t_arr_muli_scalar64_reg_avx512(__m512i* restrict dst,
                                     const gf16_t* restrict arr, gf16_t x) {
     __m512i v = _mm512_loadu_si512(arr);
+#if defined(__GFNI__)
+    *dst = _mm512_gf2p8affine_epi64_epi8(v, _mm512_set1_epi64(gf16_gfni_mat[x]), 0);
+#else
     uint8_t sbidxs[4];
     uint32_t sbnum = sbidx_in_4b(sbidxs, x);
     assert(sbnum >= 1);
@@ -389,6 +413,7 @@ gf16_t_arr_muli_scalar64_reg_avx512(__m512i* restrict dst,
     p = _mm512_mask_blend_epi8(mask, p, _mm512_xor_si512(p, v_gf_5b));
 
     *dst = p;
+#endif
 }
 
 static force_inline void
@@ -405,7 +430,11 @@ gf16_t_arr_muli_scalar64_reg_avx2(__m256i* restrict high, __m256i* restrict low,
                                   const gf16_t* restrict arr, gf16_t x) {
     __m256i v0 = _mm256_loadu_si256((__m256i*) arr);
     __m256i v1 = _mm256_loadu_si256((__m256i*) (arr + 32));
-
+#if defined(__GFNI__)
+    __m256i mat = _mm256_set1_epi64x(gf16_gfni_mat[x]);
+    *low = _mm256_gf2p8affine_epi64_epi8(v0, mat, 0);
+    *high = _mm256_gf2p8affine_epi64_epi8(v1, mat, 0);
+#else
     __m256i vp0 = _mm256_setzero_si256();
     __m256i vp1 = _mm256_setzero_si256();
     uint8_t sbidxs[4];
@@ -534,6 +563,7 @@ gf16_t_arr_muli_scalar64_reg_avx2(__m256i* restrict high, __m256i* restrict low,
     mask1 = _mm256_cmpgt_epi8(vp1, threshold);
     *low = _mm256_xor_si256(vp0, _mm256_and_si256(v_gf16p, mask0));
     *high = _mm256_xor_si256(vp1, _mm256_and_si256(v_gf16p, mask1));
+#endif
 }
 
 
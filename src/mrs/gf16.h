@@ -14,6 +14,18 @@
 
 typedef uint8_t gf16_t;
 
+// Multiplication by a constant c of GF(16) is a 4x4 matrix over GF(2), so it
+// takes a single GF2P8AFFINEQB, which multiplies each byte by an 8x8 matrix
+// over GF(2). gf16_gfni_mat[c] is the matrix operand for 1 element per byte.
+// For the bitsliced groups, each 64-bit lane is first made of 2 bytes of each
+// bit plane and transposed with GF2P8AFFINEQB on GF16_GFNI_TRANSPOSE, after
+// which gf16_gfni_bs_mat[c] as the data operand applies the matrix of c to the
+// bit planes, see grp64_gf16.c. The tables are for x^4 + x + 1; the same
+// approach extends to GF(256) with full 8x8 matrices.
+#define GF16_GFNI_TRANSPOSE (0x0102040810204080ULL)
+extern const uint64_t gf16_gfni_mat[16];
+extern const uint64_t gf16_gfni_bs_mat[16];
+
 /* ========================================================================
  * function prototypes
  * ======================================================================== */
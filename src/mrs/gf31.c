@@ -1,4 +1,9 @@
 #include "gf31.h"
+#include <string.h> // memset
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
 
 // NOTE: 0 has no inverse
 gf31_t gf31_t_inv_table[31] = {
@@ -106,3 +111,307 @@ gf31_t_arr_zc(const gf31_t* a, uint32_t sz) {
     }
     return c;
 }
+
+/* ========================================================================
+ * arrays of 64 elements
+ * ======================================================================== */
+
+#if defined(__AVX512BW__)
+
+static inline __m512i
+gf31_reduc_avx512(__m512i x) {
+    // Barrett reduction: q underestimates x / 31 by at most 1, so r < 62
+    const __m512i p = _mm512_set1_epi16(GF31_SIZE);
+    __m512i q = _mm512_mulhi_epu16(x, _mm512_set1_epi16(GF31_BARRETT));
+    __m512i r = _mm512_sub_epi16(x, _mm512_mullo_epi16(q, p));
+    return _mm512_min_epu16(r, _mm512_sub_epi16(r, p));
+}
+
+static inline void
+gf31_widen_avx512(__m512i* restrict lo, __m512i* restrict hi, const void* a) {
+    __m512i v = _mm512_loadu_si512(a);
+    *lo = _mm512_cvtepu8_epi16(_mm512_castsi512_si256(v));
+    *hi = _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(v, 1));
+}
+
+static inline void
+gf31_narrow_avx512(void* a, __m512i lo, __m512i hi) {
+    __m512i v = _mm512_castsi256_si512(_mm512_cvtepi16_epi8(lo));
+    v = _mm512_inserti64x4(v, _mm512_cvtepi16_epi8(hi), 1);
+    _mm512_storeu_si512(a, v);
+}
+
+#elif defined(__AVX2__)
+
+static inline __m256i
+gf31_reduc_avx2(__m256i x) {
+    // Barrett reduction: q underestimates x / 31 by at most 1, so r < 62
+    const __m256i p = _mm256_set1_epi16(GF31_SIZE);
+    __m256i q = _mm256_mulhi_epu16(x, _mm256_set1_epi16(GF31_BARRETT));
+    __m256i r = _mm256_sub_epi16(x, _mm256_mullo_epi16(q, p));
+    return _mm256_min_epu16(r, _mm256_sub_epi16(r, p));
+}
+
+static inline void
+gf31_widen_avx2(__m256i* restrict w, const gf31_t* a) {
+    for(uint32_t i = 0; i < 4; ++i)
+        w[i] = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) (a + 16*i)));
+}
+
+static inline void
+gf31_narrow_avx2(gf31_t* a, const __m256i* w) {
+    // packus interleaves the 128-bit lanes of its operands
+    for(uint32_t i = 0; i < 2; ++i) {
+        __m256i v = _mm256_packus_epi16(w[2*i], w[2*i+1]);
+        v = _mm256_permute4x64_epi64(v, 0xD8);
+        _mm256_storeu_si256((__m256i*) (a + 32*i), v);
+    }
+}
+
+#endif
+
+void
+gf31_t_arr_addi_64(gf31_t* restrict a, const gf31_t* restrict b) {
+    // compute a += b, where a and b are arrays of 64 elements
+#if defined(__AVX512BW__)
+    const __m512i p = _mm512_set1_epi8(GF31_SIZE);
+    __m512i s = _mm512_add_epi8(_mm512_loadu_si512(a), _mm512_loadu_si512(b));
+    _mm512_storeu_si512(a, _mm512_min_epu8(s, _mm512_sub_epi8(s, p)));
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi8(GF31_SIZE);
+    for(uint32_t i = 0; i < 64; i += 32) {
+        __m256i s = _mm256_add_epi8(_mm256_loadu_si256((__m256i*) (a + i)),
+                                    _mm256_loadu_si256((__m256i*) (b + i)));
+        s = _mm256_min_epu8(s, _mm256_sub_epi8(s, p));
+        _mm256_storeu_si256((__m256i*) (a + i), s);
+    }
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        a[i] = gf31_t_add(a[i], b[i]);
+#endif
+}
+
+void
+gf31_t_arr_muli_scalar64(gf31_t* a, gf31_t x) {
+    // compute a *= x, where a is an array of 64 elements
+#if defined(__AVX512BW__)
+    const __m512i c = _mm512_set1_epi16(x);
+    __m512i lo, hi;
+    gf31_widen_avx512(&lo, &hi, a);
+    lo = gf31_reduc_avx512(_mm512_mullo_epi16(lo, c));
+    hi = gf31_reduc_avx512(_mm512_mullo_epi16(hi, c));
+    gf31_narrow_avx512(a, lo, hi);
+#elif defined(__AVX2__)
+    const __m256i c = _mm256_set1_epi16(x);
+    __m256i w[4];
+    gf31_widen_avx2(w, a);
+    for(uint32_t i = 0; i < 4; ++i)
+        w[i] = gf31_reduc_avx2(_mm256_mullo_epi16(w[i], c));
+    gf31_narrow_avx2(a, w);
+#else
+    gf31_t_arr_muli_scalar(a, 64, x);
+#endif
+}
+
+void
+gf31_t_arr_fmaddi_scalar64(gf31_t* restrict a, const gf31_t* restrict b,
+                           gf31_t c) {
+    // compute a += b * c, where a and b are arrays of 64 elements
+    if(!c)
+        return;
+#if defined(__AVX512BW__)
+    const __m512i vc = _mm512_set1_epi16(c);
+    __m512i alo, ahi, blo, bhi;
+    gf31_widen_avx512(&alo, &ahi, a);
+    gf31_widen_avx512(&blo, &bhi, b);
+    alo = gf31_reduc_avx512(_mm512_add_epi16(alo, _mm512_mullo_epi16(blo, vc)));
+    ahi = gf31_reduc_avx512(_mm512_add_epi16(ahi, _mm512_mullo_epi16(bhi, vc)));
+    gf31_narrow_avx512(a, alo, ahi);
+#elif defined(__AVX2__)
+    const __m256i vc = _mm256_set1_epi16(c);
+    __m256i wa[4], wb[4];
+    gf31_widen_avx2(wa, a);
+    gf31_widen_avx2(wb, b);
+    for(uint32_t i = 0; i < 4; ++i) {
+        wa[i] = _mm256_add_epi16(wa[i], _mm256_mullo_epi16(wb[i], vc));
+        wa[i] = gf31_reduc_avx2(wa[i]);
+    }
+    gf31_narrow_avx2(a, wa);
+#else
+    gf31_t_arr_fmaddi_scalar(a, b, 64, c);
+#endif
+}
+
+void
+gf31_t_arr_fmsubi_scalar64(gf31_t* restrict a, const gf31_t* restrict b,
+                           gf31_t c) {
+    // compute a -= b * c, where a and b are arrays of 64 elements
+    gf31_t_arr_fmaddi_scalar64(a, b, gf31_t_neg(c));
+}
+
+void
+gf31_t_arr_widen_64(uint16_t* restrict acc, const gf31_t* restrict a) {
+    // copy an array of 64 elements into 16-bit lanes
+    for(uint32_t i = 0; i < 64; ++i)
+        acc[i] = a[i];
+}
+
+void
+gf31_t_arr_acc_fmaddi_scalar64(uint16_t* restrict acc,
+                               const gf31_t* restrict b, gf31_t c) {
+    // compute acc += b * c without reduction, where acc is an array of 64
+    // accumulators and b an array of 64 elements
+    if(!c)
+        return;
+#if defined(__AVX512BW__)
+    const __m512i vc = _mm512_set1_epi16(c);
+    __m512i blo, bhi;
+    gf31_widen_avx512(&blo, &bhi, b);
+    __m512i lo = _mm512_loadu_si512(acc);
+    __m512i hi = _mm512_loadu_si512(acc + 32);
+    lo = _mm512_add_epi16(lo, _mm512_mullo_epi16(blo, vc));
+    hi = _mm512_add_epi16(hi, _mm512_mullo_epi16(bhi, vc));
+    _mm512_storeu_si512(acc, lo);
+    _mm512_storeu_si512(acc + 32, hi);
+#elif defined(__AVX2__)
+    const __m256i vc = _mm256_set1_epi16(c);
+    __m256i wb[4];
+    gf31_widen_avx2(wb, b);
+    for(uint32_t i = 0; i < 4; ++i) {
+        __m256i v = _mm256_loadu_si256((__m256i*) (acc + 16*i));
+        v = _mm256_add_epi16(v, _mm256_mullo_epi16(wb[i], vc));
+        _mm256_storeu_si256((__m256i*) (acc + 16*i), v);
+    }
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        acc[i] += (uint16_t) b[i] * c;
+#endif
+}
+
+void
+gf31_t_arr_acc_vec_mul64(uint16_t* restrict acc, const gf31_t* restrict x,
+                         const uint16_t* restrict m) {
+    // compute acc = x * m without reduction, where x is an array of 64
+    // elements and m a 64 x 64 matrix whose rows are widened to 16-bit lanes
+    // with gf31_t_arr_widen_64. The sum of 64 products can't overflow
+#if defined(__AVX512BW__)
+    __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+    for(uint32_t k = 0; k < 64; ++k) {
+        if(!x[k])
+            continue;
+        const __m512i c = _mm512_set1_epi16(x[k]);
+        lo = _mm512_add_epi16(lo, _mm512_mullo_epi16(c,
+                              _mm512_loadu_si512(m + 64*k)));
+        hi = _mm512_add_epi16(hi, _mm512_mullo_epi16(c,
+                              _mm512_loadu_si512(m + 64*k + 32)));
+    }
+    _mm512_storeu_si512(acc, lo);
+    _mm512_storeu_si512(acc + 32, hi);
+#elif defined(__AVX2__)
+    __m256i w[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(),
+                     _mm256_setzero_si256(), _mm256_setzero_si256() };
+    for(uint32_t k = 0; k < 64; ++k) {
+        if(!x[k])
+            continue;
+        const __m256i c = _mm256_set1_epi16(x[k]);
+        for(uint32_t i = 0; i < 4; ++i) {
+            __m256i r = _mm256_loadu_si256((__m256i*) (m + 64*k + 16*i));
+            w[i] = _mm256_add_epi16(w[i], _mm256_mullo_epi16(c, r));
+        }
+    }
+    for(uint32_t i = 0; i < 4; ++i)
+        _mm256_storeu_si256((__m256i*) (acc + 16*i), w[i]);
+#else
+    memset(acc, 0x0, sizeof(uint16_t) * 64);
+    for(uint32_t k = 0; k < 64; ++k) {
+        for(uint32_t i = 0; x[k] && i < 64; ++i)
+            acc[i] += x[k] * m[64*k + i];
+    }
+#endif
+}
+
+void
+gf31_t_arr_acc_reduc64(uint16_t* acc) {
+    // reduce an array of 64 accumulators in place
+#if defined(__AVX512BW__)
+    _mm512_storeu_si512(acc, gf31_reduc_avx512(_mm512_loadu_si512(acc)));
+    _mm512_storeu_si512(acc + 32,
+                        gf31_reduc_avx512(_mm512_loadu_si512(acc + 32)));
+#elif defined(__AVX2__)
+    for(uint32_t i = 0; i < 64; i += 16) {
+        __m256i v = _mm256_loadu_si256((__m256i*) (acc + i));
+        _mm256_storeu_si256((__m256i*) (acc + i), gf31_reduc_avx2(v));
+    }
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        acc[i] = gf31_t_reduc(acc[i]);
+#endif
+}
+
+void
+gf31_t_arr_from_acc64(gf31_t* restrict a, const uint16_t* restrict acc) {
+    // store an array of 64 accumulators, reduced, into an array of elements
+#if defined(__AVX512BW__)
+    gf31_narrow_avx512(a, gf31_reduc_avx512(_mm512_loadu_si512(acc)),
+                       gf31_reduc_avx512(_mm512_loadu_si512(acc + 32)));
+#elif defined(__AVX2__)
+    __m256i w[4];
+    for(uint32_t i = 0; i < 4; ++i)
+        w[i] = gf31_reduc_avx2(_mm256_loadu_si256((__m256i*) (acc + 16*i)));
+    gf31_narrow_avx2(a, w);
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        a[i] = gf31_t_reduc(acc[i]);
+#endif
+}
+
+void
+gf31_t_arr_addi_acc64(gf31_t* restrict a, const uint16_t* restrict acc) {
+    // compute a += acc, where acc is an array of 64 accumulators
+#if defined(__AVX512BW__)
+    __m512i lo, hi;
+    gf31_widen_avx512(&lo, &hi, a);
+    lo = _mm512_add_epi16(lo, gf31_reduc_avx512(_mm512_loadu_si512(acc)));
+    hi = _mm512_add_epi16(hi, gf31_reduc_avx512(_mm512_loadu_si512(acc + 32)));
+    gf31_narrow_avx512(a, gf31_reduc_avx512(lo), gf31_reduc_avx512(hi));
+#elif defined(__AVX2__)
+    __m256i w[4];
+    gf31_widen_avx2(w, a);
+    for(uint32_t i = 0; i < 4; ++i) {
+        __m256i v = gf31_reduc_avx2(_mm256_loadu_si256((__m256i*) (acc + 16*i)));
+        w[i] = gf31_reduc_avx2(_mm256_add_epi16(w[i], v));
+    }
+    gf31_narrow_avx2(a, w);
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        a[i] = gf31_t_add(a[i], gf31_t_reduc(acc[i]));
+#endif
+}
+
+void
+gf31_t_arr_subi_acc64(gf31_t* restrict a, const uint16_t* restrict acc) {
+    // compute a -= acc, where acc is an array of 64 accumulators. The
+    // modulus is added first so the difference never goes negative
+#if defined(__AVX512BW__)
+    const __m512i p = _mm512_set1_epi16(GF31_SIZE);
+    __m512i lo, hi;
+    gf31_widen_avx512(&lo, &hi, a);
+    lo = _mm512_sub_epi16(_mm512_add_epi16(lo, p),
+                          gf31_reduc_avx512(_mm512_loadu_si512(acc)));
+    hi = _mm512_sub_epi16(_mm512_add_epi16(hi, p),
+                          gf31_reduc_avx512(_mm512_loadu_si512(acc + 32)));
+    gf31_narrow_avx512(a, gf31_reduc_avx512(lo), gf31_reduc_avx512(hi));
+#elif defined(__AVX2__)
+    const __m256i p = _mm256_set1_epi16(GF31_SIZE);
+    __m256i w[4];
+    gf31_widen_avx2(w, a);
+    for(uint32_t i = 0; i < 4; ++i) {
+        __m256i v = gf31_reduc_avx2(_mm256_loadu_si256((__m256i*) (acc + 16*i)));
+        w[i] = gf31_reduc_avx2(_mm256_sub_epi16(_mm256_add_epi16(w[i], p), v));
+    }
+    gf31_narrow_avx2(a, w);
+#else
+    for(uint32_t i = 0; i < 64; ++i)
+        a[i] = gf31_t_sub(a[i], gf31_t_reduc(acc[i]));
+#endif
+}
@@ -8,6 +8,12 @@
 
 #define GF31_MIN (0)
 #define GF31_MAX (30)
+#define GF31_SIZE (31)
+// floor(2^16 / 31), for the Barrett reduction of 16-bit lanes
+#define GF31_BARRETT (2114)
+// number of products of 2 elements that can be accumulated into a 16-bit
+// lane holding a reduced element: 64 * 30^2 + 30 < 2^16
+#define GF31_ACC_TERMS (64)
 
 typedef uint8_t gf31_t;
 
@@ -85,10 +91,15 @@ gf31_t_mul(const gf31_t a, const gf31_t b) {
     return gf31_t_reduc(p);
 }
 
+static inline gf31_t
+gf31_t_neg(const gf31_t a) {
+    return a ? GF31_SIZE - a : 0;
+}
+
 static inline gf31_t
 gf31_t_sub(const gf31_t a, const gf31_t b) {
-    // TODO: check what happens when the result is negative
-    return gf31_t_reduc(a - b);
+    // a - b is negative when b > a, so add the modulus first
+    return gf31_t_reduc(a + GF31_SIZE - b);
 }
 
 gf31_t
@@ -141,6 +152,48 @@ gf31_t_arr_nzc(const gf31_t* a, uint32_t sz);
 uint32_t
 gf31_t_arr_zc(const gf31_t* a, uint32_t sz);
 
+// The functions below work on arrays of 64 elements. Products are computed in
+// 16-bit lanes and reduced with a Barrett reduction. The ones on uint16_t
+// accumulators don't reduce, so that up to GF31_ACC_TERMS products can be
+// summed up before a reduction.
+
+void
+gf31_t_arr_addi_64(gf31_t* restrict a, const gf31_t* restrict b);
+
+void
+gf31_t_arr_muli_scalar64(gf31_t* a, gf31_t x);
+
+void
+gf31_t_arr_fmaddi_scalar64(gf31_t* restrict a, const gf31_t* restrict b,
+                           gf31_t c);
+
+void
+gf31_t_arr_fmsubi_scalar64(gf31_t* restrict a, const gf31_t* restrict b,
+                           gf31_t c);
+
+void
+gf31_t_arr_widen_64(uint16_t* restrict acc, const gf31_t* restrict a);
+
+void
+gf31_t_arr_acc_fmaddi_scalar64(uint16_t* restrict acc,
+                               const gf31_t* restrict b, gf31_t c);
+
+void
+gf31_t_arr_acc_vec_mul64(uint16_t* restrict acc, const gf31_t* restrict x,
+                         const uint16_t* restrict m);
+
+void
+gf31_t_arr_acc_reduc64(uint16_t* acc);
+
+void
+gf31_t_arr_from_acc64(gf31_t* restrict a, const uint16_t* restrict acc);
+
+void
+gf31_t_arr_addi_acc64(gf31_t* restrict a, const uint16_t* restrict acc);
+
+void
+gf31_t_arr_subi_acc64(gf31_t* restrict a, const uint16_t* restrict acc);
+
 // TODO: create versions of functions above that modify a in place
 
 #endif // __GF31_H__
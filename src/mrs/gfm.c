@@ -210,6 +210,16 @@ gfm_row_addr(const GFM* m, uint64_t ri) {
     return bytearray_addr_at(m->rows, offset);
 }
 
+/* usage: Given a struct GFM, return its memory block, which stores the rows
+ *      consecutively
+ * params:
+ *      1) m: ptr to struct GFM
+ * return: ptr to the first row */
+gf_t*
+gfm_memblk(GFM* m) {
+    return (gf_t*) bytearray_memblk(m->rows);
+}
+
 /* usage: Given a struct GFM and an array of gf_t, copy the array into the i-th
  *      row of the GFM
  * params:
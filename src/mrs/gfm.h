@@ -107,6 +107,14 @@ gfm_ncol(const GFM* m);
 const gf_t*
 gfm_row_addr(const GFM* m, uint64_t ri);
 
+/* usage: Given a struct GFM, return its memory block, which stores the rows
+ *      consecutively
+ * params:
+ *      1) m: ptr to struct GFM
+ * return: ptr to the first row */
+gf_t*
+gfm_memblk(GFM* m);
+
 /* usage: Given a struct GFM and an array of gf_t, copy the array into the i-th
  *      row of the GFM
  * params:
@@ -396,19 +396,58 @@ grp128_gf16_scalar_reg_avx512(const __m512i v, __mmask8 m0, __mmask8 m1,
     return s0;
 }
 
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+
+/* usage: given a struct Grp128GF16 stored as a 512-bit ZMM register and a
+ *      gf16_t scalar c, compute the product with GFNI. See
+ *      grp64_gf16_mul_scalar_reg_gfni for the layout of the 64-bit lanes
+ * params:
+ *      1) v: a 512-bit ZMM register which stores the struct Grp128GF16
+ *      2) c: the scalar multiplier
+ * return: the product as a 512-bit ZMM register */
+static force_inline __m512i
+grp128_gf16_scalar_reg_gfni(const __m512i v, gf16_t c) {
+    // lane q gets bytes 2q and 2q + 1 of the 4 bit planes
+    const __m512i idx = _mm512_set_epi8(
+        63, 62, 47, 46, 31, 30, 15, 14, 61, 60, 45, 44, 29, 28, 13, 12,
+        59, 58, 43, 42, 27, 26, 11, 10, 57, 56, 41, 40, 25, 24,  9,  8,
+        55, 54, 39, 38, 23, 22,  7,  6, 53, 52, 37, 36, 21, 20,  5,  4,
+        51, 50, 35, 34, 19, 18,  3,  2, 49, 48, 33, 32, 17, 16,  1,  0);
+    const __m512i idx_inv = _mm512_set_epi8(
+        63, 62, 55, 54, 47, 46, 39, 38, 31, 30, 23, 22, 15, 14,  7,  6,
+        61, 60, 53, 52, 45, 44, 37, 36, 29, 28, 21, 20, 13, 12,  5,  4,
+        59, 58, 51, 50, 43, 42, 35, 34, 27, 26, 19, 18, 11, 10,  3,  2,
+        57, 56, 49, 48, 41, 40, 33, 32, 25, 24, 17, 16,  9,  8,  1,  0);
+    __m512i x = _mm512_permutexvar_epi8(idx, v);
+    x = _mm512_gf2p8affine_epi64_epi8(
+        _mm512_set1_epi64(GF16_GFNI_TRANSPOSE), x, 0);
+    x = _mm512_gf2p8affine_epi64_epi8(_mm512_set1_epi64(gf16_gfni_bs_mat[c]),
+                                      x, 0);
+    return _mm512_permutexvar_epi8(idx_inv, x);
+}
+
+#endif
+
 static force_inline __m512i
 grp128_gf16_mul_scalar_const_avx512(const Grp128GF16* src, gf16_t c) {
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    return grp128_gf16_scalar_reg_gfni(_mm512_load_si512(src->b), c);
+#else
     uint8_t m0 = uint8_extend_from_lsb(c & 0x1U); // LSB
     uint8_t m1 = uint8_extend_from_lsb((c >> 1) & 0x1U); // 2nd LSB
     uint8_t m2 = uint8_extend_from_lsb((c >> 2) & 0x1U); // 3rd LSB
     uint8_t m3 = uint8_extend_from_lsb(c >> 3); // 4th LSB
     __m512i v = _mm512_load_si512(src->b);
     return grp128_gf16_scalar_reg_avx512(v, m0, m1, m2, m3);
+#endif
 }
 
 __m512i
 grp128_gf16_mul_scalar_bs_avx512(const __m512i v, const Grp128GF16* g,
                                  uint32_t i) {
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    return grp128_gf16_scalar_reg_gfni(v, grp128_gf16_at(g, i));
+#else
     // NOTE: slower
 //    __m512i vg = _mm512_load_si512(g);
 //    __m512i lsb_ext = _mm512_set1_epi64(0x1);
@@ -425,6 +464,7 @@ grp128_gf16_mul_scalar_bs_avx512(const __m512i v, const Grp128GF16* g,
     uint8_t m2 = uint8_extend_from_lsb(uint128_t_at(g->b + 2, i));
     uint8_t m3 = uint8_extend_from_lsb(uint128_t_at(g->b + 3, i));
     return grp128_gf16_scalar_reg_avx512(v, m0, m1, m2, m3);
+#endif
 }
 
 #elif defined(__AVX2__)
@@ -296,6 +296,85 @@ grp64_gf16_subi(Grp64GF16* restrict a, const Grp64GF16* restrict b) {
     grp64_gf16_addi(a, b);
 }
 
+#if defined(__GFNI__) && defined(__AVX2__)
+
+// The bitsliced multiplication with GF2P8AFFINEQB, see gf16.h. Each 64-bit lane
+// q of the groups is made of bytes 2q and 2q + 1 of the 4 bit planes, so that
+// its 8x8 bit transpose holds 2 elements per byte. The product of the matrix
+// of the scalar and the transpose is then computed with the transpose as the
+// matrix operand, which brings the bit planes back at the same time.
+
+static force_inline __m256i
+grp64_gf16_gfni_mul_lanes_avx2(const __m256i x, gf16_t c) {
+    __m256i t = _mm256_gf2p8affine_epi64_epi8(
+        _mm256_set1_epi64x(GF16_GFNI_TRANSPOSE), x, 0);
+    return _mm256_gf2p8affine_epi64_epi8(
+        _mm256_set1_epi64x(gf16_gfni_bs_mat[c]), t, 0);
+}
+
+/* usage: given a struct Grp64GF16 stored as a 256-bit YMM register and a
+ *      gf16_t scalar c, compute the product with GFNI
+ * params:
+ *      1) v: a 256-bit YMM register which stores the struct Grp64GF16
+ *      2) c: the scalar multiplier
+ * return: the product as a 256-bit YMM register */
+static force_inline __m256i
+grp64_gf16_mul_scalar_reg_gfni(const __m256i v, gf16_t c) {
+#if defined(__AVX512VBMI__) && defined(__AVX512VL__)
+    // the permutation is an involution
+    const __m256i idx = _mm256_setr_epi8(
+        0, 1,  8,  9, 16, 17, 24, 25,  2,  3, 10, 11, 18, 19, 26, 27,
+        4, 5, 12, 13, 20, 21, 28, 29,  6,  7, 14, 15, 22, 23, 30, 31);
+    __m256i x = _mm256_permutexvar_epi8(idx, v);
+    x = grp64_gf16_gfni_mul_lanes_avx2(x, c);
+    return _mm256_permutexvar_epi8(idx, x);
+#else
+    // interleave 2 bytes of the 2 planes in each 128-bit lane, then pair the
+    // 32-bit words of the 2 lanes
+    const __m256i s = _mm256_setr_epi8(
+        0, 1,  8,  9,  2,  3, 10, 11,  4,  5, 12, 13,  6,  7, 14, 15,
+        0, 1,  8,  9,  2,  3, 10, 11,  4,  5, 12, 13,  6,  7, 14, 15);
+    const __m256i sinv = _mm256_setr_epi8(
+        0, 1,  4,  5,  8,  9, 12, 13,  2,  3,  6,  7, 10, 11, 14, 15,
+        0, 1,  4,  5,  8,  9, 12, 13,  2,  3,  6,  7, 10, 11, 14, 15);
+    __m256i x = _mm256_shuffle_epi8(v, s);
+    x = _mm256_shuffle_epi32(_mm256_permute4x64_epi64(x, 0xD8), 0xD8);
+    x = grp64_gf16_gfni_mul_lanes_avx2(x, c);
+    x = _mm256_permute4x64_epi64(_mm256_shuffle_epi32(x, 0xD8), 0xD8);
+    return _mm256_shuffle_epi8(x, sinv);
+#endif
+}
+
+#endif
+
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+
+/* usage: given 2 struct Grp64GF16 stored as a 512-bit ZMM register and 2
+ *      gf16_t scalars c0, c1, multiply the lower struct by c0 and the upper
+ *      one by c1 with GFNI
+ * params:
+ *      1) v: a 512-bit ZMM register which stores the 2 struct Grp64GF16
+ *      2) c0: the scalar multiplier of the lower struct
+ *      3) c1: the scalar multiplier of the upper struct
+ * return: the products as a 512-bit ZMM register */
+static force_inline __m512i
+grp64_gf16_mul_scalar_reg_gfni_x2(const __m512i v, gf16_t c0, gf16_t c1) {
+    const __m512i idx = _mm512_set_epi8(
+        63, 62, 55, 54, 47, 46, 39, 38, 61, 60, 53, 52, 45, 44, 37, 36,
+        59, 58, 51, 50, 43, 42, 35, 34, 57, 56, 49, 48, 41, 40, 33, 32,
+        31, 30, 23, 22, 15, 14,  7,  6, 29, 28, 21, 20, 13, 12,  5,  4,
+        27, 26, 19, 18, 11, 10,  3,  2, 25, 24, 17, 16,  9,  8,  1,  0);
+    __m512i x = _mm512_permutexvar_epi8(idx, v);
+    x = _mm512_gf2p8affine_epi64_epi8(
+        _mm512_set1_epi64(GF16_GFNI_TRANSPOSE), x, 0);
+    __m512i mat = _mm512_mask_set1_epi64(_mm512_set1_epi64(gf16_gfni_bs_mat[c0]),
+                                         0xF0, gf16_gfni_bs_mat[c1]);
+    x = _mm512_gf2p8affine_epi64_epi8(mat, x, 0);
+    return _mm512_permutexvar_epi8(idx, x);
+}
+
+#endif
+
 #if defined(__AVX512F__)
 
 static force_inline __m512i
@@ -366,11 +445,18 @@ grp64_gf16_mul_scalar_from_bs_adj_avx512(__m256i* restrict v0,
                                          const Grp64GF16* restrict g,
                                          uint32_t i) {
     __m512i v = _mm512_load_si512(src);
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    __m512i res = grp64_gf16_mul_scalar_reg_gfni_x2(v, grp64_gf16_at(g, i),
+                                                    grp64_gf16_at(g, i + 1));
+    *v1 = _mm512_extracti64x4_epi64(res, 1);
+    *v0 = _mm512_extracti64x4_epi64(res, 0);
+#else
     __mmask8 m0 = mmask_from_2b((g->b[0] >> i) & 0x3U);
     __mmask8 m1 = mmask_from_2b((g->b[1] >> i) & 0x3U);
     __mmask8 m2 = mmask_from_2b((g->b[2] >> i) & 0x3U);
     __mmask8 m3 = mmask_from_2b((g->b[3] >> i) & 0x3U);
     grp64_gf16_mul_scalar_reg_avx512(v0, v1, v, m0, m1, m2, m3);
+#endif
 }
 
 __m512i
@@ -378,11 +464,16 @@ grp64_gf16_mul_scalar_from_bs_adj_avx512_no_split(const Grp64GF16* restrict src,
                                                   const Grp64GF16* restrict g,
                                                   uint32_t i) {
     __m512i v = _mm512_load_si512(src);
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    return grp64_gf16_mul_scalar_reg_gfni_x2(v, grp64_gf16_at(g, i),
+                                             grp64_gf16_at(g, i + 1));
+#else
     __mmask8 m0 = mmask_from_2b((g->b[0] >> i) & 0x3U);
     __mmask8 m1 = mmask_from_2b((g->b[1] >> i) & 0x3U);
     __mmask8 m2 = mmask_from_2b((g->b[2] >> i) & 0x3U);
     __mmask8 m3 = mmask_from_2b((g->b[3] >> i) & 0x3U);
     return grp64_gf16_mul_scalar_reg_avx512_no_split(v, m0, m1, m2, m3);
+#endif
 }
 
 void
@@ -394,11 +485,18 @@ grp64_gf16_muli_scalar_from_bs_2x1_avx512(__m256i* restrict v0,
                                           uint32_t i) {
     __m512i vlo = _mm512_castsi256_si512(_mm256_load_si256((__m256i*) src0));
     __m512i v = _mm512_inserti32x8(vlo, _mm256_load_si256((__m256i*) src1), 1);
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    const gf16_t c = grp64_gf16_at(g, i);
+    __m512i res = grp64_gf16_mul_scalar_reg_gfni_x2(v, c, c);
+    *v1 = _mm512_extracti64x4_epi64(res, 1);
+    *v0 = _mm512_extracti64x4_epi64(res, 0);
+#else
     uint8_t m0 = uint8_extend_from_lsb((g->b[0] >> i) & 0x1U); // LSB
     uint8_t m1 = uint8_extend_from_lsb((g->b[1] >> i) & 0x1U); // 2nd LSB
     uint8_t m2 = uint8_extend_from_lsb((g->b[2] >> i) & 0x1U); // 3rd LSB
     uint8_t m3 = uint8_extend_from_lsb((g->b[3] >> i) & 0x1U); // 4th LSB
     grp64_gf16_mul_scalar_reg_avx512(v0, v1, v, m0, m1, m2, m3);
+#endif
 }
 
 static force_inline void
@@ -409,11 +507,17 @@ grp64_gf16_mul_scalar_reg_from_coeff_2x2(__m256i* restrict v0,
                                          gf16_t c0, gf16_t c1) {
     __m512i vlo = _mm512_castsi256_si512(_mm256_load_si256((__m256i*) src0));
     __m512i v = _mm512_inserti32x8(vlo, _mm256_load_si256((__m256i*) src1), 1);
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    __m512i res = grp64_gf16_mul_scalar_reg_gfni_x2(v, c0, c1);
+    *v1 = _mm512_extracti64x4_epi64(res, 1);
+    *v0 = _mm512_extracti64x4_epi64(res, 0);
+#else
     __mmask8 m0 = mmask_from_2b( (c0 & 0x1U) | ((c1 & 0x1U) << 1 ));
     __mmask8 m1 = mmask_from_2b( ((c0 & 0x2U) >> 1) | (c1 & 0x2U) );
     __mmask8 m2 = mmask_from_2b( ((c0 & 0x4U) >> 2) | ((c1 & 0x4U) >> 1) );
     __mmask8 m3 = mmask_from_2b( ((c0 & 0x8U) >> 3) | ((c1 & 0x8U) >> 2) );
     grp64_gf16_mul_scalar_reg_avx512(v0, v1, v, m0, m1, m2, m3);
+#endif
 }
 
 static force_inline void
@@ -423,11 +527,17 @@ grp64_gf16_mul_scalar_reg_from_coeff_2x1(__m256i* restrict v0,
                                          const Grp64GF16* src1, gf16_t c) {
     __m512i vlo = _mm512_castsi256_si512(_mm256_load_si256((__m256i*) src0));
     __m512i v = _mm512_inserti32x8(vlo, _mm256_load_si256((__m256i*) src1), 1);
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    __m512i res = grp64_gf16_mul_scalar_reg_gfni_x2(v, c, c);
+    *v1 = _mm512_extracti64x4_epi64(res, 1);
+    *v0 = _mm512_extracti64x4_epi64(res, 0);
+#else
     uint8_t m0 = uint8_extend_from_lsb(c & 0x1U); // LSB
     uint8_t m1 = uint8_extend_from_lsb((c >> 1) & 0x1U); // 2nd LSB
     uint8_t m2 = uint8_extend_from_lsb((c >> 2) & 0x1U); // 3rd LSB
     uint8_t m3 = uint8_extend_from_lsb(c >> 3); // 4th LSB
     grp64_gf16_mul_scalar_reg_avx512(v0, v1, v, m0, m1, m2, m3);
+#endif
 }
 
 static force_inline void
@@ -436,11 +546,17 @@ grp64_gf16_mul_scalar_reg_from_coeff_1x2(__m256i* restrict v0,
                                          const Grp64GF16* src,
                                          gf16_t c0, gf16_t c1) {
     __m512i v = _mm512_broadcast_i64x4(_mm256_load_si256((__m256i*)src));
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    __m512i res = grp64_gf16_mul_scalar_reg_gfni_x2(v, c0, c1);
+    *v1 = _mm512_extracti64x4_epi64(res, 1);
+    *v0 = _mm512_extracti64x4_epi64(res, 0);
+#else
     __mmask8 m0 = mmask_from_2b( (c0 & 0x1U) | ((c1 & 0x1U) << 1 ));
     __mmask8 m1 = mmask_from_2b( ((c0 & 0x2U) >> 1) | (c1 & 0x2U) );
     __mmask8 m2 = mmask_from_2b( ((c0 & 0x4U) >> 2) | ((c1 & 0x4U) >> 1) );
     __mmask8 m3 = mmask_from_2b( ((c0 & 0x8U) >> 3) | ((c1 & 0x8U) >> 2) );
     grp64_gf16_mul_scalar_reg_avx512(v0, v1, v, m0, m1, m2, m3);
+#endif
 }
 
 __m512i
@@ -448,11 +564,16 @@ grp64_gf16_mul_scalar_from_bs_1x2_avx512(const Grp64GF16* src,
                                          const Grp64GF16* g,
                                          uint32_t i) {
     __m512i v = _mm512_broadcast_i64x4(_mm256_load_si256((__m256i*)src));
+#if defined(__GFNI__) && defined(__AVX512VBMI__)
+    return grp64_gf16_mul_scalar_reg_gfni_x2(v, grp64_gf16_at(g, i),
+                                             grp64_gf16_at(g, i + 1));
+#else
     __mmask8 m0 = mmask_from_2b((g->b[0] >> i) & 0x3U);
     __mmask8 m1 = mmask_from_2b((g->b[1] >> i) & 0x3U);
     __mmask8 m2 = mmask_from_2b((g->b[2] >> i) & 0x3U);
     __mmask8 m3 = mmask_from_2b((g->b[3] >> i) & 0x3U);
     return grp64_gf16_mul_scalar_reg_avx512_no_split(v, m0, m1, m2, m3);
+#endif
 }
 
 #endif
@@ -517,6 +638,9 @@ grp64_gf16_mul_scalar_reg_avx2(const __m256i v, __m256i m0, __m256i m1,
  * return: the product as a 256-bit YMM register */
 __m256i
 grp64_gf16_mul_scalar_from_bs_avx2(const __m256i v, const Grp64GF16* g, uint32_t i) {
+#if defined(__GFNI__)
+    return grp64_gf16_mul_scalar_reg_gfni(v, grp64_gf16_at(g, i));
+#else
     __m256i vg = _mm256_load_si256((__m256i*) g);
     __m256i lsb_extractor = _mm256_set1_epi64x(0x1ULL);
     vg = _mm256_and_si256(_mm256_srli_epi64(vg, i), lsb_extractor);
@@ -526,10 +650,14 @@ grp64_gf16_mul_scalar_from_bs_avx2(const __m256i v, const Grp64GF16* g, uint32_t
     __m256i m2 = _mm256_permute4x64_epi64(vg, 0xAA); // [2, 2, 2, 2]
     __m256i m3 = _mm256_permute4x64_epi64(vg, 0xFF); // [3, 3, 3, 3]
     return grp64_gf16_mul_scalar_reg_avx2(v, m0, m1, m2, m3);
+#endif
 }
 
 static force_inline __m256i
 grp64_gf16_mul_scalar_from_coeff_avx2(const __m256i v, gf16_t c) {
+#if defined(__GFNI__)
+    return grp64_gf16_mul_scalar_reg_gfni(v, c);
+#else
     __m256i cv = _mm256_set1_epi64x(c);
     __m256i lsb_extractor = _mm256_set1_epi64x(0x1ULL);
     __m256i m0 = _mm256_and_si256(cv, lsb_extractor);
@@ -541,6 +669,7 @@ grp64_gf16_mul_scalar_from_coeff_avx2(const __m256i v, gf16_t c) {
     m2 = _mm256_cmpeq_epi64(m2, lsb_extractor);
     m3 = _mm256_cmpeq_epi64(m3, lsb_extractor);
     return grp64_gf16_mul_scalar_reg_avx2(v, m0, m1, m2, m3);
+#endif
 }
 
 #endif
@@ -0,0 +1,291 @@
+#include "guess.h"
+#include "gfm.h"
+#include "ks.h"
+#include "math_util.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* ========================================================================
+ * struct GuessCtx definition
+ * ======================================================================== */
+
+// state of the search shared by the worker groups
+typedef struct {
+    pthread_mutex_t lock;
+    const MinRank* mr;
+    uint32_t g;
+    uint64_t num; // number of guesses, including the skipped ones
+    uint64_t next; // index of the next guess to take
+    uint64_t tried;
+    bool stop; // a solution is found, or an error occurred
+    bool err;
+    MRSSolution* sol;
+} GuessCtx;
+
+// a worker group: a solver context and the thread that drives it
+typedef struct {
+    GuessCtx* gc;
+    MRSolver* s;
+    pthread_t th;
+} GuessGroup;
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Compute the number of guesses to try for an instance
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) g: number of linear variables to guess
+ * return: number of guesses, or 0 if g is out of range, i.e. not in
+ *      [1, k-1], or if there are 2^32 guesses or more */
+uint64_t
+mrs_guess_num(const MinRank* mr, uint32_t g) {
+    if(!g || g >= minrank_nmat(mr))
+        return 0;
+
+    const uint64_t q = GF_MAX + 1;
+    uint64_t num = 1;
+    for(uint32_t i = 0; i < g; ++i) {
+        num *= q;
+        if(num > UINT32_MAX)
+            return 0;
+    }
+    if(!minrank_m0(mr)) // up to scaling, see guess_decode
+        num = (num - 1) / (q - 1);
+    return num;
+}
+
+/* subroutine of guess_worker: the values of the idx-th guess. Return false if
+ *      the guess is skipped, i.e. for homogeneous instances, if it's zero or
+ *      its first non-zero value is not 1 */
+static inline bool
+guess_decode(gf_t* restrict vals, uint64_t idx, uint32_t g, bool homo) {
+    const uint64_t q = GF_MAX + 1;
+    for(uint32_t j = 0; j < g; ++j) {
+        vals[j] = idx % q;
+        idx /= q;
+    }
+    if(!homo)
+        return true;
+    for(uint32_t j = 0; j < g; ++j) {
+        if(vals[j])
+            return vals[j] == 1;
+    }
+    return false;
+}
+
+/* subroutine of guess_worker: extend the solution of a specialization with
+ *      the guessed values into a solution of the original instance */
+static MRSSolution*
+guess_expand(const MRSSolution* restrict sp, const gf_t* restrict vals,
+             uint32_t g) {
+    const uint32_t k = sp->k + g;
+    const uint32_t vnum = ks_total_var_num(k, sp->r, sp->c);
+    MRSSolution* s = malloc(sizeof(MRSSolution));
+    if(!s)
+        return NULL;
+    s->val = malloc(sizeof(gf_t) * vnum);
+    s->det = malloc(sizeof(bool) * vnum);
+    if(!s->val || !s->det) {
+        mrs_solution_free(s);
+        return NULL;
+    }
+
+    s->k = k;
+    s->r = sp->r;
+    s->c = sp->c;
+    s->vnum = vnum;
+    s->consistent = sp->consistent;
+    memcpy(s->val, sp->val, sizeof(gf_t) * sp->k);
+    memcpy(s->det, sp->det, sizeof(bool) * sp->k);
+    for(uint32_t j = 0; j < g; ++j) {
+        s->val[sp->k + j] = vals[j];
+        s->det[sp->k + j] = true;
+    }
+    // the kernel variables are indexed from k on, see ks_kernel_var_idx_to_2d
+    memcpy(s->val + k, sp->val + sp->k, sizeof(gf_t) * (vnum - k));
+    memcpy(s->det + k, sp->det + sp->k, sizeof(bool) * (vnum - k));
+    return s;
+}
+
+/* subroutine of guess_worker: check that the linear variables of a solution
+ *      are a solution of the instance. A solution with free linear variables
+ *      can't be checked and is taken as is */
+static inline bool
+guess_check(const MinRank* restrict mr, const MRSSolution* restrict sol) {
+    if(!sol->consistent)
+        return false;
+    for(uint32_t i = 0; i < sol->k; ++i) {
+        if(!sol->det[i])
+            return true;
+    }
+    return minrank_eval_rank(mr, sol->val) <= minrank_rank(mr);
+}
+
+/* subroutine of mrs_guess_solve: solve the specializations of the instance
+ *      one at a time, until the guesses run out or the search is stopped */
+static void*
+guess_worker(void* arg) {
+    GuessGroup* grp = arg;
+    GuessCtx* gc = grp->gc;
+    const bool homo = !minrank_m0(gc->mr);
+    gf_t* vals = malloc(sizeof(gf_t) * gc->g);
+    if(!vals) {
+        pthread_mutex_lock(&gc->lock);
+        gc->err = gc->stop = true;
+        pthread_mutex_unlock(&gc->lock);
+        return NULL;
+    }
+
+    while(true) {
+        pthread_mutex_lock(&gc->lock);
+        if(gc->stop || gc->next >= gc->num) {
+            pthread_mutex_unlock(&gc->lock);
+            break;
+        }
+        const uint64_t idx = gc->next++;
+        pthread_mutex_unlock(&gc->lock);
+
+        if(!guess_decode(vals, idx, gc->g, homo))
+            continue;
+
+        MRSSolution* sp_sol = NULL, *sol = NULL;
+        MinRank* sp = minrank_specialize(gc->mr, vals, gc->g);
+        int32_t rv = -1;
+        if(sp) {
+            rv = mrs_solver_solve(grp->s, sp, &sp_sol);
+            minrank_free(sp);
+        }
+        if(!rv && sp_sol->consistent && !(sol = guess_expand(sp_sol, vals, gc->g)))
+            rv = -1;
+        mrs_solution_free(sp_sol);
+        if(sol && !guess_check(gc->mr, sol)) {
+            mrs_solution_free(sol);
+            sol = NULL;
+        }
+
+        pthread_mutex_lock(&gc->lock);
+        ++gc->tried;
+        if(rv < 0) {
+            gc->err = gc->stop = true;
+        } else if(sol && !gc->sol) {
+            gc->sol = sol;
+            sol = NULL;
+            gc->stop = true;
+        }
+        pthread_mutex_unlock(&gc->lock);
+        mrs_solution_free(sol); // found by another group in the meantime
+    }
+    free(vals);
+    return NULL;
+}
+
+/* usage: Solve a MinRank instance by guessing some of its linear variables
+ * params:
+ *      1) prm: ptr to MRSParams, the parameters of the solves. Logging and the
+ *          progress callback are disabled during the search. The thread pool
+ *          is only used with a single worker group
+ *      2) mr: ptr to struct MinRank
+ *      3) g: number of linear variables to guess, see mrs_guess_num
+ *      4) groups: number of worker groups. The threads are split evenly among
+ *          them
+ *      5) sol: container for the ptr to the solution of the original instance.
+ *          On success, the caller releases it with mrs_solution_free
+ *      6) tried: container for the number of guesses tried
+ * return: 0 if the instance is solved, 1 if no guess leads to a solution, or
+ *      -1 on error */
+int32_t
+mrs_guess_solve(const MRSParams* restrict prm, const MinRank* restrict mr,
+                uint32_t g, uint32_t groups, MRSSolution** restrict sol,
+                uint64_t* restrict tried) {
+    *sol = NULL;
+    *tried = 0;
+    const uint64_t num = mrs_guess_num(mr, g);
+    if(!num)
+        return -1;
+    if(!groups)
+        groups = 1;
+    if(groups > num)
+        groups = num;
+
+    GuessCtx gc = {
+        .mr = mr, .g = g, .next = 0, .tried = 0, .stop = false, .err = false,
+        .sol = NULL,
+    };
+    gc.num = 1; // all the guesses, skipped ones included
+    for(uint32_t i = 0; i < g; ++i)
+        gc.num *= GF_MAX + 1;
+
+    MRSParams gprm = *prm;
+    gprm.reuse = true; // the symbolic phase is shared by all the guesses
+    gprm.quiet = true;
+    gprm.progress = NULL;
+    if(groups > 1) {
+        // the solver splits its work in powers of 2
+        uint64_t t = prm->tnum / groups;
+        uint64_t p = next_power_of_2(t ? t : 1);
+        gprm.tnum = (p > t && t) ? p >> 1 : p;
+        gprm.tpool = NULL;
+    }
+
+    GuessGroup* grps = calloc(groups, sizeof(GuessGroup));
+    gf_t* zero = calloc(g, sizeof(gf_t));
+    MinRank* sp = NULL;
+    int32_t rval = -1;
+    if(!grps || !zero)
+        goto mrs_guess_solve_cleanup;
+
+    // the specializations only differ in M0, so any one of them gives the
+    // symbolic phase for all of them
+    if( !(sp = minrank_specialize(mr, zero, g)) ||
+        !(grps[0].s = mrs_solver_create(&gprm)) ||
+        !mrs_solver_plan(grps[0].s, sp) ) {
+        printf_err_ts("[!] Fail to build the Macaulay matrix of the guesses\n");
+        goto mrs_guess_solve_cleanup;
+    }
+    for(uint32_t i = 1; i < groups; ++i) {
+        if( !(grps[i].s = mrs_solver_clone(grps[0].s, &gprm)) ) {
+            printf_err_ts("[!] Fail to create solver context for worker group\n");
+            goto mrs_guess_solve_cleanup;
+        }
+    }
+
+    pthread_mutex_init(&gc.lock, NULL);
+    uint32_t started = 1;
+    for(uint32_t i = 0; i < groups; ++i)
+        grps[i].gc = &gc;
+    for(; started < groups; ++started) {
+        if(pthread_create(&grps[started].th, NULL, guess_worker, grps + started))
+            break;
+    }
+    guess_worker(grps); // the calling thread drives the first group
+    for(uint32_t i = 1; i < started; ++i)
+        pthread_join(grps[i].th, NULL);
+    pthread_mutex_destroy(&gc.lock);
+
+    *tried = gc.tried;
+    if(gc.err) {
+        mrs_solution_free(gc.sol);
+    } else {
+        *sol = gc.sol;
+        rval = gc.sol ? 0 : 1;
+    }
+
+mrs_guess_solve_cleanup:
+    if(grps) {
+        // the clones share the symbolic phase of the first group
+        for(uint32_t i = groups; i > 0; --i) {
+            if(grps[i-1].s)
+                mrs_solver_free(grps[i-1].s);
+        }
+    }
+    free(grps);
+    free(zero);
+    if(sp)
+        minrank_free(sp);
+    return rval;
+}
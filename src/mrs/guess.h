@@ -0,0 +1,58 @@
+#ifndef __GUESS_H__
+#define __GUESS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "minrank.h"
+#include "mrs.h"
+
+// Hybrid mode: exhaustive search over g of the linear variables combined with
+// the Macaulay solver on the remaining ones. Fixing g variables folds their
+// matrices into M0 (see minrank_specialize), so every guess is an instance
+// with k-g matrices and the same sparsity pattern of the KS matrix. The
+// symbolic phase is thus built once, and each guess only refills the
+// condensed Macaulay matrices before Block Lanczos.
+//
+// The guesses are spread over worker groups, each with its own solver context
+// that shares the symbolic phase (see mrs_solver_clone), and the search stops
+// as soon as a group finds a consistent solution whose matrix has rank at most
+// r. Solves in flight are finished, not interrupted.
+//
+// The last g linear variables are guessed. For homogeneous instances, the
+// solutions are closed under scaling, so only the guesses whose first
+// non-zero value is 1 are tried.
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Compute the number of guesses to try for an instance
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) g: number of linear variables to guess
+ * return: number of guesses, or 0 if g is out of range, i.e. not in
+ *      [1, k-1], or if there are 2^32 guesses or more */
+uint64_t
+mrs_guess_num(const MinRank* mr, uint32_t g);
+
+/* usage: Solve a MinRank instance by guessing some of its linear variables
+ * params:
+ *      1) prm: ptr to MRSParams, the parameters of the solves. Logging and the
+ *          progress callback are disabled during the search. The thread pool
+ *          is only used with a single worker group
+ *      2) mr: ptr to struct MinRank
+ *      3) g: number of linear variables to guess, see mrs_guess_num
+ *      4) groups: number of worker groups. The threads are split evenly among
+ *          them
+ *      5) sol: container for the ptr to the solution of the original instance.
+ *          On success, the caller releases it with mrs_solution_free
+ *      6) tried: container for the number of guesses tried
+ * return: 0 if the instance is solved, 1 if no guess leads to a solution, or
+ *      -1 on error */
+int32_t
+mrs_guess_solve(const MRSParams* restrict prm, const MinRank* restrict mr,
+                uint32_t g, uint32_t groups, MRSSolution** restrict sol,
+                uint64_t* restrict tried);
+
+#endif // __GUESS_H__
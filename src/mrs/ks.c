@@ -2,6 +2,7 @@
 #include "math_util.h"
 #include "mdeg.h"
 #include "mono.h"
+#include "prng.h"
 
 #include <stddef.h>
 #include <assert.h>
@@ -546,28 +547,33 @@ ks_mdmac_combi_midx(uint32_t k, uint32_t r, const MDeg** restrict degs,
     return arg.count + ks_mdeg_midx(k, r, m, target_d);
 }
 
+static force_inline gf_t
+ks_rand_entry(Prng* g) {
+    return (gf_t) (prng_u64(g) % (GF_MAX + 1));
+}
+
 static force_inline void
 gen_rand_ks_row(GFM* ks, uint32_t dst_ridx, uint32_t k, uint32_t r, uint32_t c,
-                uint32_t ri) {
+                uint32_t ri, Prng* g) {
     mono_create_static_buf(mono_buf, 2);
     Mono* m = mono_create_from_arr(2, mono_buf);
     gf_t* dst_row = (gf_t*) gfm_row_addr(ks, dst_ridx);
 
     mono_set_deg(m, 0); // constant term
-    dst_row[ks_midx(k, r, c, m)] = gf_t_rand();
+    dst_row[ks_midx(k, r, c, m)] = ks_rand_entry(g);
 
     // linear var
     mono_set_deg(m, 1);
     for(uint32_t i = 0; i < k; ++i) {
         mono_set_var(m, 0, i, false);
-        dst_row[ks_midx(k, r, c, m)] = gf_t_rand();
+        dst_row[ks_midx(k, r, c, m)] = ks_rand_entry(g);
     }
 
     // kernel var of the selected group
     for(uint32_t i = 0; i < r; ++i) {
         uint32_t vidx = ks_kernel_var_idx(ri, i, k, r, c);
         mono_set_var(m, 0, vidx, false);
-        dst_row[ks_midx(k, r, c, m)] = gf_t_rand();
+        dst_row[ks_midx(k, r, c, m)] = ks_rand_entry(g);
     }
 
     // one kernel var of the selected group and 1 linear var
@@ -577,7 +583,7 @@ gen_rand_ks_row(GFM* ks, uint32_t dst_ridx, uint32_t k, uint32_t r, uint32_t c,
         for(uint32_t j = 0; j < r; ++j) {
             uint32_t vidx = ks_kernel_var_idx(ri, j, k, r, c);
             mono_set_var(m, 1, vidx, false);
-            dst_row[ks_midx(k, r, c, m)] = gf_t_rand();
+            dst_row[ks_midx(k, r, c, m)] = ks_rand_entry(g);
         }
     }
 }
@@ -588,9 +594,10 @@ gen_rand_ks_row(GFM* ks, uint32_t dst_ridx, uint32_t k, uint32_t r, uint32_t c,
  *      2) r: target rank of the MinRank instance
  *      3) c: number of groups of kernel variables
  *      4) m: number of columns of matrices in the original MinRank instance
+ *      5) seed: seed of the stream drawing the entries, see prng.h
  * return: ptr to struct GFM, on error NULL */
 GFM*
-ks_rand(uint32_t k, uint32_t r, uint32_t c, uint32_t m) {
+ks_rand(uint32_t k, uint32_t r, uint32_t c, uint32_t m, uint64_t seed) {
     uint32_t nrow = c * m;
     uint32_t ncol = 1 + k + r * c + r * c * k;
     GFM* ks = gfm_create(nrow, ncol, NULL);
@@ -598,10 +605,12 @@ ks_rand(uint32_t k, uint32_t r, uint32_t c, uint32_t m) {
         return NULL;
 
     gfm_zero(ks);
+    Prng g;
+    prng_init(&g, seed, PRNG_KS, 0);
     uint32_t dst_row_offset = 0;
     for(uint32_t i = 0; i < c; ++i) {
         for(uint32_t j = 0; j < m; ++j) { // for each m rows
-            gen_rand_ks_row(ks, dst_row_offset++, k, r, c, i);
+            gen_rand_ks_row(ks, dst_row_offset++, k, r, c, i, &g);
         }
     }
 
@@ -246,8 +246,9 @@ ks_mdeg_midx(uint32_t k, uint32_t r, const Mono* restrict m,
  *      2) r: target rank of the MinRank instance
  *      3) c: number of groups of kernel variables
  *      4) m: number of columns of matrices in the original MinRank instance
+ *      5) seed: seed of the stream drawing the entries, see prng.h
  * return: ptr to struct GFM, on error NULL */
 GFM*
-ks_rand(uint32_t k, uint32_t r, uint32_t c, uint32_t m);
+ks_rand(uint32_t k, uint32_t r, uint32_t c, uint32_t m, uint64_t seed);
 
 #endif // __KS_H__
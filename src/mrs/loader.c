@@ -3,124 +3,348 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 /* ========================================================================
- * struct Loader definition
+ * struct LoaderText definition
  * ======================================================================== */
 
-//struct Loader {
-//};
+// cursor over a MinRank instance in the text format
+typedef struct {
+    const char* p;      // current position
+    const char* end;    // end of the file
+} LoaderText;
 
 /* ========================================================================
  * function implementations
  * ======================================================================== */
 
-static inline int32_t
-loader_gfm_store_row(gf_t* coeffs, uint32_t ncol, char buf[]) {
-    char* token = strtok(buf, " ");
-    uint32_t i = 0;
-    while(token) {
-        gf_t v = atoi(token);
+static inline bool
+loader_is_digit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+static inline bool
+loader_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
-        if(v > GF_MAX)
-            return 1;
+/* subroutine of the text parser: skip spaces in the current line */
+static inline void
+loader_text_skip_blank(LoaderText* t) {
+    while(t->p < t->end && loader_is_blank(*t->p))
+        ++(t->p);
+}
 
-        coeffs[i++] = v;
-        token = strtok(NULL, " ");
+/* subroutine of the text parser: skip lines that have only spaces */
+static inline void
+loader_text_skip_empty_lines(LoaderText* t) {
+    const char* p = t->p;
+    while(p < t->end) {
+        if(*p == '\n')
+            t->p = p + 1;
+        else if(!loader_is_blank(*p))
+            break;
+        ++p;
     }
+}
 
-    if(i != ncol)
-        return 1;
+/* subroutine of the text parser: consume the end of the current line, which
+ * may only have spaces left */
+static inline bool
+loader_text_eol(LoaderText* t) {
+    loader_text_skip_blank(t);
+    if(t->p == t->end)
+        return true;
+    if(*t->p != '\n')
+        return false;
+    ++(t->p);
+    return true;
+}
 
-    return 0;
+/* subroutine of the text parser: consume the given string after spaces */
+static inline bool
+loader_text_expect(LoaderText* t, const char* s) {
+    loader_text_skip_blank(t);
+    const size_t len = strlen(s);
+    if((size_t) (t->end - t->p) < len || memcmp(t->p, s, len))
+        return false;
+    t->p += len;
+    return true;
 }
 
-static inline enum LoaderGFMfromFileCode
-loader_gfm_load_1_matrix(gf_t* restrict coeffs, uint32_t idx,
-                         uint32_t nrow, uint32_t ncol,
-                         FILE* restrict f, char buf[], uint32_t buf_size) {
-    if(!fgets(buf, buf_size, f)) // skip the id line
-        return FILE_EOF;
+/* subroutine of the text parser: consume an unsigned integer after spaces */
+static inline bool
+loader_text_uint(LoaderText* t, uint32_t* v) {
+    loader_text_skip_blank(t);
+    if(t->p == t->end || !loader_is_digit(*t->p))
+        return false;
 
-    char id[128];
-    // TODO: check for exceptions
-    snprintf(id, 128, "M%d", idx);
-    if(strncmp(buf, id, 2))
-        return FORMAT_ERR;
+    uint64_t n = 0;
+    while(t->p < t->end && loader_is_digit(*t->p)) {
+        n = n * 10 + (*(t->p)++ - '0');
+        if(n > UINT32_MAX)
+            return false;
+    }
+    *v = n;
+    return true;
+}
 
-    if(!fgets(buf, buf_size, f)) // load the first row
-        return FORMAT_ERR;
+/* subroutine of the text parser: parse a row of ncol coefficients, each no
+ * larger than max. The end of
+ * the line is located with memchr, which libc vectorizes, and the coefficients
+ * in between are parsed without any intermediate buffer, so lines can be of
+ * any length */
+static inline bool
+loader_text_row(LoaderText* restrict t, gf_t* restrict row, uint32_t ncol,
+                uint32_t max) {
+    const char* eol = memchr(t->p, '\n', t->end - t->p);
+    if(!eol)
+        eol = t->end;
 
-    if(ncol != count_int_in_str(buf) ) // file changed
-        return FORMAT_ERR;
+    const char* p = t->p;
+    for(uint32_t i = 0; i < ncol; ++i) {
+        while(p < eol && loader_is_blank(*p))
+            ++p;
+        if(p == eol || !loader_is_digit(*p))
+            return false;
 
-    uint32_t r = 1;
-    if(loader_gfm_store_row(coeffs, ncol, buf))
-        return FORMAT_ERR;
+        uint32_t v = *p++ - '0';
+        while(p < eol && loader_is_digit(*p)) {
+            v = v * 10 + (*p++ - '0');
+            if(v > max)
+                return false;
+        }
+        if(v > max)
+            return false;
+        row[i] = v;
+    }
+    while(p < eol && loader_is_blank(*p))
+        ++p;
+    if(p != eol) // more coefficients than expected
+        return false;
+
+    t->p = (eol == t->end) ? eol : eol + 1;
+    return true;
+}
 
-    coeffs += ncol;
+/* subroutine of loader_gfm_from_file: parse an instance in the text format */
+static enum LoaderGFMfromFileCode
+loader_gfm_from_text(LoaderGFMfromFileRet* restrict rt, const char* buf,
+                     size_t size) {
+    LoaderText t = { .p = buf, .end = buf + size };
+    if(!loader_text_expect(&t, "n") || !loader_text_expect(&t, "=") ||
+       !loader_text_uint(&t, &rt->nrow) || !loader_text_eol(&t) ||
+       !loader_text_expect(&t, "m") || !loader_text_expect(&t, "=") ||
+       !loader_text_uint(&t, &rt->ncol) || !loader_text_eol(&t) ||
+       !loader_text_expect(&t, "k") || !loader_text_expect(&t, "=") ||
+       !loader_text_uint(&t, &rt->k) || !loader_text_eol(&t) ||
+       !loader_text_expect(&t, "r") || !loader_text_expect(&t, "=") ||
+       !loader_text_uint(&t, &rt->r) || !loader_text_eol(&t))
+        return FORMAT_ERR;
 
-    while(fgets(buf, buf_size, f) && strnlen(buf, buf_size-1) > 1) { // \n counts
-        if(ncol != count_int_in_str(buf))
+    // optional field size, GF(16) by default
+    rt->q = GF_MAX + 1;
+    if(loader_text_expect(&t, "q")) {
+        if(!loader_text_expect(&t, "=") || !loader_text_uint(&t, &rt->q) ||
+           !loader_text_eol(&t))
+            return FORMAT_ERR;
+        if(rt->q != GF_MAX + 1 && rt->q != 2 && rt->q != GF31_SIZE)
             return FORMAT_ERR;
+    }
+
+    if( !(rt->m0 = gfm_create(rt->nrow, rt->ncol, NULL)) ||
+        !(rt->ms = gfm_arr_create(rt->nrow, rt->ncol, rt->k, NULL)) )
+        return MEM_ERR;
+
+    for(uint32_t i = 0; i <= rt->k; ++i) {
+        loader_text_skip_empty_lines(&t);
+        if(t.p == t.end)
+            return FILE_EOF;
 
-        if(loader_gfm_store_row(coeffs, ncol, buf))
+        uint32_t idx;
+        if(!loader_text_expect(&t, "M") || !loader_text_uint(&t, &idx) ||
+           idx != i || !loader_text_expect(&t, ":") || !loader_text_eol(&t))
             return FORMAT_ERR;
 
-        coeffs += ncol;
-        ++r;
+        GFM* m = i ? gfm_arr_at(rt->ms, i - 1) : rt->m0;
+        gf_t* row = gfm_memblk(m);
+        for(uint32_t ri = 0; ri < rt->nrow; ++ri, row += rt->ncol) {
+            if(!loader_text_row(&t, row, rt->ncol, rt->q - 1))
+                return FORMAT_ERR;
+        }
     }
 
-    if(r != nrow)
+    return SUCCESS;
+}
+
+/* subroutine of the binary format: number of bytes of a packed matrix */
+static inline uint64_t
+loader_bin_mat_size(uint32_t nrow, uint32_t ncol) {
+    return ((uint64_t) nrow * ncol + 1) / 2;
+}
+
+/* subroutine of loader_gfm_from_file: unpack an instance in the binary format
+ * straight into the matrices */
+static enum LoaderGFMfromFileCode
+loader_gfm_from_bin(LoaderGFMfromFileRet* restrict rt, const uint8_t* buf,
+                    size_t size) {
+#if GF_MAX > 0xF
+    // the coefficients are packed into nibbles
+    (void) rt; (void) buf; (void) size;
+    return FORMAT_ERR;
+#else
+    if(size < LOADER_BIN_HEADER_SIZE)
+        return FILE_EOF;
+
+    // the header is little-endian, as is the host
+    uint32_t hdr[4];
+    memcpy(hdr, buf + LOADER_BIN_MAGIC_LEN, sizeof(hdr));
+    rt->nrow = hdr[0]; rt->ncol = hdr[1]; rt->k = hdr[2]; rt->r = hdr[3];
+    rt->q = GF_MAX + 1;
+
+    const uint64_t mat_size = loader_bin_mat_size(rt->nrow, rt->ncol);
+    if(!mat_size || !rt->k)
         return FORMAT_ERR;
+    // the header comes from the file, so bound it by the size of the file
+    // before it drives any allocation or copy. Checking the quotient first
+    // keeps the product below from wrapping
+    const uint64_t mnum = (uint64_t) rt->k + 1;
+    const uint64_t body = size - LOADER_BIN_HEADER_SIZE;
+    if(mat_size > body / mnum || body != mat_size * mnum)
+        return FILE_EOF;
 
+    if( !(rt->m0 = gfm_create(rt->nrow, rt->ncol, NULL)) ||
+        !(rt->ms = gfm_arr_create(rt->nrow, rt->ncol, rt->k, NULL)) )
+        return MEM_ERR;
+
+    const uint64_t cnum = (uint64_t) rt->nrow * rt->ncol;
+    const uint8_t* src = buf + LOADER_BIN_HEADER_SIZE;
+    for(uint64_t i = 0; i < mnum; ++i, src += mat_size) {
+        gf_t* dst = gfm_memblk(i ? gfm_arr_at(rt->ms, i - 1) : rt->m0);
+        for(uint64_t j = 0; j < cnum / 2; ++j) {
+            dst[2*j] = src[j] & 0xF;
+            dst[2*j+1] = src[j] >> 4;
+        }
+        if(cnum & 0x1ULL)
+            dst[cnum-1] = src[cnum/2] & 0xF;
+    }
     return SUCCESS;
+#endif
 }
 
+/* usage: Load a MinRank instance from a file in either the text or the binary
+ *      format. The file is mapped into memory and parsed in a single pass
+ *      into the matrices
+ * params:
+ *      1) rt: ptr to struct LoaderGFMfromFileRet. Container for the dimension,
+ *          the parameters and the matrices. The caller owns the matrices on
+ *          success
+ *      2) fname: path to the file
+ * return: SUCCESS, or the reason of the failure */
 enum LoaderGFMfromFileCode
 loader_gfm_from_file(LoaderGFMfromFileRet* restrict rt, const char fname[]) {
-    FILE* file = fopen(fname, "r");
-    gf_t* coeffs = NULL;
-
-    if(!file)
+    rt->m0 = NULL;
+    rt->ms = NULL;
+    const int fd = open(fname, O_RDONLY);
+    if(fd < 0)
         return FOPEN_FAIL;
 
-    char buf[4096];
-    enum LoaderGFMfromFileCode code = SUCCESS;
-    if(4 != fscanf(file, "n = %u\nm = %u\nk = %u\nr = %u\n",
-                   &rt->nrow, &rt->ncol, &rt->k, &rt->r)) {
-        code = FORMAT_ERR;
-        goto loader_gfm_from_file_cleanup;
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return FILE_EOF;
     }
 
-    const uint32_t ele_per_mat = rt->nrow * rt->ncol;
-    coeffs = malloc(sizeof(gf_t) * ele_per_mat * (rt->k+1));
-    if(!coeffs) {
-        code = MEM_ERR;
-        goto loader_gfm_from_file_cleanup;
+    const size_t size = st.st_size;
+    void* buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(buf == MAP_FAILED)
+        return FOPEN_FAIL;
+    madvise(buf, size, MADV_SEQUENTIAL);
+
+    enum LoaderGFMfromFileCode code;
+    if(size >= LOADER_BIN_MAGIC_LEN &&
+       !memcmp(buf, LOADER_BIN_MAGIC, LOADER_BIN_MAGIC_LEN))
+        code = loader_gfm_from_bin(rt, buf, size);
+    else
+        code = loader_gfm_from_text(rt, buf, size);
+
+    munmap(buf, size);
+    if(code != SUCCESS) {
+        if(rt->m0)
+            gfm_free(rt->m0);
+        if(rt->ms)
+            gfm_arr_free(rt->ms, rt->k);
+        rt->m0 = NULL;
+        rt->ms = NULL;
     }
+    return code;
+}
+
+/* usage: Write a MinRank instance to a file in the binary format
+ * params:
+ *      1) rt: ptr to struct LoaderGFMfromFileRet, as returned by
+ *          loader_gfm_from_file()
+ *      2) fname: path to the file
+ * return: SUCCESS, or the reason of the failure */
+enum LoaderGFMfromFileCode
+loader_gfm_to_bin_file(const LoaderGFMfromFileRet* restrict rt,
+                       const char fname[]) {
+#if GF_MAX > 0xF
+    (void) rt; (void) fname;
+    return FORMAT_ERR;
+#else
+    if(rt->q > 0xF + 1) // the coefficients are packed into nibbles
+        return FORMAT_ERR;
 
-    uint32_t mat_num = 0;
-    for(; mat_num <= rt->k; ++mat_num) {
-        code = loader_gfm_load_1_matrix(coeffs + ele_per_mat * mat_num,
-                                        mat_num, rt->nrow, rt->ncol,
-                                        file, buf, 4096);
-        if(code != SUCCESS)
-            goto loader_gfm_from_file_cleanup;
+    const uint64_t mat_size = loader_bin_mat_size(rt->nrow, rt->ncol);
+    const uint64_t cnum = (uint64_t) rt->nrow * rt->ncol;
+    uint8_t* packed = malloc(mat_size);
+    if(!packed)
+        return MEM_ERR;
+
+    FILE* f = fopen(fname, "wb");
+    if(!f) {
+        free(packed);
+        return FOPEN_FAIL;
     }
 
-    if( (rt->k+1) != mat_num) {
-        code = FORMAT_ERR;
-        goto loader_gfm_from_file_cleanup;
+    enum LoaderGFMfromFileCode code = SUCCESS;
+    uint8_t hdr[LOADER_BIN_HEADER_SIZE] = {0};
+    const uint32_t params[4] = { rt->nrow, rt->ncol, rt->k, rt->r };
+    memcpy(hdr, LOADER_BIN_MAGIC, LOADER_BIN_MAGIC_LEN);
+    memcpy(hdr + LOADER_BIN_MAGIC_LEN, params, sizeof(params));
+    if(1 != fwrite(hdr, sizeof(hdr), 1, f)) {
+        code = FWRITE_FAIL;
+        goto loader_gfm_to_bin_file_cleanup;
     }
 
-    rt->m0 = gfm_create(rt->nrow, rt->ncol, coeffs);
-    rt->ms = gfm_arr_create(rt->nrow, rt->ncol, rt->k, coeffs + ele_per_mat);
+    for(uint32_t i = 0; i <= rt->k; ++i) {
+        const GFM* m = i ? gfm_arr_at(rt->ms, i - 1) : rt->m0;
+        const gf_t* src = gfm_row_addr(m, 0);
+        for(uint64_t j = 0; j < cnum / 2; ++j)
+            packed[j] = src[2*j] | (src[2*j+1] << 4);
+        if(cnum & 0x1ULL)
+            packed[cnum/2] = src[cnum-1];
 
-loader_gfm_from_file_cleanup:
-    free(coeffs);
-    fclose(file);
-    return SUCCESS;
+        if(1 != fwrite(packed, mat_size, 1, f)) {
+            code = FWRITE_FAIL;
+            goto loader_gfm_to_bin_file_cleanup;
+        }
+    }
+
+loader_gfm_to_bin_file_cleanup:
+    if(fclose(f) && code == SUCCESS)
+        code = FWRITE_FAIL;
+    free(packed);
+    return code;
+#endif
 }
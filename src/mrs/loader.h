@@ -5,7 +5,41 @@
 
 #include "gfm.h"
 
-//typedef struct Loader Loader;
+// Instances are read from either of the 2 formats below. The format is
+// detected from the first bytes of the file.
+//
+// 1) text, as generated by bin/minrank-gen.sage:
+//
+//      n = <nrow>
+//      m = <ncol>
+//      k = <number of matrices - 1>
+//      r = <target rank>
+//      q = <field size>                            (optional)
+//      M0:
+//      <ncol coefficients separated by spaces>     (nrow lines)
+//
+//      M1:
+//      ...
+//
+//    with a blank line after each matrix. Anything after the last matrix is
+//    ignored. Lines can be arbitrarily long. The field size is 16 if omitted;
+//    2 and 31 are also accepted, and the coefficients must be less than it.
+//
+// 2) binary, as written by loader_gfm_to_bin_file():
+//
+//      offset  size
+//      0       8           magic "MRSBIN01"
+//      8       4 x 4       n, m, k, r as little-endian uint32_t
+//      24      8           reserved, zero
+//      32      (k+1) x ceil(n*m/2)
+//                          coefficients of M0, M1, ..., Mk, each row-majored
+//                          and packed 2 per byte, the lower nibble first. Each
+//                          matrix starts on a new byte.
+//
+//    Only instances over GF(16) (or GF(2)) can be stored in this format.
+#define LOADER_BIN_MAGIC        "MRSBIN01"
+#define LOADER_BIN_MAGIC_LEN    (8)
+#define LOADER_BIN_HEADER_SIZE  (32)
 
 /* ========================================================================
  * function prototypes
@@ -16,6 +50,7 @@ struct LoaderGFMfromFileRet {
     uint32_t ncol;
     uint32_t k;
     uint32_t r;
+    uint32_t q; // field size
     GFM* restrict m0;
     GFM* restrict ms;
 };
@@ -28,9 +63,29 @@ enum LoaderGFMfromFileCode {
     FORMAT_ERR = 2,
     FILE_EOF = 3,
     MEM_ERR = 4,
+    FWRITE_FAIL = 5,
 };
 
+/* usage: Load a MinRank instance from a file in either the text or the binary
+ *      format. The file is mapped into memory and parsed in a single pass
+ *      into the matrices
+ * params:
+ *      1) rt: ptr to struct LoaderGFMfromFileRet. Container for the dimension,
+ *          the parameters and the matrices. The caller owns the matrices on
+ *          success
+ *      2) fname: path to the file
+ * return: SUCCESS, or the reason of the failure */
 enum LoaderGFMfromFileCode
 loader_gfm_from_file(LoaderGFMfromFileRet* restrict rt, const char fname[]);
 
+/* usage: Write a MinRank instance to a file in the binary format
+ * params:
+ *      1) rt: ptr to struct LoaderGFMfromFileRet, as returned by
+ *          loader_gfm_from_file()
+ *      2) fname: path to the file
+ * return: SUCCESS, or the reason of the failure */
+enum LoaderGFMfromFileCode
+loader_gfm_to_bin_file(const LoaderGFMfromFileRet* restrict rt,
+                       const char fname[]);
+
 #endif // __LOADER_H__
@@ -179,6 +179,9 @@ cm_gf16_subset_zr_pos(const CMGF16* restrict m, const uint32_t* restrict idxs,
 #define rcm_gf16_identity(m) \
     rc512m_gf16_identity(m)
 
+#define rcm_gf16_rand(m) \
+    rc512m_gf16_rand(m)
+
 #define rcm_gf16_gj(m, inv, di) \
     rc512m_gf16_gj(m, inv, di)
 
@@ -363,6 +366,9 @@ cm_gf16_subset_zr_pos(const CMGF16* restrict m, const uint32_t* restrict idxs,
 #define rcm_gf16_identity(m) \
     rc256m_gf16_identity(m)
 
+#define rcm_gf16_rand(m) \
+    rc256m_gf16_rand(m)
+
 #define rcm_gf16_gj(m, inv, di) \
     rc256m_gf16_gj(m, inv, di)
 
@@ -573,6 +579,9 @@ cm_gf16_subset_zr_pos(const CMGF16* restrict m, const uint32_t* restrict idxs,
 #define rcm_gf16_identity(m) \
     rc128m_gf16_identity(m)
 
+#define rcm_gf16_rand(m) \
+    rc128m_gf16_rand(m)
+
 #define rcm_gf16_gj(m, inv, di) \
     rc128m_gf16_gj(m, inv, di)
 
@@ -783,6 +792,9 @@ cm_gf16_subset_zr_pos(const CMGF16* restrict m, const uint32_t* restrict idxs,
 #define rcm_gf16_identity(m) \
     rc64m_gf16_identity(m)
 
+#define rcm_gf16_rand(m) \
+    rc64m_gf16_rand(m)
+
 #define rcm_gf16_gj(m, inv, di) \
     rc64m_gf16_gj(m, inv, di)
 
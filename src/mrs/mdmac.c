@@ -7,6 +7,7 @@
 #include "mono.h"
 #include "util.h"
 #include "bitmap.h"
+#include "prng.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -27,6 +28,10 @@ struct MDMac {
     uint32_t c; // number of rows in the original KS matrix
     uint32_t m; // number of columns of matrices in the original MinRank instance
     uint64_t nrow; // number of rows in the multi-degree Macaulay matrix
+    // only the rows roff ~ roff + nrow - 1 of the full matrix are stored if
+    // it's created with mdmac_create_from_ks_part or its combi counterpart
+    uint64_t full_nrow;
+    uint64_t roff;
     uint64_t ncol; // number of columns (monomials) in the Macaulay matrix
 
     uint32_t degs_sz; // number of multi-degress in degs
@@ -38,6 +43,8 @@ struct MDMac {
                         // monomials >= the union of monomials defined by
                         // individual multi-degrees
     uint64_t* restrict mono_num_per_deg;// i-th: number of deg-i monomials
+    uint64_t* restrict grp_rend; // i-th: end of the rows derived from the i-th
+                                 // group of m rows in the base KS system
     GFA* restrict rows; // NOTE: each eq in the multi-degree Macaulay matrix is
                         // represented by m rows. Thus the number of rows is
                         // not the same as the number of equations
@@ -150,6 +157,26 @@ mdmac_nrow(const MDMac* m) {
     return m->nrow;
 }
 
+/* usage: Given a struct MDMac, return the number of rows of the full matrix,
+ *      which differs from mdmac_nrow if only a part of it is stored
+ * params:
+ *      1) m: ptr to struct MDMac
+ * return: number of rows */
+uint64_t
+mdmac_full_nrow(const MDMac* m) {
+    return m->full_nrow;
+}
+
+/* usage: Given a struct MDMac, return the index in the full matrix of its
+ *      first row, which is non-zero if only a part of it is stored
+ * params:
+ *      1) m: ptr to struct MDMac
+ * return: index of the first row */
+uint64_t
+mdmac_roff(const MDMac* m) {
+    return m->roff;
+}
+
 /* usage: Given a struct MDMac, return its number of columns (monomials)
  * params:
  *      1) m: ptr to struct MDMac
@@ -253,6 +280,25 @@ mdmac_row(const MDMac* m, uint64_t i) {
     return gfa_arr_at(m->rows, i);
 }
 
+/* usage: Given a struct MDMac and the row index i, return the index of the row
+ *      in the base KS system that the i-th row is a multiple of. The non-zero
+ *      entries of the i-th row are in the same order as those of the row in
+ *      the base KS system
+ * params:
+ *      1) m: ptr to struct MDMac
+ *      2) i: index of the row
+ * return: index of the row in the base KS system */
+uint64_t
+mdmac_row_src(const MDMac* m, uint64_t i) {
+    assert(i < m->nrow);
+    i += m->roff;
+    uint32_t g = 0;
+    uint64_t start = 0;
+    while(i >= m->grp_rend[g])
+        start = m->grp_rend[g++];
+    return (uint64_t) g * m->m + (i - start) % m->m;
+}
+
 /* usage: Given a struct MDMac, row index i, and column index j, return
  *      the specified entry
  * params:
@@ -378,15 +424,25 @@ mdmac_cmp_mmap_mono(gfa_idx_t* restrict mmap, Mono* restrict mono,
     assert(mdmac_mmap_check_ascend(mmap, dst_idx) == true);
 }
 
+/* subroutine of mdmac_create_from_ks: check if any of the m rows starting from
+ * the given row of the full multi-degree Macaulay is stored */
+static inline bool
+mdmac_eqs_stored(const MDMac* m, uint64_t row_offset) {
+    return row_offset < m->roff + m->nrow && row_offset + m->m > m->roff;
+}
+
 /* subroutine of mdmac_create_from_ks: given a monomial index map from the base KS system
  * into the multi-degree Macaulay derived from the KS system, fill monomials in the chosen
- * eq of the base KS system into the multi-degree Macaulay */
+ * eq of the base KS system into the multi-degree Macaulay. row_offset is the index
+ * in the full matrix, and the rows that are not stored are skipped */
 static inline void
 mdmac_fill_in_eqs(MDMac* restrict m, uint64_t row_offset, const GFM* restrict ks,
                   uint64_t ri, const gfa_idx_t* restrict mmap) {
     for(uint64_t i = 0; i < mdmac_m(m); ++i) { // for each row of the chosen eq in the base KS system
+        if(row_offset + i < m->roff || row_offset + i >= m->roff + m->nrow)
+            continue;
         const gf_t* src_eq = gfm_row_addr(ks, ri + i);
-        GFA* dst_eq = (GFA*) mdmac_row(m, row_offset + i);
+        GFA* dst_eq = (GFA*) mdmac_row(m, row_offset + i - m->roff);
 
         uint64_t sz = 0;
         for(uint64_t j = 0; j < gfm_ncol(ks); ++j) {
@@ -420,6 +476,17 @@ mdmac_check_mdeg(const MDeg* d) {
     return true;
 }
 
+/* subroutine of mdmac_create_from_ks_part and its combi counterpart: compute
+ *      the range of rows of the given part out of part_num parts, which are
+ *      balanced by the number of rows */
+static inline void
+mdmac_part_range(uint64_t* restrict rbeg, uint64_t* restrict rend,
+                 uint64_t full_nrow, uint32_t part, uint32_t part_num) {
+    const uint64_t q = full_nrow / part_num, rem = full_nrow % part_num;
+    *rbeg = q * part + (part < rem ? part : rem);
+    *rend = *rbeg + q + (part < rem);
+}
+
 /* usage: Given a base KS system constructed for a MinRank instance, and a target multi-degree,
  *      compute its multi-degree Macaulay matrix
  * params:
@@ -430,6 +497,25 @@ mdmac_check_mdeg(const MDeg* d) {
 MDMac*
 mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
                      const MDeg* restrict d) {
+    return mdmac_create_from_ks_part(ks, mr, d, 0, 1);
+}
+
+/* usage: the counterpart of mdmac_create_from_ks that only computes a part of
+ *      the multi-degree Macaulay matrix. The rows are split into part_num
+ *      contiguous ranges of about the same size, and only those of the given
+ *      part are stored. See mdmac_roff and mdmac_full_nrow
+ * params:
+ *      1) ks: ptr to struct GDM that stores the base KS system
+ *      2) mr: ptr to struct MinRank that defines the MinRank problem
+ *      3) d: ptr to struct MDeg that specifies the target multi-degree
+ *      4) part: index of the part to compute
+ *      5) part_num: number of parts
+ * return: ptr to struct MDMac. NULL on error or if the part has no rows */
+MDMac*
+mdmac_create_from_ks_part(const GFM* restrict ks, const MinRank* restrict mr,
+                          const MDeg* restrict d, uint32_t part,
+                          uint32_t part_num) {
+    assert(part < part_num);
     const uint32_t c = mdeg_c(d);
     assert(ks_base_total_mono_num(minrank_nmat(mr), minrank_rank(mr), c) == gfm_ncol(ks));
 
@@ -448,7 +534,10 @@ mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
     gfa_idx_t* mmap = NULL;
 
     const uint64_t max_tnum = gfm_find_max_tnum_per_eq(ks);
-    const uint64_t nrow = mdmac_eq_num(mr, d);
+    const uint64_t full_nrow = mdmac_eq_num(mr, d);
+    uint64_t rbeg, rend;
+    mdmac_part_range(&rbeg, &rend, full_nrow, part, part_num);
+    const uint64_t nrow = rend - rbeg;
 
     if(unlikely(0 == nrow))
         return NULL;
@@ -482,6 +571,7 @@ mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
         return NULL;
     }
 
+    m->grp_rend = malloc(sizeof(uint64_t) * c);
     cur_mdeg = mdeg_create_zero(c);
     mmap = malloc(sizeof(gfa_idx_t) *
             ks_base_total_mono_num(minrank_nmat(mr), minrank_rank(mr), c));
@@ -490,7 +580,7 @@ mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
     mono = mono_create_container(mono_size + 2); // each eq is bilinear, so a
                                                  // monomial from multiplication
                                                  // has at most 2 more vars
-    if(!cur_mdeg || !mmap || !mul || !mono) {
+    if(!m->grp_rend || !cur_mdeg || !mmap || !mul || !mono) {
         mdmac_create_cleanup(cur_mdeg, mmap, mono, mul);
         mdmac_free(m);
         return NULL;
@@ -498,6 +588,7 @@ mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
 
     m->k = minrank_nmat(mr); m->r = minrank_rank(mr); m->c = c;
     m->m = minrank_ncol(mr); m->nrow = nrow;
+    m->full_nrow = full_nrow; m->roff = rbeg;
     m->ncol = mac_col_num; m->degs = NULL; m->degs_sz = 0;
 
     // the first m rows in KS are from 1 row in the left multiplier,
@@ -526,26 +617,33 @@ mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
 
         mdeg_zero(cur_mdeg); // start with the constant multiplier 1
         // just fill in the base system
-        mdmac_cmp_mmap_base(mmap, mdmac_k(m), mdmac_r(m), d);
-        mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+        if(mdmac_eqs_stored(m, dst_row_offset)) {
+            mdmac_cmp_mmap_base(mmap, mdmac_k(m), mdmac_r(m), d);
+            mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+        }
         dst_row_offset += mdmac_m(m);
 
         // NOTE: some room for optimization here because some multipliers are the same for
         // different multi-degrees
         while(mdmac_mdeg_next(cur_mdeg, m->mdeg)) { // move on to the next multi-degree
             mdmac_mdeg_first(mul, cur_mdeg, mdmac_k(m), mdmac_r(m));
-            mdmac_cmp_mmap_mono(mmap, mono, mul, mdmac_k(m), mdmac_r(m), d);
-            mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+            if(mdmac_eqs_stored(m, dst_row_offset)) {
+                mdmac_cmp_mmap_mono(mmap, mono, mul, mdmac_k(m), mdmac_r(m), d);
+                mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+            }
             dst_row_offset += mdmac_m(m);
 
             while(mdmac_mdeg_iterate(mul, cur_mdeg, mdmac_k(m), mdmac_r(m))) { // for every remaining monomial of the current multi-degree
-                mdmac_cmp_mmap_mono(mmap, mono, mul, mdmac_k(m), mdmac_r(m), d);
-                mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+                if(mdmac_eqs_stored(m, dst_row_offset)) {
+                    mdmac_cmp_mmap_mono(mmap, mono, mul, mdmac_k(m), mdmac_r(m), d);
+                    mdmac_fill_in_eqs(m, dst_row_offset, ks, src_row_offset, mmap); // only the (i-1)-th eq in the base ks system
+                }
                 dst_row_offset += mdmac_m(m);
             }
         }
 
         src_row_offset += mdmac_m(m);
+        m->grp_rend[i] = dst_row_offset;
         mdeg_kv_deg_inc(m->mdeg, i);
     }
 
@@ -576,6 +674,7 @@ mdmac_free(MDMac* m) {
     mdmac_free_degs(m->degs, m->degs_sz);
     free(m->degs);
     free(m->mono_num_per_deg);
+    free(m->grp_rend);
     free(m);
 }
 
@@ -584,7 +683,7 @@ mdmac_free(MDMac* m) {
  * params:
  *      1) full_nrow: number of rows in the full MDMac
  *      2) nrow: number of rows to randomly select
- *      3) seed: seed for the random number generator
+ *      3) seed: seed of the stream selecting the rows, see prng.h
  *      4) cb: the callback function, which takes 2 parameters
  *          1st param: how many random rows have been sampled
  *          2nd param: the index of the randomly selected row
@@ -603,11 +702,11 @@ mdmac_iter_random_rows(uint64_t full_nrow, uint64_t nrow, int32_t seed,
         return -1;
 
     bitmap_zero(b);
-    int32_t old_seed = rand();
-    srand(seed);
+    Prng g;
+    prng_init(&g, (uint32_t) seed, PRNG_ROWS, 0);
     uint64_t sample_num = 0; // Floyd's random sampling
     for(uint64_t in = full_nrow - nrow; in < full_nrow && sample_num < nrow; ++in) {
-        uint64_t ridx = uint64_rand() % (in + 1);
+        uint64_t ridx = prng_u64(&g) % (in + 1);
         if(bitmap_at(b, ridx))
             ridx = in;
 
@@ -619,7 +718,6 @@ mdmac_iter_random_rows(uint64_t full_nrow, uint64_t nrow, int32_t seed,
 
     bitmap_free(b);
     assert(sample_num == nrow);
-    srand(old_seed);
     return 0;
 }
 
@@ -668,6 +766,170 @@ mdmac_nznum(uint32_t* restrict out, const MDMac* restrict m, uint64_t nrow,
     return arg.sum;
 }
 
+/* subroutine of mdmac_random_rows: store the index of a sampled row */
+static void
+mdmac_store_row(uint64_t i, uint64_t ridx, void* arg) {
+    ((uint64_t*) arg)[i] = ridx;
+}
+
+/* usage: randomly select rows as mdmac_iter_random_rows and store their
+ *      indices in the order they are sampled
+ * params:
+ *      1) ridxs: container for the indices of the rows. A uint64_t array of
+ *          size at least nrow
+ *      2) full_nrow: number of rows in the full MDMac
+ *      3) nrow: number of rows to randomly select
+ *      4) seed: seed of the stream selecting the rows, see prng.h
+ * return: 0 if success. negative value on error */
+int64_t
+mdmac_random_rows(uint64_t* restrict ridxs, uint64_t full_nrow, uint64_t nrow,
+                  int32_t seed) {
+    return mdmac_iter_random_rows(full_nrow, nrow, seed, mdmac_store_row, ridxs);
+}
+
+/* usage: call a callback function on each of the given rows of a struct MDMac
+ * params:
+ *      1) ridxs: indices of the rows
+ *      2) nrow: size of ridxs
+ *      3) cb: the callback function. See mdmac_iter_random_rows
+ *      4) arg: a generic ptr to pass to the callback function
+ * return: void */
+void
+mdmac_iter_rows(const uint64_t* restrict ridxs, uint64_t nrow,
+                mdmac_iter_rows_cb_t* cb, void* arg) {
+    for(uint64_t i = 0; i < nrow; ++i)
+        cb(i, ridxs[i], arg);
+}
+
+/* usage: Given a struct MDMac, dump the number of non-zero entries of each
+ *      columns in the given rows
+ * params:
+ *      1) out: storage for the result. A uint32_t array with size at least
+ *          as large as the number of columns
+ *      2) m: ptr to struct MDMac
+ *      3) ridxs: indices of the rows
+ *      4) nrow: size of ridxs
+ * return: the total number of non-zero entries */
+uint64_t
+mdmac_nznum_of_rows(uint32_t* restrict out, const MDMac* restrict m,
+                    const uint64_t* restrict ridxs, uint64_t nrow) {
+    memset(out, 0x0, sizeof(uint32_t) * mdmac_ncol(m));
+    struct MDMacNZnumArg arg = { .out = out, .m = m, .sum = 0 };
+    mdmac_iter_rows(ridxs, nrow, mdmac_nznum_inc_col_counter, &arg);
+    return arg.sum;
+}
+
+// min coverage of a column that mdmac_select_rows() balances towards. Beyond
+// a few rows per column, skipping the rows that only add to columns already
+// covered biases the selection and the solution is lost more often
+#define MDMAC_SEL_MAX_COVER     (4)
+
+/* subroutine of mdmac_select_rows: select the row if any of its columns is
+ * covered by less than cover selected rows, and update the coverage */
+static inline bool
+mdmac_select_row_if_under(const MDMac* restrict m, uint64_t ridx,
+                          uint32_t* restrict cnts, uint32_t cover) {
+    const GFA* row = mdmac_row(m, ridx);
+    bool under = false;
+    for(uint64_t j = 0; j < gfa_size(row) && !under; ++j) {
+        gfa_idx_t cidx; gfa_at(row, j, &cidx);
+        under = (cnts[cidx] < cover); // columns not to cover are UINT32_MAX
+    }
+    if(!under)
+        return false;
+
+    for(uint64_t j = 0; j < gfa_size(row); ++j) {
+        gfa_idx_t cidx; gfa_at(row, j, &cidx);
+        if(cnts[cidx] != UINT32_MAX)
+            ++cnts[cidx];
+    }
+    return true;
+}
+
+/* usage: Select rows from a struct MDMac such that the selected columns are
+ *      covered as evenly as possible. The rows are visited in a random order
+ *      in rounds. In the i-th round, a row is selected if it has a selected
+ *      column that is covered by less than i selected rows, up to
+ *      MDMAC_SEL_MAX_COVER rounds. The first round always completes, so every
+ *      selected column that is not empty in the full MDMac is not empty in the
+ *      selected rows, even if more than nrow rows are needed for that. The
+ *      rest are selected uniformly at random.
+ *      NOTE: the rows are not visited from the lightest ones. The weights of
+ *      rows hardly differ, and the light rows are the multiples of a few of the
+ *      equations, which leaves out the relations needed for the solution.
+ * params:
+ *      1) ridxs: container for the indices of the selected rows in ascending
+ *          order. Must be as large as the number of rows in MDMac
+ *      2) m: ptr to struct MDMac
+ *      3) nrow: number of rows to select. Must be <= the number of rows in
+ *          MDMac
+ *      4) seed: seed of the stream ordering the rows, see prng.h
+ *      5) skip: ptr to struct Bitmap where the columns not to cover are set
+ * return: the number of selected rows, which is at least nrow, if success.
+ *      negative value on error */
+int64_t
+mdmac_select_rows(uint64_t* restrict ridxs, const MDMac* restrict m,
+                  uint64_t nrow, int32_t seed, const Bitmap* restrict skip) {
+    const uint64_t full_nrow = mdmac_nrow(m);
+    if(nrow > full_nrow)
+        return -2;
+
+    uint32_t* cnts = malloc(sizeof(uint32_t) * mdmac_ncol(m));
+    Bitmap* sel = bitmap_create(full_nrow);
+    if(!cnts || !sel) {
+        free(cnts); bitmap_free(sel);
+        return -1;
+    }
+
+    // random order of the rows with Fisher-Yates shuffle. ridxs is used as the
+    // storage for it
+    Prng g;
+    prng_init(&g, (uint32_t) seed, PRNG_ROWS, 0);
+    for(uint64_t i = 0; i < full_nrow; ++i)
+        ridxs[i] = i;
+    for(uint64_t i = full_nrow - 1; i > 0; --i) {
+        uint64_t j = prng_u64(&g) % (i + 1);
+        uint64_t tmp = ridxs[i]; ridxs[i] = ridxs[j]; ridxs[j] = tmp;
+    }
+
+    for(uint64_t i = 0; i < mdmac_ncol(m); ++i)
+        cnts[i] = bitmap_at(skip, i) ? UINT32_MAX : 0;
+
+    bitmap_zero(sel);
+    uint64_t sel_num = 0;
+    for(uint32_t cover = 1; cover <= MDMAC_SEL_MAX_COVER &&
+                            (cover == 1 || sel_num < nrow); ++cover) {
+        const uint64_t prev_num = sel_num;
+        for(uint64_t i = 0; i < full_nrow && (cover == 1 || sel_num < nrow); ++i) {
+            const uint64_t ridx = ridxs[i];
+            if(bitmap_at(sel, ridx) ||
+               !mdmac_select_row_if_under(m, ridx, cnts, cover))
+                continue;
+            bitmap_set_true_at(sel, ridx);
+            ++sel_num;
+        }
+        if(prev_num == sel_num) // every column is covered by all its rows
+            break;
+    }
+    for(uint64_t i = 0; i < full_nrow && sel_num < nrow; ++i) {
+        if(bitmap_at(sel, ridxs[i]))
+            continue;
+        bitmap_set_true_at(sel, ridxs[i]);
+        ++sel_num;
+    }
+
+    uint64_t n = 0;
+    for(uint64_t i = 0; i < full_nrow; ++i) {
+        if(bitmap_at(sel, i))
+            ridxs[n++] = i;
+    }
+    assert(n == sel_num);
+
+    free(cnts);
+    bitmap_free(sel);
+    return sel_num;
+}
+
 /* usage: Given a struct MDMac, return the number of columns that correspond to
  *      linear monomials and the constant term.
  * params:
@@ -1028,6 +1290,24 @@ mdmac_combi_eq_num(const MinRank* restrict mr, MDeg** degs, uint32_t sz) {
     return num * minrank_ncol(mr);
 }
 
+/* usage: compute the amount of memory needed for a struct MDMac defined over
+ *      the combined multi-degrees
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) degs: an array of ptrs to struct MDeg
+ *      3) sz: size of degs
+ *      4) max_tnum: max number of non-zero entries in any rows of the
+ *          KS matrix derived from the input MinRank instance
+ * return: amount of memory needed in bytes */
+size_t
+mdmac_combi_calc_memsize(const MinRank* restrict mr, MDeg** degs, uint32_t sz,
+                         uint32_t max_tnum) {
+    uint64_t nrow = mdmac_combi_eq_num(mr, degs, sz);
+    size_t msz = sizeof(MDMac) + gfa_size_of_element() * nrow * max_tnum;
+    msz += gfa_memsize() * nrow;
+    return msz;
+}
+
 static inline void
 mdmac_combi_cmp_mmap_base(gfa_idx_t* restrict mmap, uint32_t k, uint32_t r,
                           const MDeg** degs, uint32_t degs_sz) {
@@ -1105,10 +1385,13 @@ static inline bool
 mdmac_mul_and_fill(MDeg* d, uint64_t idx, void* __arg) {
     struct MDMacMulAndFillArg* arg = __arg;
     if(unlikely(idx == 0)) { // (0, 0, ... 0)
-        mdmac_combi_cmp_mmap_base(arg->mmap, mdmac_k(arg->m), mdmac_r(arg->m),
-                                  arg->degs, arg->m->degs_sz);
-        mdmac_fill_in_eqs(arg->m, arg->dst_row_offset, arg->ks,
-                          arg->src_row_offset, arg->mmap);
+        if(mdmac_eqs_stored(arg->m, arg->dst_row_offset)) {
+            mdmac_combi_cmp_mmap_base(arg->mmap, mdmac_k(arg->m),
+                                      mdmac_r(arg->m), arg->degs,
+                                      arg->m->degs_sz);
+            mdmac_fill_in_eqs(arg->m, arg->dst_row_offset, arg->ks,
+                              arg->src_row_offset, arg->mmap);
+        }
         arg->dst_row_offset += mdmac_m(arg->m);
         return false;
     }
@@ -1119,19 +1402,16 @@ mdmac_mul_and_fill(MDeg* d, uint64_t idx, void* __arg) {
     Mono* mono = mono_create_from_arr(arg->mono_size + 2, mono_buf);
 
     mdmac_mdeg_first(mul, d, mdmac_k(arg->m), mdmac_r(arg->m));
-    mdmac_combi_cmp_mmap_mono(arg->mmap, mono, mul, mdmac_k(arg->m),
-                              mdmac_r(arg->m), arg->degs, arg->m->degs_sz);
-    mdmac_fill_in_eqs(arg->m, arg->dst_row_offset, arg->ks,
-                      arg->src_row_offset, arg->mmap);
-    arg->dst_row_offset += mdmac_m(arg->m);
-
-    while(mdmac_mdeg_iterate(mul, d, mdmac_k(arg->m), mdmac_r(arg->m))) {
-        mdmac_combi_cmp_mmap_mono(arg->mmap, mono, mul, mdmac_k(arg->m),
-                                  mdmac_r(arg->m), arg->degs, arg->m->degs_sz);
-        mdmac_fill_in_eqs(arg->m, arg->dst_row_offset, arg->ks,
-                          arg->src_row_offset, arg->mmap);
+    do {
+        if(mdmac_eqs_stored(arg->m, arg->dst_row_offset)) {
+            mdmac_combi_cmp_mmap_mono(arg->mmap, mono, mul, mdmac_k(arg->m),
+                                      mdmac_r(arg->m), arg->degs,
+                                      arg->m->degs_sz);
+            mdmac_fill_in_eqs(arg->m, arg->dst_row_offset, arg->ks,
+                              arg->src_row_offset, arg->mmap);
+        }
         arg->dst_row_offset += mdmac_m(arg->m);
-    }
+    } while(mdmac_mdeg_iterate(mul, d, mdmac_k(arg->m), mdmac_r(arg->m)));
 
     return false;
 }
@@ -1148,7 +1428,25 @@ mdmac_mul_and_fill(MDeg* d, uint64_t idx, void* __arg) {
 MDMac*
 mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
                            const MDeg** restrict degs, uint32_t sz) {
-    assert(ks && mr && degs && sz);
+    return mdmac_combi_create_from_ks_part(ks, mr, degs, sz, 0, 1);
+}
+
+/* usage: the counterpart of mdmac_combi_create_from_ks that only computes a
+ *      part of the Macaulay matrix. See mdmac_create_from_ks_part
+ * params:
+ *      1) ks: ptr to struct GDM that stores the base KS system
+ *      2) mr: ptr to struct MinRank that defines the MinRank problem
+ *      3) degs: an array of ptrs to struct MDeg
+ *      4) sz: size of degs
+ *      5) part: index of the part to compute
+ *      6) part_num: number of parts
+ * return: ptr to struct MDMac. NULL on error or if the part has no rows */
+MDMac*
+mdmac_combi_create_from_ks_part(const GFM* restrict ks,
+                                const MinRank* restrict mr,
+                                const MDeg** restrict degs, uint32_t sz,
+                                uint32_t part, uint32_t part_num) {
+    assert(ks && mr && degs && sz && part < part_num);
     for(uint32_t i = 0; i < sz; ++i)
         if(!mdmac_check_mdeg(degs[i]))
             return NULL;
@@ -1170,7 +1468,10 @@ mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
     const uint32_t k = minrank_nmat(mr), r = minrank_rank(mr);
     assert(ks_base_total_mono_num(k, r, c) == gfm_ncol(ks));
     uint64_t ncol = ks_mdmac_combi_total_mono_num(k, r, degs, sz);
-    uint64_t nrow = mdmac_combi_eq_num(mr, degs_copy, sz);
+    const uint64_t full_nrow = mdmac_combi_eq_num(mr, degs_copy, sz);
+    uint64_t rbeg, rend;
+    mdmac_part_range(&rbeg, &rend, full_nrow, part, part_num);
+    const uint64_t nrow = rend - rbeg;
     if(unlikely(nrow == 0))
         return NULL;
 
@@ -1188,6 +1489,7 @@ mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
 
     // TODO
     m->mono_num_per_deg = NULL;
+    m->grp_rend = NULL;
 
     m->rows = gfa_arr_create(max_tnum, nrow, m->memblk);
     if(!m->rows) {
@@ -1196,13 +1498,16 @@ mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
     }
 
     gfa_idx_t* mmap = malloc(sizeof(gfa_idx_t) * ks_base_total_mono_num(k, r, c));
-    if(!mmap) {
+    m->grp_rend = malloc(sizeof(uint64_t) * c);
+    if(!mmap || !m->grp_rend) {
+        free(mmap);
         mdmac_free(m);
         return NULL;
     }
 
     m->k = k; m->r = r; m->c = c; m->m = minrank_ncol(mr);
     m->nrow = nrow; m->ncol = ncol;
+    m->full_nrow = full_nrow; m->roff = rbeg;
 
     m->mdeg = mdeg_create_zero(c);
     if(!m->mdeg) {
@@ -1236,6 +1541,7 @@ mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
                                 mdmac_mul_and_fill, &arg);
         dst_row_offset = arg.dst_row_offset;
         src_row_offset += mdmac_m(m);
+        m->grp_rend[i] = dst_row_offset;
 
         for(uint32_t j = 0; j < sz; ++j) // restore
             mdeg_kv_deg_inc(m->degs[j], i);
@@ -1244,7 +1550,7 @@ mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
     for(uint32_t i = 0; i < sz; ++i) // restore
         mdeg_lv_deg_inc(m->degs[i]);
 
-    assert(nrow == dst_row_offset);
+    assert(full_nrow == dst_row_offset);
     free(mmap);
     return m;
 }
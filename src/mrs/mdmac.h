@@ -9,6 +9,7 @@
 #include "mono.h"
 #include "gfa.h"
 #include "minrank.h"
+#include "bitmap.h"
 
 typedef struct MDMac MDMac;
 typedef struct MDMacColIterator MDMacColIterator;
@@ -95,6 +96,22 @@ mdmac_deg(const MDMac* m);
 uint64_t
 mdmac_nrow(const MDMac* m);
 
+/* usage: Given a struct MDMac, return the number of rows of the full matrix,
+ *      which differs from mdmac_nrow if only a part of it is stored
+ * params:
+ *      1) m: ptr to struct MDMac
+ * return: number of rows */
+uint64_t
+mdmac_full_nrow(const MDMac* m);
+
+/* usage: Given a struct MDMac, return the index in the full matrix of its
+ *      first row, which is non-zero if only a part of it is stored
+ * params:
+ *      1) m: ptr to struct MDMac
+ * return: index of the first row */
+uint64_t
+mdmac_roff(const MDMac* m);
+
 /* usage: Given a struct MDMac, return its number of columns (monomials)
  * params:
  *      1) m: ptr to struct MDMac
@@ -167,6 +184,17 @@ mdmac_eq_num(const MinRank* restrict mr, const MDeg* restrict mdeg);
 const GFA*
 mdmac_row(const MDMac* m, uint64_t i);
 
+/* usage: Given a struct MDMac and the row index i, return the index of the row
+ *      in the base KS system that the i-th row is a multiple of. The non-zero
+ *      entries of the i-th row are in the same order as those of the row in
+ *      the base KS system
+ * params:
+ *      1) m: ptr to struct MDMac
+ *      2) i: index of the row
+ * return: index of the row in the base KS system */
+uint64_t
+mdmac_row_src(const MDMac* m, uint64_t i);
+
 /* usage: Given a struct MDMac, row index i, and column index j, return
  *      the specified entry
  * params:
@@ -187,6 +215,22 @@ mdmac_at(const MDMac* m, uint64_t i, uint64_t j);
 MDMac*
 mdmac_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr, const MDeg* restrict mdeg);
 
+/* usage: the counterpart of mdmac_create_from_ks that only computes a part of
+ *      the multi-degree Macaulay matrix. The rows are split into part_num
+ *      contiguous ranges of about the same size, and only those of the given
+ *      part are stored. See mdmac_roff and mdmac_full_nrow
+ * params:
+ *      1) ks: ptr to struct GDM that stores the base KS system
+ *      2) mr: ptr to struct MinRank that defines the MinRank problem
+ *      3) d: ptr to struct MDeg that specifies the target multi-degree
+ *      4) part: index of the part to compute
+ *      5) part_num: number of parts
+ * return: ptr to struct MDMac. NULL on error or if the part has no rows */
+MDMac*
+mdmac_create_from_ks_part(const GFM* restrict ks, const MinRank* restrict mr,
+                          const MDeg* restrict d, uint32_t part,
+                          uint32_t part_num);
+
 /* usage: Given a struct MDMac, release it
  * params:
  *      1) m: ptr to struct MDMac
@@ -266,6 +310,29 @@ mdmac_vidx_to_midx(const MDMac* restrict m, uint64_t vidx);
 void
 mdmac_print(const MDMac* m);
 
+/* usage: Given the MinRank instance, and an array of multi-degrees, compute
+ *      the number of rows in the MDMac defined over the combined multi-degrees.
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) degs: an array of ptrs to struct MDeg
+ *      3) sz: size of degs
+ * return: total number of eqs in the multi-degree Macaulay matrix */
+uint64_t
+mdmac_combi_eq_num(const MinRank* restrict mr, MDeg** degs, uint32_t sz);
+
+/* usage: compute the amount of memory needed for a struct MDMac defined over
+ *      the combined multi-degrees
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) degs: an array of ptrs to struct MDeg
+ *      3) sz: size of degs
+ *      4) max_tnum: max number of non-zero entries in any rows of the
+ *          KS matrix derived from the input MinRank instance
+ * return: amount of memory needed in bytes */
+size_t
+mdmac_combi_calc_memsize(const MinRank* restrict mr, MDeg** degs, uint32_t sz,
+                         uint32_t max_tnum);
+
 /* usage: Given a base KS system constructed for a MinRank instance, and an
  *      array of target multi-degrees, compute a Macaulay matrix whose
  *      monomials satisfy any of the multi-degrees.
@@ -279,12 +346,28 @@ MDMac*
 mdmac_combi_create_from_ks(const GFM* restrict ks, const MinRank* restrict mr,
                            const MDeg** restrict degs, uint32_t sz);
 
+/* usage: the counterpart of mdmac_combi_create_from_ks that only computes a
+ *      part of the Macaulay matrix. See mdmac_create_from_ks_part
+ * params:
+ *      1) ks: ptr to struct GDM that stores the base KS system
+ *      2) mr: ptr to struct MinRank that defines the MinRank problem
+ *      3) degs: an array of ptrs to struct MDeg
+ *      4) sz: size of degs
+ *      5) part: index of the part to compute
+ *      6) part_num: number of parts
+ * return: ptr to struct MDMac. NULL on error or if the part has no rows */
+MDMac*
+mdmac_combi_create_from_ks_part(const GFM* restrict ks,
+                                const MinRank* restrict mr,
+                                const MDeg** restrict degs, uint32_t sz,
+                                uint32_t part, uint32_t part_num);
+
 /* usage: randomly select rows from a struct MDMac and call a callback function
  *      on each of the selected rows
  * params:
  *      1) full_nrow: number of rows in the full MDMac
  *      2) nrow: number of rows to randomly select
- *      3) seed: seed for the random number generator
+ *      3) seed: seed of the stream selecting the rows, see prng.h
  *      4) cb: the callback function, which takes 2 parameters
  *          1st param: how many random rows have been sampled
  *          2nd param: the index of the randomly selected row
@@ -296,6 +379,61 @@ int64_t
 mdmac_iter_random_rows(uint64_t full_nrow, uint64_t nrow, int32_t seed,
                        mdmac_iter_rows_cb_t* cb, void* arg);
 
+/* usage: randomly select rows as mdmac_iter_random_rows and store their
+ *      indices in the order they are sampled
+ * params:
+ *      1) ridxs: container for the indices of the rows. A uint64_t array of
+ *          size at least nrow
+ *      2) full_nrow: number of rows in the full MDMac
+ *      3) nrow: number of rows to randomly select
+ *      4) seed: seed of the stream selecting the rows, see prng.h
+ * return: 0 if success. negative value on error */
+int64_t
+mdmac_random_rows(uint64_t* restrict ridxs, uint64_t full_nrow, uint64_t nrow,
+                  int32_t seed);
+
+/* usage: call a callback function on each of the given rows of a struct MDMac
+ * params:
+ *      1) ridxs: indices of the rows
+ *      2) nrow: size of ridxs
+ *      3) cb: the callback function. See mdmac_iter_random_rows
+ *      4) arg: a generic ptr to pass to the callback function
+ * return: void */
+void
+mdmac_iter_rows(const uint64_t* restrict ridxs, uint64_t nrow,
+                mdmac_iter_rows_cb_t* cb, void* arg);
+
+/* usage: Given a struct MDMac, dump the number of non-zero entries of each
+ *      columns in the given rows
+ * params:
+ *      1) out: storage for the result. A uint32_t array with size at least
+ *          as large as the number of columns
+ *      2) m: ptr to struct MDMac
+ *      3) ridxs: indices of the rows
+ *      4) nrow: size of ridxs
+ * return: the total number of non-zero entries */
+uint64_t
+mdmac_nznum_of_rows(uint32_t* restrict out, const MDMac* restrict m,
+                    const uint64_t* restrict ridxs, uint64_t nrow);
+
+/* usage: Select rows from a struct MDMac, in a random order, such that the
+ *      selected columns are covered as evenly as possible. Every selected
+ *      column that is not empty in the full MDMac is not empty in the selected
+ *      rows, even if more than nrow rows are needed for that.
+ * params:
+ *      1) ridxs: container for the indices of the selected rows in ascending
+ *          order. Must be as large as the number of rows in MDMac
+ *      2) m: ptr to struct MDMac
+ *      3) nrow: number of rows to select. Must be <= the number of rows in
+ *          MDMac
+ *      4) seed: seed of the stream ordering the rows, see prng.h
+ *      5) skip: ptr to struct Bitmap where the columns not to cover are set
+ * return: the number of selected rows, which is at least nrow, if success.
+ *      negative value on error */
+int64_t
+mdmac_select_rows(uint64_t* restrict ridxs, const MDMac* restrict m,
+                  uint64_t nrow, int32_t seed, const Bitmap* restrict skip);
+
 MDMacColIterator*
 mdmac_col_iter_create(uint32_t k, uint32_t r, uint32_t c,
                       const MDeg* mdeg, mdmac_col_iter_cb_t* cb);
@@ -21,6 +21,7 @@ struct MinRank {
     uint32_t ncol;      // number of columns in a matrix Mi
     uint32_t nmat;      // number of matrices in the homogeneous part (k)
     uint32_t rank;      // the target rank
+    uint32_t q;         // size of the field
     GFM* m0;            // matrix M0 (heterogeneous case)
     GFM* ms;            // matrices M1, M2, ..., Mk
 };
@@ -65,6 +66,31 @@ minrank_rank(const MinRank* mr) {
     return mr->rank;
 }
 
+/* usage: Given a struct MinRank, return the size of the field of its
+ *      coefficients
+ * params:
+ *      1) mr: ptr to MinRank
+ * return: the field size, GF_MAX + 1 unless set with minrank_set_field */
+uint32_t
+minrank_field(const MinRank* mr) {
+    return mr->q;
+}
+
+/* usage: Given a struct MinRank, set the size of the field of its
+ *      coefficients. Besides GF(16), instances over its subfield GF(2) and
+ *      over GF(31) are supported. The coefficients must already be reduced
+ * params:
+ *      1) mr: ptr to MinRank
+ *      2) q: the field size
+ * return: true on success, false if the field is not supported */
+bool
+minrank_set_field(MinRank* mr, uint32_t q) {
+    if(q != GF_MAX + 1 && q != 2 && q != GF31_SIZE)
+        return false;
+    mr->q = q;
+    return true;
+}
+
 /* usage: Given a struct MinRank, return its inhomogeneous matrix M0
  * params:
  *      1) mr: ptr to MinRank
@@ -143,6 +169,7 @@ minrank_create(uint32_t nrow, uint32_t ncol, uint32_t k, uint32_t r,
     mr->ncol = ncol;
     mr->nmat = k;
     mr->rank = r;
+    mr->q = GF_MAX + 1;
 
     return mr;
 }
@@ -359,3 +386,142 @@ minrank_ks(const MinRank* mr, uint32_t c) {
     gfm_free((GFM*) ml);
     return ks;
 }
+
+/* usage: Given a struct MinRank, compute the sparsity pattern of its
+ *      Kipnis-Shamir matrix, i.e. the KS matrix with every entry that can be
+ *      non-zero for an instance of the same parameters set to 1. Every entry
+ *      of the KS matrix is a single coefficient of the instance, so this is
+ *      the KS matrix of an instance whose coefficients are all 1
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) c: number of rows in the left multiplier.
+ *          1 <= c <= minrank_nrow(mr) - minrank_rank(mr)
+ * return: ptr to struct GFM, on error NULL */
+GFM*
+minrank_ks_pattern(const MinRank* mr, uint32_t c) {
+    const uint32_t nrow = minrank_nrow(mr), ncol = minrank_ncol(mr);
+    const uint32_t k = minrank_nmat(mr);
+    const uint64_t sz = (uint64_t) nrow * ncol;
+    GFM* m0 = NULL, *ms = gfm_arr_create(nrow, ncol, k, NULL);
+    if(!ms || (minrank_m0(mr) && !(m0 = gfm_create(nrow, ncol, NULL)))) {
+        if(ms)
+            gfm_arr_free(ms, k);
+        return NULL;
+    }
+    if(m0)
+        memset(gfm_memblk(m0), 1, sz);
+    for(uint32_t i = 0; i < k; ++i)
+        memset(gfm_memblk(gfm_arr_at(ms, i)), 1, sz);
+
+    MinRank* ones = minrank_create(nrow, ncol, k, minrank_rank(mr), m0, ms);
+    if(!ones) {
+        if(m0)
+            gfm_free(m0);
+        gfm_arr_free(ms, k);
+        return NULL;
+    }
+    GFM* ks = minrank_ks(ones, c);
+    minrank_free(ones);
+    return ks;
+}
+
+/* usage: Given a struct MinRank, fix its last g linear variables to the given
+ *      values. The matrices they multiply are folded into M0, so that the
+ *      result is an inhomogeneous instance with k-g matrices, whose solutions
+ *      extended by the given values are the solutions of the original one
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) vals: values of the variables lambda_{k-g+1} ~ lambda_k
+ *      3) g: number of variables to fix. 1 <= g < minrank_nmat(mr)
+ * return: ptr to struct MinRank, on error NULL */
+MinRank*
+minrank_specialize(const MinRank* restrict mr, const gf_t* restrict vals,
+                   uint32_t g) {
+    const uint32_t nrow = minrank_nrow(mr), ncol = minrank_ncol(mr);
+    const uint32_t k = minrank_nmat(mr) - g;
+    assert(g && g < minrank_nmat(mr));
+
+    // M0 is kept even if it's zero, so that the KS matrices of all the
+    // specializations share the same sparsity pattern
+    GFM* m0 = gfm_create(nrow, ncol, NULL);
+    GFM* ms = gfm_arr_create(nrow, ncol, k, NULL);
+    if(!m0 || !ms) {
+        if(m0)
+            gfm_free(m0);
+        if(ms)
+            gfm_arr_free(ms, k);
+        return NULL;
+    }
+
+    for(uint32_t i = 0; i < k; ++i)
+        gfm_rows_copy_from(gfm_arr_at(ms, i), 0, nrow,
+                           gfm_row_addr(minrank_matrix(mr, i+1), 0));
+    if(minrank_m0(mr))
+        gfm_rows_copy_from(m0, 0, nrow, gfm_row_addr(minrank_m0(mr), 0));
+    else
+        gfm_zero(m0);
+    gf_t* m0_blk = gfm_memblk(m0);
+    for(uint32_t j = 0; j < g; ++j) {
+        if(!vals[j])
+            continue;
+        gf_t_arr_fmaddi_scalar(m0_blk, gfm_row_addr(minrank_matrix(mr, k+1+j), 0),
+                               nrow * ncol, vals[j]);
+    }
+
+    MinRank* sp = minrank_create(nrow, ncol, k, minrank_rank(mr), m0, ms);
+    if(!sp) {
+        gfm_free(m0);
+        gfm_arr_free(ms, k);
+    }
+    return sp;
+}
+
+/* usage: Given a struct MinRank and values of its linear variables, compute
+ *      the rank of M0 + lambda_1 * M1 + ... + lambda_k * Mk
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) lambda: values of the variables lambda_1 ~ lambda_k
+ * return: the rank, or UINT32_MAX if memory allocation failed */
+uint32_t
+minrank_eval_rank(const MinRank* restrict mr, const gf_t* restrict lambda) {
+    const uint32_t nrow = minrank_nrow(mr), ncol = minrank_ncol(mr);
+    gf_t* m = calloc((uint64_t) nrow * ncol, sizeof(gf_t));
+    if(!m)
+        return UINT32_MAX;
+
+    if(minrank_m0(mr))
+        memcpy(m, gfm_row_addr(minrank_m0(mr), 0), sizeof(gf_t) * nrow * ncol);
+    for(uint32_t i = 0; i < minrank_nmat(mr); ++i) {
+        if(lambda[i])
+            gf_t_arr_fmaddi_scalar(m, gfm_row_addr(minrank_matrix(mr, i+1), 0),
+                                   nrow * ncol, lambda[i]);
+    }
+
+    // Gaussian elimination
+    uint32_t rank = 0;
+    for(uint32_t ci = 0; ci < ncol && rank < nrow; ++ci) {
+        uint32_t pi = rank;
+        while(pi < nrow && !m[pi * ncol + ci])
+            ++pi;
+        if(pi == nrow)
+            continue;
+
+        gf_t* pivot = m + rank * ncol;
+        if(pi != rank) {
+            for(uint32_t j = 0; j < ncol; ++j) {
+                gf_t tmp = pivot[j];
+                pivot[j] = m[pi * ncol + j];
+                m[pi * ncol + j] = tmp;
+            }
+        }
+        gf_t_arr_muli_scalar(pivot, ncol, gf_t_inv(pivot[ci]));
+        for(uint32_t ri = rank + 1; ri < nrow; ++ri) {
+            gf_t* row = m + ri * ncol;
+            if(row[ci])
+                gf_t_arr_fmsubi_scalar(row, pivot, ncol, row[ci]);
+        }
+        ++rank;
+    }
+    free(m);
+    return rank;
+}
@@ -3,6 +3,8 @@
 #ifndef __MINRANK_H__
 #define __MINRANK_H__
 
+#include <stdbool.h>
+
 #include "gfm.h"
 
 typedef struct MinRank MinRank;
@@ -39,6 +41,24 @@ minrank_nmat(const MinRank* mr);
 uint32_t
 minrank_rank(const MinRank* mr);
 
+/* usage: Given a struct MinRank, return the size of the field of its
+ *      coefficients
+ * params:
+ *      1) mr: ptr to MinRank
+ * return: the field size, GF_MAX + 1 unless set with minrank_set_field */
+uint32_t
+minrank_field(const MinRank* mr);
+
+/* usage: Given a struct MinRank, set the size of the field of its
+ *      coefficients. Besides GF(16), instances over its subfield GF(2) and
+ *      over GF(31) are supported. The coefficients must already be reduced
+ * params:
+ *      1) mr: ptr to MinRank
+ *      2) q: the field size
+ * return: true on success, false if the field is not supported */
+bool
+minrank_set_field(MinRank* mr, uint32_t q);
+
 /* usage: Given a struct MinRank, return its inhomogeneous matrix M0
  * params:
  *      1) mr: ptr to MinRank
@@ -162,4 +182,37 @@ minrank_ks_ncol(const MinRank* mr, uint32_t c) {
 GFM*
 minrank_ks(const MinRank* mr, uint32_t c);
 
+/* usage: Given a struct MinRank, compute the sparsity pattern of its
+ *      Kipnis-Shamir matrix, i.e. the KS matrix with every entry that can be
+ *      non-zero for an instance of the same parameters set to 1
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) c: number of rows in the left multiplier.
+ *          1 <= c <= minrank_nrow(mr) - minrank_rank(mr)
+ * return: ptr to struct GFM, on error NULL */
+GFM*
+minrank_ks_pattern(const MinRank* mr, uint32_t c);
+
+/* usage: Given a struct MinRank, fix its last g linear variables to the given
+ *      values. The matrices they multiply are folded into M0, so that the
+ *      result is an inhomogeneous instance with k-g matrices, whose solutions
+ *      extended by the given values are the solutions of the original one
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) vals: values of the variables lambda_{k-g+1} ~ lambda_k
+ *      3) g: number of variables to fix. 1 <= g < minrank_nmat(mr)
+ * return: ptr to struct MinRank, on error NULL */
+MinRank*
+minrank_specialize(const MinRank* restrict mr, const gf_t* restrict vals,
+                   uint32_t g);
+
+/* usage: Given a struct MinRank and values of its linear variables, compute
+ *      the rank of M0 + lambda_1 * M1 + ... + lambda_k * Mk
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) lambda: values of the variables lambda_1 ~ lambda_k
+ * return: the rank, or UINT32_MAX if memory allocation failed */
+uint32_t
+minrank_eval_rank(const MinRank* restrict mr, const gf_t* restrict lambda);
+
 #endif // __MINRANK_H__
@@ -0,0 +1,1754 @@
+#include "mrs.h"
+#include "gfa.h"
+#include "gfm.h"
+#include "matrix_gf16.h"
+#include "util.h"
+#include "ks.h"
+#include "mdmac.h"
+#include "cmsm_generic.h"
+#include "cmsm_filter.h"
+#include "cmsm_ooc.h"
+#include "block_lanczos_gf16.h"
+#include "block_lanczos_gf2.h"
+#include "block_lanczos_gf31.h"
+#include "echelon_gf16.h"
+#include "echelon_gf31.h"
+#include "plan_cache.h"
+#include "prof.h"
+#include "dist.h"
+#include "bitmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// for solving the final linear system
+#include "rc64m_gf16.h"
+#include "rc128m_gf16.h"
+#include "rc256m_gf16.h"
+#include "rc512m_gf16.h"
+#include "dm_gf16.h"
+
+// TODO: fix this estimation
+#define LANCZOS_MAX_ITER    (0x1ULL << 3)
+#define FILTER_MAX_MERGE_WT (8)
+#define FILTER_PRUNE_DIV    (4) // drop at most 1/4 of the excess rows
+
+/* ========================================================================
+ * solution container
+ * ======================================================================== */
+
+// operations on the solution container (sc), whose type depends on the number
+// of columns to keep
+typedef struct {
+    uint32_t size;
+    void* (*create)(void); // NULL for DMGF16, see sc_create
+    void (*zero)(void*);
+    void* (*raddr)(void*, uint32_t);
+    gf16_t (*at)(void*, uint32_t, uint32_t);
+    void (*gj_internal)(void*, void*, void*);
+    void (*free)(void*);
+    uint64_t (*uint_at)(void*, uint32_t);
+    void (*row_set_at)(void*, uint32_t, gf16_t);
+} SCOps;
+
+typedef union {
+    uint512_t b512;
+    uint256_t b256;
+    uint128_t b128;
+    uint64_t b64;
+    uint64_t* bl; // for containers larger than 512, allocated by the caller
+} sc_di_t;
+
+static inline bool
+sc_gj(const SCOps* restrict sc_ops, void* restrict sc, void* restrict inv,
+      sc_di_t* restrict di, uint32_t tnum, Threadpool* restrict tp) {
+    void* ptr = NULL;
+    if(sc_ops->size > 512) {
+        return dm_gf16_gj(sc, inv, di->bl, tnum, tp);
+    } else if(sc_ops->size == 512) {
+        // the largest container is worth splitting across threads
+        rc512m_gf16_gj_parallel(sc, inv, &(di->b512), tnum, tp);
+        return true;
+    } else if (sc_ops->size == 256) {
+        ptr = &(di->b256);
+    } else if (sc_ops->size == 128) {
+        ptr = &(di->b128);
+    } else {
+        ptr = &(di->b64);
+    }
+    sc_ops->gj_internal(sc, inv, ptr);
+    return true;
+}
+
+static inline void*
+sc_di_addr(const SCOps* restrict sc_ops, sc_di_t* restrict di) {
+    return (sc_ops->size > 512) ? (void*) di->bl : (void*) di;
+}
+
+static inline uint64_t
+sc_popcnt(const SCOps* restrict sc_ops, sc_di_t* restrict di) {
+    if(sc_ops->size > 512) {
+        uint64_t sum = 0;
+        for(uint32_t i = 0; i < (sc_ops->size >> 6); ++i)
+            sum += uint64_popcount(di->bl[i]);
+        return sum;
+    } else if(sc_ops->size == 512)
+        return uint512_t_popcount(&di->b512);
+    else if (sc_ops->size == 256)
+        return uint256_t_popcount(&di->b256);
+    else if (sc_ops->size == 128)
+        return uint128_t_popcount(&di->b128);
+    else
+        return uint64_popcount(di->b64);
+}
+
+/* create the linear system to solve, or its constant column if sol is set.
+ * The size of struct DMGF16 is decided at runtime */
+static inline void*
+sc_create(const SCOps* sc_ops, bool sol) {
+    if(sc_ops->size > 512)
+        return dm_gf16_create(sc_ops->size, sol ? 1 : sc_ops->size);
+    return sc_ops->create();
+}
+
+// wrappers for struct DMGF16
+static void*
+dm_sc_raddr(void* m, uint32_t i) {
+    return dm_gf16_raddr(m, i);
+}
+
+static gf16_t
+dm_sc_at(void* m, uint32_t i, uint32_t j) {
+    return dm_gf16_at(m, i, j);
+}
+
+static uint64_t
+dm_sc_uint_at(void* di, uint32_t i) {
+    return (((uint64_t*) di)[i >> 6] >> (i & 0x3FU)) & 0x1U;
+}
+
+static void
+dm_sc_row_set_at(void* row, uint32_t i, gf16_t v) {
+    dm_gf16_row_set_at(row, i, v);
+}
+
+static inline void
+sc_ops_init(SCOps* sc_ops, uint32_t remaining_ncols) {
+    if(remaining_ncols > 512) {
+        sc_ops->size = (remaining_ncols + 63) & ~0x3FU;
+        sc_ops->create = NULL; // see sc_create
+        sc_ops->zero = (void(*)(void*)) dm_gf16_zero;
+        sc_ops->at = dm_sc_at;
+        sc_ops->raddr = dm_sc_raddr;
+        sc_ops->gj_internal = NULL; // see sc_gj
+        sc_ops->free = (void(*)(void*)) dm_gf16_free;
+        sc_ops->uint_at = dm_sc_uint_at;
+        sc_ops->row_set_at = dm_sc_row_set_at;
+    } else if(remaining_ncols > 256) {
+        sc_ops->size = 512;
+        sc_ops->create = (void*(*)(void)) rc512m_gf16_create;
+        sc_ops->zero = (void(*)(void*)) rc512m_gf16_zero;
+        sc_ops->at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc512m_gf16_at;
+        sc_ops->raddr = (void*(*)(void*, uint32_t)) rc512m_gf16_raddr;
+        sc_ops->gj_internal = (void(*)(void*, void*, void*)) rc512m_gf16_gj;
+        sc_ops->free = (void(*)(void*)) rc512m_gf16_free;
+        sc_ops->uint_at = (uint64_t(*)(void*, uint32_t)) uint512_t_at;
+        sc_ops->row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp512_gf16_set_at;
+    } else if(remaining_ncols > 128) {
+        sc_ops->size = 256;
+        sc_ops->create = (void*(*)(void)) rc256m_gf16_create;
+        sc_ops->zero = (void(*)(void*)) rc256m_gf16_zero;
+        sc_ops->at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc256m_gf16_at;
+        sc_ops->raddr = (void*(*)(void*, uint32_t)) rc256m_gf16_raddr;
+        sc_ops->gj_internal = (void(*)(void*, void*, void*)) rc256m_gf16_gj;
+        sc_ops->free = (void(*)(void*)) rc256m_gf16_free;
+        sc_ops->uint_at = (uint64_t(*)(void*, uint32_t)) uint256_t_at;
+        sc_ops->row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp256_gf16_set_at;
+    } else if(remaining_ncols > 64) {
+        sc_ops->size = 128;
+        sc_ops->create = (void*(*)(void)) rc128m_gf16_create;
+        sc_ops->zero = (void(*)(void*)) rc128m_gf16_zero;
+        sc_ops->at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc128m_gf16_at;
+        sc_ops->raddr = (void*(*)(void*, uint32_t)) rc128m_gf16_raddr;
+#if defined(__AVX512F__) && !(defined(__GFNI__) && defined(__AVX512VBMI__))
+        sc_ops->gj_internal = (void(*)(void*, void*, void*)) rc128m_gf16_gj;
+#else
+        // with GFNI the product with the pivot row takes a couple of
+        // instructions, and without AVX-512 the bitmask doesn't pay off, so
+        // the naive elimination is faster. See gjbench
+        sc_ops->gj_internal = (void(*)(void*, void*, void*)) rc128m_gf16_gj_naive;
+#endif
+        sc_ops->free = (void(*)(void*)) rc128m_gf16_free;
+        sc_ops->uint_at = (uint64_t(*)(void*, uint32_t)) uint128_t_at;
+        sc_ops->row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp128_gf16_set_at;
+    } else {
+        sc_ops->size = 64;
+        sc_ops->create = (void*(*)(void)) rc64m_gf16_create;
+        sc_ops->zero = (void(*)(void*)) rc64m_gf16_zero;
+        sc_ops->at = (gf16_t(*)(void*, uint32_t, uint32_t)) rc64m_gf16_at;
+        sc_ops->raddr = (void*(*)(void*, uint32_t)) rc64m_gf16_raddr;
+        sc_ops->gj_internal = (void(*)(void*, void*, void*)) rc64m_gf16_gj;
+        sc_ops->free = (void(*)(void*)) rc64m_gf16_free;
+        sc_ops->uint_at = (uint64_t(*)(void*, uint32_t)) uint64_t_at;
+        sc_ops->row_set_at = (void(*)(void*, uint32_t, gf16_t)) grp64_gf16_set_at;
+    }
+}
+
+/* ========================================================================
+ * struct MRSolver definition
+ * ======================================================================== */
+
+struct MRSolver {
+    MRSParams prm;
+    Threadpool* tpool;
+    bool own_tpool;
+    SCOps sc;
+
+    // parameters of the instances the containers below are built for
+    bool ready;
+    uint32_t nrow, ncol, k, r;
+    bool has_m0;
+
+    bool refill; // whether the matrices are refilled from patterns
+    MacPlan* plan; // the symbolic phase, own_plan unless shared by another
+                   // context. cmsm and cmsm_kept are patterns if refill is
+                   // set, otherwise they are moved out below
+    MacPlan own_plan;
+    CMSMGeneric* cmsm; // the matrix to eliminate
+    CMSMOOC* ooc; // or the matrix to eliminate on disk, with --ooc
+    CMSMGeneric* cmsm_kept; // the columns to keep
+
+    // state of the numeric phase
+    uint64_t* defl_buf;
+    BLKGF16Arg* blkarg;
+    BLKGF2Arg* blkarg2; // for matrices over GF(2)
+    BLKGF31Arg* blkarg31; // for instances over GF(31)
+    EchelonGF31* ech31;
+    RMGF16* p;
+    RMGF16* gf_buf;
+    EchelonGF16* ech;
+    void* reduced_mdmac;
+    void* sol;
+    uint64_t* di_buf;
+};
+
+// log to stdout unless the context is quiet
+#define mrs_log_ts(s, ...) do { \
+    if(!(s)->prm.quiet) \
+        printf_ts(__VA_ARGS__); \
+} while(0)
+
+#define mrs_log(s, ...) do { \
+    if(!(s)->prm.quiet) \
+        printf(__VA_ARGS__); \
+} while(0)
+
+static inline void
+mrs_progress(const MRSolver* s, MRSStage stage, uint64_t done, uint64_t total) {
+    if(s->prm.progress)
+        s->prm.progress(s->prm.progress_arg, stage, done, total);
+}
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* subroutine of mrs_solver_solve: find the non-zero vectors in v^T that lead
+ *      to a linear combination of rows of cmsm that is zero. The indices of
+ *      those vectors are encoded in a DiagMGF16* */
+static inline void
+verify_nullvec(DiagMGF16* restrict out, RMGF16* restrict p,
+               const CMSMGeneric* restrict cmsm, const RMGF16* restrict v) {
+    DiagMGF16 zv, zp;
+    rm_gf16_zc_pos(v, &zv); // find zero vectors
+    cmsm_gf16_tr_mul_rm(p, cmsm, v); // compute v^t * cm (i.e. cm^t * v)
+    rm_gf16_zc_pos(p, &zp);
+    diagm_gf16_andn(out, &zp, &zv);
+}
+
+static inline void
+store_vec(const SCOps* restrict sc_ops, void* p, void* sol, uint32_t dst_idx,
+          uint32_t remaining_ncol, const gf16_t* vec_buf) {
+    void* dst = sc_ops->raddr(p, dst_idx);
+    void* sol_dst = sc_ops->raddr(sol, dst_idx);
+    sc_ops->row_set_at(sol_dst, 0, vec_buf[0]); // constant term
+    for(uint32_t k = 1; k < remaining_ncol; ++k) { // variables
+        sc_ops->row_set_at(dst, k-1, vec_buf[k]);
+    }
+}
+
+/* subroutine of mrs_solver_solve: given the positions of non-trivial
+ *      nullvectors, compute linear combinations based on them and store the
+ *      ones that increase the rank of the collected linear system. Each of
+ *      them is reduced by the previous ones before being stored, which are row
+ *      operations on the final linear system. A linear combination whose
+ *      variables are all eliminated but not the constant term means the system
+ *      is inconsistent. It is stored after the last variable so
+ *      mrs_solution_create() can detect it. */
+static inline uint32_t
+proc_nullvec(const SCOps* restrict sc_ops, EchelonGF16* restrict ech,
+             void* restrict p, void* restrict sol,
+             RMGF16* restrict prod, const RMGF16* restrict v,
+             const CMSMGeneric* restrict cmsm_kept, uint32_t tnum,
+             RMGF16PArg* restrict args, Threadpool* restrict tp,
+             const uint64_t* restrict kmap,
+#ifdef BLK_LANCZOS_COLLECT_STATS
+             uint32_t remaining_ncol, uint64_t* restrict dep_count) {
+#else
+            uint32_t remaining_ncol) {
+#endif
+    cmsm_gf16_tr_mul_rm_parallel(prod, cmsm_kept, v, tnum, args, tp);
+    // positions of nullvectors that are in the left kernel
+   DiagMGF16 valid_nv_pos;
+   // NOTE: we simply assume all nullvectors are in the left kernel of
+   // the submatrix to eliminate, since heuristically they are.
+    rm_gf16_nzc_pos(prod, &valid_nv_pos);
+
+    if(unlikely(diagm_gf16_is_zero(&valid_nv_pos)))
+        return 0;
+
+    gf_t vec_buf[remaining_ncol];
+    assert(remaining_ncol <= sc_ops->size);
+    const uint32_t ori_rank = echelon_gf16_rank(ech);
+    const uint32_t max_rank = echelon_gf16_max_rank(ech);
+
+    for(uint32_t i = 0; i < BLK_LANCZOS_BLOCK_SIZE; ++i) {
+        if( !diagm_gf16_at(&valid_nv_pos, i) )
+            continue;
+
+        if(echelon_gf16_rank(ech) == max_rank) // enough nullvecs
+            break;
+
+        // extract the result of linear combi
+        for(uint32_t j = 0; j < remaining_ncol; ++j)
+            vec_buf[j] = rm_gf16_at(prod, kmap[j], i);
+
+        // check if this linear combi is independent of the extracted ones
+        uint32_t dst_idx = echelon_gf16_rank(ech);
+        if(echelon_gf16_insert(ech, vec_buf)) {
+            store_vec(sc_ops, p, sol, dst_idx, remaining_ncol,
+                      echelon_gf16_row(ech, dst_idx));
+        } else {
+#ifdef BLK_LANCZOS_COLLECT_STATS
+            ++(*dep_count);
+#endif
+            const gf_t* rem = echelon_gf16_row(ech, dst_idx);
+            if(rem[0]) // 0 = constant
+                sc_ops->row_set_at(sc_ops->raddr(sol, max_rank), 0, rem[0]);
+        }
+    }
+
+    return echelon_gf16_rank(ech) - ori_rank;
+}
+
+/* subroutine of solve_cmsm_gf31: the counterpart of proc_nullvec over
+ *      GF(31). The linear combinations of the columns to keep given by the
+ *      nullvectors are reduced into ech directly, which is solved by back
+ *      substitution once it has full rank. A linear combination whose
+ *      variables are all eliminated but not the constant term means the system
+ *      is inconsistent, which is reported in inconsistent. */
+static inline uint32_t
+proc_nullvec_gf31(EchelonGF31* restrict ech, R64MGF31* restrict prod,
+                  const R64MGF31* restrict v,
+                  const CMSMGeneric* restrict cmsm_kept, uint32_t tnum,
+                  R64MGF31PArg* restrict args, Threadpool* restrict tp,
+                  const uint64_t* restrict kmap, uint32_t remaining_ncol,
+                  bool* restrict inconsistent) {
+    cmsm_gf31_tr_mul_parallel(prod, cmsm_kept, v, tnum, args, tp);
+
+    gf31_t vec_buf[remaining_ncol];
+    const uint32_t ori_rank = echelon_gf31_rank(ech);
+    const uint32_t max_rank = echelon_gf31_max_rank(ech);
+    for(uint32_t i = 0; i < 64; ++i) {
+        if(echelon_gf31_rank(ech) == max_rank) // enough nullvecs
+            break;
+
+        // extract the result of linear combi
+        bool nz = false;
+        for(uint32_t j = 0; j < remaining_ncol; ++j) {
+            vec_buf[j] = r64m_gf31_raddr(prod, kmap[j])[i];
+            nz |= vec_buf[j];
+        }
+        if(!nz) // not a nullvector, or not in the left kernel
+            continue;
+
+        const uint32_t dst_idx = echelon_gf31_rank(ech);
+        if(!echelon_gf31_insert(ech, vec_buf) &&
+           echelon_gf31_row(ech, dst_idx)[0]) // 0 = constant
+            *inconsistent = true;
+    }
+
+    return echelon_gf31_rank(ech) - ori_rank;
+}
+
+/* subroutine of build_mac and build_mac_dist: for each variable (and the
+ *      constant), find the index of its column in cmsm_kept. vmap maps from
+ *      variable index to column index in MDMac, and the columns of cmsm_kept
+ *      are those set in kcols in the same order as in MDMac. */
+static inline void
+calc_kmap(uint64_t* restrict kmap, const uint64_t* restrict vmap,
+          const BitmapRank* restrict kcols, uint32_t remaining_ncol) {
+    for(uint32_t j = 0; j < remaining_ncol; ++j) {
+        assert(bitmap_at(kcols->b, vmap[j]));
+        kmap[j] = bitmap_rank1(kcols, vmap[j]);
+    }
+}
+
+/* subroutine of build_mac and build_mac_dist: mark the columns to keep, i.e.
+ *      the constant and the variables, and create the rank directory of the
+ *      Bitmap. Return NULL on failure */
+static BitmapRank*
+mark_kept_cols(Bitmap* restrict kcols, const uint64_t* restrict vmap,
+               uint32_t remaining_ncol) {
+    bitmap_zero(kcols);
+    for(uint32_t j = 0; j < remaining_ncol; ++j)
+        bitmap_set_true_at(kcols, vmap[j]);
+    return bitmap_rank_create(kcols);
+}
+
+/* subroutine of mrs_solver_solve: deflate the variables solved by the
+ *      extracted nullvectors out of the matrix to eliminate. The columns of
+ *      cmsm_kept at the pivots of the extracted linear system are appended to
+ *      cmsm, so the nullvectors of the new matrix are zero at those pivots and
+ *      therefore independent of the extracted ones unless they are zero at all
+ *      the variables. Return the new matrix, or NULL on failure. */
+static inline CMSMGeneric*
+deflate_cmsm(const CMSMGeneric* restrict cmsm,
+             const CMSMGeneric* restrict cmsm_kept,
+             const EchelonGF16* restrict ech, const uint64_t* restrict kmap,
+             uint64_t* restrict buf) {
+    const uint32_t rank = echelon_gf16_rank(ech);
+    for(uint32_t i = 0; i < rank; ++i)
+        buf[i] = kmap[echelon_gf16_pivot(ech, i)];
+    return cmsm_generic_append_cols(cmsm, cmsm_kept, buf, rank);
+}
+
+/* subroutine of mrs_solver_solve: the symbolic phase of the solver. Compute
+ *      the multi-degree Macaulay matrix, select its rows, and condense it
+ *      along columns into the matrix to eliminate and the columns to keep. If
+ *      pattern is set, ks is the sparsity pattern of the KS matrix and the
+ *      positions of the entries of both matrices in the KS matrix are
+ *      recorded, so that they can be refilled with cmsm_generic_refill.
+ *      With --ooc, the matrix to eliminate is written to disk instead, and
+ *      never held in memory. Return true on success, false otherwise */
+static bool
+build_mac(MacPlan* restrict p, const MRSolver* restrict s,
+          const GFM* restrict ks, const MinRank* restrict mr, bool pattern) {
+    const MRSParams* prm = &s->prm;
+    const uint32_t k = minrank_nmat(mr);
+    const uint32_t r = minrank_rank(mr);
+    const uint32_t c = prm->c;
+    const int32_t mac_seed = prm->mac_seed;
+    MDMac* mdmac = NULL;
+    uint64_t* vmap = NULL; uint64_t* ridxs = NULL;
+    Bitmap* kcols = NULL; BitmapRank* krank = NULL;
+    bool ok = false;
+    memset(p, 0x0, sizeof(MacPlan));
+
+    uint64_t ts = prof_start(PROF_MDMAC);
+    if(prm->degs_num == 1)
+        mdmac = mdmac_create_from_ks(ks, mr, prm->degs[0]);
+    else
+        mdmac = mdmac_combi_create_from_ks(ks, mr, prm->degs, prm->degs_num);
+    prof_stop(PROF_MDMAC, ts);
+
+    if(!mdmac) {
+        printf_err_ts("[!] Fail to create multi-degree Macaulay\n");
+        goto build_mac_cleanup;
+    }
+    mrs_log(s, "\t\tdimension: %lu x %lu\n", mdmac_nrow(mdmac),
+            mdmac_ncol(mdmac));
+
+    uint64_t cidxs_sz = mdmac_num_nlcol(mdmac);
+    uint64_t remaining_ncol = mdmac_ncol(mdmac) - cidxs_sz;
+
+    uint32_t vnum = ks_total_var_num(k, r, c);
+    assert((vnum + 1) == remaining_ncol);
+    vmap = malloc(sizeof(uint64_t) * remaining_ncol);
+    if(!vmap) {
+        printf_err_ts("[!] Fail to create containers for variable map\n");
+        goto build_mac_cleanup;
+    }
+    vmap[0] = 0; // constant column
+    for(uint32_t i = 0; i < vnum; ++i) // variables (both linear and kernel)
+        vmap[1 + i] = mdmac_vidx_to_midx(mdmac, i);
+
+    // the columns of both matrices are in the same order as in MDMac, so the
+    // index of a column in either of them is its rank in the columns to keep
+    // or the others
+    if( !(kcols = bitmap_create(mdmac_ncol(mdmac))) ||
+        !(krank = mark_kept_cols(kcols, vmap, remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        goto build_mac_cleanup;
+    }
+    assert(bitmap_rank1(krank, mdmac_ncol(mdmac)) == remaining_ncol);
+
+    uint64_t cmsm_rnum = prm->mac_nrow;
+    if(prm->mac_row_auto) // just enough for the nullvectors needed
+        cmsm_rnum = cidxs_sz + remaining_ncol + BLK_LANCZOS_BLOCK_SIZE;
+    if(cmsm_rnum == 0 || cmsm_rnum > mdmac_nrow(mdmac))
+        cmsm_rnum = mdmac_nrow(mdmac); // use all rows
+    ts = prof_start(PROF_NZNUM);
+    int64_t sel_num = -1;
+    if( (ridxs = malloc(sizeof(uint64_t) * mdmac_nrow(mdmac))) ) {
+        if(cmsm_rnum < mdmac_nrow(mdmac))
+            sel_num = mdmac_select_rows(ridxs, mdmac, cmsm_rnum, mac_seed,
+                                        kcols);
+        else if(!mdmac_random_rows(ridxs, mdmac_nrow(mdmac), cmsm_rnum,
+                                   mac_seed))
+            sel_num = cmsm_rnum;
+    }
+    if(sel_num < 0) {
+        printf_err_ts("[!] Fail to select rows of multi-degree Macaulay\n");
+        goto build_mac_cleanup;
+    }
+    cmsm_rnum = sel_num;
+    prof_stop(PROF_NZNUM, ts);
+
+    mrs_log_ts(s, "[+] Condensing multi-degree Macaulay along columns\n");
+    ts = prof_start(PROF_CMSM);
+    bool cmsm_ok = false;
+    if(prm->ooc_dir) {
+        // the matrix to eliminate is written to disk block by block
+        mrs_log(s, "\t\twriting the matrix to eliminate to %s\n",
+                prm->ooc_dir);
+        assert(!pattern);
+        cmsm_ok = cmsm_generic_split_mdmac_ooc(&p->ooc, &p->cmsm_kept, mdmac,
+                                               ridxs, cmsm_rnum, krank,
+                                               prm->ooc_dir, prm->ooc_blk_mem,
+                                               prm->tnum, s->tpool);
+    } else if(!pattern)
+        cmsm_ok = cmsm_generic_split_mdmac(&p->cmsm, &p->cmsm_kept, mdmac,
+                                           ridxs, cmsm_rnum, krank, NULL, NULL,
+                                           NULL, prm->tnum, s->tpool);
+    else if( (uint64_t) gfm_nrow(ks) * gfm_ncol(ks) <= UINT32_MAX )
+        // record where each coefficient comes from in the KS matrix
+        cmsm_ok = cmsm_generic_split_mdmac(&p->cmsm, &p->cmsm_kept, mdmac,
+                                           ridxs, cmsm_rnum, krank, ks,
+                                           &p->koff, &p->koff_kept, prm->tnum,
+                                           s->tpool);
+    if(!cmsm_ok) {
+        printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
+        goto build_mac_cleanup;
+    }
+    const uint64_t elim_nznum = p->ooc ? cmsm_ooc_nznum(p->ooc) :
+                                         cmsm_generic_nznum(p->cmsm);
+    const uint64_t mac_nznum = elim_nznum + cmsm_generic_nznum(p->cmsm_kept);
+    // only the buffers of the matrix on disk are in memory
+    const size_t elim_mem = p->ooc ? cmsm_ooc_mem_size(p->ooc) :
+                                     cmsm_generic_mem_size(p->cmsm);
+    const double cmsm_total_mem = (double) (elim_mem +
+                                  cmsm_generic_mem_size(p->cmsm_kept)) / MBFLOAT;
+    mrs_log(s, "\t\trows to keep: %lu\n"
+               "\t\tcolumns to keep: %lu\n"
+               "\t\tcolumns to eliminate: %lu\n"
+               "\t\tnumber of non-zero entries: %lu (%.2f%%)\n"
+               "\t\tsize of column-majored condensed multi-degree Macaulay: %.2fMB\n",
+            cmsm_rnum, remaining_ncol, cidxs_sz, mac_nznum,
+            100.0 * mac_nznum / cmsm_rnum / cidxs_sz, cmsm_total_mem);
+    if(p->ooc)
+        mrs_log(s, "\t\tnumber of blocks on disk: %u\n",
+                cmsm_ooc_blk_num(p->ooc));
+
+    if( !(p->kmap = malloc(sizeof(uint64_t) * remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        goto build_mac_cleanup;
+    }
+    calc_kmap(p->kmap, vmap, krank, remaining_ncol);
+    prof_stop(PROF_CMSM, ts);
+    prof_add_units(PROF_CMSM, mac_nznum);
+    p->mac_ncol = mdmac_ncol(mdmac);
+    p->remaining_ncol = remaining_ncol;
+    ok = true;
+
+build_mac_cleanup:
+    if(!ok) {
+        cmsm_generic_free(p->cmsm);
+        cmsm_ooc_free(p->ooc);
+        cmsm_generic_free(p->cmsm_kept);
+        free(p->koff);
+        free(p->koff_kept);
+        free(p->kmap);
+    }
+    bitmap_rank_free(krank);
+    bitmap_free(kcols);
+    mdmac_free(mdmac);
+    free(ridxs);
+    free(vmap);
+    return ok;
+}
+
+// an entry of the Macaulay matrix, sent to the ranks that hold its column in
+// the distributed mode
+typedef struct {
+    uint64_t ridx; // index of the row in the matrix to eliminate
+    uint64_t cidx; // index of the column in the block of the rank
+    gf_t v;
+} DistEntry;
+
+/* subroutine of build_mac_dist: mark a selected row in the bitmap */
+static void
+dist_select_row(uint64_t i, uint64_t ridx, void* arg) {
+    (void) i;
+    bitmap_set_true_at((Bitmap*) arg, ridx);
+}
+
+/* subroutine of build_mac_dist: find the rank that holds the given column to
+ *      eliminate. cbeg has size + 1 entries */
+static inline uint32_t
+dist_col_owner(const uint64_t* cbeg, uint32_t size, uint64_t pos) {
+    uint32_t lo = 0, hi = size; // cbeg[lo] <= pos < cbeg[hi]
+    while(hi - lo > 1) {
+        const uint32_t mid = (lo + hi) / 2;
+        if(cbeg[mid] <= pos)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* subroutine of build_mac_dist: create a CMSMGeneric from entries sorted by
+ *      row. Return NULL if memory allocation failed */
+static CMSMGeneric*
+dist_entries_to_cmsm(const DistEntry* e, uint64_t n, uint64_t rnum,
+                     uint64_t cnum) {
+    uint64_t* rptr = calloc(rnum + 1, sizeof(uint64_t));
+    gfa_idx_t* cidxs = malloc(sizeof(gfa_idx_t) * (n ? n : 1));
+    gf_t* vals = malloc(sizeof(gf_t) * (n ? n : 1));
+    CMSMGeneric* m = NULL;
+    if(!rptr || !cidxs || !vals)
+        goto dist_entries_to_cmsm_cleanup;
+
+    for(uint64_t i = 0; i < n; ++i) {
+        assert(!i || e[i-1].ridx <= e[i].ridx);
+        ++rptr[e[i].ridx + 1];
+        cidxs[i] = e[i].cidx;
+        vals[i] = e[i].v;
+    }
+    for(uint64_t i = 0; i < rnum; ++i)
+        rptr[i+1] += rptr[i];
+    m = cmsm_generic_from_csr(rnum, cnum, rptr, cidxs, vals);
+
+dist_entries_to_cmsm_cleanup:
+    free(rptr);
+    free(cidxs);
+    free(vals);
+    return m;
+}
+
+/* subroutine of mrs_solver_prepare: the counterpart of build_mac in the
+ *      distributed mode, called by all the ranks together. Each rank computes
+ *      its share of the rows of the multi-degree Macaulay matrix, so none of
+ *      them holds the full matrix. The columns to eliminate are split into
+ *      contiguous blocks with about the same number of non-zero entries, one
+ *      per rank, and the entries are sent to the rank of their column. The
+ *      columns to keep are small, so they are replicated. When only some rows
+ *      are kept, they are sampled randomly with the same seed on all the
+ *      ranks. Return true on success, false otherwise */
+static bool
+build_mac_dist(MacPlan* restrict p, const MRSolver* restrict s,
+               const GFM* restrict ks, const MinRank* restrict mr) {
+    const MRSParams* prm = &s->prm;
+    const uint32_t k = minrank_nmat(mr);
+    const uint32_t r = minrank_rank(mr);
+    const uint32_t c = prm->c;
+    const uint32_t rank = dist_rank(), size = dist_size();
+    MDMac* mdmac = NULL;
+    uint64_t* vmap = NULL; uint32_t* nznum = NULL;
+    Bitmap* kcols = NULL; BitmapRank* krank = NULL;
+    Bitmap* sel = NULL; uint64_t* cnt = NULL;
+    DistEntry* sbuf = NULL, *rbuf = NULL, *kbuf = NULL, *kall = NULL;
+    bool ok = false;
+    memset(p, 0x0, sizeof(MacPlan));
+
+    uint64_t ts = prof_start(PROF_MDMAC);
+    if(prm->degs_num == 1)
+        mdmac = mdmac_create_from_ks_part(ks, mr, prm->degs[0], rank, size);
+    else
+        mdmac = mdmac_combi_create_from_ks_part(ks, mr, prm->degs,
+                                                prm->degs_num, rank, size);
+    prof_stop(PROF_MDMAC, ts);
+
+    if(!mdmac) {
+        printf_err_ts("[!] Fail to create multi-degree Macaulay\n");
+        goto build_mac_dist_cleanup;
+    }
+    const uint64_t full_nrow = mdmac_full_nrow(mdmac);
+    const uint64_t roff = mdmac_roff(mdmac);
+    const uint64_t ncol = mdmac_ncol(mdmac);
+    mrs_log(s, "\t\tdimension: %lu x %lu\n"
+               "\t\trows computed by each of the %u ranks: %lu\n",
+            full_nrow, ncol, size, mdmac_nrow(mdmac));
+
+    const uint64_t cidxs_sz = mdmac_num_nlcol(mdmac);
+    const uint64_t remaining_ncol = ncol - cidxs_sz;
+    if(cidxs_sz < size) {
+        printf_err_ts("[!] Fewer columns to eliminate than ranks\n");
+        goto build_mac_dist_cleanup;
+    }
+
+    uint32_t vnum = ks_total_var_num(k, r, c);
+    assert((vnum + 1) == remaining_ncol);
+    vmap = malloc(sizeof(uint64_t) * remaining_ncol);
+    kcols = bitmap_create(ncol);
+    nznum = calloc(ncol, sizeof(uint32_t));
+    cnt = calloc(4 * size + 1, sizeof(uint64_t));
+    if(!vmap || !kcols || !nznum || !cnt) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        goto build_mac_dist_cleanup;
+    }
+    vmap[0] = 0; // constant column
+    for(uint32_t i = 0; i < vnum; ++i) // variables (both linear and kernel)
+        vmap[1 + i] = mdmac_vidx_to_midx(mdmac, i);
+    if( !(krank = mark_kept_cols(kcols, vmap, remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        goto build_mac_dist_cleanup;
+    }
+
+    // the rows to keep are the same on all the ranks
+    uint64_t cmsm_rnum = prm->mac_nrow;
+    if(prm->mac_row_auto) // just enough for the nullvectors needed
+        cmsm_rnum = cidxs_sz + remaining_ncol + BLK_LANCZOS_BLOCK_SIZE;
+    if(cmsm_rnum == 0 || cmsm_rnum > full_nrow)
+        cmsm_rnum = full_nrow; // use all rows
+    uint64_t ridx = roff; // index in the matrix to eliminate of the 1st row
+    if(cmsm_rnum < full_nrow) {
+        if( !(sel = bitmap_create(full_nrow)) ) {
+            printf_err_ts("[!] Fail to select rows of multi-degree Macaulay\n");
+            goto build_mac_dist_cleanup;
+        }
+        bitmap_zero(sel);
+        mdmac_iter_random_rows(full_nrow, cmsm_rnum, prm->mac_seed,
+                               dist_select_row, sel);
+        ridx = bitmap_popcnt_upto(sel, roff);
+    }
+
+    // count the non-zero entries of each column over all the ranks
+    ts = prof_start(PROF_NZNUM);
+    for(uint64_t i = 0; i < mdmac_nrow(mdmac); ++i) {
+        if(sel && !bitmap_at(sel, roff + i))
+            continue;
+        const GFA* row = mdmac_row(mdmac, i);
+        for(uint64_t j = 0; j < gfa_size(row); ++j) {
+            gfa_idx_t idx; gfa_at(row, j, &idx);
+            ++nznum[idx];
+        }
+    }
+    dist_sum_u32(nznum, ncol);
+    uint64_t nznum_to_remove = 0, nznum_to_keep = 0;
+    for(uint64_t i = 0; i < ncol; ++i) {
+        if(bitmap_at(kcols, i))
+            nznum_to_keep += nznum[i];
+        else
+            nznum_to_remove += nznum[i];
+    }
+    const uint64_t mac_nznum = nznum_to_remove + nznum_to_keep;
+    prof_stop(PROF_NZNUM, ts);
+
+    // split the columns to eliminate into blocks of about the same number of
+    // non-zero entries, leaving at least 1 column to each rank
+    uint64_t* cbeg = cnt + 3 * size; // size + 1 entries
+    uint64_t pos = 0, acc = 0;
+    uint32_t b = 1;
+    for(uint64_t i = 0; i < ncol; ++i) {
+        if(bitmap_at(kcols, i))
+            continue;
+        while(b < size && pos > cbeg[b-1] &&
+              (acc * size >= nznum_to_remove * b ||
+               cidxs_sz - pos <= size - b))
+            cbeg[b++] = pos;
+        acc += nznum[i];
+        ++pos;
+    }
+    assert(b == size && pos == cidxs_sz);
+    cbeg[size] = cidxs_sz;
+
+    double cmsm_total_mem = cmsm_generic_calc_mem_size(cmsm_rnum,
+                                                       cbeg[rank+1] - cbeg[rank],
+                                                       nznum_to_remove / size);
+    cmsm_total_mem += cmsm_generic_calc_mem_size(cmsm_rnum, remaining_ncol,
+                                                 nznum_to_keep);
+    cmsm_total_mem /= MBFLOAT;
+    mrs_log(s, "\t\trows to keep: %lu\n"
+               "\t\tcolumns to keep: %lu\n"
+               "\t\tcolumns to eliminate: %lu\n"
+               "\t\tnumber of non-zero entries: %lu (%.2f%%)\n"
+               "\t\tsize of column-majored condensed multi-degree Macaulay per rank: %.2fMB\n",
+            cmsm_rnum, remaining_ncol, cidxs_sz, mac_nznum,
+            100.0 * mac_nznum / cmsm_rnum / cidxs_sz, cmsm_total_mem);
+
+    // send the entries to eliminate to the ranks of their columns, in the
+    // order of the rows. Since the ranks hold increasing ranges of rows, the
+    // entries received are sorted by row too
+    mrs_log_ts(s, "[+] Condensing multi-degree Macaulay along columns\n");
+    ts = prof_start(PROF_CMSM);
+    uint64_t* scnt = cnt, *rcnt = cnt + size, *soff = cnt + 2 * size;
+    uint64_t kcnt = 0;
+    for(uint64_t i = 0; i < mdmac_nrow(mdmac); ++i) {
+        if(sel && !bitmap_at(sel, roff + i))
+            continue;
+        const GFA* row = mdmac_row(mdmac, i);
+        for(uint64_t j = 0; j < gfa_size(row); ++j) {
+            gfa_idx_t idx; gfa_at(row, j, &idx);
+            if(bitmap_at(kcols, idx))
+                ++kcnt;
+            else
+                ++scnt[dist_col_owner(cbeg, size, bitmap_rank0(krank, idx))];
+        }
+    }
+    uint64_t snum = 0;
+    for(uint32_t i = 0; i < size; ++i) {
+        soff[i] = snum;
+        snum += scnt[i];
+    }
+    if( !(sbuf = malloc(sizeof(DistEntry) * (snum ? snum : 1))) ||
+        !(kbuf = malloc(sizeof(DistEntry) * (kcnt ? kcnt : 1))) ) {
+        printf_err_ts("[!] Fail to create buffers for the distributed entries\n");
+        goto build_mac_dist_cleanup;
+    }
+    uint64_t ki = 0;
+    for(uint64_t i = 0; i < mdmac_nrow(mdmac); ++i) {
+        if(sel && !bitmap_at(sel, roff + i))
+            continue;
+        const GFA* row = mdmac_row(mdmac, i);
+        for(uint64_t j = 0; j < gfa_size(row); ++j) {
+            gfa_idx_t idx; gf_t v = gfa_at(row, j, &idx);
+            DistEntry* e;
+            if(bitmap_at(kcols, idx)) {
+                e = kbuf + ki++;
+                e->cidx = bitmap_rank1(krank, idx);
+            } else {
+                const uint64_t cpos = bitmap_rank0(krank, idx);
+                const uint32_t dst = dist_col_owner(cbeg, size, cpos);
+                e = sbuf + soff[dst]++;
+                e->cidx = cpos - cbeg[dst];
+            }
+            e->ridx = ridx;
+            e->v = v;
+        }
+        ++ridx;
+    }
+    // the rows are all in the entries now
+    mdmac_free(mdmac);
+    mdmac = NULL;
+
+    // the numbers of entries to receive
+    for(uint32_t i = 0; i < size; ++i)
+        soff[i] = 1;
+    bool comm_ok = dist_alltoallv(scnt, soff, rcnt, soff, sizeof(uint64_t));
+    uint64_t rnum = 0;
+    for(uint32_t i = 0; i < size; ++i)
+        rnum += rcnt[i];
+    if(comm_ok && (rbuf = malloc(sizeof(DistEntry) * (rnum ? rnum : 1))))
+        comm_ok = dist_alltoallv(sbuf, scnt, rbuf, rcnt, sizeof(DistEntry));
+    free(sbuf);
+    sbuf = NULL;
+    if(!comm_ok || !rbuf) {
+        printf_err_ts("[!] Fail to exchange the entries to eliminate\n");
+        goto build_mac_dist_cleanup;
+    }
+    p->cmsm = dist_entries_to_cmsm(rbuf, rnum, cmsm_rnum,
+                                   cbeg[rank+1] - cbeg[rank]);
+    free(rbuf);
+    rbuf = NULL;
+    if(!p->cmsm) {
+        printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
+        goto build_mac_dist_cleanup;
+    }
+
+    // gather the columns to keep on all the ranks
+    comm_ok = dist_allgatherv(&kcnt, rcnt, soff, sizeof(uint64_t));
+    assert(!comm_ok || rcnt[rank] == kcnt);
+    uint64_t knum = 0;
+    for(uint32_t i = 0; i < size; ++i)
+        knum += rcnt[i];
+    if(comm_ok && (kall = malloc(sizeof(DistEntry) * (knum ? knum : 1))))
+        comm_ok = dist_allgatherv(kbuf, kall, rcnt, sizeof(DistEntry));
+    if(!comm_ok || !kall) {
+        printf_err_ts("[!] Fail to exchange the columns to keep\n");
+        goto build_mac_dist_cleanup;
+    }
+    assert(knum == nznum_to_keep);
+    if( !(p->cmsm_kept = dist_entries_to_cmsm(kall, knum, cmsm_rnum,
+                                              remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
+        goto build_mac_dist_cleanup;
+    }
+    if( !(p->kmap = malloc(sizeof(uint64_t) * remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        goto build_mac_dist_cleanup;
+    }
+    calc_kmap(p->kmap, vmap, krank, remaining_ncol);
+    prof_stop(PROF_CMSM, ts);
+    prof_add_units(PROF_CMSM, cmsm_generic_nznum(p->cmsm) +
+                              cmsm_generic_nznum(p->cmsm_kept));
+    p->mac_ncol = ncol;
+    p->remaining_ncol = remaining_ncol;
+    ok = true;
+
+build_mac_dist_cleanup:
+    if(!ok) {
+        cmsm_generic_free(p->cmsm);
+        cmsm_generic_free(p->cmsm_kept);
+        free(p->kmap);
+    }
+    bitmap_rank_free(krank);
+    bitmap_free(kcols);
+    mdmac_free(mdmac);
+    bitmap_free(sel);
+    free(nznum);
+    free(cnt);
+    free(vmap);
+    free(sbuf);
+    free(rbuf);
+    free(kbuf);
+    free(kall);
+    return ok;
+}
+
+/* subroutine of mrs_solver_solve and mrs_solver_free: release the symbolic
+ *      phase, unless it's shared, and the containers of the numeric phase */
+static void
+mrs_solver_release(MRSolver* s) {
+    cmsm_generic_free(s->own_plan.cmsm);
+    cmsm_ooc_free(s->own_plan.ooc);
+    cmsm_generic_free(s->own_plan.cmsm_kept);
+    free(s->own_plan.koff);
+    free(s->own_plan.koff_kept);
+    free(s->own_plan.kmap);
+    memset(&s->own_plan, 0x0, sizeof(MacPlan));
+    s->plan = NULL;
+    s->refill = false;
+    cmsm_generic_free(s->cmsm);
+    cmsm_generic_free(s->cmsm_kept);
+    s->cmsm = s->cmsm_kept = NULL;
+    cmsm_ooc_free(s->ooc);
+    s->ooc = NULL;
+    free(s->defl_buf);
+    s->defl_buf = NULL;
+    blkgf16_arg_free(s->blkarg);
+    s->blkarg = NULL;
+    blkgf2_arg_free(s->blkarg2);
+    s->blkarg2 = NULL;
+    blkgf31_arg_free(s->blkarg31);
+    s->blkarg31 = NULL;
+    echelon_gf31_free(s->ech31);
+    s->ech31 = NULL;
+    rm_gf16_free(s->p);
+    s->p = NULL;
+    rm_gf16_free(s->gf_buf);
+    s->gf_buf = NULL;
+    echelon_gf16_free(s->ech);
+    s->ech = NULL;
+    if(s->sc.free) {
+        s->sc.free(s->reduced_mdmac);
+        s->sc.free(s->sol);
+    }
+    s->reduced_mdmac = s->sol = NULL;
+    free(s->di_buf);
+    s->di_buf = NULL;
+    s->ready = false;
+}
+
+/* subroutine of mrs_solver_prepare and mrs_solver_clone: create the matrices
+ *      to solve and the containers of the numeric phase for the symbolic
+ *      phase of the context. Return true on success, false otherwise */
+static bool
+mrs_solver_setup(MRSolver* s) {
+    const MRSParams* prm = &s->prm;
+    MacPlan* plan = s->plan;
+    if(s->refill) {
+        // the matrices to solve are copies of the patterns to refill
+        if( !(s->cmsm = cmsm_generic_append_cols(plan->cmsm, plan->cmsm,
+                                                 NULL, 0)) ||
+            !(s->cmsm_kept = cmsm_generic_append_cols(plan->cmsm_kept,
+                                                      plan->cmsm_kept,
+                                                      NULL, 0)) ) {
+            printf_err_ts("[!] Fail to create column-majored multi-degree Macaulay\n");
+            return false;
+        }
+    } else {
+        s->cmsm = plan->cmsm;
+        s->ooc = plan->ooc;
+        s->cmsm_kept = plan->cmsm_kept;
+        plan->cmsm = plan->cmsm_kept = NULL;
+        plan->ooc = NULL;
+    }
+
+    const uint64_t remaining_ncol = plan->remaining_ncol;
+    const uint64_t cidxs_sz = s->ooc ? cmsm_ooc_cnum(s->ooc) :
+                                       cmsm_generic_cnum(s->cmsm);
+    sc_ops_init(&s->sc, remaining_ncol);
+    mrs_log_ts(s, "[+] Done\n");
+    mrs_log(s, "\t\tmax number of entries to eliminate in a column: %lu\n"
+               "\t\tavg number of entries to eliminate in a column: %lu\n",
+            s->ooc ? cmsm_ooc_max_tnum(s->ooc) : cmsm_generic_max_tnum(s->cmsm),
+            s->ooc ? cmsm_ooc_avg_tnum(s->ooc) : cmsm_generic_avg_tnum(s->cmsm));
+
+    if(prm->deflate && !(s->defl_buf = malloc(sizeof(uint64_t) * remaining_ncol))) {
+        printf_err_ts("[!] Fail to create containers for column indices\n");
+        return false;
+    }
+    if( !(s->p = rm_gf16_create(cidxs_sz)) ) {
+        printf_err_ts("[!] Fail to create RMGF16 matrix for Block Lanczos\n");
+        return false;
+    }
+    if( !(s->ech = echelon_gf16_create(remaining_ncol, 1)) ) { // 0 = constant
+        printf_err_ts("[!] Fail to create echelon form for Block Lanczos\n");
+        return false;
+    }
+    if(s->sc.size > 512)
+        s->di_buf = malloc(sizeof(uint64_t) * (s->sc.size >> 6));
+    if( !(s->reduced_mdmac = sc_create(&s->sc, false)) ||
+        !(s->sol = sc_create(&s->sc, true)) ||
+        (s->sc.size > 512 && !s->di_buf) ) {
+        printf_err_ts("[!] Fail to create containers for the resultant matrix\n");
+        return false;
+    }
+    if( !(s->gf_buf = rm_gf16_create(remaining_ncol)) ) {
+        printf_err_ts("[!] Fail to create buffer to GF vector\n");
+        return false;
+    }
+    s->ready = true;
+    return true;
+}
+
+/* subroutine of mrs_solver_solve and mrs_solver_plan: build the condensed
+ *      Macaulay matrices of the instance and the containers of the numeric
+ *      phase, unless those of a previous instance with the same parameters are
+ *      reused. If the symbolic phase is reused or cached, the matrices are
+ *      refilled and ks may be NULL. Return true on success, false otherwise */
+static bool
+mrs_solver_prepare(MRSolver* restrict s, const MinRank* restrict mr,
+                   const GFM* restrict ks) {
+    const MRSParams* prm = &s->prm;
+    const uint32_t k = minrank_nmat(mr);
+    const uint32_t r = minrank_rank(mr);
+    const uint32_t c = prm->c;
+    if(s->ready && prm->reuse && s->nrow == minrank_nrow(mr) &&
+       s->ncol == minrank_ncol(mr) && s->k == k && s->r == r &&
+       s->has_m0 == (minrank_m0(mr) != NULL))
+        return true;
+
+    mrs_solver_release(s);
+    GFM* ks_pat = NULL;
+    PlanKey* pkey = NULL;
+    bool ok = false;
+    uint64_t ts;
+
+    // when the symbolic phase is reused or cached, the Macaulay matrix is
+    // built from the sparsity pattern of the KS matrix, which is shared by all
+    // the instances of the same parameters, and refilled with the
+    // coefficients of each instance
+    s->refill = prm->reuse || prm->plan_dir;
+    if(s->refill && !(ks_pat = minrank_ks_pattern(mr, c)) ) {
+        printf_err_ts("[!] Fail to create sparsity pattern of KS matrix\n");
+        goto mrs_solver_prepare_cleanup;
+    }
+    const GFM* ks_mac = ks_pat ? ks_pat : ks;
+
+    uint64_t max_tnum = gfm_find_max_tnum_per_eq(ks_mac);
+    size_t mdmac_memsize = mdmac_calc_memsize(k, r, prm->degs[prm->degs_num-1],
+                                              minrank_ncol(mr), max_tnum);
+
+    mrs_log_ts(s, "[+] Computing multi-degree Macaulay matrix\n"
+                  "\t\tmax number of supported rows: 2^64-1\n"
+                  "\t\tmax number of supported columns: 2^%u-1\n"
+                  "\t\tmax number of non-zero entries in a row of the base system: %lu\n"
+                  "\t\tstorage requirement: %.2fMB\n",
+               gfa_size_of_idx(), max_tnum, mdmac_memsize / MBFLOAT);
+
+    // the symbolic phase only depends on the parameters, so it may be cached
+    MacPlan* plan = s->plan = &s->own_plan;
+    bool plan_hit = false;
+    if(prm->plan_dir) {
+        if( !(pkey = plan_key_create(mr, ks_mac, c, prm->degs, prm->degs_num,
+                                     prm->mac_nrow, prm->mac_row_auto,
+                                     prm->mac_seed)) ) {
+            printf_err_ts("[!] Fail to create key of the plan\n");
+            goto mrs_solver_prepare_cleanup;
+        }
+        ts = prof_start(PROF_PLAN);
+        plan_hit = plan_cache_load(plan, prm->plan_dir, pkey);
+        prof_stop(PROF_PLAN, ts);
+        if(plan_hit)
+            mrs_log_ts(s, "[+] Loaded plan from %s\n"
+                          "\t\trows to keep: %lu\n"
+                          "\t\tcolumns to keep: %lu\n"
+                          "\t\tcolumns to eliminate: %lu\n",
+                       prm->plan_dir, cmsm_generic_rnum(plan->cmsm),
+                       plan->remaining_ncol, cmsm_generic_cnum(plan->cmsm));
+        else
+            mrs_log_ts(s, "[+] No plan in %s for the parameters\n",
+                       prm->plan_dir);
+    }
+    if(!plan_hit) {
+        if(prm->dist ? !build_mac_dist(plan, s, ks_mac, mr) :
+                       !build_mac(plan, s, ks_mac, mr, s->refill))
+            goto mrs_solver_prepare_cleanup;
+        if(prm->plan_dir) {
+            ts = prof_start(PROF_PLAN);
+            if(plan_cache_store(plan, prm->plan_dir, pkey))
+                mrs_log_ts(s, "[+] Stored plan in %s\n", prm->plan_dir);
+            else
+                printf_err_ts("[!] Failed to store plan in %s\n",
+                              prm->plan_dir);
+            prof_stop(PROF_PLAN, ts);
+        }
+    }
+    if(!mrs_solver_setup(s))
+        goto mrs_solver_prepare_cleanup;
+    s->nrow = minrank_nrow(mr);
+    s->ncol = minrank_ncol(mr);
+    s->k = k;
+    s->r = r;
+    s->has_m0 = (minrank_m0(mr) != NULL);
+    ok = true;
+
+mrs_solver_prepare_cleanup:
+    if(ks_pat)
+        gfm_free(ks_pat);
+    plan_key_free(pkey);
+    if(!ok)
+        mrs_solver_release(s);
+    return ok;
+}
+
+/* subroutine of mrs_solver_solve: read the solution off the solved linear
+ *      system. Return the solution, or NULL if memory allocation failed */
+static MRSSolution*
+mrs_solution_create(const SCOps* restrict sc_ops, void* restrict sol,
+                    void* restrict di, uint32_t k, uint32_t r, uint32_t c) {
+    const uint32_t vnum = ks_total_var_num(k, r, c);
+    MRSSolution* s = malloc(sizeof(MRSSolution));
+    if(!s)
+        return NULL;
+    s->val = malloc(sizeof(gf_t) * vnum);
+    s->det = malloc(sizeof(bool) * vnum);
+    if(!s->val || !s->det) {
+        mrs_solution_free(s);
+        return NULL;
+    }
+
+    s->k = k;
+    s->r = r;
+    s->c = c;
+    s->vnum = vnum;
+    s->consistent = true;
+    for(uint32_t i = vnum; i < sc_ops->size; ++i) {
+        if(sc_ops->at(sol, i, 0)) {
+            s->consistent = false;
+            break;
+        }
+    }
+    for(uint32_t i = 0; i < vnum; ++i) {
+        s->det[i] = sc_ops->uint_at(di, i);
+        s->val[i] = s->det[i] ? sc_ops->at(sol, i, 0) : 0;
+    }
+    return s;
+}
+
+/* subroutine of mrs_solver_solve: extract nullvectors of the matrix to
+ *      eliminate with Block Lanczos until enough of them are found, and solve
+ *      the linear system they form with the columns to keep. Unless the
+ *      symbolic phase is reused, the matrices are released as soon as they are
+ *      no longer needed. Return 0 if the instance is solved, 1 if not enough
+ *      nullvectors are found, or -1 on error */
+static int32_t
+solve_cmsm(MRSolver* restrict s, MRSSolution** restrict sol_p) {
+    const MRSParams* prm = &s->prm;
+    const SCOps* sc_ops = &s->sc;
+    const bool keep = prm->reuse;
+    const uint32_t tnum = prm->tnum;
+    const uint64_t remaining_ncol = s->plan->remaining_ncol;
+    const uint64_t* kmap = s->plan->kmap;
+    const uint32_t target_nv_num = ks_total_var_num(s->k, s->r, prm->c) + 1;
+    CMSMGeneric* cmsm = s->cmsm, *cmsm_kept = s->cmsm_kept;
+    CMSMOOC* ooc = s->ooc; // with --ooc, cmsm is never in memory
+    uint64_t cmsm_rnum = ooc ? cmsm_ooc_rnum(ooc) : cmsm_generic_rnum(cmsm);
+    uint64_t cidxs_sz = ooc ? cmsm_ooc_cnum(ooc) : cmsm_generic_cnum(cmsm);
+    CMSMFilter* filter = NULL; CMSMGeneric* cmsm_kept_f = NULL;
+    CMSMGeneric* cmsm_defl = NULL; RMGF16* lifted = NULL;
+    RMGF16* nullvec_candidates = NULL;
+    int32_t rval = 1;
+    uint64_t ts;
+
+    // the matrix to eliminate and the columns to keep, possibly filtered
+    const CMSMGeneric* cmsm_elim = cmsm, *cmsm_lin = cmsm_kept;
+    if(prm->filter) {
+        mrs_log_ts(s, "[+] Filtering the matrix to eliminate\n");
+        // the heaviest rows are needed by some of the nullvectors, so only a
+        // fraction of the excess rows is dropped
+        uint64_t excess = (cmsm_rnum > cidxs_sz) ? cmsm_rnum - cidxs_sz : 0;
+        excess -= excess / FILTER_PRUNE_DIV;
+        if(excess < remaining_ncol + BLK_LANCZOS_BLOCK_SIZE)
+            excess = remaining_ncol + BLK_LANCZOS_BLOCK_SIZE;
+        ts = prof_start(PROF_FILTER);
+        filter = cmsm_filter_create(cmsm, excess, FILTER_MAX_MERGE_WT,
+                                    cmsm_generic_nznum(cmsm));
+        if(filter)
+            cmsm_kept_f = cmsm_filter_apply(filter, cmsm_kept);
+        prof_stop(PROF_FILTER, ts);
+        if(!filter || !cmsm_kept_f) {
+            printf_err_ts("[!] Fail to filter the matrix to eliminate\n");
+            rval = -1;
+            goto solve_cmsm_cleanup;
+        }
+        cmsm_elim = cmsm_filter_matrix(filter);
+        cmsm_lin = cmsm_kept_f;
+        mrs_log(s, "\t\treduced dimension: %lu x %lu\n"
+                   "\t\tnumber of non-zero entries: %lu\n",
+                cmsm_generic_rnum(cmsm_elim), cmsm_generic_cnum(cmsm_elim),
+                cmsm_generic_nznum(cmsm_elim));
+#ifdef BLK_LANCZOS_COLLECT_STATS
+        // nullvectors are lifted and verified against the original matrix
+        if( !(lifted = rm_gf16_create(cmsm_generic_rnum(cmsm))) ) {
+            printf_err_ts("[!] Fail to create RMGF16 matrix for lifting\n");
+            rval = -1;
+            goto solve_cmsm_cleanup;
+        }
+#else
+        if(!keep) { // release resources as soon as possible
+            cmsm_generic_free(cmsm);
+            s->cmsm = cmsm = NULL;
+        }
+#endif
+        if(!keep) {
+            cmsm_generic_free(cmsm_kept);
+            s->cmsm_kept = cmsm_kept = NULL;
+        }
+        cmsm_rnum = cmsm_generic_rnum(cmsm_elim);
+        cidxs_sz = cmsm_generic_cnum(cmsm_elim);
+    }
+
+    // instances over GF(2) give binary matrices, which are eliminated with
+    // the bit-packed Block Lanczos. Deflation appends columns of cmsm_lin, so
+    // the matrix stays binary
+    // the distributed mode and the out-of-core one only have the GF(16) one
+    const bool gf2 = !prm->dist && !prm->ooc_dir &&
+                     cmsm_generic_is_gf2(cmsm_elim) &&
+                     cmsm_generic_is_gf2(cmsm_lin);
+    // the rows of the matrix to eliminate only change with filtering
+    if( (s->blkarg && (gf2 || rm_gf16_rnum(blkgf16_arg_v(s->blkarg)) != cmsm_rnum)) ||
+        (s->blkarg2 && (!gf2 || blkgf2_arg_rnum(s->blkarg2) != cmsm_rnum)) ) {
+        blkgf16_arg_free(s->blkarg);
+        blkgf2_arg_free(s->blkarg2);
+        s->blkarg = NULL;
+        s->blkarg2 = NULL;
+    }
+    bool blkarg_ok;
+    if(gf2) {
+        blkarg_ok = (s->blkarg2 || (s->blkarg2 = blkgf2_arg_create(cmsm_rnum, cidxs_sz, tnum))) &&
+                    blkgf2_arg_set_cnum(s->blkarg2, cidxs_sz);
+    } else {
+        blkarg_ok = (s->blkarg || (s->blkarg = blkgf16_arg_create(cmsm_rnum, cidxs_sz, tnum))) &&
+                    blkgf16_arg_set_cnum(s->blkarg, cidxs_sz);
+    }
+    if(!blkarg_ok) {
+        printf_err_ts("[!] Fail to create containers for Block Lanczos\n");
+        rval = -1;
+        goto solve_cmsm_cleanup;
+    }
+    if(gf2)
+        blkgf2_arg_set_seed(s->blkarg2, prm->seed);
+    else
+        blkgf16_arg_set_seed(s->blkarg, prm->seed);
+    BLKGF16Arg* blkarg = s->blkarg;
+    BLKGF2Arg* blkarg2 = s->blkarg2;
+
+    RMGF16PArg* nv_pargs = gf2 ? blkgf2_arg_pargs(blkarg2) :
+                                 blkgf16_arg_pargs(blkarg);
+    EchelonGF16* ech = s->ech;
+    void* reduced_mdmac = s->reduced_mdmac, *sol = s->sol;
+
+    // launch block Lanczos until enough nullvectors are found
+    // the rank of the extracted linear system is tracked as they come, so
+    // dependent nullvectors are dropped and no batch is wasted
+    echelon_gf16_reset(ech);
+    sc_ops->zero(reduced_mdmac);
+    sc_ops->zero(sol);
+
+    mrs_log_ts(s, "[+] Try to extract %u nullvectors\n", target_nv_num);
+    // TODO: what is the expected rank?
+    // in the distributed mode, cmsm only holds the block of columns of a rank
+    const uint64_t elim_ncol = prm->dist ? s->plan->mac_ncol - remaining_ncol :
+                                           cidxs_sz;
+    uint64_t expected_rank = (elim_ncol > cmsm_rnum) ? cmsm_rnum : elim_ncol;
+    if(gf2) {
+        mrs_log(s, "\t\tmatrix to eliminate over GF(2): %d runs of block "
+                   "size 64 per batch\n", BLK_LANCZOS_BLOCK_SIZE / 64);
+    }
+    mrs_log(s, "\t\texpected rank of submatrix to eliminate: %lu\n"
+               "\t\tblock size: %d\n"
+               "\t\texpected number of iterations: %zu\n"
+               "\t\tsize of %lu x %d matrix: %.2fMB\n"
+               "\t\tsize of %lu x %d matrix: %.2fMB\n"
+               "\t\tsize of %d x %d matrix: %.2fKB\n",
+            expected_rank,
+            BLK_LANCZOS_BLOCK_SIZE,
+            gf2 ? blkgf2_iter_num(64, expected_rank) * (BLK_LANCZOS_BLOCK_SIZE / 64) :
+                  blkgf16_iter_num(BLK_LANCZOS_BLOCK_SIZE, expected_rank),
+            cmsm_rnum, BLK_LANCZOS_BLOCK_SIZE,
+            rm_gf16_memsize(cmsm_rnum) / MBFLOAT,
+            s->plan->mac_ncol, BLK_LANCZOS_BLOCK_SIZE,
+            rm_gf16_memsize(s->plan->mac_ncol) / MBFLOAT,
+            BLK_LANCZOS_BLOCK_SIZE, BLK_LANCZOS_BLOCK_SIZE,
+            rcm_gf16_memsize() / KBFLOAT);
+
+#ifdef BLK_LANCZOS_COLLECT_STATS
+    uint64_t dep_count = 0, zero_nv_count = 0, invalid_nv_count = 0;
+#endif
+    uint64_t iter = 0;
+    const CMSMGeneric* cmsm_cur = cmsm_elim; // deflated as nullvectors come
+    while(iter++ < LANCZOS_MAX_ITER && echelon_gf16_rank(ech) < target_nv_num-1) {
+        // TODO: record iter_count
+        ts = prof_start(PROF_LANCZOS);
+        uint32_t iter_count;
+        if(gf2)
+            iter_count = blk_lczs_gf2(blkarg2, cmsm_cur, s->tpool);
+        else if(prm->dist)
+            iter_count = blk_lczs_gf16_dist(blkarg, cmsm_cur, s->tpool);
+        else if(ooc)
+            iter_count = blk_lczs_gf16_ooc(blkarg, ooc, s->tpool);
+        else
+            iter_count = blk_lczs_gf16(blkarg, cmsm_cur, s->tpool);
+        prof_stop(PROF_LANCZOS, ts);
+        if(ooc && !iter_count) {
+            printf_err_ts("[!] Fail to read the matrix to eliminate\n");
+            rval = -1;
+            goto solve_cmsm_cleanup;
+        }
+        ts = prof_start(PROF_NULLVEC);
+        nullvec_candidates = gf2 ? blkgf2_arg_v(blkarg2) : blkgf16_arg_v(blkarg);
+#ifdef BLK_LANCZOS_COLLECT_STATS
+        DiagMGF16 nv_pos, zv;
+        if(filter) {
+            cmsm_filter_lift(filter, lifted, nullvec_candidates);
+            verify_nullvec(&nv_pos, s->p, cmsm, lifted);
+        } else if(cmsm)
+            verify_nullvec(&nv_pos, s->p, cmsm, nullvec_candidates);
+        else { // only on disk, so they're assumed to be in the left kernel
+            rm_gf16_zc_pos(nullvec_candidates, &zv);
+            diagm_gf16_negate(&nv_pos, &zv);
+        }
+        rm_gf16_zc_pos(nullvec_candidates, &zv); // find zero vectors
+        zero_nv_count += diagm_gf16_nzc(&zv);
+        invalid_nv_count += diagm_gf16_zc(&nv_pos);
+        uint32_t nvc = proc_nullvec(sc_ops, ech, reduced_mdmac, sol, s->gf_buf,
+                                    nullvec_candidates, cmsm_lin,
+                                    tnum, nv_pargs, s->tpool,
+                                    kmap, remaining_ncol, &dep_count);
+#else
+        uint32_t nvc = proc_nullvec(sc_ops, ech, reduced_mdmac, sol, s->gf_buf,
+                                    nullvec_candidates, cmsm_lin,
+                                    tnum, nv_pargs, s->tpool,
+                                    kmap, remaining_ncol);
+#endif
+        prof_stop(PROF_NULLVEC, ts);
+        mrs_log_ts(s, "[+] %zu-th batch: %u iterations, %u nullvectors\n",
+                   iter, iter_count, nvc);
+        mrs_progress(s, MRS_STAGE_LANCZOS, echelon_gf16_rank(ech),
+                     target_nv_num-1);
+
+        // in the distributed mode, the columns deflated are appended to the
+        // block of rank 0, and the other ranks keep theirs
+        if(prm->deflate && nvc && echelon_gf16_rank(ech) < target_nv_num-1 &&
+           (!prm->dist || dist_rank() == 0)) {
+            ts = prof_start(PROF_DEFLATE);
+            CMSMGeneric* tmp = deflate_cmsm(cmsm_elim, cmsm_lin, ech, kmap,
+                                            s->defl_buf);
+            prof_stop(PROF_DEFLATE, ts);
+            const uint64_t ncol = tmp ? cmsm_generic_cnum(tmp) : 0;
+            if(!tmp || !(gf2 ? blkgf2_arg_set_cnum(blkarg2, ncol) :
+                               blkgf16_arg_set_cnum(blkarg, ncol))) {
+                printf_err_ts("[!] Fail to deflate the matrix to eliminate\n");
+                cmsm_generic_free(tmp);
+                rval = -1;
+                goto solve_cmsm_cleanup;
+            }
+            cmsm_generic_free(cmsm_defl);
+            cmsm_cur = cmsm_defl = tmp;
+            mrs_log(s, "\t\tcolumns deflated: %u\n", echelon_gf16_rank(ech));
+        }
+    }
+
+    mrs_log_ts(s, "[+] Block Lanczos finished in %zu batches\n"
+                  "\t\tindependent nullvectors extracted: %u\n",
+               iter-1, echelon_gf16_rank(ech));
+#ifdef BLK_LANCZOS_COLLECT_STATS
+    mrs_log(s, "\t\tnullvectors dropped due to linear dependency: %zu\n"
+               "\t\tnullvectors that are full zero: %zu\n"
+               "\t\tnullvectors not in the left kernel: %zu\n",
+            dep_count, zero_nv_count, invalid_nv_count);
+#endif
+
+    if(echelon_gf16_rank(ech) < (target_nv_num-1)) {
+        mrs_log_ts(s, "[!] Failed, only %u nullvectors are independent\n",
+                   echelon_gf16_rank(ech));
+    } else {
+        mrs_log_ts(s, "[+] Solving the extracted linear system\n");
+        if(prm->ks_rand) {
+            mrs_log_ts(s, "[!] This solution is for the randomly sampled KS matrix!\n");
+            mrs_log(s, "\t\tNot the original MinRank instance!\n");
+        }
+        // reduced mdmac from nullvectors is dense and small. Just run Gaussian
+        // elimination to extract the linear variables
+        sc_di_t di; di.bl = s->di_buf;
+        ts = prof_start(PROF_SOLVE);
+        const bool gj_ok = sc_gj(sc_ops, reduced_mdmac, sol, &di, tnum,
+                                 s->tpool);
+        prof_stop(PROF_SOLVE, ts);
+        if(!gj_ok) {
+            printf_err_ts("[!] Fail to allocate memory for Gaussian elimination\n");
+            rval = -1;
+            goto solve_cmsm_cleanup;
+        }
+        assert(sc_popcnt(sc_ops, &di) == (target_nv_num-1));
+        if( !(*sol_p = mrs_solution_create(sc_ops, sol,
+                                           sc_di_addr(sc_ops, &di),
+                                           s->k, s->r, prm->c)) ) {
+            printf_err_ts("[!] Fail to create containers for the solution\n");
+            rval = -1;
+            goto solve_cmsm_cleanup;
+        }
+        mrs_progress(s, MRS_STAGE_SOLVE, 1, 1);
+        rval = 0;
+    }
+
+solve_cmsm_cleanup:
+    cmsm_generic_free(cmsm_defl);
+    cmsm_generic_free(cmsm_kept_f);
+    cmsm_filter_free(filter);
+    rm_gf16_free(lifted);
+    return rval;
+}
+
+/* subroutine of mrs_solver_solve: the counterpart of solve_cmsm for
+ *      instances over GF(31). Each batch runs Block Lanczos of block size 64
+ *      BLK_LANCZOS_BLOCK_SIZE / 64 times, and the extracted linear system is
+ *      solved as the nullvectors come. Return 0 if the instance is solved, 1
+ *      if not enough nullvectors are found, or -1 on error */
+static int32_t
+solve_cmsm_gf31(MRSolver* restrict s, MRSSolution** restrict sol_p) {
+    const MRSParams* prm = &s->prm;
+    const uint32_t tnum = prm->tnum;
+    const uint64_t remaining_ncol = s->plan->remaining_ncol;
+    const uint64_t* kmap = s->plan->kmap;
+    const uint32_t target_nv_num = ks_total_var_num(s->k, s->r, prm->c) + 1;
+    const CMSMGeneric* cmsm = s->cmsm, *cmsm_kept = s->cmsm_kept;
+    const uint64_t cmsm_rnum = cmsm_generic_rnum(cmsm);
+    const uint64_t cidxs_sz = cmsm_generic_cnum(cmsm);
+    CMSMGeneric* cmsm_defl = NULL; R64MGF31* prod = NULL;
+    MRSSolution* sol = NULL;
+    int32_t rval = 1;
+    uint64_t ts;
+
+    if(s->blkarg31 && blkgf31_arg_rnum(s->blkarg31) != cmsm_rnum) {
+        blkgf31_arg_free(s->blkarg31);
+        s->blkarg31 = NULL;
+    }
+    if( !(s->blkarg31 || (s->blkarg31 = blkgf31_arg_create(cmsm_rnum, cidxs_sz, tnum))) ||
+        !blkgf31_arg_set_cnum(s->blkarg31, cidxs_sz) ||
+        !(s->ech31 || (s->ech31 = echelon_gf31_create(remaining_ncol, 1))) || // 0 = constant
+        !(prod = r64m_gf31_create(cmsm_generic_cnum(cmsm_kept))) ) {
+        printf_err_ts("[!] Fail to create containers for Block Lanczos\n");
+        rval = -1;
+        goto solve_cmsm_gf31_cleanup;
+    }
+    blkgf31_arg_set_seed(s->blkarg31, prm->seed);
+    BLKGF31Arg* blkarg = s->blkarg31;
+    EchelonGF31* ech = s->ech31;
+    echelon_gf31_reset(ech);
+
+    mrs_log_ts(s, "[+] Try to extract %u nullvectors\n", target_nv_num);
+    uint64_t expected_rank = (cidxs_sz > cmsm_rnum) ? cmsm_rnum : cidxs_sz;
+    mrs_log(s, "\t\tmatrix to eliminate over GF(31): %d runs of block "
+               "size 64 per batch\n"
+               "\t\texpected rank of submatrix to eliminate: %lu\n"
+               "\t\texpected number of iterations: %zu\n"
+               "\t\tsize of %lu x 64 matrix: %.2fMB\n"
+               "\t\tsize of %lu x 64 matrix: %.2fMB\n",
+            BLK_LANCZOS_BLOCK_SIZE / 64, expected_rank,
+            blkgf31_iter_num(64, expected_rank) * (BLK_LANCZOS_BLOCK_SIZE / 64),
+            cmsm_rnum, r64m_gf31_memsize(cmsm_rnum) / MBFLOAT,
+            s->plan->mac_ncol, r64m_gf31_memsize(s->plan->mac_ncol) / MBFLOAT);
+
+    uint64_t iter = 0;
+    bool inconsistent = false;
+    const CMSMGeneric* cmsm_cur = cmsm; // deflated as nullvectors come
+    while(iter++ < LANCZOS_MAX_ITER && echelon_gf31_rank(ech) < target_nv_num-1) {
+        uint32_t iter_count = 0, nvc = 0;
+        for(uint32_t i = 0; i < BLK_LANCZOS_BLOCK_SIZE / 64 &&
+                            echelon_gf31_rank(ech) < target_nv_num-1; ++i) {
+            ts = prof_start(PROF_LANCZOS);
+            iter_count += blk_lczs_gf31(blkarg, cmsm_cur, s->tpool);
+            prof_stop(PROF_LANCZOS, ts);
+            ts = prof_start(PROF_NULLVEC);
+            nvc += proc_nullvec_gf31(ech, prod, blkgf31_arg_v(blkarg),
+                                     cmsm_kept, tnum, blkgf31_arg_pargs(blkarg),
+                                     s->tpool, kmap, remaining_ncol,
+                                     &inconsistent);
+            prof_stop(PROF_NULLVEC, ts);
+        }
+        mrs_log_ts(s, "[+] %zu-th batch: %u iterations, %u nullvectors\n",
+                   iter, iter_count, nvc);
+        mrs_progress(s, MRS_STAGE_LANCZOS, echelon_gf31_rank(ech),
+                     target_nv_num-1);
+
+        if(prm->deflate && nvc && echelon_gf31_rank(ech) < target_nv_num-1) {
+            ts = prof_start(PROF_DEFLATE);
+            const uint32_t rank = echelon_gf31_rank(ech);
+            for(uint32_t i = 0; i < rank; ++i)
+                s->defl_buf[i] = kmap[echelon_gf31_pivot(ech, i)];
+            CMSMGeneric* tmp = cmsm_generic_append_cols(cmsm, cmsm_kept,
+                                                        s->defl_buf, rank);
+            prof_stop(PROF_DEFLATE, ts);
+            if(!tmp || !blkgf31_arg_set_cnum(blkarg, cmsm_generic_cnum(tmp))) {
+                printf_err_ts("[!] Fail to deflate the matrix to eliminate\n");
+                cmsm_generic_free(tmp);
+                rval = -1;
+                goto solve_cmsm_gf31_cleanup;
+            }
+            cmsm_generic_free(cmsm_defl);
+            cmsm_cur = cmsm_defl = tmp;
+            mrs_log(s, "\t\tcolumns deflated: %u\n", rank);
+        }
+    }
+
+    mrs_log_ts(s, "[+] Block Lanczos finished in %zu batches\n"
+                  "\t\tindependent nullvectors extracted: %u\n",
+               iter-1, echelon_gf31_rank(ech));
+
+    if(echelon_gf31_rank(ech) < (target_nv_num-1)) {
+        mrs_log_ts(s, "[!] Failed, only %u nullvectors are independent\n",
+                   echelon_gf31_rank(ech));
+        goto solve_cmsm_gf31_cleanup;
+    }
+
+    // the extracted linear system is already in echelon form
+    mrs_log_ts(s, "[+] Solving the extracted linear system\n");
+    const uint32_t vnum = target_nv_num - 1;
+    if( !(sol = calloc(1, sizeof(MRSSolution))) ||
+        !(sol->val = malloc(sizeof(gf_t) * vnum)) ||
+        !(sol->det = malloc(sizeof(bool) * vnum)) ) {
+        printf_err_ts("[!] Fail to create containers for the solution\n");
+        mrs_solution_free(sol);
+        rval = -1;
+        goto solve_cmsm_gf31_cleanup;
+    }
+    ts = prof_start(PROF_SOLVE);
+    echelon_gf31_solve(ech, sol->val);
+    prof_stop(PROF_SOLVE, ts);
+    sol->k = s->k;
+    sol->r = s->r;
+    sol->c = prm->c;
+    sol->vnum = vnum;
+    sol->consistent = !inconsistent;
+    for(uint32_t i = 0; i < vnum; ++i)
+        sol->det[i] = true;
+    *sol_p = sol;
+    mrs_progress(s, MRS_STAGE_SOLVE, 1, 1);
+    rval = 0;
+
+solve_cmsm_gf31_cleanup:
+    cmsm_generic_free(cmsm_defl);
+    r64m_gf31_free(prod);
+    return rval;
+}
+
+/* usage: Create a solver context
+ * params:
+ *      1) prm: ptr to MRSParams. It's copied into the context
+ * return: ptr to struct MRSolver on success, NULL otherwise */
+MRSolver*
+mrs_solver_create(const MRSParams* prm) {
+    if(!prm->degs_num || !prm->tnum)
+        return NULL;
+
+    MRSolver* s = calloc(1, sizeof(MRSolver));
+    if(!s)
+        return NULL;
+
+    s->prm = *prm;
+    if(prm->tpool) {
+        s->tpool = prm->tpool;
+    } else {
+        if( !(s->tpool = thpool_create(prm->tnum)) ) {
+            free(s);
+            return NULL;
+        }
+        s->own_tpool = true;
+    }
+    return s;
+}
+
+/* usage: Release a solver context
+ * params:
+ *      1) s: ptr to struct MRSolver
+ * return: void */
+void
+mrs_solver_free(MRSolver* s) {
+    if(!s)
+        return;
+    mrs_solver_release(s);
+    if(s->own_tpool)
+        thpool_destroy(s->tpool, true);
+    free(s);
+}
+
+/* usage: Build the symbolic phase for the instances with the parameters of
+ *      the given one ahead of the first solve, so that it can be shared with
+ *      mrs_solver_clone. Only for a context that reuses the symbolic phase
+ * params:
+ *      1) s: ptr to struct MRSolver
+ *      2) mr: ptr to struct MinRank, only its parameters matter
+ * return: true on success, false otherwise */
+bool
+mrs_solver_plan(MRSolver* restrict s, const MinRank* restrict mr) {
+    if(!s->prm.reuse)
+        return false;
+    return mrs_solver_prepare(s, mr, NULL);
+}
+
+/* usage: Create a solver context that shares the symbolic phase of another
+ *      one, which is built with mrs_solver_plan or by a solve. The symbolic
+ *      phase is only read by the solves, so both contexts may be used
+ *      concurrently, but the source must outlive the new context. If an
+ *      instance with other parameters is given to the new context, it builds
+ *      its own symbolic phase
+ * params:
+ *      1) src: ptr to struct MRSolver, the source of the symbolic phase
+ *      2) prm: ptr to MRSParams for the new context. It must reuse the
+ *          symbolic phase and have the same parameters of the construction
+ *          as the source
+ * return: ptr to struct MRSolver on success, NULL otherwise */
+MRSolver*
+mrs_solver_clone(const MRSolver* restrict src, const MRSParams* restrict prm) {
+    if(!src->ready || !src->refill || !prm->reuse)
+        return NULL;
+
+    MRSolver* s = mrs_solver_create(prm);
+    if(!s)
+        return NULL;
+
+    s->plan = src->plan;
+    s->refill = true;
+    if(!mrs_solver_setup(s)) {
+        mrs_solver_free(s);
+        return NULL;
+    }
+    s->nrow = src->nrow;
+    s->ncol = src->ncol;
+    s->k = src->k;
+    s->r = src->r;
+    s->has_m0 = src->has_m0;
+    return s;
+}
+
+/* usage: Solve a MinRank instance
+ * params:
+ *      1) s: ptr to struct MRSolver
+ *      2) mr: ptr to struct MinRank
+ *      3) sol: container for the ptr to the solution. On success, the caller
+ *          releases it with mrs_solution_free
+ * return: 0 if the instance is solved, 1 if not enough nullvectors are found,
+ *      or -1 on error */
+int32_t
+mrs_solver_solve(MRSolver* restrict s, const MinRank* restrict mr,
+                 MRSSolution** restrict sol) {
+    const MRSParams* prm = &s->prm;
+    const uint32_t c = prm->c;
+    *sol = NULL;
+
+    if(prm->dist && (minrank_field(mr) == GF31_SIZE || prm->filter ||
+                     prm->reuse || prm->plan_dir)) {
+        printf_err_ts("[!] Filtering, the plan cache, reusing the symbolic "
+                      "phase and GF(%u) are not supported in the distributed "
+                      "mode\n", GF31_SIZE);
+        return -1;
+    }
+    // refilling the matrix to eliminate needs its pattern in memory
+    if(prm->ooc_dir && (minrank_field(mr) == GF31_SIZE || prm->filter ||
+                        prm->deflate || prm->dist || prm->reuse ||
+                        prm->plan_dir)) {
+        printf_err_ts("[!] Filtering, deflation, the distributed mode, the "
+                      "plan cache, reusing the symbolic phase and GF(%u) are "
+                      "not supported with the matrix to eliminate on disk\n",
+                      GF31_SIZE);
+        return -1;
+    }
+
+    // the Macaulay matrix is built the same way over any field, but only the
+    // elimination itself has a GF(31) counterpart
+    if(minrank_field(mr) == GF31_SIZE && (prm->ks_rand || prm->filter)) {
+        printf_err_ts("[!] Random KS matrix and filtering are not supported "
+                      "over GF(%u)\n", GF31_SIZE);
+        return -1;
+    }
+
+    uint64_t ts = prof_start(PROF_KS);
+    GFM* ks;
+    if(prm->ks_rand) {
+        mrs_log_ts(s, "[+] Generating random KS matrix:\n");
+        ks = ks_rand(minrank_nmat(mr), minrank_rank(mr), c, minrank_ncol(mr),
+                     prm->seed);
+    } else {
+        mrs_log_ts(s, "[+] Computing KS matrix:\n");
+        ks = minrank_ks(mr, c);
+    }
+    prof_stop(PROF_KS, ts);
+
+    if(!ks) {
+        printf_err_ts("[!] Fail to create KS matrix\n");
+        return -1;
+    }
+    mrs_log(s, "\t\tnumber of rows in left multiplier (parameter c): %u\n"
+               "\t\tdimension (logical): %u x %u\n"
+               "\t\tdimension (actual): %lu x %lu\n",
+            c, c, minrank_ncol(mr), gfm_nrow(ks), gfm_ncol(ks));
+    mrs_progress(s, MRS_STAGE_KS, 1, 1);
+
+    int32_t rval = -1;
+    if(!mrs_solver_prepare(s, mr, ks))
+        goto mrs_solver_solve_cleanup;
+
+    if(s->refill) {
+        ts = prof_start(PROF_CMSM);
+        cmsm_generic_refill(s->cmsm, s->plan->cmsm, s->plan->koff, ks);
+        cmsm_generic_refill(s->cmsm_kept, s->plan->cmsm_kept,
+                            s->plan->koff_kept, ks);
+        prof_stop(PROF_CMSM, ts);
+        prof_add_units(PROF_CMSM, cmsm_generic_nznum(s->cmsm) +
+                                  cmsm_generic_nznum(s->cmsm_kept));
+        mrs_log(s, "\t\tnumber of non-zero entries: %lu\n",
+                cmsm_generic_nznum(s->cmsm) + cmsm_generic_nznum(s->cmsm_kept));
+    }
+    mrs_progress(s, MRS_STAGE_PLAN, 1, 1);
+    gfm_free(ks);
+    ks = NULL;
+
+    rval = (minrank_field(mr) == GF31_SIZE) ? solve_cmsm_gf31(s, sol) :
+                                              solve_cmsm(s, sol);
+    if(rval < 0 || !prm->reuse) // the matrices may have been released
+        mrs_solver_release(s);
+
+mrs_solver_solve_cleanup:
+    if(ks)
+        gfm_free(ks);
+    return rval;
+}
+
+/* usage: Release a solution returned by mrs_solver_solve
+ * params:
+ *      1) sol: ptr to MRSSolution
+ * return: void */
+void
+mrs_solution_free(MRSSolution* sol) {
+    if(!sol)
+        return;
+    free(sol->val);
+    free(sol->det);
+    free(sol);
+}
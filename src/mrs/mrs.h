@@ -0,0 +1,140 @@
+#ifndef __MRS_H__
+#define __MRS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gf.h"
+#include "minrank.h"
+#include "mdeg.h"
+#include "thpool.h"
+
+// Entry point of the library: a solver context that takes MinRank instances
+// and returns their solutions. A context owns everything the solver needs,
+// i.e. the thread pool (unless one is lent to it), the condensed Macaulay
+// matrices and the containers of Block Lanczos and of the final linear system,
+// so several contexts can be used in the same process, each from its own
+// thread. A context is not meant to be shared by threads.
+//
+// When reuse is set, the symbolic phase of the construction is kept across
+// instances with the same parameters and only refilled with the coefficients
+// of each instance. Otherwise everything is rebuilt for each instance, and
+// released as early as possible.
+//
+// The random numbers of a context are drawn from its own streams, see prng.h,
+// so its results only depend on the seeds in its parameters, and not on the
+// number of threads nor on other contexts.
+
+typedef struct MRSolver MRSolver;
+
+// stages reported to the progress callback
+typedef enum {
+    MRS_STAGE_KS,       // the KS matrix is computed
+    MRS_STAGE_PLAN,     // the condensed Macaulay matrices are ready
+    MRS_STAGE_LANCZOS,  // a batch of Block Lanczos is done: done out of total
+                        // independent nullvectors are extracted
+    MRS_STAGE_SOLVE,    // the extracted linear system is solved
+} MRSStage;
+
+typedef void (*MRSProgressFn)(void* arg, MRSStage stage, uint64_t done,
+                              uint64_t total);
+
+// parameters of a solver context
+typedef struct {
+    uint32_t c; // number of rows in the left multiplier of the KS matrix
+    const MDeg** degs; // multi-degree(s), must outlive the context
+    uint32_t degs_num;
+    uint64_t mac_nrow; // number of rows to keep, 0 for all of them
+    bool mac_row_auto; // keep just enough rows for the nullvectors needed
+    int32_t mac_seed; // seed to select the rows
+    uint64_t seed; // seed of the Lanczos vectors and of a random KS matrix
+    bool filter; // structured Gaussian elimination before Block Lanczos
+    bool deflate; // deflate the extracted nullvectors out of the matrix
+    bool ks_rand; // sample the KS matrix randomly instead of computing it
+    bool reuse; // keep the symbolic phase across instances
+    bool quiet; // don't log to stdout; errors are still printed to stderr
+    bool dist; // shard the matrix to eliminate over the ranks of the MPI job,
+               // see dist.h. All the ranks solve the same instance together
+    uint32_t tnum; // number of threads to use
+    Threadpool* tpool; // thread pool to use, or NULL to create one
+    const char* plan_dir; // cache directory of the symbolic phase, or NULL
+    const char* ooc_dir; // directory to stream the matrix to eliminate from
+                         // during Block Lanczos, or NULL to keep it in memory
+    uint64_t ooc_blk_mem; // size of a block of it in bytes, see cmsm_ooc.h
+    MRSProgressFn progress; // progress callback, or NULL
+    void* progress_arg; // first argument of the progress callback
+} MRSParams;
+
+// solution of a MinRank instance. Variables 0 ~ k-1 are the linear variables,
+// and the kernel variables follow (see ks_kernel_var_idx_to_2d)
+typedef struct {
+    uint32_t k, r, c;
+    uint32_t vnum; // total number of variables
+    bool consistent; // false if the extracted linear system has no solution
+    gf_t* val; // value of each variable
+    bool* det; // whether each variable is determined, or free
+} MRSSolution;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Create a solver context
+ * params:
+ *      1) prm: ptr to MRSParams. It's copied into the context
+ * return: ptr to struct MRSolver on success, NULL otherwise */
+MRSolver*
+mrs_solver_create(const MRSParams* prm);
+
+/* usage: Release a solver context
+ * params:
+ *      1) s: ptr to struct MRSolver
+ * return: void */
+void
+mrs_solver_free(MRSolver* s);
+
+/* usage: Build the symbolic phase for the instances with the parameters of
+ *      the given one ahead of the first solve, so that it can be shared with
+ *      mrs_solver_clone. Only for a context that reuses the symbolic phase
+ * params:
+ *      1) s: ptr to struct MRSolver
+ *      2) mr: ptr to struct MinRank, only its parameters matter
+ * return: true on success, false otherwise */
+bool
+mrs_solver_plan(MRSolver* restrict s, const MinRank* restrict mr);
+
+/* usage: Create a solver context that shares the symbolic phase of another
+ *      one, which is built with mrs_solver_plan or by a solve. The symbolic
+ *      phase is only read by the solves, so both contexts may be used
+ *      concurrently, but the source must outlive the new context. If an
+ *      instance with other parameters is given to the new context, it builds
+ *      its own symbolic phase
+ * params:
+ *      1) src: ptr to struct MRSolver, the source of the symbolic phase
+ *      2) prm: ptr to MRSParams for the new context. It must reuse the
+ *          symbolic phase and have the same parameters of the construction
+ *          as the source
+ * return: ptr to struct MRSolver on success, NULL otherwise */
+MRSolver*
+mrs_solver_clone(const MRSolver* restrict src, const MRSParams* restrict prm);
+
+/* usage: Solve a MinRank instance
+ * params:
+ *      1) s: ptr to struct MRSolver
+ *      2) mr: ptr to struct MinRank
+ *      3) sol: container for the ptr to the solution. On success, the caller
+ *          releases it with mrs_solution_free
+ * return: 0 if the instance is solved, 1 if not enough nullvectors are found,
+ *      or -1 on error */
+int32_t
+mrs_solver_solve(MRSolver* restrict s, const MinRank* restrict mr,
+                 MRSSolution** restrict sol);
+
+/* usage: Release a solution returned by mrs_solver_solve
+ * params:
+ *      1) sol: ptr to MRSSolution
+ * return: void */
+void
+mrs_solution_free(MRSSolution* sol);
+
+#endif // __MRS_H__
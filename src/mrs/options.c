@@ -13,6 +13,7 @@
 #include <errno.h>
 
 #include <sys/sysinfo.h> // get_nprocs
+#include <unistd.h> // sysconf
 
 /* ========================================================================
  * struct Options definition
@@ -21,6 +22,7 @@
 #define MAX_FILE_PATH_LEN               (255)
 #define MAX_INPUT_STR_LEN               (255)
 #define MAX_MDEG_NUM                    (64)
+#define DEFAULT_OOC_BLK_MB              (256)
 
 #define OPT_PARSE_ERR_PATH_TOO_LONG     (1)
 #define OPT_PARSE_NO_MDEG               (2)
@@ -31,6 +33,11 @@
 #define OPT_PARSE_MDEG_DIFF_C           (7)
 #define OPT_PARSE_INVALID_TNUM          (8)
 #define OPT_PARSE_TOO_MANY_MR_FILE      (9)
+#define OPT_PARSE_MDEG_AUTO_MIX         (10)
+#define OPT_PARSE_GUESS_THROUGHPUT      (11)
+#define OPT_PARSE_DIST_MIX              (12)
+#define OPT_PARSE_OOC_MIX               (13)
+#define OPT_PARSE_PERF_MIX              (14)
 #define OPT_PARSE_INVALID_NUM           (126)
 #define OPT_PARSE_UNKNOWN_ERR           (127)
 #define OPT_PARSE_INVALID_OPT           (128)
@@ -41,8 +48,17 @@ struct Options {
     uint32_t c;
     uint64_t mac_nrow; // number of rows to keep in Macaulay matrices
     uint32_t degs_sz;
+    uint64_t max_mem; // memory budget in bytes for --mdeg=auto
+    double peak_gbps; // peak memory bandwidth for --perf-counters
+    uint32_t guess; // number of linear variables to guess
+    uint32_t guess_groups; // number of worker groups for the guesses
+    uint64_t ooc_blk_mem; // size of a block of the matrix on disk in bytes
 
     char mr_file[MAX_FILE_PATH_LEN+1];
+    char timing_file[MAX_FILE_PATH_LEN+1];
+    char batch_file[MAX_FILE_PATH_LEN+1];
+    char plan_dir[MAX_FILE_PATH_LEN+1];
+    char ooc_dir[MAX_FILE_PATH_LEN+1];
     MDeg* mdeg[MAX_MDEG_NUM];
 
     bool verbose;
@@ -51,6 +67,17 @@ struct Options {
     bool rand_seed;
     bool has_mr_file;
     bool ks_rand;
+    bool deflate;
+    bool filter;
+    bool has_timing_file;
+    bool has_batch_file;
+    bool has_plan_dir;
+    bool has_ooc_dir;
+    bool perf_counters;
+    bool mdeg_auto;
+    bool mac_row_auto;
+    bool throughput;
+    bool dist;
 };
 
 /* ========================================================================
@@ -111,6 +138,33 @@ opt_mr_file(const Options* opts) {
     return opts->mr_file;
 }
 
+/* usage: return the path to the list of MinRank instances to solve in batch
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if not in batch mode */
+const char*
+opt_batch_file(const Options* opts) {
+    return opts->has_batch_file ? opts->batch_file : NULL;
+}
+
+/* usage: return the directory of the cache of Macaulay plans
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if the cache is not used */
+const char*
+opt_plan_dir(const Options* opts) {
+    return opts->has_plan_dir ? opts->plan_dir : NULL;
+}
+
+/* usage: return the path to write the timing report to
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if no report is requested */
+const char*
+opt_timing_file(const Options* opts) {
+    return opts->has_timing_file ? opts->timing_file : NULL;
+}
+
 /* usage: return the number of rows in left matrix of the KS system
  * params:
  *      1) opts: pointer to struct Options
@@ -158,6 +212,123 @@ opt_ks_rand(const Options* opts) {
     return opts->ks_rand;
 }
 
+/* usage: check if the nullvectors already extracted should be deflated out
+ *      of the matrix to eliminate before the next batch of Block Lanczos
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_deflate(const Options* opts) {
+    return opts->deflate;
+}
+
+/* usage: check if the matrix to eliminate should be filtered with structured
+ *      Gaussian elimination before Block Lanczos
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_filter(const Options* opts) {
+    return opts->filter;
+}
+
+/* usage: check if the instances of the batch should be solved concurrently
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_throughput(const Options* opts) {
+    return opts->throughput;
+}
+
+/* usage: check if the matrix to eliminate should be sharded over the ranks of
+ *      the MPI job
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_dist(const Options* opts) {
+    return opts->dist;
+}
+
+/* usage: return the directory to stream the matrix to eliminate from
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if the matrix stays in memory */
+const char*
+opt_ooc_dir(const Options* opts) {
+    return opts->has_ooc_dir ? opts->ooc_dir : NULL;
+}
+
+/* usage: return the size of a block of the matrix to eliminate on disk
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the size in bytes */
+uint64_t
+opt_ooc_blk_mem(const Options* opts) {
+    return opts->ooc_blk_mem;
+}
+
+/* usage: return the number of linear variables to guess
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the number of variables, or 0 if none should be guessed */
+uint32_t
+opt_guess(const Options* opts) {
+    return opts->guess;
+}
+
+/* usage: return the number of worker groups to spread the guesses over
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the number of worker groups */
+uint32_t
+opt_guess_groups(const Options* opts) {
+    return opts->guess_groups;
+}
+
+/* usage: check if hardware performance counters should be sampled
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_perf_counters(const Options* opts) {
+    return opts->perf_counters;
+}
+
+/* usage: return the peak memory bandwidth for the roofline summary
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the bandwidth in GB/s, or 0 if it should be measured */
+double
+opt_perf_peak_gbps(const Options* opts) {
+    return opts->peak_gbps;
+}
+
+/* usage: check if the multi-degree should be picked by the planner
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_mdeg_auto(const Options* opts) {
+    return opts->mdeg_auto;
+}
+
+/* usage: return the memory budget for the multi-degree picked by the planner
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the budget in bytes */
+uint64_t
+opt_max_mem(const Options* opts) {
+    return opts->max_mem;
+}
+
+/* usage: check if the number of rows to keep in the Macaulay matrix should be
+ *      chosen automatically
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_mac_row_auto(const Options* opts) {
+    return opts->mac_row_auto;
+}
+
 /* usage: return the size of the thread pool
  * params:
  *      1) opts: pointer to struct Options
@@ -210,6 +381,18 @@ opt_free(Options* opts) {
 #define OPT_TPOOL_SIZE          6
 #define OPT_MAC_ROW             7
 #define OPT_KS_RAND             8
+#define OPT_DEFLATE             9
+#define OPT_FILTER              10
+#define OPT_TIMING              11
+#define OPT_PERF                12
+#define OPT_MAX_MEM             13
+#define OPT_BATCH               14
+#define OPT_PLAN_CACHE          15
+#define OPT_THROUGHPUT          16
+#define OPT_GUESS               17
+#define OPT_DIST                18
+#define OPT_OOC                 19
+#define OPT_OOC_BLOCK           20
 
 #define OPT_SEED_STR            "seed"
 #define OPT_MR_SYS_STR          "minrank"
@@ -219,20 +402,44 @@ opt_free(Options* opts) {
 #define OPT_TPOOL_SIZE_STR      "thread"
 #define OPT_MAC_ROW_STR         "mac-row"
 #define OPT_KS_RAND_STR         "ks-rand"
+#define OPT_DEFLATE_STR         "deflate"
+#define OPT_FILTER_STR          "filter"
+#define OPT_TIMING_STR          "timing"
+#define OPT_PERF_STR            "perf-counters"
+#define OPT_MAX_MEM_STR         "max-mem"
+#define OPT_BATCH_STR           "batch"
+#define OPT_PLAN_CACHE_STR      "plan-cache"
+#define OPT_THROUGHPUT_STR      "throughput"
+#define OPT_GUESS_STR           "guess"
+#define OPT_DIST_STR            "dist"
+#define OPT_OOC_STR             "ooc"
+#define OPT_OOC_BLOCK_STR       "ooc-block"
 #define OPT_HELP_STR            "help"
 
 static struct option long_opts[] = {
     { OPT_MR_SYS_STR, 1, 0, OPT_MR_SYS },
+    { OPT_BATCH_STR, 1, 0, OPT_BATCH },
+    { OPT_THROUGHPUT_STR, 0, 0, OPT_THROUGHPUT },
+    { OPT_GUESS_STR, 1, 0, OPT_GUESS },
+    { OPT_DIST_STR, 0, 0, OPT_DIST },
     { OPT_SEED_STR, 1, 0, OPT_SEED },
     { OPT_VERBOSE_STR, 0, 0, OPT_VERBOSE },
     { OPT_DRY_STR, 0, 0, OPT_DRY },
     { OPT_SEED_STR, 1, 0, OPT_SEED },
     { OPT_DRY_STR, 0, 0, OPT_DRY },
     { OPT_KS_RAND_STR, 0, 0, OPT_KS_RAND },
+    { OPT_DEFLATE_STR, 0, 0, OPT_DEFLATE },
+    { OPT_FILTER_STR, 0, 0, OPT_FILTER },
+    { OPT_TIMING_STR, 1, 0, OPT_TIMING },
+    { OPT_PERF_STR, 2, 0, OPT_PERF },
     { OPT_TPOOL_SIZE_STR, 1, 0, OPT_TPOOL_SIZE },
 
     { OPT_MAC_MDEG_STR, 1, 0, OPT_MAC_MDEG },
     { OPT_MAC_ROW_STR, 1, 0, OPT_MAC_ROW },
+    { OPT_PLAN_CACHE_STR, 1, 0, OPT_PLAN_CACHE },
+    { OPT_OOC_STR, 1, 0, OPT_OOC },
+    { OPT_OOC_BLOCK_STR, 1, 0, OPT_OOC_BLOCK },
+    { OPT_MAX_MEM_STR, 1, 0, OPT_MAX_MEM },
 
     { OPT_HELP_STR, 0, 0, 'h' },
     { 0, 0, 0, 0 }
@@ -246,7 +453,7 @@ void
 opt_print_usage(const char* const name) {
     // not using macros defined above for each option to keep alignment easier
     printf(
-"Usage: %s [OPTIONS] --minrank=FILE --mdeg=DEG\n"
+"Usage: %s [OPTIONS] --minrank=FILE|--batch=FILE_LIST --mdeg=DEG\n"
 "\n"
 "Options:\n"
 "\n"
@@ -256,10 +463,56 @@ opt_print_usage(const char* const name) {
 "  --minrank=FILE   Read MinRank instance to solve from FILE. FILE must have\n"
 "                   the same format as files generated by bin/minrank-gen.sage.\n"
 "\n"
+"  --batch=FILE_LIST\n"
+"                   Solve the MinRank instances listed in FILE_LIST, one path\n"
+"                   per line, in one run. Empty lines and lines starting with\n"
+"                   # are skipped. All instances must have the same parameters\n"
+"                   as the first one. The sparsity pattern of the Macaulay\n"
+"                   matrix is computed once for all of them, the coefficients\n"
+"                   are refilled for each instance, and the thread pool and\n"
+"                   the buffers are reused. The result of each instance is\n"
+"                   printed as it is solved, followed by a summary.\n"
+"\n"
+"  --throughput     With --batch, solve several instances at once to maximize\n"
+"                   the number of instances solved per hour. The threads are\n"
+"                   split among the concurrent solves by their predicted work,\n"
+"                   each on its own cores, within the memory budget of\n"
+"                   --max-mem. The instances may have different parameters.\n"
+"                   A solve keeps the threads it's started with, so cores\n"
+"                   freed at the end of the queue only go to the solves\n"
+"                   started after them. Only the results are printed, as\n"
+"                   each solve finishes.\n"
+"\n"
+"  --guess=G[:W]    Guess the last G linear variables and solve the instance\n"
+"                   with the remaining ones for each guess, until one of them\n"
+"                   gives a solution. The Macaulay matrix is built once for\n"
+"                   all the guesses, which are spread over W worker groups\n"
+"                   (as many as the threads by default) that split the\n"
+"                   threads evenly. The multi-degree(s) are those of the\n"
+"                   instance with G fewer matrices.\n"
+"\n"
+"  --dist           Shard the matrix to eliminate by columns over the ranks of\n"
+"                   the MPI job the program is launched in, e.g. with\n"
+"                   mpirun -np 4. Each rank builds its share of the rows of\n"
+"                   the Macaulay matrix and holds a block of the columns to\n"
+"                   eliminate; the products of Block Lanczos are combined\n"
+"                   over the ranks. Requires a build with -DUSE_MPI=ON, and\n"
+"                   cannot be combined with --batch, --guess, --filter,\n"
+"                   --plan-cache, --dry-run or --mdeg=auto. Only rank 0\n"
+"                   prints.\n"
+"\n"
 "  --mdeg=DEG       Multi-degree of the Macaulay matrix. At least one multi-\n"
 "                   degree must be provided. If more than one is provided,\n"
 "                   the Macaulay matrix will be defined over the combined multi-\n"
 "                   degrees. Currently at most 64 multi-degrees are supported.\n"
+"                   With DEG=auto[:C], the multi-degree with the lowest\n"
+"                   predicted runtime that is predicted to solve the instance\n"
+"                   within the memory budget is picked, with C rows (2 by\n"
+"                   default) in the left matrix of the Kipnis-Shamir system.\n"
+"\n", name);
+    printf(
+"  --max-mem=MB     Memory budget in MB for --mdeg=auto and --throughput.\n"
+"                   Default is the amount of physical memory.\n"
 "\n"
 "  --verbose        Print extra information.\n"
 "\n"
@@ -267,21 +520,85 @@ opt_print_usage(const char* const name) {
 "                   to use as many threads as the number of CPU cores,\n"
 "                   which is also the default value.\n"
 "\n"
-"  --mac-row=NUM    Specify the number of rows to randomly select and keep in\n"
-"                   the Macaulay matrix. By default, all rows are kept.\n"
+"  --mac-row=NUM    Specify the number of rows to select and keep in the\n"
+"                   Macaulay matrix. By default, all rows are kept. The rows\n"
+"                   are selected such that the columns to eliminate are\n"
+"                   covered evenly and no such column is left empty, which\n"
+"                   may take slightly more than NUM rows.\n"
+"                   With NUM=auto, just enough rows are kept to find the\n"
+"                   nullvectors needed.\n"
+"\n"
+"  --plan-cache=DIR Keep the symbolic part of the construction of the Macaulay\n"
+"                   matrix in DIR: the selected rows, the columns to keep and\n"
+"                   to eliminate and the sparsity pattern of both. It only\n"
+"                   depends on the parameters of the instance, the multi-\n"
+"                   degree(s), --mac-row and the random seed, so later runs\n"
+"                   with the same ones, e.g. with the same --seed, load it\n"
+"                   and only fill in the coefficients of the instance.\n"
 "\n"
+"  --ooc=DIR        Keep the matrix to eliminate in a file in DIR during Block\n"
+"                   Lanczos instead of in memory, and read it block by block\n"
+"                   once per iteration, the next block being read while the\n"
+"                   current one is processed. Trades disk bandwidth for the\n"
+"                   memory of the matrix, which is written to the file block\n"
+"                   by block as it's built. The file is removed on exit.\n"
+"                   Cannot be combined with --dist, --filter, --deflate,\n"
+"                   --guess or --plan-cache. With --batch, the matrices of\n"
+"                   each instance are built anew.\n"
+"\n"
+"  --ooc-block=MB   Size of a block read at once with --ooc. Two of them are\n"
+"                   held in memory. Default is 256.\n"
+"\n");
+    printf(
 "  --ks-rand        Instead of computing the Kipnis-Shamir matrix from the input\n"
 "                   MinRank instance, randomly sample it with the same dimension\n"
 "\n"
+"  --deflate        Before each batch of Block Lanczos, append the columns of\n"
+"                   the variables solved by the extracted nullvectors to the\n"
+"                   matrix to eliminate, so that each batch only finds new ones.\n"
+"\n"
+"  --filter         Shrink the matrix to eliminate with structured Gaussian\n"
+"                   elimination before Block Lanczos: remove singleton columns\n"
+"                   and excess rows, and merge light columns.\n"
+"\n"
+"  --timing=FILE    Measure the wall time of each phase of the solver and of\n"
+"                   each step of Block Lanczos, and write them to FILE as JSON\n"
+"                   at exit. Use - for stdout.\n"
+"\n"
+"  --perf-counters[=GBPS]\n"
+"                   Sample hardware performance counters (cycles, instructions,\n"
+"                   LLC and dTLB misses) of all threads around each measured\n"
+"                   phase and print a roofline summary at exit against a peak\n"
+"                   memory bandwidth of GBPS GB/s, which is measured with a\n"
+"                   large memcpy if omitted. Falls back to wall time only if\n"
+"                   the counters are unavailable. Adds a few system calls per\n"
+"                   thread to each measurement. Cannot be combined with\n"
+"                   --throughput or --guess with more than one worker group,\n"
+"                   whose concurrent solves can't be told apart.\n"
+"\n"
 "  --dry-run        Do not actually solve the MinRank instance; Simply check\n"
-"                   the sanity of the parameters and then terminate.\n"
+"                   the sanity of the parameters, print the predicted\n"
+"                   dimension, number of non-zero entries, memory, number of\n"
+"                   Block Lanczos iterations and runtime of each multi-degree\n"
+"                   and their combination, and then terminate. The runtime is\n"
+"                   calibrated with a short benchmark on the host.\n"
 "\n"
 "Examples:\n"
 "\n"
 "  %s --verbose --minrank=toy_example.txt --mdeg=2,2,1\n"
 "\n"
 "  %s --minrank=large_system.txt --mdeg=2,2,2,2,1,1 --mdeg=1,2,2,2,1,2\n"
-"\n", name, name, name);
+"\n"
+"  %s --minrank=large_system.txt --mdeg=auto --max-mem=65536\n"
+"\n"
+"  %s --batch=instances.list --mdeg=2,1,1 --mac-row=auto\n"
+"\n"
+"  %s --batch=instances.list --mdeg=2,1,1 --throughput --thread=32\n"
+"\n"
+"  %s --minrank=large_system.txt --mdeg=2,1,1 --guess=2:8 --thread=32\n"
+"\n"
+"  mpirun -np 4 %s --minrank=large_system.txt --mdeg=2,2,1 --dist --thread=8\n"
+"\n", name, name, name, name, name, name, name);
 }
 
 /* usage: subroutine of options_parse(): copy input string with strncpy and
@@ -303,6 +620,29 @@ safe_strncpy(char* const dst, const char* const src, const size_t n) {
     return 0;
 }
 
+/* usage: subroutine of options_parse(): parse the number of rows in the left
+ *      matrix of the KS system from --mdeg=auto[:C]
+ * params:
+ *      1) str: the argument of --mdeg
+ * return: the number of rows. 0 if str is not auto[:C] or C is invalid */
+static inline uint32_t
+opt_parse_mdeg_auto(const char* str) {
+    const size_t len = strlen("auto");
+    if(strncmp(str, "auto", len))
+        return 0;
+    if(str[len] == '\0')
+        return 2;
+    if(str[len] != ':')
+        return 0;
+
+    errno = 0;
+    char* end;
+    long c = strtol(str + len + 1, &end, 0);
+    if(errno || *end != '\0' || c <= 0 || c > UINT8_MAX)
+        return 0;
+    return c;
+}
+
 static inline MDeg*
 opt_parse_mdeg(const char* str) {
     if(MAX_INPUT_STR_LEN == strnlen(str, MAX_INPUT_STR_LEN))
@@ -375,6 +715,55 @@ opt_parse(Options* const opts, int argc, char** argv) {
                 opts->ks_rand = true;
                 break;
 
+            case OPT_DEFLATE:
+                opts->deflate = true;
+                break;
+
+            case OPT_FILTER:
+                opts->filter = true;
+                break;
+
+            case OPT_THROUGHPUT:
+                opts->throughput = true;
+                break;
+
+            case OPT_DIST:
+                opts->dist = true;
+                break;
+
+            case OPT_GUESS: {
+                char* end = NULL;
+                errno = 0;
+                opts->guess = strtoul(optarg, &end, 0);
+                if(errno || !opts->guess)
+                    return OPT_PARSE_INVALID_NUM;
+                if(*end == ':') {
+                    opts->guess_groups = strtoul(end + 1, &end, 0);
+                    if(errno || !opts->guess_groups)
+                        return OPT_PARSE_INVALID_NUM;
+                }
+                if(*end != '\0')
+                    return OPT_PARSE_INVALID_NUM;
+                break;
+            }
+
+            case OPT_TIMING:
+                if(safe_strncpy(opts->timing_file, optarg, MAX_FILE_PATH_LEN))
+                    return OPT_PARSE_ERR_PATH_TOO_LONG;
+
+                opts->has_timing_file = true;
+                break;
+
+            case OPT_PERF:
+                opts->perf_counters = true;
+                if(optarg) {
+                    errno = 0;
+                    opts->peak_gbps = strtod(optarg, NULL);
+                    if(errno || opts->peak_gbps <= 0.0)
+                        return OPT_PARSE_INVALID_NUM;
+                }
+                break;
+
             case OPT_TPOOL_SIZE:
                 errno = 0;
                 opts->tpsize = strtol(optarg, NULL, 0);
@@ -393,7 +782,7 @@ opt_parse(Options* const opts, int argc, char** argv) {
                 break;
 
             case OPT_MR_SYS:
-                if(opts->has_mr_file)
+                if(opts->has_mr_file || opts->has_batch_file)
                     return OPT_PARSE_TOO_MANY_MR_FILE;
 
                 if(safe_strncpy(opts->mr_file, optarg, MAX_FILE_PATH_LEN))
@@ -402,7 +791,28 @@ opt_parse(Options* const opts, int argc, char** argv) {
                 opts->has_mr_file = true;
                 break;
 
+            case OPT_BATCH:
+                if(opts->has_mr_file || opts->has_batch_file)
+                    return OPT_PARSE_TOO_MANY_MR_FILE;
+
+                if(safe_strncpy(opts->batch_file, optarg, MAX_FILE_PATH_LEN))
+                    return OPT_PARSE_ERR_PATH_TOO_LONG;
+
+                opts->has_batch_file = true;
+                break;
+
             case OPT_MAC_MDEG:
+                if(!strncmp(optarg, "auto", strlen("auto"))) {
+                    if(opts->degs_sz || opts->mdeg_auto)
+                        return OPT_PARSE_MDEG_AUTO_MIX;
+                    if(0 == (opts->c = opt_parse_mdeg_auto(optarg)))
+                        return OPT_PARSE_INVALID_MDEG;
+                    opts->mdeg_auto = true;
+                    break;
+                }
+
+                if(opts->mdeg_auto)
+                    return OPT_PARSE_MDEG_AUTO_MIX;
                 if(opts->degs_sz > MAX_MDEG_NUM)
                     return OPT_PARSE_MDEG_NUM_MAX;
 
@@ -420,7 +830,41 @@ opt_parse(Options* const opts, int argc, char** argv) {
                 opts->mdeg[(opts->degs_sz)++] = d;
                 break;
 
+            case OPT_MAX_MEM:
+                errno = 0;
+                opts->max_mem = strtoull(optarg, NULL, 0) << 20;
+                if(errno || opts->max_mem == 0)
+                    return OPT_PARSE_INVALID_NUM;
+                break;
+
+            case OPT_OOC:
+                if(safe_strncpy(opts->ooc_dir, optarg, MAX_FILE_PATH_LEN))
+                    return OPT_PARSE_ERR_PATH_TOO_LONG;
+
+                opts->has_ooc_dir = true;
+                break;
+
+            case OPT_OOC_BLOCK:
+                errno = 0;
+                opts->ooc_blk_mem = strtoull(optarg, NULL, 0);
+                // a block must be addressable by the indices of struct GFA
+                if(errno || !opts->ooc_blk_mem || opts->ooc_blk_mem > 4096)
+                    return OPT_PARSE_INVALID_NUM;
+                opts->ooc_blk_mem <<= 20;
+                break;
+
+            case OPT_PLAN_CACHE:
+                if(safe_strncpy(opts->plan_dir, optarg, MAX_FILE_PATH_LEN))
+                    return OPT_PARSE_ERR_PATH_TOO_LONG;
+
+                opts->has_plan_dir = true;
+                break;
+
             case OPT_MAC_ROW:
+                if(!strcmp(optarg, "auto")) {
+                    opts->mac_row_auto = true;
+                    break;
+                }
                 errno = 0;
                 opts->mac_nrow = strtol(optarg, NULL, 0);
                 if(errno)
@@ -437,23 +881,51 @@ opt_parse(Options* const opts, int argc, char** argv) {
     }
 
     // mandatory option
-    if(!opts->has_mr_file)
+    if(!opts->has_mr_file && !opts->has_batch_file)
         return OPT_PARSE_NO_PATH;
 
-    if(opts->degs_sz == 0)
+    if(opts->degs_sz == 0 && !opts->mdeg_auto)
         return OPT_PARSE_NO_MDEG;
 
+    if(opts->guess && opts->throughput)
+        return OPT_PARSE_GUESS_THROUGHPUT;
+
+    if(opts->dist && (opts->has_batch_file || opts->guess || opts->filter ||
+                      opts->has_plan_dir || opts->dry || opts->mdeg_auto))
+        return OPT_PARSE_DIST_MIX;
+
+    if(opts->has_ooc_dir && (opts->dist || opts->filter || opts->deflate ||
+                             opts->guess || opts->has_plan_dir))
+        return OPT_PARSE_OOC_MIX;
+
+    if(!opts->ooc_blk_mem)
+        opts->ooc_blk_mem = (uint64_t) DEFAULT_OOC_BLK_MB << 20;
+
+    // default memory budget
+    if(!opts->max_mem)
+        opts->max_mem = (uint64_t) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+
     // set default thread num
     if(!opt_tpsize(opts))
         opts->tpsize = next_power_of_2(get_nprocs());
 
+    // one thread per worker group by default
+    if(opts->guess && !opts->guess_groups)
+        opts->guess_groups = opts->tpsize;
+
+    // the counters are summed over all the threads of the process, so they
+    // can't be attributed to one of several concurrent solves
+    if(opts->perf_counters &&
+       (opts->throughput || (opts->guess && opts->guess_groups > 1)))
+        return OPT_PARSE_PERF_MIX;
+
     return 0;
 }
 
 const char* const opt_parse_path_too_long_str =
     "input path length > 255";
 const char* const opt_parse_no_path_str =
-    "missing option "OPT_MR_SYS_STR;
+    "missing option "OPT_MR_SYS_STR" or "OPT_BATCH_STR;
 const char* const opt_parse_no_mdeg_str =
     "missing option "OPT_MAC_MDEG_STR;
 const char* const opt_parse_invalid_mdeg_str =
@@ -462,6 +934,21 @@ const char* const opt_parse_mdeg_num_max_str =
     "too many multi-degrees, max supported number: 64";
 const char* const opt_parse_mdeg_diff_c_str =
     "multi-degrees have different number of groups of kernel variables";
+const char* const opt_parse_mdeg_auto_mix_str =
+    "multi-degree auto cannot be combined with other multi-degrees";
+const char* const opt_parse_guess_throughput_str =
+    "option "OPT_GUESS_STR" cannot be combined with "OPT_THROUGHPUT_STR;
+const char* const opt_parse_dist_mix_str =
+    "option "OPT_DIST_STR" cannot be combined with "OPT_BATCH_STR", "
+    OPT_GUESS_STR", "OPT_FILTER_STR", "OPT_PLAN_CACHE_STR", "OPT_DRY_STR
+    " or "OPT_MAC_MDEG_STR"=auto";
+const char* const opt_parse_ooc_mix_str =
+    "option "OPT_OOC_STR" cannot be combined with "OPT_DIST_STR", "
+    OPT_FILTER_STR", "OPT_DEFLATE_STR", "OPT_GUESS_STR" or "
+    OPT_PLAN_CACHE_STR;
+const char* const opt_parse_perf_mix_str =
+    "option "OPT_PERF_STR" cannot be combined with "OPT_THROUGHPUT_STR" or "
+    OPT_GUESS_STR" with more than one worker group";
 const char* const opt_parse_invalid_alg_str =
     "invalid algorithm";
 const char* const opt_parse_invalid_fix_str =
@@ -477,7 +964,7 @@ const char* const opt_parse_unknown_str =
 const char* const opt_parse_invalid_opt_str =
     "invalid option";
 const char* const opt_parse_too_many_mr_str =
-    "there can be only 1 input MinRank file";
+    "there can be only 1 input MinRank file or list of them";
 
 /* usage: Given an error code returned from opt_parse(), return a human
  *      friendly text explanation
@@ -496,8 +983,18 @@ opt_err_code_to_str(int code) {
             return opt_parse_invalid_mdeg_str;
         case OPT_PARSE_MDEG_DIFF_C:
             return opt_parse_mdeg_diff_c_str;
+        case OPT_PARSE_MDEG_AUTO_MIX:
+            return opt_parse_mdeg_auto_mix_str;
         case OPT_PARSE_MDEG_NUM_MAX:
             return opt_parse_mdeg_num_max_str;
+        case OPT_PARSE_GUESS_THROUGHPUT:
+            return opt_parse_guess_throughput_str;
+        case OPT_PARSE_DIST_MIX:
+            return opt_parse_dist_mix_str;
+        case OPT_PARSE_OOC_MIX:
+            return opt_parse_ooc_mix_str;
+        case OPT_PARSE_PERF_MIX:
+            return opt_parse_perf_mix_str;
         case OPT_PARSE_NO_PATH:
             return opt_parse_no_path_str;
         case OPT_PARSE_INVALID_NUM:
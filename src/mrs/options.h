@@ -54,6 +54,27 @@ opt_seed(const Options* opts);
 const char*
 opt_mr_file(const Options* opts);
 
+/* usage: return the path to the list of MinRank instances to solve in batch
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if not in batch mode */
+const char*
+opt_batch_file(const Options* opts);
+
+/* usage: return the directory of the cache of Macaulay plans
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if the cache is not used */
+const char*
+opt_plan_dir(const Options* opts);
+
+/* usage: return the path to write the timing report to
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if no report is requested */
+const char*
+opt_timing_file(const Options* opts);
+
 /* usage: return the number of multi-degrees for the Macaulay matrix
  * params:
  *      1) opts: pointer to struct Options
@@ -83,6 +104,75 @@ opt_degs(const Options* opts);
 bool
 opt_ks_rand(const Options* opts);
 
+/* usage: check if the nullvectors already extracted should be deflated out
+ *      of the matrix to eliminate before the next batch of Block Lanczos
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_deflate(const Options* opts);
+
+/* usage: check if the matrix to eliminate should be filtered with structured
+ *      Gaussian elimination before Block Lanczos
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_filter(const Options* opts);
+
+/* usage: check if the instances of the batch should be solved concurrently
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_throughput(const Options* opts);
+
+/* usage: check if the matrix to eliminate should be sharded over the ranks of
+ *      the MPI job
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_dist(const Options* opts);
+
+/* usage: return the directory to stream the matrix to eliminate from
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: a char pointer to the path, or NULL if the matrix stays in memory */
+const char*
+opt_ooc_dir(const Options* opts);
+
+/* usage: return the size of a block of the matrix to eliminate on disk
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the size in bytes */
+uint64_t
+opt_ooc_blk_mem(const Options* opts);
+
+/* usage: return the number of linear variables to guess
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the number of variables, or 0 if none should be guessed */
+uint32_t
+opt_guess(const Options* opts);
+
+/* usage: return the number of worker groups to spread the guesses over
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the number of worker groups */
+uint32_t
+opt_guess_groups(const Options* opts);
+
+/* usage: check if hardware performance counters should be sampled
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_perf_counters(const Options* opts);
+
+/* usage: return the peak memory bandwidth for the roofline summary
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the bandwidth in GB/s, or 0 if it should be measured */
+double
+opt_perf_peak_gbps(const Options* opts);
+
 /* usage: return the number of rows in left matrix of the KS system
  * params:
  *      1) opts: pointer to struct Options
@@ -90,6 +180,28 @@ opt_ks_rand(const Options* opts);
 uint32_t
 opt_c(const Options* opts);
 
+/* usage: check if the number of rows to keep in the Macaulay matrix should be
+ *      chosen automatically
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_mac_row_auto(const Options* opts);
+
+/* usage: check if the multi-degree should be picked by the planner
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: true if yes, false otherwise */
+bool
+opt_mdeg_auto(const Options* opts);
+
+/* usage: return the memory budget for the multi-degree picked by the planner
+ * params:
+ *      1) opts: pointer to struct Options
+ * return: the budget in bytes */
+uint64_t
+opt_max_mem(const Options* opts);
+
 /* usage: return the size of the thread pool
  * params:
  *      1) opts: pointer to struct Options
@@ -0,0 +1,292 @@
+#include "plan_cache.h"
+#include "gfa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ========================================================================
+ * struct PlanKey definition
+ * ======================================================================== */
+
+struct PlanKey {
+    uint64_t ks_size; // number of coefficients in the KS matrix
+    uint64_t len; // number of words
+    uint32_t w[];
+};
+
+// number of words in the key besides the multi-degrees
+#define PLAN_KEY_FIXED_LEN  (15)
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Create the key of the plan for the given parameters
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) ks: ptr to struct GFM, the KS matrix of mr
+ *      3) c: number of rows in the left multiplier of the KS matrix
+ *      4) degs: an array of ptrs to struct MDeg
+ *      5) degs_num: size of degs
+ *      6) mac_nrow: number of rows to keep in the Macaulay matrix as given
+ *          by the user, 0 for all of them
+ *      7) mac_row_auto: whether the number of rows is chosen automatically
+ *      8) mac_seed: seed to select the rows
+ * return: ptr to struct PlanKey on success, NULL otherwise */
+PlanKey*
+plan_key_create(const MinRank* restrict mr, const GFM* restrict ks, uint32_t c,
+                const MDeg** degs, uint32_t degs_num, uint64_t mac_nrow,
+                bool mac_row_auto, int32_t mac_seed) {
+    const uint64_t len = PLAN_KEY_FIXED_LEN + (uint64_t) degs_num * (c + 1);
+    PlanKey* key = malloc(sizeof(PlanKey) + sizeof(uint32_t) * len);
+    if(!key)
+        return NULL;
+
+    key->ks_size = (uint64_t) gfm_nrow(ks) * gfm_ncol(ks);
+    key->len = len;
+    uint32_t* w = key->w;
+    *w++ = GF_MAX;
+    *w++ = sizeof(gfa_idx_t);
+    *w++ = minrank_nrow(mr);
+    *w++ = minrank_ncol(mr);
+    *w++ = minrank_nmat(mr);
+    *w++ = minrank_rank(mr);
+    *w++ = minrank_m0(mr) != NULL;
+    *w++ = c;
+    *w++ = gfm_nrow(ks);
+    *w++ = gfm_ncol(ks);
+    *w++ = mac_nrow & 0xFFFFFFFFULL;
+    *w++ = mac_nrow >> 32;
+    *w++ = mac_row_auto;
+    *w++ = mac_seed;
+    *w++ = degs_num;
+    for(uint32_t i = 0; i < degs_num; ++i) {
+        for(uint32_t j = 0; j <= c; ++j)
+            *w++ = mdeg_deg(degs[i], j);
+    }
+    return key;
+}
+
+/* usage: Release a struct PlanKey
+ * params:
+ *      1) key: ptr to struct PlanKey
+ * return: void */
+void
+plan_key_free(PlanKey* key) {
+    free(key);
+}
+
+/* subroutine of plan_cache_load and plan_cache_store: return the path to the
+ * plan of the given key followed by the given suffix. The caller frees it */
+static char*
+plan_cache_path(const char* dir, const PlanKey* restrict key,
+                const char* suffix) {
+    // 64-bit FNV-1a; the key is compared in full when the plan is loaded
+    const uint8_t* b = (const uint8_t*) key->w;
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for(uint64_t i = 0; i < sizeof(uint32_t) * key->len; ++i)
+        h = (h ^ b[i]) * 0x100000001B3ULL;
+
+    const size_t sz = strlen(dir) + 1 + 16 + strlen(".plan") +
+                      strlen(suffix) + 1;
+    char* path = malloc(sz);
+    if(path)
+        sprintf(path, "%s/%016lx.plan%s", dir, h, suffix);
+    return path;
+}
+
+/* subroutine of plan_cache_load and plan_cache_store: size of an array in the
+ * file, padded to a multiple of 8 bytes */
+static inline uint64_t
+plan_cache_padded_size(uint64_t n, size_t esize) {
+    return (n * esize + 7) & ~0x7ULL;
+}
+
+/* subroutine of plan_cache_load: copy the positions in the KS matrix of the
+ * entries of a pattern, and check that they are within the KS matrix */
+static uint32_t*
+plan_cache_load_koff(const uint8_t* restrict buf, size_t* restrict off,
+                     size_t size, uint64_t nznum, uint64_t ks_size) {
+    const uint64_t sz = plan_cache_padded_size(nznum, sizeof(uint32_t));
+    if(size - *off < sz)
+        return NULL;
+
+    uint32_t* koff = malloc(sizeof(uint32_t) * (nznum ? nznum : 1));
+    if(!koff)
+        return NULL;
+    memcpy(koff, buf + *off, sizeof(uint32_t) * nznum);
+    for(uint64_t i = 0; i < nznum; ++i) {
+        if(koff[i] >= ks_size) {
+            free(koff);
+            return NULL;
+        }
+    }
+    *off += sz;
+    return koff;
+}
+
+/* subroutine of plan_cache_load: parse a plan mapped into memory */
+static bool
+plan_cache_parse(MacPlan* restrict p, const uint8_t* restrict buf,
+                 size_t size, const PlanKey* restrict key) {
+    const uint64_t key_sz = plan_cache_padded_size(key->len, sizeof(uint32_t));
+    uint64_t hdr[2];
+    if(size < PLAN_CACHE_MAGIC_LEN + sizeof(uint64_t) + key_sz + sizeof(hdr) ||
+       memcmp(buf, PLAN_CACHE_MAGIC, PLAN_CACHE_MAGIC_LEN))
+        return false;
+
+    uint64_t len;
+    memcpy(&len, buf + PLAN_CACHE_MAGIC_LEN, sizeof(len));
+    size_t off = PLAN_CACHE_MAGIC_LEN + sizeof(len);
+    if(len != key->len || memcmp(buf + off, key->w, sizeof(uint32_t) * len))
+        return false; // a hash collision
+    off += key_sz;
+
+    memcpy(hdr, buf + off, sizeof(hdr));
+    off += sizeof(hdr);
+    p->mac_ncol = hdr[0];
+    p->remaining_ncol = hdr[1];
+
+    size_t used;
+    if( !(p->cmsm = cmsm_generic_from_buf(buf + off, size - off, &used)) )
+        return false;
+    off += used;
+    if( !(p->koff = plan_cache_load_koff(buf, &off, size,
+                                         cmsm_generic_nznum(p->cmsm),
+                                         key->ks_size)) )
+        return false;
+    if( !(p->cmsm_kept = cmsm_generic_from_buf(buf + off, size - off, &used)) )
+        return false;
+    off += used;
+    if( !(p->koff_kept = plan_cache_load_koff(buf, &off, size,
+                                              cmsm_generic_nznum(p->cmsm_kept),
+                                              key->ks_size)) )
+        return false;
+
+    if(cmsm_generic_rnum(p->cmsm) != cmsm_generic_rnum(p->cmsm_kept) ||
+       cmsm_generic_cnum(p->cmsm_kept) != p->remaining_ncol ||
+       p->mac_ncol != cmsm_generic_cnum(p->cmsm) + p->remaining_ncol ||
+       size - off != sizeof(uint64_t) * p->remaining_ncol)
+        return false;
+
+    if( !(p->kmap = malloc(sizeof(uint64_t) * p->remaining_ncol)) )
+        return false;
+    memcpy(p->kmap, buf + off, sizeof(uint64_t) * p->remaining_ncol);
+    for(uint64_t i = 0; i < p->remaining_ncol; ++i) {
+        if(p->kmap[i] >= p->remaining_ncol)
+            return false;
+    }
+    return true;
+}
+
+/* usage: Load the plan of the given key from the cache. The file is mapped
+ *      into memory and copied into the containers
+ * params:
+ *      1) p: ptr to MacPlan. Container for the plan. The caller owns its
+ *          members on success
+ *      2) dir: the cache directory
+ *      3) key: ptr to struct PlanKey
+ * return: true on success, false if the plan is not in the cache, is
+ *      corrupted, or memory allocation failed */
+bool
+plan_cache_load(MacPlan* restrict p, const char* dir,
+                const PlanKey* restrict key) {
+    memset(p, 0x0, sizeof(MacPlan));
+    char* path = plan_cache_path(dir, key, "");
+    if(!path)
+        return false;
+    const int fd = open(path, O_RDONLY);
+    free(path);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    const size_t size = st.st_size;
+    void* buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(buf == MAP_FAILED)
+        return false;
+    madvise(buf, size, MADV_SEQUENTIAL);
+
+    const bool ok = plan_cache_parse(p, buf, size, key);
+    munmap(buf, size);
+    if(!ok) {
+        cmsm_generic_free(p->cmsm);
+        cmsm_generic_free(p->cmsm_kept);
+        free(p->koff);
+        free(p->koff_kept);
+        free(p->kmap);
+        memset(p, 0x0, sizeof(MacPlan));
+    }
+    return ok;
+}
+
+/* subroutine of plan_cache_store: write an array followed by its padding */
+static inline bool
+plan_cache_write_arr(FILE* f, const void* a, uint64_t n, size_t esize) {
+    static const uint8_t zeros[8] = {0};
+    const uint64_t pad = plan_cache_padded_size(n, esize) - n * esize;
+    return (!n || 1 == fwrite(a, n * esize, 1, f)) &&
+           (!pad || 1 == fwrite(zeros, pad, 1, f));
+}
+
+/* usage: Store a plan in the cache. The directory is created if it doesn't
+ *      exist, and the plan is written to a temporary file first, so that
+ *      concurrent runs never see a partial plan
+ * params:
+ *      1) p: ptr to MacPlan
+ *      2) dir: the cache directory
+ *      3) key: ptr to struct PlanKey
+ * return: true on success, false otherwise */
+bool
+plan_cache_store(const MacPlan* restrict p, const char* dir,
+                 const PlanKey* restrict key) {
+    if(mkdir(dir, 0755) && errno != EEXIST)
+        return false;
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%ld.tmp", (long) getpid());
+    char* path = plan_cache_path(dir, key, "");
+    char* tmp_path = plan_cache_path(dir, key, suffix);
+    FILE* f = NULL;
+    bool ok = false;
+    if(!path || !tmp_path || !(f = fopen(tmp_path, "wb")))
+        goto plan_cache_store_cleanup;
+
+    const uint64_t hdr[2] = { p->mac_ncol, p->remaining_ncol };
+    ok = 1 == fwrite(PLAN_CACHE_MAGIC, PLAN_CACHE_MAGIC_LEN, 1, f) &&
+         1 == fwrite(&key->len, sizeof(key->len), 1, f) &&
+         plan_cache_write_arr(f, key->w, key->len, sizeof(uint32_t)) &&
+         1 == fwrite(hdr, sizeof(hdr), 1, f) &&
+         cmsm_generic_write(p->cmsm, f) &&
+         plan_cache_write_arr(f, p->koff, cmsm_generic_nznum(p->cmsm),
+                              sizeof(uint32_t)) &&
+         cmsm_generic_write(p->cmsm_kept, f) &&
+         plan_cache_write_arr(f, p->koff_kept,
+                              cmsm_generic_nznum(p->cmsm_kept),
+                              sizeof(uint32_t)) &&
+         plan_cache_write_arr(f, p->kmap, p->remaining_ncol,
+                              sizeof(uint64_t));
+    if(fclose(f))
+        ok = false;
+    if(ok)
+        ok = !rename(tmp_path, path);
+    if(!ok)
+        unlink(tmp_path);
+
+plan_cache_store_cleanup:
+    free(path);
+    free(tmp_path);
+    return ok;
+}
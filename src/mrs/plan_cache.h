@@ -0,0 +1,112 @@
+#ifndef __PLAN_CACHE_H__
+#define __PLAN_CACHE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gfm.h"
+#include "minrank.h"
+#include "mdeg.h"
+#include "cmsm_generic.h"
+
+// On-disk cache of the symbolic phase of the construction of the condensed
+// Macaulay matrices. Which rows are kept, which columns are kept or
+// eliminated and where the non-zero entries are only depend on the parameters
+// of the instance, the multi-degree(s) and the row selection, not on the
+// coefficients. They are kept as the sparsity patterns of the matrices built
+// from an all-ones instance (see minrank_ks_pattern) together with the
+// positions of their entries in the KS matrix, so a later run only has to
+// refill them with cmsm_generic_refill.
+//
+// A plan is stored in <dir>/<hash>.plan, where <hash> is the 64-bit FNV-1a
+// hash of its key in hex. Each field is in the byte order of the host and each
+// array is padded to a multiple of 8 bytes:
+//
+//      offset  size
+//      0       8           magic "MRSPLAN2"
+//      8       8           number of 32-bit words in the key, L
+//      16      4 x L       the key, compared in full when the plan is loaded
+//              2 x 8       number of columns of the Macaulay matrix, and of
+//                          the columns to keep
+//              ...         pattern of the columns to eliminate, as written
+//                          by cmsm_generic_write()
+//              4 x nznum   positions of its entries in the KS matrix
+//              ...         pattern of the columns to keep
+//              4 x nznum   positions of its entries in the KS matrix
+//              8 x ncol    index of the column of each variable, and of the
+//                          constant first, in the columns to keep
+//
+// The version in the magic is bumped whenever the plan computed for the same
+// key changes, e.g. the column order or the rows drawn for a seed, so a plan
+// from an older version is a miss rather than a different plan.
+#define PLAN_CACHE_MAGIC        "MRSPLAN2"
+#define PLAN_CACHE_MAGIC_LEN    (8)
+
+typedef struct PlanKey PlanKey;
+
+// the symbolic phase of the construction, owned by the caller
+typedef struct {
+    uint64_t mac_ncol; // number of columns of the multi-degree Macaulay
+    uint64_t remaining_ncol; // number of columns to keep
+    CMSMGeneric* cmsm; // pattern of the columns to eliminate
+    uint32_t* koff; // positions of its entries in the KS matrix
+    CMSMOOC* ooc; // or the columns to eliminate on disk, never cached
+    CMSMGeneric* cmsm_kept; // pattern of the columns to keep
+    uint32_t* koff_kept;
+    uint64_t* kmap; // index of the column of each variable in cmsm_kept
+} MacPlan;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Create the key of the plan for the given parameters
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) ks: ptr to struct GFM, the KS matrix of mr
+ *      3) c: number of rows in the left multiplier of the KS matrix
+ *      4) degs: an array of ptrs to struct MDeg
+ *      5) degs_num: size of degs
+ *      6) mac_nrow: number of rows to keep in the Macaulay matrix as given
+ *          by the user, 0 for all of them
+ *      7) mac_row_auto: whether the number of rows is chosen automatically
+ *      8) mac_seed: seed to select the rows
+ * return: ptr to struct PlanKey on success, NULL otherwise */
+PlanKey*
+plan_key_create(const MinRank* restrict mr, const GFM* restrict ks, uint32_t c,
+                const MDeg** degs, uint32_t degs_num, uint64_t mac_nrow,
+                bool mac_row_auto, int32_t mac_seed);
+
+/* usage: Release a struct PlanKey
+ * params:
+ *      1) key: ptr to struct PlanKey
+ * return: void */
+void
+plan_key_free(PlanKey* key);
+
+/* usage: Load the plan of the given key from the cache. The file is mapped
+ *      into memory and copied into the containers
+ * params:
+ *      1) p: ptr to MacPlan. Container for the plan. The caller owns its
+ *          members on success
+ *      2) dir: the cache directory
+ *      3) key: ptr to struct PlanKey
+ * return: true on success, false if the plan is not in the cache, is
+ *      corrupted, or memory allocation failed */
+bool
+plan_cache_load(MacPlan* restrict p, const char* dir,
+                const PlanKey* restrict key);
+
+/* usage: Store a plan in the cache. The directory is created if it doesn't
+ *      exist, and the plan is written to a temporary file first, so that
+ *      concurrent runs never see a partial plan
+ * params:
+ *      1) p: ptr to MacPlan
+ *      2) dir: the cache directory
+ *      3) key: ptr to struct PlanKey
+ * return: true on success, false otherwise */
+bool
+plan_cache_store(const MacPlan* restrict p, const char* dir,
+                 const PlanKey* restrict key);
+
+#endif // __PLAN_CACHE_H__
@@ -0,0 +1,370 @@
+/* planner.c: implementation of planner.h */
+
+#include "planner.h"
+#include "ks.h"
+#include "mdmac.h"
+#include "cmsm_generic.h"
+#include "cmsm_ooc.h"
+#include "block_lanczos_gf16.h"
+#include "matrix_gf16.h"
+#include "math_util.h"
+#include "prof.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// max degree of each group of variables in the search of planner_auto_mdeg
+#define PLANNER_MAX_DEG         (4)
+// size of the random sparse matrices to calibrate Block Lanczos
+#define PLANNER_CALIB_RNUM      (1ULL << 12)
+#define PLANNER_CALIB_CNUM      (1ULL << 11)
+#define PLANNER_CALIB_WT_LO     (16)
+#define PLANNER_CALIB_WT_HI     (512)
+// min time and max rounds to calibrate the construction
+#define PLANNER_CALIB_MIN_NS    (5000000ULL)
+#define PLANNER_CALIB_MAX_ROUND (64)
+// lower bound of the calibrated costs, against measurement noise
+#define PLANNER_MIN_COST_NS     (0.01)
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: subroutine of planner_calibrate: run Block Lanczos on a random sparse
+ *      matrix and measure the time of an iteration
+ * params:
+ *      1) ns: container for the time of an iteration in nanoseconds
+ *      2) nznum: container for the number of non-zero entries
+ *      3) col_wt: expected number of non-zero entries in a column
+ *      4) tnum: number of threads to use
+ *      5) tp: ptr to struct Threadpool
+ * return: true on success, false if memory allocation failed */
+static bool
+planner_calib_lczs(double* restrict ns, uint64_t* restrict nznum,
+                   uint32_t col_wt, uint32_t tnum, Threadpool* restrict tp) {
+    CMSMGeneric* m = cmsm_generic_rand(PLANNER_CALIB_RNUM, PLANNER_CALIB_CNUM,
+                                       col_wt);
+    BLKGF16Arg* arg = NULL;
+    bool ok = m && (arg = blkgf16_arg_create(PLANNER_CALIB_RNUM,
+                                             PLANNER_CALIB_CNUM, tnum));
+    if(ok) {
+        uint64_t ts = prof_now();
+        uint32_t iter = blk_lczs_gf16(arg, m, tp);
+        ts = prof_now() - ts;
+        *ns = (double) ts / (iter ? iter : 1);
+        *nznum = cmsm_generic_nznum(m);
+    }
+    blkgf16_arg_free(arg);
+    cmsm_generic_free(m);
+    return ok;
+}
+
+/* usage: subroutine of planner_calibrate: construct the Macaulay matrix of
+ *      the lowest multi-degree and the sparse matrix to eliminate from it
+ * params:
+ *      1) ns: container for the time in nanoseconds
+ *      2) nznum: container for the number of non-zero entries
+ *      3) ks: ptr to struct GFM, the KS matrix of the instance
+ *      4) mr: ptr to struct MinRank
+ *      5) d: ptr to struct MDeg
+ * return: true on success, false if memory allocation failed */
+static bool
+planner_calib_build(uint64_t* restrict ns, uint64_t* restrict nznum,
+                    const GFM* restrict ks, const MinRank* restrict mr,
+                    const MDeg* restrict d) {
+    MDMac* mac = NULL; MDMacColIterator* it = NULL; uint32_t* nznums = NULL;
+    CMSMGeneric* m = NULL;
+    uint64_t ts = prof_now();
+    bool ok = (mac = mdmac_create_from_ks(ks, mr, d)) &&
+              (it = mdmac_col_iter_create_from_mdmac(mac, mdeg_is_nonlinear)) &&
+              (nznums = malloc(sizeof(uint32_t) * mdmac_ncol(mac)));
+    if(ok) {
+        const uint64_t nrow = mdmac_nrow(mac);
+        *nznum = mdmac_nznum(nznums, mac, nrow, 0);
+        uint64_t sum = 0;
+        for(mdmac_col_iter_begin(it); !mdmac_col_iter_end(it); mdmac_col_iter_next(it))
+            sum += nznums[mdmac_col_iter_idx(it)];
+        ok = (NULL != (m = cmsm_generic_from_mdmac(mac, nrow, 0, it, nznums, sum)));
+    }
+    *ns = prof_now() - ts;
+
+    cmsm_generic_free(m);
+    free(nznums);
+    mdmac_col_iter_free(it);
+    mdmac_free(mac);
+    return ok;
+}
+
+/* usage: Measure the costs of the cost model on the host. Block Lanczos is run
+ *      on 2 random sparse matrices of different densities, and the Macaulay
+ *      matrix of the lowest multi-degree of the instance is constructed.
+ *      Consumes numbers from rand()
+ * params:
+ *      1) cal: ptr to PlanCalib. Container for the costs
+ *      2) ks: ptr to struct GFM, the KS matrix of the instance
+ *      3) mr: ptr to struct MinRank
+ *      4) c: number of rows in the left multiplier of the KS matrix
+ *      5) tnum: number of threads to use
+ *      6) tp: ptr to struct Threadpool
+ * return: true on success, false if memory allocation failed */
+bool
+planner_calibrate(PlanCalib* restrict cal, const GFM* restrict ks,
+                  const MinRank* restrict mr, uint32_t c, uint32_t tnum,
+                  Threadpool* restrict tp) {
+    // the time of an iteration is linear in the number of non-zero entries
+    // and in the number of rows, so 2 densities separate them
+    double ns_lo, ns_hi;
+    uint64_t nz_lo, nz_hi;
+    if(!planner_calib_lczs(&ns_lo, &nz_lo, PLANNER_CALIB_WT_LO, tnum, tp) ||
+       !planner_calib_lczs(&ns_hi, &nz_hi, PLANNER_CALIB_WT_HI, tnum, tp))
+        return false;
+
+    cal->nz_ns = (ns_hi - ns_lo) / (nz_hi - nz_lo);
+    if(cal->nz_ns < PLANNER_MIN_COST_NS)
+        cal->nz_ns = PLANNER_MIN_COST_NS;
+    cal->row_ns = (ns_lo - cal->nz_ns * nz_lo) /
+                  (PLANNER_CALIB_RNUM + PLANNER_CALIB_CNUM);
+    if(cal->row_ns < PLANNER_MIN_COST_NS)
+        cal->row_ns = PLANNER_MIN_COST_NS;
+
+    MDeg* d = mdeg_create_zero(c);
+    if(!d)
+        return false;
+    for(uint32_t i = 0; i <= c; ++i)
+        mdeg_set_deg(d, i, 1);
+
+    uint64_t total_ns = 0, total_nz = 0;
+    for(uint32_t i = 0; i < PLANNER_CALIB_MAX_ROUND &&
+                        total_ns < PLANNER_CALIB_MIN_NS; ++i) {
+        uint64_t ns, nz;
+        if(!planner_calib_build(&ns, &nz, ks, mr, d)) {
+            mdeg_free(d);
+            return false;
+        }
+        total_ns += ns;
+        total_nz += nz;
+    }
+    mdeg_free(d);
+    cal->build_ns = total_nz ? (double) total_ns / total_nz : PLANNER_MIN_COST_NS;
+    return true;
+}
+
+/* usage: subroutine of planner_hs: sum up the terms of the Hilbert series
+ *      for the groups of kernel variables from i onwards
+ * params:
+ *      1) d: ptr to struct MDeg, the target multi-degree
+ *      2) i: the current group of kernel variables
+ *      3) lv_deg: degree of the linear variables left
+ *      4) k, r, m: parameters of the MinRank instance
+ *      5) coef: product of the terms of the previous groups
+ * return: the sum */
+static int64_t
+planner_hs_rec(const MDeg* d, uint32_t i, uint32_t lv_deg, uint32_t k,
+               uint32_t r, uint32_t m, int64_t coef) {
+    if(i == mdeg_c(d)) // monomials of the linear variables left
+        return coef * (int64_t) binom(lv_deg + k, k);
+
+    // pick a of the m factors (1 - t_0 t_i), and monomials for the rest
+    const uint32_t kv_deg = mdeg_kv_deg(d, i);
+    int64_t sum = 0;
+    for(uint32_t a = 0; a <= m && a <= kv_deg && a <= lv_deg; ++a) {
+        int64_t t = coef * (int64_t) binom(m, a) *
+                    (int64_t) binom(kv_deg - a + r, r);
+        if(a & 0x1U)
+            t = -t;
+        sum += planner_hs_rec(d, i + 1, lv_deg - a, k, r, m, t);
+    }
+    return sum;
+}
+
+/* usage: compute the coefficient of the Hilbert series of the KS system at
+ *      the given multi-degree. See planner.h
+ * params:
+ *      1) mr: ptr to struct MinRank
+ *      2) d: ptr to struct MDeg
+ * return: the expected dimension of the quotient. Negative if the Macaulay
+ *      matrix has more independent rows than needed */
+static int64_t
+planner_hs(const MinRank* restrict mr, const MDeg* restrict d) {
+    return planner_hs_rec(d, 0, mdeg_lv_deg(d), minrank_nmat(mr),
+                          minrank_rank(mr), minrank_ncol(mr), 1);
+}
+
+/* usage: Predict the costs of solving the instance with a multi-degree or a
+ *      combination of multi-degrees. A combination is predicted to solve the
+ *      instance if any of its multi-degrees is
+ * params:
+ *      1) p: ptr to MDPlan. Container for the predictions
+ *      2) cal: ptr to PlanCalib
+ *      3) ks: ptr to struct GFM, the KS matrix of the instance
+ *      4) mr: ptr to struct MinRank
+ *      5) degs: an array of ptrs to struct MDeg
+ *      6) sz: size of degs
+ *      7) tnum: number of threads to use
+ *      8) ooc_blk_mem: size of a block of the matrix to eliminate on disk in
+ *          bytes, or 0 if it's held in memory
+ * return: void */
+void
+planner_eval(MDPlan* restrict p, const PlanCalib* restrict cal,
+             const GFM* restrict ks, const MinRank* restrict mr,
+             const MDeg** degs, uint32_t sz, uint32_t tnum,
+             uint64_t ooc_blk_mem) {
+    const uint32_t k = minrank_nmat(mr), r = minrank_rank(mr);
+    const uint32_t c = mdeg_c(degs[0]);
+    const uint64_t max_tnum = gfm_find_max_tnum_per_eq(ks);
+    size_t mac_mem;
+    if(sz == 1) {
+        p->nrow = mdmac_eq_num(mr, degs[0]);
+        p->ncol = mdmac_calc_ncol(k, r, degs[0]);
+        mac_mem = mdmac_calc_memsize(k, r, degs[0], minrank_ncol(mr), max_tnum);
+    } else {
+        // the functions for combinations modify the multi-degrees in place
+        mdeg_create_static_buf(bufs[sz], c);
+        MDeg* copies[sz];
+        for(uint32_t i = 0; i < sz; ++i) {
+            copies[i] = mdeg_create_from_arr(c, bufs[i]);
+            mdeg_copy(copies[i], degs[i]);
+        }
+        p->nrow = mdmac_combi_eq_num(mr, copies, sz);
+        p->ncol = ks_mdmac_combi_total_mono_num(k, r, degs, sz);
+        mac_mem = mdmac_combi_calc_memsize(mr, copies, sz, max_tnum);
+    }
+
+    p->hs = INT64_MAX;
+    for(uint32_t i = 0; i < sz; ++i) {
+        int64_t hs = planner_hs(mr, degs[i]);
+        if(hs < p->hs)
+            p->hs = hs;
+    }
+    p->solvable = (p->hs <= 1);
+
+    // each row is a KS equation times a monomial, which keeps its terms
+    const uint64_t lcol = 1 + ks_total_var_num(k, r, c);
+    p->nlcol = p->ncol - lcol;
+    const uint64_t ks_nznum = (uint64_t) gfm_nrow(ks) * gfm_ncol(ks) - gfm_cz(ks);
+    p->nznum = p->nrow * ks_nznum / gfm_nrow(ks);
+    const uint64_t nznum_elim = (uint64_t) ((double) p->nznum * p->nlcol / p->ncol);
+    const uint64_t rank = (p->nlcol < p->nrow) ? p->nlcol : p->nrow;
+    p->iter_num = blkgf16_iter_num(BLK_LANCZOS_BLOCK_SIZE, rank);
+
+    // the Macaulay matrix is released after Block Lanczos is set up
+    p->memsize = mac_mem + cmsm_generic_split_calc_mem_size(p->ncol, tnum);
+    // only the buffers of the matrix to eliminate on disk are in memory
+    p->memsize += ooc_blk_mem ?
+                  cmsm_ooc_calc_mem_size(p->nlcol, nznum_elim, ooc_blk_mem) :
+                  cmsm_generic_calc_mem_size(p->nrow, p->nlcol, nznum_elim);
+    p->memsize += cmsm_generic_calc_mem_size(p->nrow, lcol, p->nznum - nznum_elim);
+    p->memsize += blkgf16_arg_memsize(p->nrow, p->nlcol, tnum);
+    p->memsize += rm_gf16_memsize(p->nlcol);
+
+    p->sec = cal->build_ns * p->nznum;
+    p->sec += p->iter_num * (cal->nz_ns * nznum_elim +
+                             cal->row_ns * (p->nrow + p->nlcol));
+    p->sec /= 1e9;
+}
+
+/* usage: subroutine of planner_auto_mdeg: print a multi-degree
+ * params:
+ *      1) d: ptr to struct MDeg
+ * return: void */
+static void
+planner_print_mdeg(const MDeg* d) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), "(");
+    for(uint32_t i = 0; i <= mdeg_c(d) && n < (int) sizeof(buf); ++i)
+        n += snprintf(buf + n, sizeof(buf) - n, " %u%s", mdeg_deg(d, i),
+                      (i < mdeg_c(d)) ? "," : " )");
+    printf("\t\t%-16s", buf);
+}
+
+/* usage: Search the multi-degrees up to PLANNER_MAX_DEG in each group of
+ *      variables and pick the one with the lowest predicted runtime among
+ *      those that are predicted to solve the instance within the memory budget
+ * params:
+ *      1) best: ptr to MDPlan. Container for the predictions of the pick
+ *      2) cal: ptr to PlanCalib
+ *      3) ks: ptr to struct GFM, the KS matrix of the instance
+ *      4) mr: ptr to struct MinRank
+ *      5) c: number of rows in the left multiplier of the KS matrix
+ *      6) max_mem: memory budget in bytes
+ *      7) tnum: number of threads to use
+ *      8) ooc_blk_mem: size of a block of the matrix to eliminate on disk in
+ *          bytes, or 0 if it's held in memory
+ *      9) verbose: print the predictions of each candidate
+ * return: ptr to a new struct MDeg, or NULL if no candidate qualifies or
+ *      memory allocation failed */
+MDeg*
+planner_auto_mdeg(MDPlan* restrict best, const PlanCalib* restrict cal,
+                  const GFM* restrict ks, const MinRank* restrict mr,
+                  uint32_t c, size_t max_mem, uint32_t tnum,
+                  uint64_t ooc_blk_mem, bool verbose) {
+    MDeg* d = mdeg_create_zero(c);
+    MDeg* pick = NULL;
+    if(!d)
+        return NULL;
+
+    if(verbose)
+        printf("\t\t%-16s %12s %12s %14s %10s %8s %10s %8s\n", "multi-degree",
+               "rows", "columns", "non-zeros", "memory", "iters", "runtime",
+               "HS");
+    // the groups of kernel variables are symmetric, so their degrees are
+    // enumerated in non-increasing order. Each degree runs from 1 to
+    // PLANNER_MAX_DEG like the digits of a counter
+    for(uint32_t i = 0; i <= c; ++i)
+        mdeg_set_deg(d, i, 1);
+    while(true) {
+        bool sorted = true;
+        for(uint32_t i = 1; i < c; ++i)
+            sorted = sorted && (mdeg_kv_deg(d, i - 1) >= mdeg_kv_deg(d, i));
+
+        if(sorted) {
+            MDPlan p;
+            const MDeg* degs[1] = { d };
+            planner_eval(&p, cal, ks, mr, degs, 1, tnum, ooc_blk_mem);
+            // the sparse matrix to eliminate is indexed with 32-bit offsets
+            const bool fits = (p.memsize <= max_mem) && (p.nznum < UINT32_MAX);
+            if(verbose) {
+                planner_print_mdeg(d);
+                printf(" %12lu %12lu %14lu %8.0fMB %8lu %9.2fs %8ld%s\n",
+                       p.nrow, p.ncol, p.nznum, p.memsize / MBFLOAT,
+                       p.iter_num, p.sec, p.hs,
+                       !p.solvable ? "" : (fits ? "  *" : "  (over budget)"));
+            }
+            if(p.solvable && fits && (!pick || p.sec < best->sec)) {
+                mdeg_free(pick);
+                if(!(pick = mdeg_dup(d)))
+                    break;
+                *best = p;
+            }
+        }
+
+        uint32_t i = 0;
+        for(; i <= c && mdeg_deg(d, i) == PLANNER_MAX_DEG; ++i)
+            mdeg_set_deg(d, i, 1);
+        if(i > c)
+            break;
+        mdeg_deg_inc(d, i);
+    }
+
+    mdeg_free(d);
+    return pick;
+}
+
+/* usage: Print the predictions for a multi-degree
+ * params:
+ *      1) p: ptr to MDPlan
+ * return: void */
+void
+planner_print(const MDPlan* p) {
+    printf("\t\tdimension: %lu x %lu\n"
+           "\t\tcolumns to eliminate: %lu\n"
+           "\t\texpected number of non-zero entries: %lu\n"
+           "\t\texpected dimension of the quotient: %ld\n"
+           "\t\texpected to solve the instance: %s\n"
+           "\t\texpected number of iterations: %lu\n"
+           "\t\texpected peak memory: %.2fMB\n"
+           "\t\tpredicted runtime: %.2fs\n",
+           p->nrow, p->ncol, p->nlcol, p->nznum, p->hs,
+           p->solvable ? "yes" : "no", p->iter_num, p->memsize / MBFLOAT,
+           p->sec);
+}
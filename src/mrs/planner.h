@@ -0,0 +1,121 @@
+#ifndef __PLANNER_H__
+#define __PLANNER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "gfm.h"
+#include "minrank.h"
+#include "mdeg.h"
+#include "thpool.h"
+
+// cost model of the solver for a multi-degree, or a combination of
+// multi-degrees, of the Macaulay matrix, without building it. The dimension,
+// the number of non-zero entries, the peak memory and the number of Block
+// Lanczos iterations are derived from the parameters of the MinRank instance.
+// The runtime is derived from them with per-entry and per-row costs measured
+// on the host by planner_calibrate().
+//
+// Whether the Macaulay matrix solves the instance is predicted with its
+// Hilbert series, assuming the m equations of each kernel vector in the KS
+// system form a regular sequence:
+//
+//      HS(t_0, t_1, ..., t_c) = prod_j (1 - t_0 t_j)^m /
+//                               ((1 - t_0)^(k+1) prod_j (1 - t_j)^(r+1))
+//
+// whose coefficient at the multi-degree is the expected dimension of the
+// quotient, i.e. the number of columns minus the rank. If it's at most 1, the
+// solution is the only thing left in the quotient and the linear variables can
+// be read off the nullvectors.
+
+// calibrated costs, all in nanoseconds
+typedef struct {
+    double nz_ns;    // per non-zero entry in each Block Lanczos iteration
+    double row_ns;   // per row of the Lanczos vectors in each iteration
+    double build_ns; // per non-zero entry to construct the sparse matrices
+} PlanCalib;
+
+// predictions for a multi-degree
+typedef struct {
+    uint64_t nrow;
+    uint64_t ncol;
+    uint64_t nlcol; // number of columns to eliminate
+    uint64_t nznum; // expected number of non-zero entries
+    uint64_t iter_num; // expected number of Block Lanczos iterations
+    int64_t hs; // expected dimension of the quotient
+    size_t memsize; // expected peak memory in bytes
+    double sec; // predicted runtime in seconds
+    bool solvable;
+} MDPlan;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Measure the costs of the cost model on the host. Block Lanczos is run
+ *      on 2 random sparse matrices of different densities, and the Macaulay
+ *      matrix of the lowest multi-degree of the instance is constructed.
+ *      Consumes numbers from rand()
+ * params:
+ *      1) cal: ptr to PlanCalib. Container for the costs
+ *      2) ks: ptr to struct GFM, the KS matrix of the instance
+ *      3) mr: ptr to struct MinRank
+ *      4) c: number of rows in the left multiplier of the KS matrix
+ *      5) tnum: number of threads to use
+ *      6) tp: ptr to struct Threadpool
+ * return: true on success, false if memory allocation failed */
+bool
+planner_calibrate(PlanCalib* restrict cal, const GFM* restrict ks,
+                  const MinRank* restrict mr, uint32_t c, uint32_t tnum,
+                  Threadpool* restrict tp);
+
+/* usage: Predict the costs of solving the instance with a multi-degree or a
+ *      combination of multi-degrees. A combination is predicted to solve the
+ *      instance if any of its multi-degrees is
+ * params:
+ *      1) p: ptr to MDPlan. Container for the predictions
+ *      2) cal: ptr to PlanCalib
+ *      3) ks: ptr to struct GFM, the KS matrix of the instance
+ *      4) mr: ptr to struct MinRank
+ *      5) degs: an array of ptrs to struct MDeg
+ *      6) sz: size of degs
+ *      7) tnum: number of threads to use
+ *      8) ooc_blk_mem: size of a block of the matrix to eliminate on disk in
+ *          bytes, or 0 if it's held in memory
+ * return: void */
+void
+planner_eval(MDPlan* restrict p, const PlanCalib* restrict cal,
+             const GFM* restrict ks, const MinRank* restrict mr,
+             const MDeg** degs, uint32_t sz, uint32_t tnum,
+             uint64_t ooc_blk_mem);
+
+/* usage: Search the multi-degrees up to PLANNER_MAX_DEG in each group of
+ *      variables and pick the one with the lowest predicted runtime among
+ *      those that are predicted to solve the instance within the memory budget
+ * params:
+ *      1) best: ptr to MDPlan. Container for the predictions of the pick
+ *      2) cal: ptr to PlanCalib
+ *      3) ks: ptr to struct GFM, the KS matrix of the instance
+ *      4) mr: ptr to struct MinRank
+ *      5) c: number of rows in the left multiplier of the KS matrix
+ *      6) max_mem: memory budget in bytes
+ *      7) tnum: number of threads to use
+ *      8) ooc_blk_mem: size of a block of the matrix to eliminate on disk in
+ *          bytes, or 0 if it's held in memory
+ *      9) verbose: print the predictions of each candidate
+ * return: ptr to a new struct MDeg, or NULL if no candidate qualifies or
+ *      memory allocation failed */
+MDeg*
+planner_auto_mdeg(MDPlan* restrict best, const PlanCalib* restrict cal,
+                  const GFM* restrict ks, const MinRank* restrict mr,
+                  uint32_t c, size_t max_mem, uint32_t tnum,
+                  uint64_t ooc_blk_mem, bool verbose);
+
+/* usage: Print the predictions for a multi-degree
+ * params:
+ *      1) p: ptr to MDPlan
+ * return: void */
+void
+planner_print(const MDPlan* p);
+
+#endif // __PLANNER_H__
@@ -0,0 +1,219 @@
+/* prng.c: implementation of the pseudorandom number generator of the solver */
+
+#include "prng.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define PHILOX_M0       0xD2511F53U
+#define PHILOX_M1       0xCD9E8D57U
+#define PHILOX_W0       0x9E3779B9U
+#define PHILOX_W1       0xBB67AE85U
+#define PHILOX_ROUNDS   10
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+static force_inline uint64_t
+prng_blk_idx(const Prng* g) {
+    return ((uint64_t) g->ctr[1] << 32) | g->ctr[0];
+}
+
+static force_inline void
+prng_set_blk_idx(Prng* g, uint64_t i) {
+    g->ctr[0] = (uint32_t) i;
+    g->ctr[1] = (uint32_t) (i >> 32);
+}
+
+static force_inline void
+philox4x32(uint64_t out[2], const uint32_t ctr[4], const uint32_t key[2]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for(uint32_t r = 0; r < PHILOX_ROUNDS; ++r) {
+        const uint64_t p0 = (uint64_t) PHILOX_M0 * c0;
+        const uint64_t p1 = (uint64_t) PHILOX_M1 * c2;
+        c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t) p1;
+        c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t) p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = ((uint64_t) c1 << 32) | c0;
+    out[1] = ((uint64_t) c3 << 32) | c2;
+}
+
+#if defined(__AVX2__)
+
+// 4 blocks at once, one in each 64-bit lane. The words of the state are kept
+// in the lower half of the lanes, where _mm256_mul_epu32 reads them
+static force_inline void
+philox4x32_x4(uint64_t out[8], uint64_t blk, const uint32_t ctr[4],
+              const uint32_t key[2]) {
+    const __m256i lo32 = _mm256_set1_epi64x(0xFFFFFFFFULL);
+    const __m256i m0 = _mm256_set1_epi64x(PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi64x(PHILOX_M1);
+    const __m256i w0 = _mm256_set1_epi64x(PHILOX_W0);
+    const __m256i w1 = _mm256_set1_epi64x(PHILOX_W1);
+    const __m256i b = _mm256_add_epi64(_mm256_set1_epi64x(blk),
+                                       _mm256_set_epi64x(3, 2, 1, 0));
+    __m256i c0 = _mm256_and_si256(b, lo32);
+    __m256i c1 = _mm256_srli_epi64(b, 32);
+    __m256i c2 = _mm256_set1_epi64x(ctr[2]);
+    __m256i c3 = _mm256_set1_epi64x(ctr[3]);
+    __m256i k0 = _mm256_set1_epi64x(key[0]);
+    __m256i k1 = _mm256_set1_epi64x(key[1]);
+    for(uint32_t r = 0; r < PHILOX_ROUNDS; ++r) {
+        const __m256i p0 = _mm256_mul_epu32(c0, m0);
+        const __m256i p1 = _mm256_mul_epu32(c2, m1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1),
+                              k0);
+        c1 = _mm256_and_si256(p1, lo32);
+        c2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3),
+                              k1);
+        c3 = _mm256_and_si256(p0, lo32);
+        // the upper halves of the key lanes stay 0
+        k0 = _mm256_add_epi32(k0, w0);
+        k1 = _mm256_add_epi32(k1, w1);
+    }
+    const __m256i o0 = _mm256_or_si256(c0, _mm256_slli_epi64(c1, 32));
+    const __m256i o1 = _mm256_or_si256(c2, _mm256_slli_epi64(c3, 32));
+    const __m256i t0 = _mm256_unpacklo_epi64(o0, o1);
+    const __m256i t1 = _mm256_unpackhi_epi64(o0, o1);
+    _mm256_storeu_si256((__m256i*) out,
+                        _mm256_permute2x128_si256(t0, t1, 0x20));
+    _mm256_storeu_si256((__m256i*) (out + 4),
+                        _mm256_permute2x128_si256(t0, t1, 0x31));
+}
+
+#endif
+
+/* usage: Initialize a struct Prng at the beginning of a stream
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) seed: the seed
+ *      3) use: purpose of the stream
+ *      4) stream: index of the stream
+ * return: void */
+void
+prng_init(Prng* g, uint64_t seed, PrngUse use, uint32_t stream) {
+    g->key[0] = (uint32_t) seed;
+    g->key[1] = (uint32_t) (seed >> 32);
+    g->ctr[0] = g->ctr[1] = 0;
+    g->ctr[2] = stream;
+    g->ctr[3] = use;
+    g->left = 0;
+}
+
+/* usage: Move a struct Prng to a position in its stream
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) pos: index of the next output
+ * return: void */
+void
+prng_seek(Prng* g, uint64_t pos) {
+    prng_set_blk_idx(g, pos >> 1);
+    g->left = 0;
+    if(pos & 0x1ULL) {
+        prng_next_block(g);
+        g->left = 1;
+    }
+}
+
+/* usage: Compute the next block of outputs of a struct Prng. Called by
+ *      prng_u64 only
+ * params:
+ *      1) g: ptr to struct Prng
+ * return: void */
+void
+prng_next_block(Prng* g) {
+    philox4x32(g->buf, g->ctr, g->key);
+    prng_set_blk_idx(g, prng_blk_idx(g) + 1);
+    g->left = 2;
+}
+
+/* usage: Draw the next outputs of a struct Prng into a buffer
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) out: the buffer
+ *      3) n: number of outputs to draw
+ * return: void */
+void
+prng_fill(Prng* restrict g, uint64_t* restrict out, uint64_t n) {
+    for(; g->left && n; --n)
+        *(out++) = prng_u64(g);
+
+    // whole blocks straight into the buffer
+    uint64_t blk = prng_blk_idx(g);
+    const uint64_t end = blk + n / 2;
+#if defined(__AVX2__)
+    for(; blk + 4 <= end; blk += 4, out += 8)
+        philox4x32_x4(out, blk, g->ctr, g->key);
+#endif
+    for(; blk < end; ++blk, out += 2) {
+        prng_set_blk_idx(g, blk);
+        philox4x32(out, g->ctr, g->key);
+    }
+    prng_set_blk_idx(g, blk);
+
+    if(n & 0x1ULL)
+        *out = prng_u64(g);
+}
+
+struct __PrngFillArg {
+    uint64_t* restrict out;
+    uint64_t sidx;
+    uint64_t eidx;
+    uint64_t seed;
+    PrngUse use;
+    uint32_t stream;
+};
+
+static void
+prng_fill_worker(void* __arg) {
+    struct __PrngFillArg* arg = __arg;
+    Prng g;
+    prng_init(&g, arg->seed, arg->use, arg->stream);
+    prng_seek(&g, arg->sidx);
+    prng_fill(&g, arg->out + arg->sidx, arg->eidx - arg->sidx);
+}
+
+/* usage: Fill a buffer with the beginning of a stream in parallel
+ * params:
+ *      1) out: the buffer
+ *      2) n: number of outputs to draw
+ *      3) seed: the seed
+ *      4) use: purpose of the stream
+ *      5) stream: index of the stream
+ *      6) tnum: number of threads to use
+ *      7) tp: ptr to struct Threadpool
+ * return: void */
+void
+prng_fill_parallel(uint64_t* restrict out, uint64_t n, uint64_t seed,
+                   PrngUse use, uint32_t stream, uint32_t tnum,
+                   Threadpool* restrict tp) {
+    struct __PrngFillArg* args = NULL;
+    if(tnum > 1 && tp)
+        args = malloc(sizeof(struct __PrngFillArg) * tnum);
+    if(!args) { // same outputs, only slower
+        Prng g;
+        prng_init(&g, seed, use, stream);
+        prng_fill(&g, out, n);
+        return;
+    }
+
+    // keep the ranges on block boundaries
+    const uint64_t strip = (n / tnum) & ~0x1ULL;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i] = (struct __PrngFillArg) {
+            .out = out, .sidx = i * strip,
+            .eidx = (i == tnum - 1) ? n : (i + 1) * strip,
+            .seed = seed, .use = use, .stream = stream,
+        };
+        thpool_add_job(tp, prng_fill_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+    free(args);
+}
@@ -0,0 +1,101 @@
+/* prng.h: header file for the pseudorandom number generator of the solver */
+
+#ifndef __PRNG_H__
+#define __PRNG_H__
+
+#include <stdint.h>
+
+#include "util.h"
+#include "thpool.h"
+
+// Counter-based generator Philox4x32-10 (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC'11). The i-th output of a stream is a
+// function of the seed, the stream and i only, so any part of a stream can be
+// computed on its own, and a buffer filled by several threads is the same
+// whatever the number of threads. A stream is identified by a purpose and an
+// index, so the numbers drawn for one purpose don't depend on how many were
+// drawn for another.
+
+typedef enum {
+    PRNG_ROWS = 1,  // rows of the Macaulay matrix to keep
+    PRNG_LCZS,      // starting points of Block Lanczos, one stream per start
+    PRNG_KS,        // entries of a random KS matrix
+} PrngUse;
+
+/* ========================================================================
+ * struct Prng definition
+ * ======================================================================== */
+
+typedef struct {
+    uint32_t key[2];
+    uint32_t ctr[4]; // index of the next block (low, high), stream, purpose
+    uint64_t buf[2]; // outputs of the last block
+    uint32_t left; // number of outputs in buf not consumed yet
+} Prng;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Initialize a struct Prng at the beginning of a stream
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) seed: the seed
+ *      3) use: purpose of the stream
+ *      4) stream: index of the stream
+ * return: void */
+void
+prng_init(Prng* g, uint64_t seed, PrngUse use, uint32_t stream);
+
+/* usage: Move a struct Prng to a position in its stream
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) pos: index of the next output
+ * return: void */
+void
+prng_seek(Prng* g, uint64_t pos);
+
+/* usage: Compute the next block of outputs of a struct Prng. Called by
+ *      prng_u64 only
+ * params:
+ *      1) g: ptr to struct Prng
+ * return: void */
+void
+prng_next_block(Prng* g);
+
+/* usage: Draw the next output of a struct Prng
+ * params:
+ *      1) g: ptr to struct Prng
+ * return: a random uint64_t */
+static inline uint64_t
+prng_u64(Prng* g) {
+    if(unlikely(!g->left))
+        prng_next_block(g);
+    return g->buf[2 - g->left--];
+}
+
+/* usage: Draw the next outputs of a struct Prng into a buffer
+ * params:
+ *      1) g: ptr to struct Prng
+ *      2) out: the buffer
+ *      3) n: number of outputs to draw
+ * return: void */
+void
+prng_fill(Prng* restrict g, uint64_t* restrict out, uint64_t n);
+
+/* usage: Fill a buffer with the beginning of a stream in parallel
+ * params:
+ *      1) out: the buffer
+ *      2) n: number of outputs to draw
+ *      3) seed: the seed
+ *      4) use: purpose of the stream
+ *      5) stream: index of the stream
+ *      6) tnum: number of threads to use
+ *      7) tp: ptr to struct Threadpool
+ * return: void */
+void
+prng_fill_parallel(uint64_t* restrict out, uint64_t n, uint64_t seed,
+                   PrngUse use, uint32_t stream, uint32_t tnum,
+                   Threadpool* restrict tp);
+
+#endif // __PRNG_H__
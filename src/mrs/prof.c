@@ -0,0 +1,636 @@
+/* prof.c: implementation of prof.h */
+
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PROF_HAS_PERF_EVENT
+#endif
+
+// max number of threads whose counters are summed up
+#define PROF_PERF_MAX_THREADS   (1024)
+// size of the buffers used to measure the memory bandwidth
+#define PROF_PEAK_BUF_SIZE      (64ULL << 20)
+// number of rounds to measure the memory bandwidth
+#define PROF_PEAK_ROUNDS        (5)
+// each LLC miss is assumed to move a cache line from memory
+#define PROF_CACHE_LINE_SIZE    (64)
+
+// hardware events sampled per probe. Kept to 4 so that on most CPUs they fit
+// into the general purpose counters without multiplexing
+typedef enum {
+    PROF_EV_CYCLES,
+    PROF_EV_INSTRUCTIONS,
+    PROF_EV_LLC_MISSES,
+    PROF_EV_DTLB_MISSES,
+    PROF_EV_NUM,
+} ProfEv;
+
+/* ========================================================================
+ * global profiling data
+ * ======================================================================== */
+
+bool prof_on = false;
+bool prof_perf_on = false;
+
+// the measurements of a thread. Each thread that measures a probe has its
+// own, so concurrent solver contexts never write to the same counters. They
+// are summed up when reported
+typedef struct ProfAcc {
+    uint64_t calls[PROF_ID_NUM];
+    uint64_t ns[PROF_ID_NUM];
+    uint64_t units[PROF_ID_NUM];
+    uint64_t perf[PROF_ID_NUM][PROF_EV_NUM];
+    uint64_t perf_snap[PROF_ID_NUM][PROF_EV_NUM];
+    struct ProfAcc* prev;
+    struct ProfAcc* next;
+} ProfAcc;
+
+static uint64_t prof_begin;
+
+static pthread_mutex_t prof_acc_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t prof_acc_once = PTHREAD_ONCE_INIT;
+static pthread_key_t prof_acc_key; // releases the ProfAcc of exiting threads
+static ProfAcc* prof_acc_live; // ProfAcc of the running threads
+static ProfAcc prof_acc_exited; // sum of the threads that have exited
+static __thread ProfAcc* prof_acc_self;
+
+static pthread_mutex_t prof_perf_lock = PTHREAD_MUTEX_INITIALIZER;
+static int prof_perf_fds[PROF_PERF_MAX_THREADS][PROF_EV_NUM];
+static bool prof_perf_used[PROF_PERF_MAX_THREADS];
+static uint32_t prof_perf_slot_end; // slots beyond it were never used
+static uint32_t prof_perf_thnum; // number of threads attached so far
+// final counts of the threads detached so far
+static uint64_t prof_perf_retired[PROF_EV_NUM];
+// slot of the calling thread, -1 if it's not registered
+static __thread int32_t prof_perf_slot = -1;
+static bool prof_perf_ev_ok[PROF_EV_NUM];
+static double prof_perf_peak_gbps;
+
+static const char* const prof_ev_names[PROF_EV_NUM] = {
+    [PROF_EV_CYCLES] = "cycles",
+    [PROF_EV_INSTRUCTIONS] = "instructions",
+    [PROF_EV_LLC_MISSES] = "llc_misses",
+    [PROF_EV_DTLB_MISSES] = "dtlb_misses",
+};
+
+static const char* const prof_names[PROF_ID_NUM] = {
+    [PROF_LOAD] = "load",
+    [PROF_KS] = "ks",
+    [PROF_MDMAC] = "mdmac",
+    [PROF_NZNUM] = "nznum",
+    [PROF_CMSM] = "cmsm",
+    [PROF_PLAN] = "plan",
+    [PROF_FILTER] = "filter",
+    [PROF_LANCZOS] = "lanczos",
+    [PROF_NULLVEC] = "nullvec",
+    [PROF_DEFLATE] = "deflate",
+    [PROF_SOLVE] = "solve",
+    [PROF_LCZS_TR_MUL] = "tr_mul",
+    [PROF_LCZS_MUL] = "mul",
+    [PROF_LCZS_GRAMIAN_VTAV] = "gramian_vtav",
+    [PROF_LCZS_GRAMIAN_VTA2V] = "gramian_vta2v",
+    [PROF_LCZS_GJ] = "gj",
+    [PROF_LCZS_SMALL] = "small",
+    [PROF_LCZS_MIXI] = "mixi",
+    [PROF_LCZS_FMS_DIAG] = "fms_diag",
+    [PROF_LCZS_FMS] = "fms",
+    [PROF_LCZS_DIAG_FMA] = "diag_fma",
+    [PROF_LCZS_ALLREDUCE] = "allreduce",
+    [PROF_LCZS_OOC_MUL] = "ooc_mul",
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: subroutine of prof_acc_release and prof_acc_sum: add the
+ *      measurements of a ProfAcc to another
+ * params:
+ *      1) dst: ptr to ProfAcc to add to
+ *      2) src: ptr to ProfAcc
+ * return: void */
+static void
+prof_acc_add(ProfAcc* restrict dst, const ProfAcc* restrict src) {
+    for(uint32_t i = 0; i < PROF_ID_NUM; ++i) {
+        dst->calls[i] += src->calls[i];
+        dst->ns[i] += src->ns[i];
+        dst->units[i] += src->units[i];
+        for(uint32_t e = 0; e < PROF_EV_NUM; ++e)
+            dst->perf[i][e] += src->perf[i][e];
+    }
+}
+
+/* usage: destructor of prof_acc_key: fold the measurements of an exiting
+ *      thread into prof_acc_exited and release its ProfAcc
+ * params:
+ *      1) arg: ptr to ProfAcc
+ * return: void */
+static void
+prof_acc_release(void* arg) {
+    ProfAcc* a = arg;
+    pthread_mutex_lock(&prof_acc_lock);
+    prof_acc_add(&prof_acc_exited, a);
+    if(a->prev)
+        a->prev->next = a->next;
+    else
+        prof_acc_live = a->next;
+    if(a->next)
+        a->next->prev = a->prev;
+    pthread_mutex_unlock(&prof_acc_lock);
+    free(a);
+}
+
+static void
+prof_acc_key_init(void) {
+    pthread_key_create(&prof_acc_key, prof_acc_release);
+}
+
+/* usage: return the ProfAcc of the calling thread, created on first use
+ * params: void
+ * return: ptr to ProfAcc, or NULL if memory allocation failed, in which case
+ *      the measurement is dropped */
+static ProfAcc*
+prof_acc(void) {
+    if(likely(prof_acc_self != NULL))
+        return prof_acc_self;
+
+    pthread_once(&prof_acc_once, prof_acc_key_init);
+    ProfAcc* a = calloc(1, sizeof(ProfAcc));
+    if(!a)
+        return NULL;
+    pthread_mutex_lock(&prof_acc_lock);
+    a->next = prof_acc_live;
+    if(prof_acc_live)
+        prof_acc_live->prev = a;
+    prof_acc_live = a;
+    pthread_mutex_unlock(&prof_acc_lock);
+    pthread_setspecific(prof_acc_key, a);
+    prof_acc_self = a;
+    return a;
+}
+
+/* usage: sum up the measurements of all the threads so far. Called once the
+ *      measured work is done
+ * params:
+ *      1) sum: ptr to ProfAcc for the sums
+ * return: void */
+static void
+prof_acc_sum(ProfAcc* sum) {
+    pthread_mutex_lock(&prof_acc_lock);
+    memcpy(sum, &prof_acc_exited, sizeof(ProfAcc));
+    for(const ProfAcc* a = prof_acc_live; a; a = a->next)
+        prof_acc_add(sum, a);
+    pthread_mutex_unlock(&prof_acc_lock);
+}
+
+/* usage: Turn on profiling. The total time in the report starts from here
+ * params: void
+ * return: void */
+void
+prof_enable(void) {
+    pthread_mutex_lock(&prof_acc_lock);
+    memset(&prof_acc_exited, 0x0, sizeof(ProfAcc));
+    for(ProfAcc* a = prof_acc_live; a; a = a->next) {
+        ProfAcc* prev = a->prev, *next = a->next;
+        memset(a, 0x0, sizeof(ProfAcc));
+        a->prev = prev;
+        a->next = next;
+    }
+    pthread_mutex_unlock(&prof_acc_lock);
+    prof_begin = prof_now();
+    prof_on = true;
+}
+
+#if defined(PROF_HAS_PERF_EVENT)
+
+/* usage: subroutine of prof_perf_open: fill in the attributes of an event
+ * params:
+ *      1) attr: ptr to struct perf_event_attr
+ *      2) ev: the event
+ * return: void */
+static void
+prof_perf_attr(struct perf_event_attr* attr, ProfEv ev) {
+    memset(attr, 0x0, sizeof(struct perf_event_attr));
+    attr->size = sizeof(struct perf_event_attr);
+    attr->type = PERF_TYPE_HARDWARE;
+    switch(ev) {
+        case PROF_EV_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PROF_EV_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PROF_EV_LLC_MISSES:
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PROF_EV_DTLB_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        default:
+            break;
+    }
+    // user space only, which is allowed with perf_event_paranoid <= 2
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                        PERF_FORMAT_TOTAL_TIME_RUNNING;
+}
+
+/* usage: subroutine of prof_perf_enable and prof_perf_thread_attach: open an
+ *      event for the calling thread
+ * params:
+ *      1) ev: the event
+ * return: file descriptor on success, -1 otherwise */
+static int
+prof_perf_open(ProfEv ev) {
+    struct perf_event_attr attr;
+    prof_perf_attr(&attr, ev);
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* usage: subroutine of prof_perf_read: read an event, scaled up if it was
+ *      multiplexed with others
+ * params:
+ *      1) fd: file descriptor of the event
+ * return: the count */
+static uint64_t
+prof_perf_read_fd(int fd) {
+    uint64_t buf[3]; // value, time enabled, time running
+    if(read(fd, buf, sizeof(buf)) != sizeof(buf) || !buf[2])
+        return 0;
+    if(buf[1] == buf[2])
+        return buf[0];
+    return (uint64_t) ((double) buf[0] * buf[1] / buf[2]);
+}
+
+#else
+
+static int
+prof_perf_open(ProfEv ev) {
+    (void) ev;
+    errno = ENOSYS;
+    return -1;
+}
+
+static uint64_t
+prof_perf_read_fd(int fd) {
+    (void) fd;
+    return 0;
+}
+
+#endif
+
+/* usage: subroutine of prof_perf_enable and prof_perf_thread_attach: open the
+ *      available events for the calling thread and register them
+ * params: void
+ * return: void */
+static void
+prof_perf_register(void) {
+    if(prof_perf_slot >= 0)
+        return;
+    pthread_mutex_lock(&prof_perf_lock);
+    // the slots of the threads detached so far are reused
+    for(uint32_t i = 0; i < PROF_PERF_MAX_THREADS; ++i) {
+        if(prof_perf_used[i])
+            continue;
+        int* fds = prof_perf_fds[i];
+        for(uint32_t e = 0; e < PROF_EV_NUM; ++e)
+            fds[e] = prof_perf_ev_ok[e] ? prof_perf_open(e) : -1;
+        prof_perf_used[i] = true;
+        prof_perf_slot = i;
+        if(i >= prof_perf_slot_end)
+            prof_perf_slot_end = i + 1;
+        ++prof_perf_thnum;
+        break;
+    }
+    pthread_mutex_unlock(&prof_perf_lock);
+}
+
+/* usage: subroutine of prof_perf_begin and prof_perf_end: sum up the events
+ *      over all registered threads
+ * params:
+ *      1) cnt: container for the counts
+ * return: void */
+static void
+prof_perf_read(uint64_t cnt[PROF_EV_NUM]) {
+    pthread_mutex_lock(&prof_perf_lock);
+    memcpy(cnt, prof_perf_retired, sizeof(uint64_t) * PROF_EV_NUM);
+    for(uint32_t i = 0; i < prof_perf_slot_end; ++i) {
+        if(!prof_perf_used[i])
+            continue;
+        for(uint32_t e = 0; e < PROF_EV_NUM; ++e) {
+            if(prof_perf_fds[i][e] >= 0)
+                cnt[e] += prof_perf_read_fd(prof_perf_fds[i][e]);
+        }
+    }
+    pthread_mutex_unlock(&prof_perf_lock);
+}
+
+/* usage: subroutine of prof_perf_enable: measure the memory bandwidth of a
+ *      single thread with large memcpy
+ * params: void
+ * return: bandwidth in GB/s, counting both reads and writes. 0 on failure */
+static double
+prof_perf_measure_peak(void) {
+    uint8_t* src = malloc(PROF_PEAK_BUF_SIZE);
+    uint8_t* dst = malloc(PROF_PEAK_BUF_SIZE);
+    double gbps = 0.0;
+    if(!src || !dst)
+        goto cleanup;
+
+    memset(src, 0x1, PROF_PEAK_BUF_SIZE);
+    memset(dst, 0x0, PROF_PEAK_BUF_SIZE); // fault in the pages
+    uint64_t best = UINT64_MAX;
+    for(uint32_t i = 0; i < PROF_PEAK_ROUNDS; ++i) {
+        uint64_t ts = prof_now();
+        memcpy(dst, src, PROF_PEAK_BUF_SIZE);
+        ts = prof_now() - ts;
+        if(ts < best)
+            best = ts;
+        src[i] = dst[PROF_PEAK_BUF_SIZE - 1 - i]; // keep the copy alive
+    }
+    if(best)
+        gbps = 2.0 * PROF_PEAK_BUF_SIZE / best;
+
+cleanup:
+    free(src);
+    free(dst);
+    return gbps;
+}
+
+/* usage: Turn on the hardware performance counters for the calling thread
+ *      and the threads attached later on. Must be called after prof_enable()
+ *      and before any Threadpool is created. If the counters are not
+ *      available, e.g. not supported by the kernel or not permitted by
+ *      perf_event_paranoid, profiling falls back to wall time only.
+ * params:
+ *      1) peak_gbps: peak memory bandwidth in GB/s for the roofline summary.
+ *              If it's 0, the bandwidth of a large memcpy is measured instead
+ * return: true if at least one counter is available, false otherwise */
+bool
+prof_perf_enable(double peak_gbps) {
+    bool any = false;
+    for(uint32_t e = 0; e < PROF_EV_NUM; ++e) {
+        int fd = prof_perf_open(e);
+        prof_perf_ev_ok[e] = (fd >= 0);
+        if(fd >= 0) {
+            close(fd);
+            any = true;
+        }
+    }
+    if(!any)
+        return false;
+
+    memset(prof_perf_retired, 0x0, sizeof(prof_perf_retired));
+    prof_perf_peak_gbps = (peak_gbps > 0.0) ? peak_gbps :
+                          prof_perf_measure_peak();
+    prof_perf_register();
+    prof_perf_on = true;
+    return true;
+}
+
+/* usage: Open the hardware performance counters for the calling thread if
+ *      they are enabled. Called by each worker of a Threadpool on start
+ * params: void
+ * return: void */
+void
+prof_perf_thread_attach(void) {
+    if(prof_perf_on)
+        prof_perf_register();
+}
+
+/* usage: Close the hardware performance counters of the calling thread, if
+ *      it's registered. Its counts so far are kept in the sums, and its slot
+ *      is given to the threads attached later on. Called by each worker of a
+ *      Threadpool on exit
+ * params: void
+ * return: void */
+void
+prof_perf_thread_detach(void) {
+    if(prof_perf_slot < 0)
+        return;
+    pthread_mutex_lock(&prof_perf_lock);
+    int* fds = prof_perf_fds[prof_perf_slot];
+    for(uint32_t e = 0; e < PROF_EV_NUM; ++e) {
+        if(fds[e] < 0)
+            continue;
+        prof_perf_retired[e] += prof_perf_read_fd(fds[e]);
+        close(fds[e]);
+        fds[e] = -1;
+    }
+    prof_perf_used[prof_perf_slot] = false;
+    pthread_mutex_unlock(&prof_perf_lock);
+    prof_perf_slot = -1;
+}
+
+/* usage: Snapshot the hardware performance counters for the selected probe
+ * params:
+ *      1) id: the probe
+ * return: void */
+void
+prof_perf_begin(ProfId id) {
+    ProfAcc* a = prof_acc();
+    if(a)
+        prof_perf_read(a->perf_snap[id]);
+}
+
+/* usage: Accumulate the hardware performance counters for the selected probe
+ *      since the last prof_perf_begin()
+ * params:
+ *      1) id: the probe
+ * return: void */
+void
+prof_perf_end(ProfId id) {
+    ProfAcc* a = prof_acc();
+    if(!a)
+        return;
+    uint64_t cnt[PROF_EV_NUM];
+    prof_perf_read(cnt);
+    for(uint32_t e = 0; e < PROF_EV_NUM; ++e) {
+        // counters of threads registered in between can make it go backward
+        if(cnt[e] > a->perf_snap[id][e])
+            a->perf[id][e] += cnt[e] - a->perf_snap[id][e];
+    }
+}
+
+/* usage: Add units of work, e.g. the number of non-zero entries processed by
+ *      a sparse matrix-vector product, to the selected probe. They are used
+ *      to normalize the counters in the roofline summary
+ * params:
+ *      1) id: the probe
+ *      2) n: number of units
+ * return: void */
+void
+prof_add_units(ProfId id, uint64_t n) {
+    ProfAcc* a;
+    if(prof_on && (a = prof_acc()))
+        a->units[id] += n;
+}
+
+/* usage: Print a roofline-style summary of the hardware performance counters:
+ *      IPC, cache and TLB misses per unit of work, and the memory traffic
+ *      implied by the LLC misses against the peak bandwidth. Without the
+ *      counters, only the wall time, the calls and the units are printed
+ * params:
+ *      1) fp: the output file
+ * return: void */
+void
+prof_perf_print_summary(FILE* fp) {
+    ProfAcc* sum = malloc(sizeof(ProfAcc));
+    if(!sum)
+        return;
+    prof_acc_sum(sum);
+
+    if(prof_perf_on)
+        fprintf(fp, "hardware counters summed over %u threads, peak memory "
+                "bandwidth %.2f GB/s\n", prof_perf_thnum, prof_perf_peak_gbps);
+    else
+        fprintf(fp, "hardware counters unavailable, wall time only\n");
+    fprintf(fp, "%-14s %10s %10s %10s", "probe", "sec", "calls", "units");
+    if(prof_perf_on)
+        fprintf(fp, " %6s %10s %10s %9s %7s", "IPC", "LLCmiss/u",
+                "dTLBmiss/u", "GB/s", "%peak");
+    fprintf(fp, "\n");
+    for(uint32_t i = 0; i < PROF_ID_NUM; ++i) {
+        if(!sum->calls[i])
+            continue;
+
+        const double sec = sum->ns[i] / 1e9;
+        fprintf(fp, "%-14s %10.4f %10lu ", prof_names[i], sec, sum->calls[i]);
+        if(sum->units[i])
+            fprintf(fp, "%10lu", sum->units[i]);
+        else
+            fprintf(fp, "%10s", "-");
+        if(!prof_perf_on) {
+            fprintf(fp, "\n");
+            continue;
+        }
+
+        const uint64_t* c = sum->perf[i];
+        const double bytes = (double) c[PROF_EV_LLC_MISSES] * PROF_CACHE_LINE_SIZE;
+        const double gbps = sec > 0.0 ? bytes / sec / 1e9 : 0.0;
+        if(prof_perf_ev_ok[PROF_EV_CYCLES] && prof_perf_ev_ok[PROF_EV_INSTRUCTIONS]
+           && c[PROF_EV_CYCLES])
+            fprintf(fp, " %6.2f ", (double) c[PROF_EV_INSTRUCTIONS] / c[PROF_EV_CYCLES]);
+        else
+            fprintf(fp, " %6s ", "n/a");
+
+        for(uint32_t e = PROF_EV_LLC_MISSES; e <= PROF_EV_DTLB_MISSES; ++e) {
+            if(sum->units[i] && prof_perf_ev_ok[e])
+                fprintf(fp, "%10.4f ", (double) c[e] / sum->units[i]);
+            else
+                fprintf(fp, "%10s ", sum->units[i] ? "n/a" : "-");
+        }
+
+        if(prof_perf_ev_ok[PROF_EV_LLC_MISSES]) {
+            fprintf(fp, "%9.2f ", gbps);
+            if(prof_perf_peak_gbps > 0.0)
+                fprintf(fp, "%6.1f%%\n", 100.0 * gbps / prof_perf_peak_gbps);
+            else
+                fprintf(fp, "%7s\n", "n/a");
+        } else {
+            fprintf(fp, "%9s %7s\n", "n/a", "n/a");
+        }
+    }
+    free(sum);
+}
+
+/* usage: return the current time of a monotonic clock
+ * params: void
+ * return: time in nanoseconds */
+uint64_t
+prof_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/* usage: Add a measurement to the selected probe
+ * params:
+ *      1) id: the probe
+ *      2) ns: elapsed time in nanoseconds
+ * return: void */
+void
+prof_add(ProfId id, uint64_t ns) {
+    ProfAcc* a = prof_acc();
+    if(!a)
+        return;
+    ++a->calls[id];
+    a->ns[id] += ns;
+}
+
+/* usage: subroutine of prof_write_json: write the probes in [begin, end) as
+ *      a JSON object
+ * params:
+ *      1) fp: the output file
+ *      2) name: name of the object
+ *      3) begin, end: range of the probes
+ *      4) total: total time in nanoseconds, for the percentages
+ * return: void */
+static void
+prof_write_group(FILE* fp, const ProfAcc* sum, const char* name,
+                 uint32_t begin, uint32_t end, uint64_t total) {
+    fprintf(fp, "  \"%s\": {\n", name);
+    for(uint32_t i = begin; i < end; ++i) {
+        fprintf(fp, "    \"%s\": { \"calls\": %lu, \"sec\": %.6f, \"pct\": %.2f",
+                prof_names[i], sum->calls[i], sum->ns[i] / 1e9,
+                total ? 100.0 * sum->ns[i] / total : 0.0);
+        if(sum->units[i])
+            fprintf(fp, ", \"units\": %lu", sum->units[i]);
+        if(prof_perf_on) {
+            for(uint32_t e = 0; e < PROF_EV_NUM; ++e) {
+                if(prof_perf_ev_ok[e])
+                    fprintf(fp, ", \"%s\": %lu", prof_ev_names[e], sum->perf[i][e]);
+            }
+        }
+        fprintf(fp, " }%s\n", (i + 1 < end) ? "," : "");
+    }
+    fprintf(fp, "  }");
+}
+
+/* usage: Write the measurements collected so far into a file as JSON
+ * params:
+ *      1) path: path to the file. If it's "-", write to stdout
+ * return: true on success, false otherwise */
+bool
+prof_write_json(const char* path) {
+    const bool to_stdout = !strcmp(path, "-");
+    ProfAcc* sum = malloc(sizeof(ProfAcc));
+    FILE* fp = NULL;
+    if(!sum || !(fp = to_stdout ? stdout : fopen(path, "w"))) {
+        free(sum);
+        return false;
+    }
+    prof_acc_sum(sum);
+
+    const uint64_t total = prof_now() - prof_begin;
+    // the steps are measured as parts of the Lanczos phase
+    fprintf(fp, "{\n  \"total_sec\": %.6f,\n", total / 1e9);
+    if(prof_perf_on)
+        fprintf(fp, "  \"peak_gbps\": %.2f,\n", prof_perf_peak_gbps);
+    prof_write_group(fp, sum, "phases", PROF_LOAD, PROF_LCZS_TR_MUL, total);
+    fprintf(fp, ",\n");
+    prof_write_group(fp, sum, "lanczos", PROF_LCZS_TR_MUL, PROF_ID_NUM,
+                     sum->ns[PROF_LANCZOS]);
+    fprintf(fp, "\n}\n");
+
+    bool ok = !ferror(fp);
+    if(to_stdout)
+        fflush(fp);
+    else
+        ok = !fclose(fp) && ok;
+    free(sum);
+    return ok;
+}
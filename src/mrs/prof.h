@@ -0,0 +1,184 @@
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "util.h"
+
+// wall time and call counts of the phases of the solver and the steps of each
+// Block Lanczos iteration. Profiling is turned on at runtime with
+// prof_enable(). While it's off, each probe costs a single branch. Each thread
+// measures into its own counters, which are summed up in the reports, so
+// concurrent solver contexts can be measured: their times add up.
+//
+// Optionally, hardware performance counters (cycles, instructions, LLC misses
+// and dTLB misses) are sampled with perf_event_open(2) around each probe as
+// well. The counters are opened per thread, for the main thread by
+// prof_perf_enable() and for the workers of each Threadpool by
+// prof_perf_thread_attach(), and each probe sums them over all threads, so
+// they also count the work of the other contexts running meanwhile. The
+// counters of a worker are closed by prof_perf_thread_detach() when its pool
+// is destroyed, and its final counts are kept in the sums.
+
+typedef enum {
+    // phases of the solver
+    PROF_LOAD,
+    PROF_KS,
+    PROF_MDMAC,
+    PROF_NZNUM,
+    PROF_CMSM,
+    PROF_PLAN, // loading and storing the plan cache
+    PROF_FILTER,
+    PROF_LANCZOS,
+    PROF_NULLVEC,
+    PROF_DEFLATE,
+    PROF_SOLVE,
+    // steps of a Block Lanczos iteration
+    PROF_LCZS_TR_MUL,
+    PROF_LCZS_MUL,
+    PROF_LCZS_GRAMIAN_VTAV,
+    PROF_LCZS_GRAMIAN_VTA2V,
+    PROF_LCZS_GJ,
+    PROF_LCZS_SMALL, // products of the small square matrices
+    PROF_LCZS_MIXI,
+    PROF_LCZS_FMS_DIAG,
+    PROF_LCZS_FMS,
+    PROF_LCZS_DIAG_FMA,
+    PROF_LCZS_ALLREDUCE, // communication of the distributed mode
+    PROF_LCZS_OOC_MUL, // both sparse products, streamed from disk
+    PROF_ID_NUM,
+} ProfId;
+
+extern bool prof_on;
+extern bool prof_perf_on;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Turn on profiling. The total time in the report starts from here
+ * params: void
+ * return: void */
+void
+prof_enable(void);
+
+/* usage: Turn on the hardware performance counters for the calling thread
+ *      and the threads attached later on. Must be called after prof_enable()
+ *      and before any Threadpool is created. If the counters are not
+ *      available, e.g. not supported by the kernel or not permitted by
+ *      perf_event_paranoid, profiling falls back to wall time only.
+ * params:
+ *      1) peak_gbps: peak memory bandwidth in GB/s for the roofline summary.
+ *              If it's 0, the bandwidth of a large memcpy is measured instead
+ * return: true if at least one counter is available, false otherwise */
+bool
+prof_perf_enable(double peak_gbps);
+
+/* usage: Open the hardware performance counters for the calling thread if
+ *      they are enabled. Called by each worker of a Threadpool on start
+ * params: void
+ * return: void */
+void
+prof_perf_thread_attach(void);
+
+/* usage: Close the hardware performance counters of the calling thread, if
+ *      it's registered. Its counts so far are kept in the sums, and its slot
+ *      is given to the threads attached later on. Called by each worker of a
+ *      Threadpool on exit
+ * params: void
+ * return: void */
+void
+prof_perf_thread_detach(void);
+
+/* usage: return the current time of a monotonic clock
+ * params: void
+ * return: time in nanoseconds */
+uint64_t
+prof_now(void);
+
+/* usage: Add a measurement to the selected probe
+ * params:
+ *      1) id: the probe
+ *      2) ns: elapsed time in nanoseconds
+ * return: void */
+void
+prof_add(ProfId id, uint64_t ns);
+
+/* usage: Snapshot the hardware performance counters for the selected probe
+ * params:
+ *      1) id: the probe
+ * return: void */
+void
+prof_perf_begin(ProfId id);
+
+/* usage: Accumulate the hardware performance counters for the selected probe
+ *      since the last prof_perf_begin()
+ * params:
+ *      1) id: the probe
+ * return: void */
+void
+prof_perf_end(ProfId id);
+
+/* usage: Add units of work, e.g. the number of non-zero entries processed by
+ *      a sparse matrix-vector product, to the selected probe. They are used
+ *      to normalize the counters in the roofline summary
+ * params:
+ *      1) id: the probe
+ *      2) n: number of units
+ * return: void */
+void
+prof_add_units(ProfId id, uint64_t n);
+
+/* usage: Print a roofline-style summary of the hardware performance counters:
+ *      IPC, cache and TLB misses per unit of work, and the memory traffic
+ *      implied by the LLC misses against the peak bandwidth. Without the
+ *      counters, only the wall time, the calls and the units are printed
+ * params:
+ *      1) fp: the output file
+ * return: void */
+void
+prof_perf_print_summary(FILE* fp);
+
+/* usage: Write the measurements collected so far into a file as JSON
+ * params:
+ *      1) path: path to the file. If it's "-", write to stdout
+ * return: true on success, false otherwise */
+bool
+prof_write_json(const char* path);
+
+/* usage: start a measurement
+ * params:
+ *      1) id: the probe
+ * return: the start time, or 0 if profiling is off */
+static inline uint64_t
+prof_start(ProfId id) {
+    if(likely(!prof_on))
+        return 0;
+    if(prof_perf_on)
+        prof_perf_begin(id);
+    return prof_now();
+}
+
+/* usage: finish a measurement started with prof_start()
+ * params:
+ *      1) id: the probe
+ *      2) start: return value of prof_start()
+ * return: void */
+static inline void
+prof_stop(ProfId id, uint64_t start) {
+    if(likely(!prof_on))
+        return;
+    prof_add(id, prof_now() - start);
+    if(prof_perf_on)
+        prof_perf_end(id);
+}
+
+/* measure a statement with the selected probe */
+#define PROF(id, stmt) do { \
+    uint64_t __prof_start = prof_start(id); \
+    stmt; \
+    prof_stop(id, __prof_start); \
+} while(0)
+
+#endif // __PROF_H__
@@ -0,0 +1,238 @@
+#include "r64m_gf2.h"
+#include "uint64a.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================================
+ * struct R64MGF2 definition
+ * ======================================================================== */
+
+struct R64MGF2 {
+    uint64_t rnum;
+    uint64_t rows[];
+};
+
+// products with a 64 x 64 matrix are looked up 8 bits at a time: the j-th
+// table holds all the linear combinations of rows 8j ~ 8j+7 of the matrix
+typedef uint64_t R64MGF2Tab[8][256];
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Compute the size of memory needed for R64MGF2
+ * params:
+ *      1) rnum: number of rows
+ * return: size of memory needed in bytes */
+uint64_t
+r64m_gf2_memsize(uint64_t rnum) {
+    return sizeof(R64MGF2) + sizeof(uint64_t) * rnum;
+}
+
+/* usage: Create a R64MGF2 matrix. The matrix is not initialized
+ * params:
+ *      1) rnum: number of rows
+ * return: ptr to struct R64MGF2. NULL on faliure */
+R64MGF2*
+r64m_gf2_create(uint64_t rnum) {
+    R64MGF2* m = malloc(r64m_gf2_memsize(rnum));
+    if(!m)
+        return NULL;
+
+    m->rnum = rnum;
+    return m;
+}
+
+/* usage: Release a struct R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_free(R64MGF2* m) {
+    free(m);
+}
+
+/* usage: Return the number of rows of a R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: number of rows */
+uint64_t
+r64m_gf2_rnum(const R64MGF2* m) {
+    return m->rnum;
+}
+
+/* usage: Return the address of the i-th row of a R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ *      2) i: index of the row
+ * return: ptr to the row */
+uint64_t*
+r64m_gf2_raddr(R64MGF2* m, uint64_t i) {
+    return m->rows + i;
+}
+
+/* usage: Set a R64MGF2 matrix to zero
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_zero(R64MGF2* m) {
+    memset(m->rows, 0x0, sizeof(uint64_t) * m->rnum);
+}
+
+/* usage: Fill a R64MGF2 matrix with random values
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_rand(R64MGF2* m) {
+    uint64a_rand(m->rows, m->rnum);
+}
+
+/* usage: Given 2 R64MGF2 A and B, compute A + B and store the result back
+ *      into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ * return: void */
+void
+r64m_gf2_addi(R64MGF2* restrict a, const R64MGF2* restrict b) {
+    assert(a->rnum == b->rnum);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        a->rows[i] ^= b->rows[i];
+}
+
+/* subroutine of the products with a RC64MGF2: build the lookup tables of c.
+ *      The columns not in d are cleared */
+static inline void
+r64m_gf2_tab_init(R64MGF2Tab tab, const RC64MGF2* restrict c, uint64_t d) {
+    for(uint32_t t = 0; t < 8; ++t) {
+        tab[t][0] = 0;
+        for(uint32_t b = 1; b < 256; ++b) {
+            uint32_t lsb = b & -b;
+            tab[t][b] = tab[t][b ^ lsb] ^
+                        (c->rows[8 * t + uint64_t_ctz(b)] & d);
+        }
+    }
+}
+
+static force_inline uint64_t
+r64m_gf2_tab_mul(R64MGF2Tab tab, uint64_t x) {
+    uint64_t res = 0;
+    for(uint32_t t = 0; t < 8; ++t, x >>= 8)
+        res ^= tab[t][x & 0xFF];
+    return res;
+}
+
+/* usage: Given a R64MGF2 matrix m and a container, compute the Gramian
+ *      matrix of m, i.e. m.transpose() * m, and store it into the container.
+ * params:
+ *      1) m: ptr to a struct R64MGF2
+ *      2) p: ptr to a struct RC64MGF2, container for the result
+ * return: void */
+void
+r64m_gf2_gramian(const R64MGF2* restrict m, RC64MGF2* restrict p) {
+    // each row is accumulated into the bucket of its bits 8j ~ 8j+7, and the
+    // buckets are summed up by bit afterwards
+    R64MGF2Tab acc;
+    memset(acc, 0x0, sizeof(acc));
+    for(uint64_t i = 0; i < m->rnum; ++i) {
+        uint64_t x = m->rows[i];
+        for(uint32_t t = 0; t < 8; ++t)
+            acc[t][(x >> (8 * t)) & 0xFF] ^= x;
+    }
+
+    for(uint32_t t = 0; t < 8; ++t) {
+        for(uint32_t j = 0; j < 8; ++j) {
+            uint64_t row = 0;
+            for(uint32_t b = 0; b < 256; ++b) {
+                if((b >> j) & 0x1)
+                    row ^= acc[t][b];
+            }
+            p->rows[8 * t + j] = row;
+        }
+    }
+}
+
+/* usage: Given 2 R64MGF2 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+r64m_gf2_mixi(R64MGF2* restrict a, const R64MGF2* restrict b, uint64_t di) {
+    assert(a->rnum == b->rnum);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        a->rows[i] = (a->rows[i] & di) | (b->rows[i] & ~di);
+}
+
+/* usage: Given 2 R64MGF2 A and B, and a RC64MGF2 C, compute A - B * C and
+ *      store the result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ * return: void */
+void
+r64m_gf2_fms(R64MGF2* restrict a, const R64MGF2* restrict b,
+             const RC64MGF2* restrict c) {
+    r64m_gf2_fms_diag(a, b, c, UINT64_MAX);
+}
+
+/* usage: Given 2 R64MGF2 A and B, a RC64MGF2 C, and a 64x64 diagonal matrix D
+ *      with coefficients either 1 and 0, compute A - B * C * D and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf2_fms_diag(R64MGF2* restrict a, const R64MGF2* restrict b,
+                  const RC64MGF2* restrict c, uint64_t d) {
+    assert(a->rnum == b->rnum);
+    R64MGF2Tab tab;
+    r64m_gf2_tab_init(tab, c, d);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        a->rows[i] ^= r64m_gf2_tab_mul(tab, b->rows[i]);
+}
+
+/* usage: Given 2 R64MGF2 A and B, a RC64MGF2 C, and a 64x64 diagonal matrix D
+ *      with coefficients either 1 and 0, compute A * D + B * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf2_diag_fma(R64MGF2* restrict a, const R64MGF2* restrict b,
+                  const RC64MGF2* restrict c, uint64_t d) {
+    assert(a->rnum == b->rnum);
+    R64MGF2Tab tab;
+    r64m_gf2_tab_init(tab, c, UINT64_MAX);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        a->rows[i] = (a->rows[i] & d) ^ r64m_gf2_tab_mul(tab, b->rows[i]);
+}
+
+/* usage: Given a R64MGF2 A and a RC64MGF2 C, compute A * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) c: ptr to struct RC64MGF2, storing the matrix C
+ * return: void */
+void
+r64m_gf2_muli(R64MGF2* restrict a, const RC64MGF2* restrict c) {
+    R64MGF2Tab tab;
+    r64m_gf2_tab_init(tab, c, UINT64_MAX);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        a->rows[i] = r64m_gf2_tab_mul(tab, a->rows[i]);
+}
@@ -0,0 +1,157 @@
+#ifndef __R64M_GF2_H__
+#define __R64M_GF2_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rc64m_gf2.h"
+#include "util.h"
+
+// N x 64 matrix over GF(2), stored row by row with 1 bit per entry. If the
+// j-th bit of the i-th row is set, then entry (i, j) is 1.
+typedef struct R64MGF2 R64MGF2;
+
+// argument of the workers that operate on a strip of rows of R64MGF2
+typedef struct {
+    R64MGF2* restrict a;
+    const R64MGF2* restrict b;
+    const void* restrict c; // usually the sparse matrix
+    R64MGF2* restrict d; // partial result
+    uint64_t sidx;
+    uint64_t eidx;
+    void* restrict ptr; // a generic ptr
+} R64MGF2PArg;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Compute the size of memory needed for R64MGF2
+ * params:
+ *      1) rnum: number of rows
+ * return: size of memory needed in bytes */
+uint64_t
+r64m_gf2_memsize(uint64_t rnum);
+
+/* usage: Create a R64MGF2 matrix. The matrix is not initialized
+ * params:
+ *      1) rnum: number of rows
+ * return: ptr to struct R64MGF2. NULL on faliure */
+R64MGF2*
+r64m_gf2_create(uint64_t rnum);
+
+/* usage: Release a struct R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_free(R64MGF2* m);
+
+/* usage: Return the number of rows of a R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: number of rows */
+uint64_t
+r64m_gf2_rnum(const R64MGF2* m);
+
+/* usage: Return the address of the i-th row of a R64MGF2
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ *      2) i: index of the row
+ * return: ptr to the row */
+uint64_t*
+r64m_gf2_raddr(R64MGF2* m, uint64_t i);
+
+/* usage: Set a R64MGF2 matrix to zero
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_zero(R64MGF2* m);
+
+/* usage: Fill a R64MGF2 matrix with random values
+ * params:
+ *      1) m: ptr to struct R64MGF2
+ * return: void */
+void
+r64m_gf2_rand(R64MGF2* m);
+
+/* usage: Given 2 R64MGF2 A and B, compute A + B and store the result back
+ *      into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ * return: void */
+void
+r64m_gf2_addi(R64MGF2* restrict a, const R64MGF2* restrict b);
+
+/* usage: Given a R64MGF2 matrix m and a container, compute the Gramian
+ *      matrix of m, i.e. m.transpose() * m, and store it into the container.
+ * params:
+ *      1) m: ptr to a struct R64MGF2
+ *      2) p: ptr to a struct RC64MGF2, container for the result
+ * return: void */
+void
+r64m_gf2_gramian(const R64MGF2* restrict m, RC64MGF2* restrict p);
+
+/* usage: Given 2 R64MGF2 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+r64m_gf2_mixi(R64MGF2* restrict a, const R64MGF2* restrict b, uint64_t di);
+
+/* usage: Given 2 R64MGF2 A and B, and a RC64MGF2 C, compute A - B * C and
+ *      store the result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ * return: void */
+void
+r64m_gf2_fms(R64MGF2* restrict a, const R64MGF2* restrict b,
+             const RC64MGF2* restrict c);
+
+/* usage: Given 2 R64MGF2 A and B, a RC64MGF2 C, and a 64x64 diagonal matrix D
+ *      with coefficients either 1 and 0, compute A - B * C * D and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf2_fms_diag(R64MGF2* restrict a, const R64MGF2* restrict b,
+                  const RC64MGF2* restrict c, uint64_t d);
+
+/* usage: Given 2 R64MGF2 A and B, a RC64MGF2 C, and a 64x64 diagonal matrix D
+ *      with coefficients either 1 and 0, compute A * D + B * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) b: ptr to struct R64MGF2, storing the matrix B
+ *      3) c: ptr to struct RC64MGF2, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf2_diag_fma(R64MGF2* restrict a, const R64MGF2* restrict b,
+                  const RC64MGF2* restrict c, uint64_t d);
+
+/* usage: Given a R64MGF2 A and a RC64MGF2 C, compute A * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF2, storing the matrix A
+ *      2) c: ptr to struct RC64MGF2, storing the matrix C
+ * return: void */
+void
+r64m_gf2_muli(R64MGF2* restrict a, const RC64MGF2* restrict c);
+
+#endif // __R64M_GF2_H__
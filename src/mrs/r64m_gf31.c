@@ -0,0 +1,251 @@
+#include "r64m_gf31.h"
+#include "uint64a.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+
+/* ========================================================================
+ * struct R64MGF31 definition
+ * ======================================================================== */
+
+struct R64MGF31 {
+    uint64_t rnum;
+    alignas(64) gf31_t rows[][64];
+};
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Compute the size of memory needed for R64MGF31
+ * params:
+ *      1) rnum: number of rows
+ * return: size of memory needed in bytes */
+uint64_t
+r64m_gf31_memsize(uint64_t rnum) {
+    return sizeof(R64MGF31) + sizeof(gf31_t) * 64 * rnum;
+}
+
+/* usage: Create a R64MGF31 matrix. The matrix is not initialized
+ * params:
+ *      1) rnum: number of rows
+ * return: ptr to struct R64MGF31. NULL on faliure */
+R64MGF31*
+r64m_gf31_create(uint64_t rnum) {
+    R64MGF31* m = aligned_alloc(64, r64m_gf31_memsize(rnum));
+    if(!m)
+        return NULL;
+
+    m->rnum = rnum;
+    return m;
+}
+
+/* usage: Release a struct R64MGF31
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ * return: void */
+void
+r64m_gf31_free(R64MGF31* m) {
+    free(m);
+}
+
+/* usage: Return the number of rows of a R64MGF31
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ * return: number of rows */
+uint64_t
+r64m_gf31_rnum(const R64MGF31* m) {
+    return m->rnum;
+}
+
+/* usage: Return the address of the i-th row of a R64MGF31
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ *      2) i: index of the row
+ * return: ptr to the row, an array of 64 gf31_t */
+gf31_t*
+r64m_gf31_raddr(R64MGF31* m, uint64_t i) {
+    return m->rows[i];
+}
+
+/* usage: Set a R64MGF31 matrix to zero
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ * return: void */
+void
+r64m_gf31_zero(R64MGF31* m) {
+    memset(m->rows, 0x0, sizeof(gf31_t) * 64 * m->rnum);
+}
+
+/* usage: Turn a R64MGF31 matrix filled with random bytes into one with random
+ *      values
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ * return: void */
+void
+r64m_gf31_fold(R64MGF31* m) {
+    // 5 random bits per entry, where 31 is folded into 0. The slight bias
+    // doesn't matter for the starting point of Block Lanczos
+    uint8_t* buf = (uint8_t*) m->rows;
+    for(uint64_t i = 0; i < 64 * m->rnum; ++i) {
+        uint8_t x = buf[i] & 0x1F;
+        buf[i] = (x == GF31_SIZE) ? 0 : x;
+    }
+}
+
+/* usage: Fill a R64MGF31 matrix with random values
+ * params:
+ *      1) m: ptr to struct R64MGF31
+ * return: void */
+void
+r64m_gf31_rand(R64MGF31* m) {
+    uint64a_rand((uint64_t*) m->rows, 8 * m->rnum);
+    r64m_gf31_fold(m);
+}
+
+/* usage: Given 2 R64MGF31 A and B, compute A + B and store the result back
+ *      into A
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) b: ptr to struct R64MGF31, storing the matrix B
+ * return: void */
+void
+r64m_gf31_addi(R64MGF31* restrict a, const R64MGF31* restrict b) {
+    assert(a->rnum == b->rnum);
+    for(uint64_t i = 0; i < a->rnum; ++i)
+        gf31_t_arr_addi_64(a->rows[i], b->rows[i]);
+}
+
+/* usage: Given a R64MGF31 matrix m and a container, compute the Gramian
+ *      matrix of m, i.e. m.transpose() * m, and store it into the container.
+ * params:
+ *      1) m: ptr to a struct R64MGF31
+ *      2) p: ptr to a struct RC64MGF31, container for the result
+ * return: void */
+void
+r64m_gf31_gramian(const R64MGF31* restrict m, RC64MGF31* restrict p) {
+    // the j-th row of the result accumulates the rows of m scaled by their
+    // j-th entry, and is reduced once every GF31_ACC_TERMS rows
+    alignas(64) uint16_t acc[64][64];
+    memset(acc, 0x0, sizeof(acc));
+    for(uint64_t i = 0; i < m->rnum; ++i) {
+        const gf31_t* row = m->rows[i];
+        for(uint32_t j = 0; j < 64; ++j)
+            gf31_t_arr_acc_fmaddi_scalar64(acc[j], row, row[j]);
+        if((i + 1) % GF31_ACC_TERMS == 0) {
+            for(uint32_t j = 0; j < 64; ++j)
+                gf31_t_arr_acc_reduc64(acc[j]);
+        }
+    }
+    for(uint32_t j = 0; j < 64; ++j)
+        gf31_t_arr_from_acc64(p->rows[j], acc[j]);
+}
+
+/* subroutine of the column operations: expand a 64-bit integer into a mask
+ *      of 64 bytes */
+static inline void
+r64m_gf31_byte_mask(uint8_t* restrict mask, uint64_t d) {
+    for(uint32_t j = 0; j < 64; ++j)
+        mask[j] = ((d >> j) & 0x1ULL) ? 0xFF : 0x0;
+}
+
+/* usage: Given 2 R64MGF31 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) b: ptr to struct R64MGF31, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+r64m_gf31_mixi(R64MGF31* restrict a, const R64MGF31* restrict b, uint64_t di) {
+    assert(a->rnum == b->rnum);
+    alignas(64) uint8_t mask[64];
+    r64m_gf31_byte_mask(mask, di);
+    for(uint64_t i = 0; i < a->rnum; ++i) {
+        for(uint32_t j = 0; j < 64; ++j)
+            a->rows[i][j] = (a->rows[i][j] & mask[j]) |
+                            (b->rows[i][j] & ~mask[j]);
+    }
+}
+
+/* usage: Given 2 R64MGF31 A and B, and a RC64MGF31 C, compute A - B * C and
+ *      store the result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) b: ptr to struct R64MGF31, storing the matrix B
+ *      3) c: ptr to struct RC64MGF31, storing the matrix C
+ * return: void */
+void
+r64m_gf31_fms(R64MGF31* restrict a, const R64MGF31* restrict b,
+              const RC64MGF31* restrict c) {
+    r64m_gf31_fms_diag(a, b, c, UINT64_MAX);
+}
+
+/* usage: Given 2 R64MGF31 A and B, a RC64MGF31 C, and a 64x64 diagonal matrix
+ *      D with coefficients either 1 and 0, compute A - B * C * D and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) b: ptr to struct R64MGF31, storing the matrix B
+ *      3) c: ptr to struct RC64MGF31, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf31_fms_diag(R64MGF31* restrict a, const R64MGF31* restrict b,
+                   const RC64MGF31* restrict c, uint64_t d) {
+    assert(a->rnum == b->rnum);
+    alignas(64) uint16_t w[64 * 64];
+    alignas(64) uint16_t acc[64];
+    rc64m_gf31_widen(w, c, d);
+    for(uint64_t i = 0; i < a->rnum; ++i) {
+        gf31_t_arr_acc_vec_mul64(acc, b->rows[i], w);
+        gf31_t_arr_subi_acc64(a->rows[i], acc);
+    }
+}
+
+/* usage: Given 2 R64MGF31 A and B, a RC64MGF31 C, and a 64x64 diagonal matrix
+ *      D with coefficients either 1 and 0, compute A * D + B * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) b: ptr to struct R64MGF31, storing the matrix B
+ *      3) c: ptr to struct RC64MGF31, storing the matrix C
+ *      4) d: a 64-bit integer that encodes the diagonal matrix D. If the LSB
+ *          is 1, then entry (0, 0) of D is 1. Otherwise 0.
+ * return: void */
+void
+r64m_gf31_diag_fma(R64MGF31* restrict a, const R64MGF31* restrict b,
+                   const RC64MGF31* restrict c, uint64_t d) {
+    assert(a->rnum == b->rnum);
+    alignas(64) uint16_t w[64 * 64];
+    alignas(64) uint16_t acc[64];
+    alignas(64) uint8_t mask[64];
+    rc64m_gf31_widen(w, c, UINT64_MAX);
+    r64m_gf31_byte_mask(mask, d);
+    for(uint64_t i = 0; i < a->rnum; ++i) {
+        for(uint32_t j = 0; j < 64; ++j)
+            a->rows[i][j] &= mask[j];
+        gf31_t_arr_acc_vec_mul64(acc, b->rows[i], w);
+        gf31_t_arr_addi_acc64(a->rows[i], acc);
+    }
+}
+
+/* usage: Given a R64MGF31 A and a RC64MGF31 C, compute A * C and store the
+ *      result back into A
+ * params:
+ *      1) a: ptr to struct R64MGF31, storing the matrix A
+ *      2) c: ptr to struct RC64MGF31, storing the matrix C
+ * return: void */
+void
+r64m_gf31_muli(R64MGF31* restrict a, const RC64MGF31* restrict c) {
+    alignas(64) uint16_t w[64 * 64];
+    alignas(64) uint16_t acc[64];
+    rc64m_gf31_widen(w, c, UINT64_MAX);
+    for(uint64_t i = 0; i < a->rnum; ++i) {
+        gf31_t_arr_acc_vec_mul64(acc, a->rows[i], w);
+        gf31_t_arr_from_acc64(a->rows[i], acc);
+    }
+}
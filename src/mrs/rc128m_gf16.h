@@ -163,6 +163,20 @@ void
 rc128m_gf16_gj(RC128MGF16* restrict m, RC128MGF16* restrict inv,
                uint128_t* restrict di);
 
+/* usage: Reference implementation of rc128m_gf16_gj(). The pivot is searched
+ *      element by element and every row is reduced serially. Kept for
+ *      benchmarking and cross-checking.
+ * params:
+ *      1) m: ptr to a struct RC128MGF16
+ *      2) inv: ptr to a struct RC128MGF16
+ *      3) di: ptr to an uint128_t, when the function returns di encodes the
+ *              independent columns. If the 1st column is independent, then the
+ *              1st bit (0x1ULL) is set, and so on.
+ * return: void */
+void
+rc128m_gf16_gj_naive(RC128MGF16* restrict m, RC128MGF16* restrict inv,
+                     uint128_t* restrict di);
+
 #if defined(__AVX2__)
 
 __m256i
@@ -1,4 +1,6 @@
 #include "rc512m_gf16.h"
+#include "thpool.h"
+#include <pthread.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -248,11 +250,9 @@ rc512m_gf16_row_reduc(Grp512GF16* restrict dst_row,
     grp512_gf16_fmsubi_scalar(dst_inv_row, inv_row, mul_scalar);
 }
 
-/* usage: Given a RC512MGF16 m, perform Gauss-Jordan elimination on it to
- *      identify independent columns, which form an invertible submatrix. The
- *      inverse can also be computed if the caller passes an identity matrix as
- *      inv. Alternatively, if the caller passes the constant column as inv,
- *      the solution of solvable systems can be computed.
+/* usage: Reference implementation of rc512m_gf16_gj(). The pivot is searched
+ *      element by element and every row is reduced serially. Kept for
+ *      benchmarking and cross-checking.
  * params:
  *      1) m: ptr to a struct RC512MGF16
  *      2) inv: ptr to a struct RC512MGF16
@@ -261,8 +261,8 @@ rc512m_gf16_row_reduc(Grp512GF16* restrict dst_row,
  *              1st bit (0x1ULL) is set, and so on.
  * return: void */
 void
-rc512m_gf16_gj(RC512MGF16* restrict m, RC512MGF16* restrict inv,
-               uint512_t* restrict di) {
+rc512m_gf16_gj_naive(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                     uint512_t* restrict di) {
     uint512_t_max(di);
     gf16_t inv_coeff;
     for(uint32_t i = 0; i < 512; ++i) { // for each pivot
@@ -303,6 +303,304 @@ rc512m_gf16_gj(RC512MGF16* restrict m, RC512MGF16* restrict inv,
     }
 }
 
+/* usage: subroutine of rc512m_gf16_gj: given the non-zero masks of all rows,
+ *      collect the rows whose i-th element is non-zero. Branch-free.
+ * params:
+ *      1) out: ptr to uint512_t. If the i-th element of the r-th row is
+ *          non-zero, then the r-th bit is set.
+ *      2) nz: an array of 512 uint512_t; the non-zero masks of the rows
+ *      3) i: index of the column
+ * return: void */
+static inline void
+rc512m_gf16_col_nzpos(uint512_t* restrict out, const uint512_t* restrict nz,
+                      uint32_t i) {
+    const uint32_t slot = i >> 6;
+    const uint32_t sh = i & 0x3F;
+    for(uint32_t k = 0; k < 8; ++k) {
+        const uint512_t* src = nz + (k << 6);
+        uint64_t v = 0;
+        for(uint32_t r = 0; r < 64; ++r)
+            v |= ((src[r].s[slot] >> sh) & 0x1ULL) << r;
+        out->s[k] = v;
+    }
+}
+
+/* usage: subroutine of rc512m_gf16_gj: return the index of the first set bit
+ *      in a non-zero uint512_t
+ * params:
+ *      1) a: ptr to struct uint512_t. Must not be zero
+ * return: index of the first set bit */
+static inline uint32_t
+rc512m_gf16_first_sb(const uint512_t* a) {
+    uint32_t k = 0;
+    while(!a->s[k])
+        ++k;
+    return (k << 6) + uint64_t_ctz(a->s[k]);
+}
+
+/* usage: subroutine of rc512m_gf16_gj: move the pivot rows into place.
+ *      Afterwards the pivot row of the i-th column is the i-th row, while the
+ *      remaining rows fill the positions of the singular columns.
+ * params:
+ *      1) m: ptr to struct RC512MGF16
+ *      2) inv: ptr to struct RC512MGF16, permuted in the same way as m
+ *      3) src: an array of 512 uint16_t. The i-th row of the result is the
+ *          src[i]-th row of m before the permutation. Will be overwritten.
+ * return: void */
+static inline void
+rc512m_gf16_permute_rows(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                         uint16_t* restrict src) {
+    Grp512GF16 tmp0, tmp1;
+    for(uint32_t i = 0; i < 512; ++i) {
+        if(src[i] == i)
+            continue;
+        // follow the cycle that starts at i
+        grp512_gf16_copy(&tmp0, rc512m_gf16_raddr(m, i));
+        grp512_gf16_copy(&tmp1, rc512m_gf16_raddr(inv, i));
+        uint32_t j = i;
+        while(src[j] != i) {
+            grp512_gf16_copy(rc512m_gf16_raddr(m, j), rc512m_gf16_raddr(m, src[j]));
+            grp512_gf16_copy(rc512m_gf16_raddr(inv, j),
+                             rc512m_gf16_raddr(inv, src[j]));
+            uint32_t next = src[j];
+            src[j] = j;
+            j = next;
+        }
+        grp512_gf16_copy(rc512m_gf16_raddr(m, j), &tmp0);
+        grp512_gf16_copy(rc512m_gf16_raddr(inv, j), &tmp1);
+        src[j] = j;
+    }
+}
+
+/* usage: subroutine of rc512m_gf16_gj: given a row, compute its products
+ *      with all 16 elements of GF(16)
+ * params:
+ *      1) tbl: an array of 16 Grp512GF16. tbl[1] must hold the row, and upon
+ *          return tbl[c] = row * c
+ * return: void */
+static inline void
+rc512m_gf16_mul_tbl(Grp512GF16* tbl) {
+    grp512_gf16_zero(tbl);
+    grp512_gf16_mul_scalar(tbl + 2, tbl + 1, 2);
+    grp512_gf16_mul_scalar(tbl + 4, tbl + 1, 4);
+    grp512_gf16_mul_scalar(tbl + 8, tbl + 1, 8);
+    for(uint32_t hb = 2; hb < 16; hb <<= 1) {
+        for(uint32_t lb = 1; lb < hb; ++lb) {
+            grp512_gf16_copy(tbl + (hb | lb), tbl + hb);
+            grp512_gf16_addi(tbl + (hb | lb), tbl + lb);
+        }
+    }
+}
+
+typedef struct {
+    RC512MGF16* restrict m;
+    RC512MGF16* restrict inv;
+    uint512_t* restrict nz; // non-zero masks of all rows
+    uint512_t* restrict di;
+    uint512_t* restrict unused; // rows that are not pivots at the end
+    uint16_t* restrict src; // src[i]: the pivot row of the i-th column
+    pthread_barrier_t* bar; // NULL if single-threaded
+    uint32_t sidx; // rows [sidx, eidx) are reduced by this worker
+    uint32_t eidx;
+    bool leader; // whether this worker records di, src and unused
+} RC512MGF16GJArg;
+
+/* usage: subroutine of rc512m_gf16_gj: run the elimination on a strip of rows.
+ *      Every worker searches the pivots independently from the shared
+ *      non-zero masks, so the only synchronization needed is 2 barriers per
+ *      pivot: one before the pivot row is normalized in place, and one before
+ *      the non-zero masks are read again.
+ * params:
+ *      1) __arg: ptr to RC512MGF16GJArg
+ * return: void */
+static void
+rc512m_gf16_gj_worker(void* __arg) {
+    const RC512MGF16GJArg* arg = (RC512MGF16GJArg*) __arg;
+    RC512MGF16* m = arg->m;
+    RC512MGF16* inv = arg->inv;
+    uint512_t* nz = arg->nz;
+
+    // all multiples of the normalized pivot rows, so that reducing a row
+    // becomes a table lookup and an addition
+    Grp512GF16 mtbl[16], itbl[16];
+    uint16_t ridxs[512 + 32]; // sbpos may write past the last index
+    uint512_t unused; uint512_t_max(&unused);
+    for(uint32_t i = 0; i < 512; ++i) { // for each pivot
+        uint512_t col, cand;
+        rc512m_gf16_col_nzpos(&col, nz, i);
+        uint512_t_and(&cand, &col, &unused);
+        if(uint512_t_is_zero(&cand)) { // singular column
+            if(arg->leader) {
+                uint512_t_toggle_at(arg->di, i);
+                arg->src[i] = UINT16_MAX;
+            }
+            continue;
+        }
+
+        const uint32_t pvt_ri = rc512m_gf16_first_sb(&cand);
+        uint512_t_clear_at(&unused, pvt_ri);
+        if(arg->leader)
+            arg->src[i] = pvt_ri;
+
+        Grp512GF16* pvt_row = rc512m_gf16_raddr(m, pvt_ri);
+        Grp512GF16* inv_row = rc512m_gf16_raddr(inv, pvt_ri);
+        gf16_t inv_coeff = gf16_t_inv(grp512_gf16_at(pvt_row, i));
+        grp512_gf16_mul_scalar(mtbl + 1, pvt_row, inv_coeff);
+        grp512_gf16_mul_scalar(itbl + 1, inv_row, inv_coeff);
+        if(arg->bar)
+            pthread_barrier_wait(arg->bar);
+
+        if(arg->sidx <= pvt_ri && pvt_ri < arg->eidx) {
+            grp512_gf16_copy(pvt_row, mtbl + 1);
+            grp512_gf16_copy(inv_row, itbl + 1);
+        }
+        rc512m_gf16_mul_tbl(mtbl);
+        rc512m_gf16_mul_tbl(itbl);
+
+        // only rows with a non-zero element in the pivot column need to be
+        // reduced
+        uint512_t_clear_at(&col, pvt_ri);
+        uint32_t rnum = uint512_t_sbpos(&col, ridxs);
+        for(uint32_t k = 0; k < rnum; ++k) {
+            const uint32_t ri = ridxs[k];
+            if(ri < arg->sidx)
+                continue;
+            if(ri >= arg->eidx)
+                break;
+            Grp512GF16* row = rc512m_gf16_raddr(m, ri);
+            gf16_t c = grp512_gf16_at(row, i);
+            // subtraction is the same as addition in GF(16)
+            grp512_gf16_addi(row, mtbl + c);
+            grp512_gf16_addi(rc512m_gf16_raddr(inv, ri), itbl + c);
+            grp512_gf16_nzpos(nz + ri, row);
+        }
+        if(arg->bar)
+            pthread_barrier_wait(arg->bar);
+    }
+
+    if(arg->leader)
+        uint512_t_copy(arg->unused, &unused);
+}
+
+/* usage: subroutine of rc512m_gf16_gj: move the remaining rows to the
+ *      positions of the singular columns and then permute the rows
+ * params:
+ *      1) m: ptr to a struct RC512MGF16
+ *      2) inv: ptr to a struct RC512MGF16
+ *      3) src: an array of 512 uint16_t filled by rc512m_gf16_gj_worker
+ *      4) unused: ptr to uint512_t; rows that are not pivots
+ * return: void */
+static inline void
+rc512m_gf16_gj_finalize(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                        uint16_t* restrict src, const uint512_t* unused) {
+    uint16_t left[512 + 32];
+    uint32_t lnum = uint512_t_sbpos(unused, left);
+    for(uint32_t i = 0, j = 0; i < 512; ++i) {
+        if(src[i] == UINT16_MAX) {
+            assert(j < lnum);
+            src[i] = left[j++];
+        }
+    }
+    (void) lnum;
+    rc512m_gf16_permute_rows(m, inv, src);
+}
+
+/* usage: Given a RC512MGF16 m, perform Gauss-Jordan elimination on it to
+ *      identify independent columns, which form an invertible submatrix. The
+ *      inverse can also be computed if the caller passes an identity matrix as
+ *      inv. Alternatively, if the caller passes the constant column as inv,
+ *      the solution of solvable systems can be computed.
+ *
+ *      The non-zero mask of every row is cached, so the pivot search and the
+ *      choice of rows to reduce are plain bit operations. All 16 multiples of
+ *      the pivot row are precomputed, so a row is reduced with a lookup and an
+ *      addition. The row swaps are deferred to a single permutation at the
+ *      end. Unlike rc512m_gf16_gj_naive(), the rows left at singular columns
+ *      can still be picked as pivots later, so all independent columns are
+ *      found.
+ * params:
+ *      1) m: ptr to a struct RC512MGF16
+ *      2) inv: ptr to a struct RC512MGF16
+ *      3) di: ptr to an uint512_t, when the function returns di encodes the
+ *              independent columns. If the 1st column is independent, then the
+ *              1st bit (0x1ULL) is set, and so on.
+ * return: void */
+void
+rc512m_gf16_gj(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+               uint512_t* restrict di) {
+    uint512_t* nz = aligned_alloc(64, sizeof(uint512_t) * 512);
+    if(!nz) { // fall back to the version without extra memory
+        rc512m_gf16_gj_naive(m, inv, di);
+        return;
+    }
+    for(uint32_t r = 0; r < 512; ++r)
+        grp512_gf16_nzpos(nz + r, rc512m_gf16_raddr(m, r));
+
+    uint512_t_max(di);
+    uint16_t src[512];
+    uint512_t unused;
+    RC512MGF16GJArg arg = {
+        .m = m, .inv = inv, .nz = nz, .di = di, .unused = &unused, .src = src,
+        .bar = NULL, .sidx = 0, .eidx = 512, .leader = true,
+    };
+    rc512m_gf16_gj_worker(&arg);
+    rc512m_gf16_gj_finalize(m, inv, src, &unused);
+    free(nz);
+}
+
+/* usage: Same as rc512m_gf16_gj() but the row reduction is split across
+ *      threads. Each thread owns a strip of rows for the whole elimination.
+ * params:
+ *      1) m: ptr to a struct RC512MGF16
+ *      2) inv: ptr to a struct RC512MGF16
+ *      3) di: ptr to an uint512_t, when the function returns di encodes the
+ *              independent columns. If the 1st column is independent, then the
+ *              1st bit (0x1ULL) is set, and so on.
+ *      4) tnum: number of threads to use. The threadpool must have at least
+ *              tnum workers, since the workers wait for each other.
+ *      5) tp: ptr to a struct Threadpool
+ * return: void */
+void
+rc512m_gf16_gj_parallel(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                        uint512_t* restrict di, uint32_t tnum,
+                        Threadpool* restrict tp) {
+    if(tnum > 64)
+        tnum = 64; // at least 8 rows per strip
+    uint512_t* nz = aligned_alloc(64, sizeof(uint512_t) * 512);
+    pthread_barrier_t bar;
+    if(tnum <= 1 || !nz || pthread_barrier_init(&bar, NULL, tnum)) {
+        free(nz);
+        rc512m_gf16_gj(m, inv, di);
+        return;
+    }
+    for(uint32_t r = 0; r < 512; ++r)
+        grp512_gf16_nzpos(nz + r, rc512m_gf16_raddr(m, r));
+
+    uint512_t_max(di);
+    uint16_t src[512];
+    uint512_t unused;
+    RC512MGF16GJArg args[64];
+    const uint32_t strip_sz = 512 / tnum;
+    for(uint32_t i = 0; i < tnum; ++i) {
+        args[i].m = m;
+        args[i].inv = inv;
+        args[i].nz = nz;
+        args[i].di = di;
+        args[i].unused = &unused;
+        args[i].src = src;
+        args[i].bar = &bar;
+        args[i].sidx = i * strip_sz;
+        args[i].eidx = (i == tnum - 1) ? 512 : (i + 1) * strip_sz;
+        args[i].leader = (i == 0);
+        thpool_add_job(tp, rc512m_gf16_gj_worker, args + i);
+    }
+    thpool_wait_jobs(tp);
+    pthread_barrier_destroy(&bar);
+
+    rc512m_gf16_gj_finalize(m, inv, src, &unused);
+    free(nz);
+}
+
 /* usage: Given 2 struct RC512MGF16 m and n, compute m*n and store the result
  *      into p
  * params:
@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include "gf16.h"
 #include "grp512_gf16.h"
+#include "thpool.h"
 
 typedef struct RC512MGF16 RC512MGF16;
 
@@ -121,6 +122,37 @@ void
 rc512m_gf16_gj(RC512MGF16* restrict m, RC512MGF16* restrict inv,
                uint512_t* restrict di);
 
+/* usage: Same as rc512m_gf16_gj() but the row reduction is split across
+ *      threads. Each thread owns a strip of rows for the whole elimination.
+ * params:
+ *      1) m: ptr to a struct RC512MGF16
+ *      2) inv: ptr to a struct RC512MGF16
+ *      3) di: ptr to an uint512_t, when the function returns di encodes the
+ *              independent columns. If the 1st column is independent, then the
+ *              1st bit (0x1ULL) is set, and so on.
+ *      4) tnum: number of threads to use. The threadpool must have at least
+ *              tnum workers, since the workers wait for each other.
+ *      5) tp: ptr to a struct Threadpool
+ * return: void */
+void
+rc512m_gf16_gj_parallel(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                        uint512_t* restrict di, uint32_t tnum,
+                        Threadpool* restrict tp);
+
+/* usage: Reference implementation of rc512m_gf16_gj(). The pivot is searched
+ *      element by element and every row is reduced serially. Kept for
+ *      benchmarking and cross-checking.
+ * params:
+ *      1) m: ptr to a struct RC512MGF16
+ *      2) inv: ptr to a struct RC512MGF16
+ *      3) di: ptr to an uint512_t, when the function returns di encodes the
+ *              independent columns. If the 1st column is independent, then the
+ *              1st bit (0x1ULL) is set, and so on.
+ * return: void */
+void
+rc512m_gf16_gj_naive(RC512MGF16* restrict m, RC512MGF16* restrict inv,
+                     uint512_t* restrict di);
+
 /* usage: Given 2 struct RC512MGF16 m and n, compute m*n and store the result
  *      into p
  * params:
@@ -0,0 +1,154 @@
+#include "rc64m_gf2.h"
+#include "uint64a.h"
+#include <string.h>
+#include <assert.h>
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Given a struct RC64MGF2, set it to the identity matrix
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_identity(RC64MGF2* m) {
+    for(uint32_t i = 0; i < 64; ++i)
+        m->rows[i] = 0x1ULL << i;
+}
+
+/* usage: Given a struct RC64MGF2, set it to zero
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_zero(RC64MGF2* m) {
+    memset(m->rows, 0x0, sizeof(m->rows));
+}
+
+/* usage: Given a struct RC64MGF2, check if it's symmetric
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: true if symmetric, false otherwise */
+bool
+rc64m_gf2_is_symmetric(const RC64MGF2* m) {
+    for(uint32_t i = 0; i < 64; ++i) {
+        for(uint32_t j = i + 1; j < 64; ++j) {
+            if(((m->rows[i] >> j) ^ (m->rows[j] >> i)) & 0x1ULL)
+                return false;
+        }
+    }
+    return true;
+}
+
+/* subroutine of rc64m_gf2_gj: try to add the i-th column of m to the basis
+ *      of the columns selected so far. Each basis vector is stored at the
+ *      index of its lowest set bit. Return true if the column is independent
+ *      of the basis */
+static inline bool
+rc64m_gf2_basis_insert(uint64_t* restrict basis, uint64_t x) {
+    while(x) {
+        uint64_t p = uint64_t_ctz(x);
+        if(!basis[p]) {
+            basis[p] = x;
+            return true;
+        }
+        x ^= basis[p]; // clears bit p, only touches the higher bits
+    }
+    return false;
+}
+
+/* usage: Given a symmetric RC64MGF2 m, select a subset S of its columns such
+ *      that the submatrix with rows and columns in S is invertible and has
+ *      the same rank as m, and compute the inverse of that submatrix. The
+ *      columns not in pref are selected first, which is the choice that keeps
+ *      the Lanczos vectors of consecutive iterations independent over GF(2).
+ * params:
+ *      1) m: ptr to a struct RC64MGF2, must be symmetric
+ *      2) inv: ptr to a struct RC64MGF2, container for the inverse. The rows
+ *          and columns not in S are cleared to zero
+ *      3) di: ptr to an uint64_t, when the function returns di encodes S. If
+ *          the 1st column is selected, then the 1st bit (0x1ULL) is set, and
+ *          so on.
+ *      4) pref: a 64-bit integer that encodes the columns to consider last,
+ *          usually the selection of the previous iteration
+ * return: void */
+void
+rc64m_gf2_gj(const RC64MGF2* restrict m, RC64MGF2* restrict inv,
+             uint64_t* restrict di, uint64_t pref) {
+    // a basis of the column space of a symmetric matrix indexes an invertible
+    // principal submatrix, so the columns are selected greedily
+    uint64_t basis[64] = {0};
+    uint64_t s = 0;
+    const uint64_t order[2] = { ~pref, pref };
+    for(uint32_t k = 0; k < 2; ++k) {
+        for(uint64_t cols = order[k]; cols; cols = uint64_t_clear_lsb(cols)) {
+            uint64_t c = uint64_t_ctz(cols);
+            if(rc64m_gf2_basis_insert(basis, m->rows[c]))
+                s |= 0x1ULL << c;
+        }
+    }
+
+    // Gauss-Jordan on the submatrix, and apply the same to the identity
+    uint64_t a[64], b[64], pvt[64];
+    for(uint64_t rows = s; rows; rows = uint64_t_clear_lsb(rows)) {
+        uint64_t r = uint64_t_ctz(rows);
+        a[r] = m->rows[r] & s;
+        b[r] = 0x1ULL << r;
+    }
+    uint64_t free_rows = s;
+    for(uint64_t cols = s; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        uint64_t cand = free_rows;
+        while(cand && !((a[uint64_t_ctz(cand)] >> c) & 0x1ULL))
+            cand = uint64_t_clear_lsb(cand);
+        assert(cand); // the submatrix is invertible
+        uint64_t r = uint64_t_ctz(cand);
+        free_rows ^= 0x1ULL << r;
+        pvt[c] = r;
+        for(uint64_t rows = s ^ (0x1ULL << r); rows;
+            rows = uint64_t_clear_lsb(rows)) {
+            uint64_t j = uint64_t_ctz(rows);
+            if((a[j] >> c) & 0x1ULL) {
+                a[j] ^= a[r];
+                b[j] ^= b[r];
+            }
+        }
+    }
+
+    // the pivot rows now form a permutation matrix, which is undone here
+    rc64m_gf2_zero(inv);
+    for(uint64_t cols = s; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        inv->rows[c] = b[pvt[c]];
+    }
+    *di = s;
+}
+
+/* usage: Given 2 RC64MGF2 m and n, compute m * n
+ * params:
+ *      1) p: ptr to a struct RC64MGF2, container for the result
+ *      2) m: ptr to a struct RC64MGF2
+ *      3) n: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_mul(RC64MGF2* restrict p, const RC64MGF2* restrict m,
+              const RC64MGF2* restrict n) {
+    for(uint32_t i = 0; i < 64; ++i)
+        p->rows[i] = rc64m_gf2_vec_mul(m->rows[i], n);
+}
+
+/* usage: Given 2 RC64MGF2 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct RC64MGF2, storing the matrix A
+ *      2) b: ptr to struct RC64MGF2, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+rc64m_gf2_mixi(RC64MGF2* restrict a, const RC64MGF2* restrict b, uint64_t di) {
+    for(uint32_t i = 0; i < 64; ++i)
+        a->rows[i] = (a->rows[i] & di) | (b->rows[i] & ~di);
+}
@@ -0,0 +1,94 @@
+#ifndef __RC64M_GF2_H__
+#define __RC64M_GF2_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "util.h"
+
+// 64 x 64 matrix over GF(2). The i-th row is a bitmap of its entries: if the
+// j-th bit of rows[i] is set, then entry (i, j) is 1.
+typedef struct {
+    uint64_t rows[64];
+} RC64MGF2;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Given a struct RC64MGF2, set it to the identity matrix
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_identity(RC64MGF2* m);
+
+/* usage: Given a struct RC64MGF2, set it to zero
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_zero(RC64MGF2* m);
+
+/* usage: Given a struct RC64MGF2, check if it's symmetric
+ * params:
+ *      1) m: ptr to a struct RC64MGF2
+ * return: true if symmetric, false otherwise */
+bool
+rc64m_gf2_is_symmetric(const RC64MGF2* m);
+
+/* usage: Given a symmetric RC64MGF2 m, select a subset S of its columns such
+ *      that the submatrix with rows and columns in S is invertible and has
+ *      the same rank as m, and compute the inverse of that submatrix. The
+ *      columns not in pref are selected first, which is the choice that keeps
+ *      the Lanczos vectors of consecutive iterations independent over GF(2).
+ * params:
+ *      1) m: ptr to a struct RC64MGF2, must be symmetric
+ *      2) inv: ptr to a struct RC64MGF2, container for the inverse. The rows
+ *          and columns not in S are cleared to zero
+ *      3) di: ptr to an uint64_t, when the function returns di encodes S. If
+ *          the 1st column is selected, then the 1st bit (0x1ULL) is set, and
+ *          so on.
+ *      4) pref: a 64-bit integer that encodes the columns to consider last,
+ *          usually the selection of the previous iteration
+ * return: void */
+void
+rc64m_gf2_gj(const RC64MGF2* restrict m, RC64MGF2* restrict inv,
+             uint64_t* restrict di, uint64_t pref);
+
+/* usage: Given 2 RC64MGF2 m and n, compute m * n
+ * params:
+ *      1) p: ptr to a struct RC64MGF2, container for the result
+ *      2) m: ptr to a struct RC64MGF2
+ *      3) n: ptr to a struct RC64MGF2
+ * return: void */
+void
+rc64m_gf2_mul(RC64MGF2* restrict p, const RC64MGF2* restrict m,
+              const RC64MGF2* restrict n);
+
+/* usage: Given 2 RC64MGF2 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct RC64MGF2, storing the matrix A
+ *      2) b: ptr to struct RC64MGF2, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+rc64m_gf2_mixi(RC64MGF2* restrict a, const RC64MGF2* restrict b, uint64_t di);
+
+/* usage: Given a 64-bit row vector x and a struct RC64MGF2 m, compute x * m
+ * params:
+ *      1) x: the row vector, encoded as a bitmap
+ *      2) m: ptr to a struct RC64MGF2
+ * return: the product, encoded as a bitmap */
+static inline uint64_t
+rc64m_gf2_vec_mul(uint64_t x, const RC64MGF2* m) {
+    uint64_t res = 0;
+    for(; x; x &= x - 1)
+        res ^= m->rows[uint64_t_ctz(x)];
+    return res;
+}
+
+#endif // __RC64M_GF2_H__
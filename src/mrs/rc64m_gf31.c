@@ -0,0 +1,202 @@
+#include "rc64m_gf31.h"
+#include "uint64a.h"
+#include <string.h>
+#include <assert.h>
+
+/* ========================================================================
+ * function implementations
+ * ======================================================================== */
+
+/* usage: Given a struct RC64MGF31, set it to the identity matrix
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_identity(RC64MGF31* m) {
+    rc64m_gf31_zero(m);
+    for(uint32_t i = 0; i < 64; ++i)
+        m->rows[i][i] = 1;
+}
+
+/* usage: Given a struct RC64MGF31, set it to zero
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_zero(RC64MGF31* m) {
+    memset(m->rows, 0x0, sizeof(m->rows));
+}
+
+/* usage: Given a struct RC64MGF31, check if it's symmetric
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: true if symmetric, false otherwise */
+bool
+rc64m_gf31_is_symmetric(const RC64MGF31* m) {
+    for(uint32_t i = 0; i < 64; ++i) {
+        for(uint32_t j = i + 1; j < 64; ++j) {
+            if(m->rows[i][j] != m->rows[j][i])
+                return false;
+        }
+    }
+    return true;
+}
+
+/* usage: Given a struct RC64MGF31, copy its rows into 16-bit lanes for the
+ *      products computed with gf31_t_arr_acc_vec_mul64
+ * params:
+ *      1) w: array of 64 x 64 uint16_t, container for the result
+ *      2) m: ptr to a struct RC64MGF31
+ *      3) d: a 64-bit integer that encodes the columns to copy. If the i-th
+ *          bit is 0, then the i-th column of the result is zero
+ * return: void */
+void
+rc64m_gf31_widen(uint16_t* restrict w, const RC64MGF31* restrict m,
+                 uint64_t d) {
+    for(uint32_t i = 0; i < 64; ++i)
+        gf31_t_arr_widen_64(w + 64 * i, m->rows[i]);
+    if(d == UINT64_MAX)
+        return;
+    for(uint64_t cols = ~d; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        for(uint32_t i = 0; i < 64; ++i)
+            w[64 * i + c] = 0;
+    }
+}
+
+/* subroutine of rc64m_gf31_gj: try to add a column of m to the basis of the
+ *      columns selected so far. Each basis vector is stored at the index of
+ *      its first non-zero entry, which is normalized to 1. Return true if the
+ *      column is independent of the basis */
+static inline bool
+rc64m_gf31_basis_insert(gf31_t basis[64][64], bool* restrict used,
+                        const gf31_t* restrict col) {
+    alignas(64) gf31_t x[64];
+    memcpy(x, col, sizeof(x));
+    for(uint32_t p = 0; p < 64; ++p) {
+        if(!x[p])
+            continue;
+        if(!used[p]) {
+            gf31_t_arr_muli_scalar64(x, gf31_t_inv(x[p]));
+            memcpy(basis[p], x, sizeof(x));
+            used[p] = true;
+            return true;
+        }
+        // clears entry p, only touches the later entries
+        gf31_t_arr_fmsubi_scalar64(x, basis[p], x[p]);
+    }
+    return false;
+}
+
+/* usage: Given a symmetric RC64MGF31 m, select a subset S of its columns such
+ *      that the submatrix with rows and columns in S is invertible and has
+ *      the same rank as m, and compute the inverse of that submatrix. The
+ *      columns not in pref are selected first, which is the choice that keeps
+ *      the Lanczos vectors of consecutive iterations independent.
+ * params:
+ *      1) m: ptr to a struct RC64MGF31, must be symmetric
+ *      2) inv: ptr to a struct RC64MGF31, container for the inverse. The rows
+ *          and columns not in S are cleared to zero
+ *      3) di: ptr to an uint64_t, when the function returns di encodes S. If
+ *          the 1st column is selected, then the 1st bit (0x1ULL) is set, and
+ *          so on.
+ *      4) pref: a 64-bit integer that encodes the columns to consider last,
+ *          usually the selection of the previous iteration
+ * return: void */
+void
+rc64m_gf31_gj(const RC64MGF31* restrict m, RC64MGF31* restrict inv,
+              uint64_t* restrict di, uint64_t pref) {
+    // a basis of the column space of a symmetric matrix indexes an invertible
+    // principal submatrix, so the columns are selected greedily. Since m is
+    // symmetric, its i-th column is its i-th row
+    RC64MGF31 a, b;
+    bool used[64] = {0};
+    uint64_t s = 0;
+    const uint64_t order[2] = { ~pref, pref };
+    for(uint32_t k = 0; k < 2; ++k) {
+        for(uint64_t cols = order[k]; cols; cols = uint64_t_clear_lsb(cols)) {
+            uint64_t c = uint64_t_ctz(cols);
+            if(rc64m_gf31_basis_insert(a.rows, used, m->rows[c]))
+                s |= 0x1ULL << c;
+        }
+    }
+
+    // Gauss-Jordan on the submatrix, and apply the same to the identity
+    rc64m_gf31_zero(&a);
+    rc64m_gf31_zero(&b);
+    for(uint64_t rows = s; rows; rows = uint64_t_clear_lsb(rows)) {
+        uint64_t r = uint64_t_ctz(rows);
+        for(uint64_t cols = s; cols; cols = uint64_t_clear_lsb(cols)) {
+            uint64_t c = uint64_t_ctz(cols);
+            a.rows[r][c] = m->rows[r][c];
+        }
+        b.rows[r][r] = 1;
+    }
+    uint32_t pvt[64];
+    uint64_t free_rows = s;
+    for(uint64_t cols = s; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        uint64_t cand = free_rows;
+        while(cand && !a.rows[uint64_t_ctz(cand)][c])
+            cand = uint64_t_clear_lsb(cand);
+        assert(cand); // the submatrix is invertible
+        uint64_t r = uint64_t_ctz(cand);
+        free_rows ^= 0x1ULL << r;
+        pvt[c] = r;
+        gf31_t pinv = gf31_t_inv(a.rows[r][c]);
+        gf31_t_arr_muli_scalar64(a.rows[r], pinv);
+        gf31_t_arr_muli_scalar64(b.rows[r], pinv);
+        for(uint64_t rows = s ^ (0x1ULL << r); rows;
+            rows = uint64_t_clear_lsb(rows)) {
+            uint64_t j = uint64_t_ctz(rows);
+            gf31_t f = a.rows[j][c];
+            gf31_t_arr_fmsubi_scalar64(a.rows[j], a.rows[r], f);
+            gf31_t_arr_fmsubi_scalar64(b.rows[j], b.rows[r], f);
+        }
+    }
+
+    // the pivot rows now form a permutation matrix, which is undone here
+    rc64m_gf31_zero(inv);
+    for(uint64_t cols = s; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        memcpy(inv->rows[c], b.rows[pvt[c]], sizeof(inv->rows[c]));
+    }
+    *di = s;
+}
+
+/* usage: Given 2 RC64MGF31 m and n, compute m * n
+ * params:
+ *      1) p: ptr to a struct RC64MGF31, container for the result
+ *      2) m: ptr to a struct RC64MGF31
+ *      3) n: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_mul(RC64MGF31* restrict p, const RC64MGF31* restrict m,
+               const RC64MGF31* restrict n) {
+    alignas(64) uint16_t w[64 * 64];
+    alignas(64) uint16_t acc[64];
+    rc64m_gf31_widen(w, n, UINT64_MAX);
+    for(uint32_t i = 0; i < 64; ++i) {
+        gf31_t_arr_acc_vec_mul64(acc, m->rows[i], w);
+        gf31_t_arr_from_acc64(p->rows[i], acc);
+    }
+}
+
+/* usage: Given 2 RC64MGF31 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct RC64MGF31, storing the matrix A
+ *      2) b: ptr to struct RC64MGF31, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+rc64m_gf31_mixi(RC64MGF31* restrict a, const RC64MGF31* restrict b,
+                uint64_t di) {
+    for(uint64_t cols = ~di; cols; cols = uint64_t_clear_lsb(cols)) {
+        uint64_t c = uint64_t_ctz(cols);
+        for(uint32_t i = 0; i < 64; ++i)
+            a->rows[i][c] = b->rows[i][c];
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef __RC64M_GF31_H__
+#define __RC64M_GF31_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+
+#include "gf31.h"
+#include "util.h"
+
+// 64 x 64 matrix over GF(31), stored row by row with 1 byte per entry
+typedef struct {
+    alignas(64) gf31_t rows[64][64];
+} RC64MGF31;
+
+/* ========================================================================
+ * function prototypes
+ * ======================================================================== */
+
+/* usage: Given a struct RC64MGF31, set it to the identity matrix
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_identity(RC64MGF31* m);
+
+/* usage: Given a struct RC64MGF31, set it to zero
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_zero(RC64MGF31* m);
+
+/* usage: Given a struct RC64MGF31, check if it's symmetric
+ * params:
+ *      1) m: ptr to a struct RC64MGF31
+ * return: true if symmetric, false otherwise */
+bool
+rc64m_gf31_is_symmetric(const RC64MGF31* m);
+
+/* usage: Given a struct RC64MGF31, copy its rows into 16-bit lanes for the
+ *      products computed with gf31_t_arr_acc_vec_mul64
+ * params:
+ *      1) w: array of 64 x 64 uint16_t, container for the result
+ *      2) m: ptr to a struct RC64MGF31
+ *      3) d: a 64-bit integer that encodes the columns to copy. If the i-th
+ *          bit is 0, then the i-th column of the result is zero
+ * return: void */
+void
+rc64m_gf31_widen(uint16_t* restrict w, const RC64MGF31* restrict m, uint64_t d);
+
+/* usage: Given a symmetric RC64MGF31 m, select a subset S of its columns such
+ *      that the submatrix with rows and columns in S is invertible and has
+ *      the same rank as m, and compute the inverse of that submatrix. The
+ *      columns not in pref are selected first, which is the choice that keeps
+ *      the Lanczos vectors of consecutive iterations independent.
+ * params:
+ *      1) m: ptr to a struct RC64MGF31, must be symmetric
+ *      2) inv: ptr to a struct RC64MGF31, container for the inverse. The rows
+ *          and columns not in S are cleared to zero
+ *      3) di: ptr to an uint64_t, when the function returns di encodes S. If
+ *          the 1st column is selected, then the 1st bit (0x1ULL) is set, and
+ *          so on.
+ *      4) pref: a 64-bit integer that encodes the columns to consider last,
+ *          usually the selection of the previous iteration
+ * return: void */
+void
+rc64m_gf31_gj(const RC64MGF31* restrict m, RC64MGF31* restrict inv,
+              uint64_t* restrict di, uint64_t pref);
+
+/* usage: Given 2 RC64MGF31 m and n, compute m * n
+ * params:
+ *      1) p: ptr to a struct RC64MGF31, container for the result
+ *      2) m: ptr to a struct RC64MGF31
+ *      3) n: ptr to a struct RC64MGF31
+ * return: void */
+void
+rc64m_gf31_mul(RC64MGF31* restrict p, const RC64MGF31* restrict m,
+               const RC64MGF31* restrict n);
+
+/* usage: Given 2 RC64MGF31 A and B, replace a subset of columns of A with
+ *      corresponding columns of B
+ * params:
+ *      1) a: ptr to struct RC64MGF31, storing the matrix A
+ *      2) b: ptr to struct RC64MGF31, storing the matrix B
+ *      3) di: a 64-bit integer that encodes which columns of A to keep. If
+ *          the LSB is 1, then the first column of A is keep. If 0, then the
+ *          first column of A is replaced by the first column  of B
+ * return: void */
+void
+rc64m_gf31_mixi(RC64MGF31* restrict a, const RC64MGF31* restrict b,
+                uint64_t di);
+
+#endif // __RC64M_GF31_H__
@@ -1,10 +1,13 @@
 /* thpool.c: implementation of thpool.h */
 
+#define _GNU_SOURCE             // for pthread_setaffinity_np
 #include "thpool.h"
+#include "prof.h"
 
 #include <stdlib.h>
 #include <signal.h>
 #include <pthread.h>            // requires -lpthread at link time
+#include <sched.h>
 #include <unistd.h>
 #include <errno.h>
 #include <setjmp.h>
@@ -51,11 +54,11 @@ struct Threadpool {
     Thread threads[];
 };
 
-// Global handle to the threadpool; Necessary because it's not possible to pass
-// extra arguments to signal handlers. Using a global handle restricts the
-// number of Threadpool to only one. I.e. a process must not create multiple
-// Threadpools.
-static Threadpool* g_tp_handle;
+// The worker running on the current thread; Necessary because it's not
+// possible to pass extra arguments to signal handlers. The signals are sent to
+// a worker with pthread_kill(), so the handler runs on the worker itself, and
+// any number of Threadpools may coexist in a process.
+static __thread Thread* tl_worker;
 
 /* ========================================================================
  * function implementations
@@ -153,13 +156,13 @@ static inline void
 thpool_worker_sa_handler_pause(int sig_id) {
     (void) sig_id; // get rid of 'unused param' warning from compiler
 
-    Threadpool* tp = g_tp_handle;
-    if(!tp)
+    Thread* t = tl_worker;
+    if(!t)
         return;
 
     // NOTE: cannot use a condition variable because only async-signal-safe
     // functions are allowed in a signal handler.
-    while(tp->pause)
+    while(t->pool->pause)
         sleep(1);
 }
 
@@ -168,23 +171,11 @@ static inline void
 thpool_worker_sa_handler_terminate(int sig_id) {
     (void) sig_id; // get rid of 'unused param' warning from compiler
 
-    Threadpool* tp = g_tp_handle;
-    if(!tp)
+    Thread* t = tl_worker;
+    if(!t)
         return;
 
-    // find the Thread data structure for this thread; just do
-    // a linear search because there're not so many threads.
-    pthread_t own_pid = pthread_self();
-    int64_t idx = -1;
-    for(int64_t i = 0; i < tp->init_capacity; ++i) {
-        if(tp->threads[i].pthread == own_pid) {
-            idx = i;
-            break;
-        }
-    }
-
-    assert(idx != -1);
-    longjmp(*(tp->threads[idx].envp), 36); // NOTE: 2nd param can be anything
+    longjmp(*(t->envp), 36); // NOTE: 2nd param can be anything
 }
 
 /* usage: internal worker that dequeue jobs from the jobqueue and execute them.
@@ -193,6 +184,8 @@ thpool_worker_sa_handler_terminate(int sig_id) {
  * return : void*, as per requirement of pthread */
 static inline void*
 thpool_worker(Thread* t) {
+    tl_worker = t;
+
     // register signal handlers
     struct sigaction sig_info;
     sigset_t block_mask;
@@ -324,6 +317,19 @@ thpool_worker(Thread* t) {
     return NULL;
 }
 
+/* usage: entry point of the workers. Performance counters are per thread, so
+ *      they are opened and closed by the worker itself around thpool_worker()
+ * params:
+ *      1) t: ptr to Thread storing info for the worker
+ * return : void*, as per requirement of pthread */
+static void*
+thpool_worker_run(void* t) {
+    prof_perf_thread_attach();
+    void* rv = thpool_worker(t);
+    prof_perf_thread_detach();
+    return rv;
+}
+
 /* usage: subroutine of thpool_create(). Wait until threads created earlier are
  *      initialized, then perform a soft shutdown.
  * params:
@@ -365,16 +371,12 @@ thpool_worker_init_abort(Threadpool* tp, int64_t n) {
     return 0;
 }
 
-/* usage: create and initialize a threadpool; A process may only create one
- *      Threadpool at a time.
+/* usage: create and initialize a threadpool
  * params:
  *      1) n: number of worker threads to create in the threadpool
  * return: a ptr to Threadpool on success; NULL on error */
 Threadpool*
 thpool_create(int64_t n) {
-    if(g_tp_handle) // there can only be 1 Threadpool at a time
-        return NULL;
-
     if(n <= 0)
         return NULL;
 
@@ -449,7 +451,7 @@ thpool_create(int64_t n) {
         tp->threads[i].id = i;
         tp->threads[i].pool = tp;
         if(pthread_create(&tp->threads[i].pthread, NULL,
-                          (void* (*) (void*)) thpool_worker,
+                          thpool_worker_run,
                           (void*) (tp->threads + i))) {
             if(thpool_worker_init_abort(tp, i)) {
                 // NOTE: cannot release lock and condition vars in this case
@@ -487,11 +489,33 @@ thpool_create(int64_t n) {
         return NULL;
     }
 
-    // update the global handle
-    g_tp_handle = tp;
     return tp;
 }
 
+/* usage: given a threadpool, restrict its workers to the given CPUs. Each
+ *      worker may run on any of them
+ * params:
+ *      1) tp: ptr to Threadpool
+ *      2) cpus: indices of the CPUs
+ *      3) n: size of cpus
+ * return: 0 on success; non-zero value on error */
+int
+thpool_pin(Threadpool* restrict tp, const uint32_t* restrict cpus, uint32_t n) {
+    if(!tp)
+        return Threadpool_null;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(uint32_t i = 0; i < n; ++i)
+        CPU_SET(cpus[i], &set);
+
+    for(int64_t i = 0; i < tp->init_capacity; ++i) {
+        if(pthread_setaffinity_np(tp->threads[i].pthread, sizeof(set), &set))
+            return Threadpool_pin_fail;
+    }
+    return 0;
+}
+
 /* usage: given a threadpool, add a job to execute into the pool. This function
  *      blocks the calling thread if the job queue in the pool is full.
  * params:
@@ -853,7 +877,6 @@ thpool_destroy(Threadpool* tp, bool type) {
        pthread_cond_destroy(&tp->th_init_done))
         return Threadpool_free_fail;
 
-    g_tp_handle = NULL; // reset the global handle
     free(tp);
     return 0;
 }
@@ -16,6 +16,7 @@ typedef enum {
    Threadpool_null = -5,
    Threadpool_free_fail = -6,
    Threadpool_sleep_fail = -7,
+   Threadpool_pin_fail = -8,
    Threadpool_shutdown = 1,
 } ThreadpoolErrorType;
 
@@ -23,8 +24,7 @@ typedef enum {
  * function prototypes
  * ======================================================================== */
 
-/* usage: create and initialize a threadpool; A process may only create one
- *      Threadpool at a time.
+/* usage: create and initialize a threadpool
  * params:
  *      1) n: number of worker threads to create in the threadpool
  * return: a ptr to Threadpool on success; NULL on error */
@@ -39,6 +39,16 @@ thpool_create(int64_t n);
 int64_t
 thpool_alive_worker_num(Threadpool* tp);
 
+/* usage: given a threadpool, restrict its workers to the given CPUs. Each
+ *      worker may run on any of them
+ * params:
+ *      1) tp: ptr to Threadpool
+ *      2) cpus: indices of the CPUs
+ *      3) n: size of cpus
+ * return: 0 on success; non-zero value on error */
+int
+thpool_pin(Threadpool* restrict tp, const uint32_t* restrict cpus, uint32_t n);
+
 /* usage: given a threadpool, add a job to execute into the pool. This function
  *      blocks the calling thread if the job queue in the pool is full.
  * params:
@@ -0,0 +1,505 @@
+/* mrsbench.c: micro-benchmarks for the hot kernels of the solver. Each kernel
+ *      is timed with rdtsc and the wall clock, and reported in CSV or JSON:
+ *      - cycles per call
+ *      - cycles per unit of work, where a unit is a non-zero entry for the
+ *        sparse kernels and the Macaulay construction, and a GF(16) element
+ *        for the dense ones
+ *      - GB/s, counting the bytes each call has to move at least once
+ *      - the speedup over 1 thread. The parallel kernels are run with 1, 2,
+ *        4, ... threads up to the given number of threads */
+
+#include <cmsm_generic.h>
+#include <matrix_gf16.h>
+#include <grp64_gf16.h>
+#include <grp128_gf16.h>
+#include <grp256_gf16.h>
+#include <grp512_gf16.h>
+#include <gfm.h>
+#include <minrank.h>
+#include <mdeg.h>
+#include <mdmac.h>
+#include <thpool.h>
+#include <util.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define GRP_NUM             (1024) // number of groups for the fmaddi kernels
+#define GRP_REPS            (64) // passes over the groups per call
+#define MAX_MDEG_LEN        (16)
+
+typedef struct {
+    uint32_t rounds;
+    uint32_t tnum;
+    uint64_t rnum;
+    uint64_t cnum;
+    uint32_t col_wt;
+    uint32_t mr[4]; // nrow, ncol, k, r of the random MinRank instance
+    uint32_t mdeg[MAX_MDEG_LEN];
+    uint32_t mdeg_len;
+    bool json;
+} BenchOpts;
+
+/* a kernel and the work done by each call */
+typedef struct {
+    const char* kernel;
+    uint32_t threads;
+    uint64_t rnum;
+    uint64_t cnum;
+    uint64_t units;
+    double bytes;
+} Bench;
+
+static bool bench_first = true;
+static volatile uint8_t bench_sink; // keeps the results alive
+
+/* usage: return the wall clock in seconds
+ * params: void
+ * return: seconds since the epoch */
+static inline double
+wall_clock(void) {
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+#define BENCH(cycles, secs, expr) do { \
+    double __t = wall_clock(); \
+    uint64_t __start = rdtsc(); \
+    expr; \
+    (cycles) += rdtsc() - __start; \
+    (secs) += wall_clock() - __t; \
+} while(0)
+
+/* usage: print the result of a benchmark
+ * params:
+ *      1) o: ptr to BenchOpts
+ *      2) b: ptr to Bench
+ *      3) calls: number of calls measured
+ *      4) cycles: total number of cycles
+ *      5) secs: total wall clock time in seconds
+ *      6) base_secs: time of the same kernel with 1 thread; 0 if unknown
+ * return: void */
+static void
+bench_report(const BenchOpts* o, const Bench* b, uint32_t calls,
+             uint64_t cycles, double secs, double base_secs) {
+    const double cpc = (double) cycles / calls;
+    const double cpu = cpc / b->units;
+    const double gbps = (secs > 0) ? b->bytes * calls / secs / 1e9 : 0;
+    const double speedup = (base_secs > 0 && secs > 0) ? base_secs / secs : 1;
+    if(o->json) {
+        printf("%s  { \"kernel\": \"%s\", \"threads\": %u, \"rows\": %lu, "
+               "\"cols\": %lu, \"units\": %lu, \"cycles_per_call\": %.0f, "
+               "\"cycles_per_unit\": %.4f, \"gbps\": %.3f, \"speedup\": %.2f }",
+               bench_first ? "[\n" : ",\n", b->kernel, b->threads, b->rnum,
+               b->cnum, b->units, cpc, cpu, gbps, speedup);
+    } else {
+        if(bench_first)
+            printf("kernel,threads,rows,cols,units,cycles_per_call,"
+                   "cycles_per_unit,gbps,speedup\n");
+        printf("%s,%u,%lu,%lu,%lu,%.0f,%.4f,%.3f,%.2f\n", b->kernel,
+               b->threads, b->rnum, b->cnum, b->units, cpc, cpu, gbps, speedup);
+    }
+    bench_first = false;
+}
+
+/* usage: extract the function name from a call expression
+ * params:
+ *      1) call: the call expression as a string
+ * return: ptr to a static buffer holding the name */
+static const char*
+bench_fn_name(const char* call) {
+    static char buf[64];
+    size_t n = strcspn(call, "(");
+    n = (n < sizeof(buf) - 1) ? n : sizeof(buf) - 1;
+    memcpy(buf, call, n);
+    buf[n] = '\0';
+    return buf;
+}
+
+#define BENCH_GRP(o, name, type, size, call) do { \
+    type* a = aligned_alloc(64, sizeof(type) * GRP_NUM); \
+    type* b = aligned_alloc(64, sizeof(type) * GRP_NUM); \
+    if(!a || !b) { \
+        free(a); free(b); \
+        return false; \
+    } \
+    for(uint32_t i = 0; i < GRP_NUM; ++i) { \
+        name##_rand(a + i); \
+        name##_rand(b + i); \
+    } \
+    uint64_t cycles = 0; double secs = 0; \
+    for(uint32_t k = 0; k < (o)->rounds; ++k) { \
+        BENCH(cycles, secs, \
+            for(uint32_t j = 0; j < GRP_REPS; ++j) { \
+                for(uint32_t i = 0; i < GRP_NUM; ++i) { \
+                    const gf16_t c = (i + j) & 0xF; (void) c; \
+                    call; \
+                } \
+            }); \
+    } \
+    bench_sink ^= *(uint8_t*) a; \
+    Bench bi = { bench_fn_name(#call), 1, GRP_NUM, size, \
+                 (uint64_t) size * GRP_NUM * GRP_REPS, \
+                 3.0 * sizeof(type) * GRP_NUM * GRP_REPS }; \
+    bench_report(o, &bi, (o)->rounds, cycles, secs, 0); \
+    free(a); free(b); \
+} while(0)
+
+/* usage: benchmark the fmaddi kernels of the bitsliced groups
+ * params:
+ *      1) o: ptr to BenchOpts
+ * return: true on success, false if memory allocation failed */
+static bool
+bench_grp(const BenchOpts* o) {
+    uint64_t d64; memset(&d64, 0x5A, sizeof(d64));
+    uint128_t d128; memset(&d128, 0x5A, sizeof(d128));
+    uint256_t d256; memset(&d256, 0x5A, sizeof(d256));
+    uint512_t d512; memset(&d512, 0x5A, sizeof(d512));
+    BENCH_GRP(o, grp64_gf16, Grp64GF16, 64,
+              grp64_gf16_fmaddi_scalar(a + i, b + i, c));
+    BENCH_GRP(o, grp64_gf16, Grp64GF16, 64,
+              grp64_gf16_fmaddi_scalar_bs(a + i, b + i, b + (i ^ 1), j & 63));
+    BENCH_GRP(o, grp64_gf16, Grp64GF16, 64,
+              grp64_gf16_fmaddi_scalar_mask(a + i, b + i, c, d64));
+    BENCH_GRP(o, grp128_gf16, Grp128GF16, 128,
+              grp128_gf16_fmaddi_scalar(a + i, b + i, c));
+    BENCH_GRP(o, grp128_gf16, Grp128GF16, 128,
+              grp128_gf16_fmaddi_scalar_bs(a + i, b + i, b + (i ^ 1), j & 127));
+    BENCH_GRP(o, grp128_gf16, Grp128GF16, 128,
+              grp128_gf16_fmaddi_scalar_mask(a + i, b + i, c, &d128));
+    BENCH_GRP(o, grp256_gf16, Grp256GF16, 256,
+              grp256_gf16_fmaddi_scalar(a + i, b + i, c));
+    BENCH_GRP(o, grp256_gf16, Grp256GF16, 256,
+              grp256_gf16_fmaddi_scalar_mask(a + i, b + i, c, &d256));
+    BENCH_GRP(o, grp512_gf16, Grp512GF16, 512,
+              grp512_gf16_fmaddi_scalar(a + i, b + i, c));
+    BENCH_GRP(o, grp512_gf16, Grp512GF16, 512,
+              grp512_gf16_fmaddi_scalar_mask(a + i, b + i, c, &d512));
+    return true;
+}
+
+/* usage: return the next number of threads to try in the scaling runs
+ * params:
+ *      1) t: current number of threads
+ *      2) tnum: max number of threads
+ * return: the next number of threads, or 0 if t is already the max */
+static inline uint32_t
+bench_next_tnum(uint32_t t, uint32_t tnum) {
+    if(t >= tnum)
+        return 0;
+    return (t << 1 > tnum) ? tnum : t << 1;
+}
+
+/* usage: benchmark the sparse matrix multiplications and the Gramian matrix
+ *      used by each iteration of Block Lanczos, with the serial versions and
+ *      the parallel versions at different number of threads
+ * params:
+ *      1) o: ptr to BenchOpts
+ * return: true on success, false if memory allocation failed */
+static bool
+bench_lanczos(const BenchOpts* o) {
+    CMSMGeneric* m = cmsm_generic_rand(o->rnum, o->cnum, o->col_wt);
+    RMGF16* v = rm_gf16_create(o->rnum);
+    RMGF16* mtv = rm_gf16_create(o->cnum);
+    RMGF16* av = rm_gf16_create(o->rnum);
+    RMGF16** partials = calloc(o->tnum, sizeof(RMGF16*));
+    RMGF16PArg* args = malloc(sizeof(RMGF16PArg) * o->tnum);
+    RCMGF16* g = rcm_gf16_create();
+    RCMGF16* gbuf = rcm_gf16_arr_create(o->tnum);
+    pthread_mutex_t lock;
+    bool ok = m && v && mtv && av && partials && args && g && gbuf &&
+              !pthread_mutex_init(&lock, NULL);
+    for(uint32_t i = 0; ok && i < o->tnum; ++i)
+        ok = (NULL != (partials[i] = rm_gf16_create(o->rnum)));
+    if(!ok)
+        goto bench_lanczos_end;
+
+    rm_gf16_rand(v);
+    rm_gf16_rand(mtv);
+    const uint64_t nznum = cmsm_generic_nznum(m);
+    const double row_sz = sizeof(RowGF16);
+    // each non-zero entry reads its index and a row of the input. The
+    // output is written once
+    Bench bmv = { "cmsm_gf16_mul_rm", 1, o->rnum, o->cnum, nznum,
+                  nznum * (sizeof(gfa_idx_t) + row_sz) + o->rnum * row_sz };
+    Bench btr = { "cmsm_gf16_tr_mul_rm", 1, o->rnum, o->cnum, nznum,
+                  nznum * (sizeof(gfa_idx_t) + row_sz) + o->cnum * row_sz };
+    Bench bgr = { "rm_gf16_gramian", 1, o->rnum, BLK_LANCZOS_BLOCK_SIZE,
+                  o->rnum * BLK_LANCZOS_BLOCK_SIZE,
+                  o->rnum * row_sz + rcm_gf16_memsize() };
+
+    uint64_t cycles[3] = {0}; double secs[3] = {0};
+    for(uint32_t k = 0; k < o->rounds; ++k) {
+        BENCH(cycles[0], secs[0], cmsm_gf16_mul_rm(av, m, mtv));
+        BENCH(cycles[1], secs[1], cmsm_gf16_tr_mul_rm(mtv, m, v));
+        BENCH(cycles[2], secs[2], rm_gf16_gramian(v, g));
+    }
+    bench_report(o, &bmv, o->rounds, cycles[0], secs[0], 0);
+    bench_report(o, &btr, o->rounds, cycles[1], secs[1], 0);
+    bench_report(o, &bgr, o->rounds, cycles[2], secs[2], 0);
+
+    bmv.kernel = "cmsm_gf16_mul_rm_parallel";
+    btr.kernel = "cmsm_gf16_tr_mul_rm_parallel";
+    bgr.kernel = "rm_gf16_gramian_parallel";
+    double base[3] = {0};
+    for(uint32_t t = 1; t; t = bench_next_tnum(t, o->tnum)) {
+        Threadpool* tp = thpool_create(t);
+        if(!tp) {
+            ok = false;
+            goto bench_lanczos_end;
+        }
+        memset(cycles, 0x0, sizeof(cycles));
+        memset(secs, 0x0, sizeof(secs));
+        for(uint32_t k = 0; k < o->rounds; ++k) {
+            BENCH(cycles[0], secs[0],
+                  cmsm_gf16_mul_rm_parallel(av, m, mtv, t, partials, args, tp,
+                                            &lock));
+            BENCH(cycles[1], secs[1],
+                  cmsm_gf16_tr_mul_rm_parallel(mtv, m, v, t, args, tp));
+            BENCH(cycles[2], secs[2],
+                  rm_gf16_gramian_parallel(v, g, t, gbuf, args, tp));
+        }
+        thpool_destroy(tp, true);
+        if(t == 1)
+            memcpy(base, secs, sizeof(secs));
+        bmv.threads = btr.threads = bgr.threads = t;
+        bench_report(o, &bmv, o->rounds, cycles[0], secs[0], base[0]);
+        bench_report(o, &btr, o->rounds, cycles[1], secs[1], base[1]);
+        bench_report(o, &bgr, o->rounds, cycles[2], secs[2], base[2]);
+    }
+    bench_sink ^= rcm_gf16_at(g, 0, 0) ^ rm_gf16_at(av, 0, 0);
+    pthread_mutex_destroy(&lock);
+
+bench_lanczos_end:
+    cmsm_generic_free(m);
+    rm_gf16_free(v);
+    rm_gf16_free(mtv);
+    rm_gf16_free(av);
+    if(partials) {
+        for(uint32_t i = 0; i < o->tnum; ++i)
+            rm_gf16_free(partials[i]);
+    }
+    free(partials);
+    free(args);
+    rcm_gf16_free(g);
+    rcm_gf16_arr_free(gbuf);
+    return ok;
+}
+
+/* usage: benchmark the dense kernels on the small square matrices of Block
+ *      Lanczos
+ * params:
+ *      1) o: ptr to BenchOpts
+ * return: true on success, false if memory allocation failed */
+static bool
+bench_rcm(const BenchOpts* o) {
+    RCMGF16* a = rcm_gf16_create();
+    RCMGF16* b = rcm_gf16_create();
+    RCMGF16* c = rcm_gf16_create();
+    RCMGF16* inv = rcm_gf16_create();
+    bool ok = a && b && c && inv;
+    if(!ok)
+        goto bench_rcm_end;
+
+    rcm_gf16_rand(a);
+    rcm_gf16_rand(b);
+    const uint64_t units = BLK_LANCZOS_BLOCK_SIZE * BLK_LANCZOS_BLOCK_SIZE;
+    Bench bgj = { "rcm_gf16_gj", 1, BLK_LANCZOS_BLOCK_SIZE,
+                  BLK_LANCZOS_BLOCK_SIZE, units, 4.0 * rcm_gf16_memsize() };
+    Bench bmul = { "rcm_gf16_mul_naive", 1, BLK_LANCZOS_BLOCK_SIZE,
+                   BLK_LANCZOS_BLOCK_SIZE, units, 3.0 * rcm_gf16_memsize() };
+    uint64_t cycles[2] = {0}; double secs[2] = {0};
+    for(uint32_t k = 0; k < o->rounds; ++k) {
+        DiagMGF16 di;
+        rcm_gf16_copy(c, a);
+        rcm_gf16_identity(inv);
+        BENCH(cycles[0], secs[0], rcm_gf16_gj(c, inv, &di));
+        BENCH(cycles[1], secs[1], rcm_gf16_mul_naive(c, a, b));
+    }
+    bench_report(o, &bgj, o->rounds, cycles[0], secs[0], 0);
+    bench_report(o, &bmul, o->rounds, cycles[1], secs[1], 0);
+    bench_sink ^= rcm_gf16_at(c, 0, 0) ^ rcm_gf16_at(inv, 0, 0);
+
+bench_rcm_end:
+    rcm_gf16_free(a);
+    rcm_gf16_free(b);
+    rcm_gf16_free(c);
+    rcm_gf16_free(inv);
+    return ok;
+}
+
+/* usage: benchmark the construction of the multi-degree Macaulay matrix of a
+ *      random MinRank instance, and of the sparse matrix to eliminate from it
+ * params:
+ *      1) o: ptr to BenchOpts
+ * return: true on success, false otherwise */
+static bool
+bench_mac(const BenchOpts* o) {
+    const uint32_t c = o->mdeg_len - 1;
+    MinRank* mr = NULL; GFM* ks = NULL; MDeg* mdeg = NULL;
+    MDMac* mac = NULL; MDMacColIterator* it = NULL; uint32_t* nznums = NULL;
+    GFM* m0 = gfm_rand_mat(o->mr[0], o->mr[1]);
+    bool ok = m0 &&
+              (mr = minrank_create(o->mr[0], o->mr[1], o->mr[2], o->mr[3], m0, NULL)) &&
+              (ks = minrank_ks(mr, c)) && (mdeg = mdeg_create(c, o->mdeg));
+    if(!mr)
+        gfm_free(m0);
+    if(!ok)
+        goto bench_mac_end;
+
+    uint64_t cycles[2] = {0}; double secs[2] = {0};
+    uint64_t rnum = 0, cnum = 0, nznum = 0, mac_nznum = 0;
+    double mem = 0;
+    for(uint32_t k = 0; k < o->rounds; ++k) {
+        BENCH(cycles[0], secs[0], mac = mdmac_create_from_ks(ks, mr, mdeg));
+        if(!mac || !(it = mdmac_col_iter_create_from_mdmac(mac, mdeg_is_nonlinear)) ||
+           !(nznums = malloc(sizeof(uint32_t) * mdmac_ncol(mac)))) {
+            ok = false;
+            goto bench_mac_end;
+        }
+        rnum = mdmac_nrow(mac);
+        mac_nznum = mdmac_nznum(nznums, mac, rnum, k);
+        cnum = nznum = 0;
+        for(mdmac_col_iter_begin(it); !mdmac_col_iter_end(it); mdmac_col_iter_next(it)) {
+            nznum += nznums[mdmac_col_iter_idx(it)];
+            ++cnum;
+        }
+        CMSMGeneric* m = NULL;
+        BENCH(cycles[1], secs[1],
+              m = cmsm_generic_from_mdmac(mac, rnum, k, it, nznums, nznum));
+        if(!m) {
+            ok = false;
+            goto bench_mac_end;
+        }
+        mem = cmsm_generic_calc_mem_size(rnum, cnum, nznum);
+        cmsm_generic_free(m);
+        mdmac_col_iter_free(it);
+        it = NULL;
+        mdmac_free(mac);
+        mac = NULL;
+        free(nznums);
+        nznums = NULL;
+    }
+    const double mac_mem = mdmac_calc_memsize(o->mr[2], o->mr[3], mdeg, o->mr[1],
+                                              gfm_find_max_tnum_per_eq(ks));
+    Bench bmac = { "mdmac_create_from_ks", 1, rnum, cnum, mac_nznum, mac_mem };
+    Bench bcmsm = { "cmsm_generic_from_mdmac", 1, rnum, cnum, nznum, mem };
+    bench_report(o, &bmac, o->rounds, cycles[0], secs[0], 0);
+    bench_report(o, &bcmsm, o->rounds, cycles[1], secs[1], 0);
+
+bench_mac_end:
+    free(nznums);
+    mdmac_col_iter_free(it);
+    mdmac_free(mac);
+    mdeg_free(mdeg);
+    gfm_free(ks);
+    minrank_free(mr);
+    return ok;
+}
+
+/* usage: parse a list of comma-separated unsigned integers
+ * params:
+ *      1) out: array to store the integers
+ *      2) max: size of the array
+ *      3) str: the list
+ * return: number of integers, or 0 if the list is invalid */
+static uint32_t
+parse_uint_list(uint32_t* restrict out, uint32_t max, const char* restrict str) {
+    uint32_t n = 0;
+    while(n < max) {
+        char* end;
+        out[n++] = strtoul(str, &end, 10);
+        if(end == str)
+            return 0;
+        if(*end == '\0')
+            return n;
+        if(*end != ',')
+            return 0;
+        str = end + 1;
+    }
+    return 0;
+}
+
+static const char* const usage_msg =
+"Usage: %s [OPTIONS]\n"
+"Benchmark the kernels of the solver, and report cycles per call, cycles per\n"
+"non-zero entry (or GF(16) element), GB/s and speedup over 1 thread.\n"
+"\n"
+"  --rounds=N       Number of calls to time for each kernel. Default: 10\n"
+"  --thread=N       Max number of threads. Default: number of CPU cores\n"
+"  --rows=N         Number of rows of the random sparse matrix. Default: 20000\n"
+"  --cols=N         Number of columns of the random sparse matrix.\n"
+"                   Default: 14000\n"
+"  --weight=N       Number of non-zero entries in a column of the random\n"
+"                   sparse matrix. Default: 140\n"
+"  --minrank=N,M,K,R\n"
+"                   Dimension of the matrices, number of matrices and target\n"
+"                   rank of the random MinRank instance for the Macaulay\n"
+"                   construction. Default: 15,30,20,3\n"
+"  --mdeg=DEG       Multi-degree of the Macaulay matrix. Default: 2,1,1\n"
+"  --json           Print the results in JSON instead of CSV\n"
+"  --help           Print this message\n";
+
+int
+main(int argc, char* argv[]) {
+    BenchOpts o = {
+        .rounds = 10, .tnum = get_cpu_core_count(), .rnum = 20000,
+        .cnum = 14000, .col_wt = 140, .mr = { 15, 30, 20, 3 },
+        .mdeg = { 2, 1, 1 }, .mdeg_len = 3, .json = false,
+    };
+    static const struct option long_opts[] = {
+        { "rounds", 1, 0, 'n' },
+        { "thread", 1, 0, 't' },
+        { "rows", 1, 0, 'r' },
+        { "cols", 1, 0, 'c' },
+        { "weight", 1, 0, 'w' },
+        { "minrank", 1, 0, 'm' },
+        { "mdeg", 1, 0, 'd' },
+        { "json", 0, 0, 'j' },
+        { "help", 0, 0, 'h' },
+        { 0, 0, 0, 0 },
+    };
+    int c;
+    bool ok = true;
+    while(ok && -1 != (c = getopt_long(argc, argv, "h", long_opts, NULL))) {
+        switch(c) {
+            case 'n': ok = (o.rounds = strtoul(optarg, NULL, 0)) != 0; break;
+            case 't': ok = (o.tnum = strtoul(optarg, NULL, 0)) != 0; break;
+            case 'r': ok = (o.rnum = strtoull(optarg, NULL, 0)) != 0; break;
+            case 'c': ok = (o.cnum = strtoull(optarg, NULL, 0)) != 0; break;
+            case 'w': ok = (o.col_wt = strtoul(optarg, NULL, 0)) != 0; break;
+            case 'm': ok = parse_uint_list(o.mr, 4, optarg) == 4; break;
+            case 'd':
+                ok = (o.mdeg_len = parse_uint_list(o.mdeg, MAX_MDEG_LEN, optarg)) > 1;
+                break;
+            case 'j': o.json = true; break;
+            case 'h':
+                printf(usage_msg, argv[0]);
+                return 0;
+            default: ok = false; break;
+        }
+    }
+    if(!ok || optind != argc || o.col_wt > o.rnum) {
+        printf_err(usage_msg, argv[0]);
+        return 1;
+    }
+    srand(time(NULL));
+
+    int rval = 0;
+    if(!bench_grp(&o) || !bench_rcm(&o) || !bench_lanczos(&o)) {
+        printf_err("[!] Failed to allocate memory\n");
+        rval = 1;
+    } else if(!bench_mac(&o)) {
+        printf_err("[!] Failed to construct the Macaulay matrix\n");
+        rval = 1;
+    }
+    if(o.json && !bench_first)
+        printf("\n]\n");
+    return rval;
+}
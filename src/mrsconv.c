@@ -0,0 +1,61 @@
+/* mrsconv.c: convert a MinRank instance from the text format into the binary
+ *      format, which mrsolver loads without parsing. See loader.h for both
+ *      formats. The input can also be a binary file, e.g. to check it */
+
+#include <loader.h>
+#include <gfm.h>
+#include <util.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char*
+loader_code_to_str(enum LoaderGFMfromFileCode code) {
+    switch(code) {
+        case SUCCESS:
+            return "success";
+        case FOPEN_FAIL:
+            return "cannot open the file";
+        case FORMAT_ERR:
+            return "invalid format";
+        case FILE_EOF:
+            return "unexpected end of file";
+        case MEM_ERR:
+            return "out of memory";
+        case FWRITE_FAIL:
+            return "cannot write the file";
+    }
+    return "unknown error";
+}
+
+int
+main(int argc, char* argv[]) {
+    if(argc != 3 || !strcmp(argv[1], "--help") || !strcmp(argv[1], "-h")) {
+        printf("Usage: %s INPUT OUTPUT\n"
+               "\n"
+               "Convert the MinRank instance in INPUT, in either the text or\n"
+               "the binary format, into the binary format in OUTPUT.\n",
+               argv[0]);
+        return (argc == 2) ? 0 : 1;
+    }
+
+    LoaderGFMfromFileRet rt;
+    enum LoaderGFMfromFileCode code = loader_gfm_from_file(&rt, argv[1]);
+    if(code != SUCCESS) {
+        printf_err_ts("[!] Failed to load %s: %s\n", argv[1],
+                      loader_code_to_str(code));
+        return 1;
+    }
+    printf_ts("[+] Loaded %s: n = %u, m = %u, k = %u, r = %u\n", argv[1],
+              rt.nrow, rt.ncol, rt.k, rt.r);
+
+    code = loader_gfm_to_bin_file(&rt, argv[2]);
+    gfm_free(rt.m0);
+    gfm_arr_free(rt.ms, rt.k);
+    if(code != SUCCESS) {
+        printf_err_ts("[!] Failed to write %s: %s\n", argv[2],
+                      loader_code_to_str(code));
+        return 1;
+    }
+    printf_ts("[+] Written %s\n", argv[2]);
+    return 0;
+}